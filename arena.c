@@ -0,0 +1,80 @@
+#include <stdio.h>
+#include <string.h>
+#include "arena.h"
+#include "compiler.h"
+
+void *arena_alloc(ARENA *arena, size_t size)
+{
+    ARENA_BLOCK *block = arena->head;
+    void *memory;
+
+    size = (size + 15) & ~(size_t)15;
+    if (!block || block->used + size > block->size)
+    {
+        size_t block_size = size > ARENA_BLOCK_SIZE ? size : ARENA_BLOCK_SIZE;
+        if (arena->spare && arena->spare->size >= size)
+        {
+            block = arena->spare;
+            arena->spare = block->next;
+        }
+        else
+        {
+            block = (ARENA_BLOCK *)malloc(sizeof(ARENA_BLOCK) + block_size);
+            if (!block)
+            {
+                compiler_fail("arena: out of memory\n");
+            }
+            block->size = block_size;
+        }
+        block->next = arena->head;
+        block->used = 0;
+        arena->head = block;
+    }
+
+    memory = block->data + block->used;
+    block->used += size;
+    memset(memory, 0, size);
+    return memory;
+}
+
+// moves the blocks allocated from other into arena, which keeps allocating from its own
+// head
+void arena_adopt(ARENA *arena, ARENA *other)
+{
+    ARENA_BLOCK *tail = other->head;
+    if (!tail)
+        return;
+    while (tail->next)
+        tail = tail->next;
+    if (arena->head)
+    {
+        tail->next = arena->head->next;
+        arena->head->next = other->head;
+    }
+    else
+        arena->head = other->head;
+    other->head = NULL;
+}
+
+void arena_free(ARENA *arena)
+{
+    arena_reset(arena);
+    while (arena->spare)
+    {
+        ARENA_BLOCK *next = arena->spare->next;
+        free(arena->spare);
+        arena->spare = next;
+    }
+}
+
+// releases everything allocated but keeps the blocks for the allocations to come
+void arena_reset(ARENA *arena)
+{
+    while (arena->head)
+    {
+        ARENA_BLOCK *next = arena->head->next;
+        arena->head->next = arena->spare;
+        arena->spare = arena->head;
+        arena->head = next;
+    }
+}
@@ -0,0 +1,24 @@
+#pragma once
+#include <stdlib.h>
+
+#define ARENA_BLOCK_SIZE 65536
+
+typedef struct arena_block
+{
+    struct arena_block *next;
+    size_t used;
+    size_t size;
+    char data[];
+} ARENA_BLOCK;
+
+// bump allocator: many small objects, released together
+typedef struct arena
+{
+    ARENA_BLOCK *head;
+    ARENA_BLOCK *spare; // blocks of an arena_reset, taken again before new ones
+} ARENA;
+
+void *arena_alloc(ARENA *arena, size_t size);
+void arena_free(ARENA *arena);
+void arena_reset(ARENA *arena);
+void arena_adopt(ARENA *arena, ARENA *other);
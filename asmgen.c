@@ -1,37 +1,660 @@
 #include "asmgen.h"
 #include "hash.h"
+#include "fragment.h"
 
-char *print_registers[2] = {
-    "esi", "edi"};
+// _name: followed by a single .long/.float/.string item
+void asm_data(MCODE *data, MOPERAND label, int op, MOPERAND value)
+{
+    minstr_emit(data, MI_LABEL, 0, mop_none(), label);
+    minstr_emit(data, op, 4, mop_none(), value);
+}
+
+// zero-initialised scalars go to .bss
+void asm_bss(MCODE *bss, MOPERAND label)
+{
+    minstr_emit(bss, MI_LABEL, 0, mop_none(), label);
+    minstr_emit(bss, MI_ZERO, 4, mop_none(), mop_imm(4));
+}
+
+MOPERAND asm_constant(int bits)
+{
+    int i;
+    for (i = 0; i < compiler->assembly->constants.count && compiler->assembly->constants.bits[i] != bits; i++)
+        ;
+    if (i == compiler->assembly->constants.count)
+    {
+        if (compiler->assembly->constants.count == compiler->assembly->constants.size)
+        {
+            compiler->assembly->constants.size = compiler->assembly->constants.size ? 2 * compiler->assembly->constants.size : 16;
+            compiler->assembly->constants.bits = (int *)realloc(compiler->assembly->constants.bits, compiler->assembly->constants.size * sizeof(int));
+        }
+        compiler->assembly->constants.bits[compiler->assembly->constants.count++] = bits;
+    }
+    return mop_const(bits);
+}
+
+// an integer, char or real literal as a pool entry, for operands that cannot be immediates
+MOPERAND asm_literal(HASH *literal)
+{
+    float value;
+    int bits;
+    if (literal->type != SYMBOL_LIT_REAL)
+        return asm_constant(isel_literal_value(literal));
+    value = strtof(literal->text, NULL);
+    memcpy(&bits, &value, sizeof(bits));
+    return asm_constant(bits);
+}
+
+// commands that print the same things share a descriptor
+MOPERAND asm_format(char *text)
+{
+    int i;
+    for (i = 0; i < compiler->assembly->formats.count; i++)
+    {
+        if (strcmp(compiler->assembly->formats.text[i], text) == 0)
+            return mop_format(compiler->assembly->formats.id[i]);
+    }
+
+    if (compiler->assembly->formats.count == compiler->assembly->formats.size)
+    {
+        compiler->assembly->formats.size = compiler->assembly->formats.size ? 2 * compiler->assembly->formats.size : 16;
+        compiler->assembly->formats.text = (char **)realloc(compiler->assembly->formats.text, compiler->assembly->formats.size * sizeof(char *));
+        compiler->assembly->formats.id = (int *)realloc(compiler->assembly->formats.id, compiler->assembly->formats.size * sizeof(int));
+    }
+    compiler->assembly->formats.text[compiler->assembly->formats.count] = strdup(text);
+    compiler->assembly->formats.id[compiler->assembly->formats.count] = compiler->assembly->formats.next_id++;
+    return mop_format(compiler->assembly->formats.id[compiler->assembly->formats.count++]);
+}
+
+// the constants and descriptors used since the last call, appended to a .rodata section
+void asm_pool(MCODE *rodata)
+{
+    int i;
+    for (i = 0; i < compiler->assembly->formats.count; i++)
+    {
+        char *text = (char *)arena_alloc(&rodata->arena, strlen(compiler->assembly->formats.text[i]) + 3);
+        sprintf(text, "\"%s\"", compiler->assembly->formats.text[i]);
+        asm_data(rodata, mop_format(compiler->assembly->formats.id[i]), MI_STRING, mop_text(text));
+        free(compiler->assembly->formats.text[i]);
+    }
+    compiler->assembly->formats.count = 0;
+
+    if (!compiler->assembly->constants.count)
+        return;
+    minstr_emit(rodata, MI_ALIGN, 0, mop_none(), mop_imm(4));
+    for (i = 0; i < compiler->assembly->constants.count; i++)
+        asm_data(rodata, mop_const(compiler->assembly->constants.bits[i]), MI_LONG, mop_imm(compiler->assembly->constants.bits[i]));
+    compiler->assembly->constants.count = 0;
+}
+
+// an output command of a single argument keeps its direct call
+int asm_output_alone(TAC *tac)
+{
+    TAC *next;
+    if (compiler->assembly->out.items)
+        return 0;
+    for (next = tac->next; next && next->type == TAC_SYMBOL; next = next->next)
+        ;
+    return next && next->type == TAC_PRINT;
+}
+
+// room for one item, the source spelling being an upper bound for text
+int asm_output_room(int item, HASH *symbol)
+{
+    switch (item)
+    {
+    case RUNTIME_FORMAT_INT:
+        return RUNTIME_INT_ROOM;
+    case RUNTIME_FORMAT_REAL:
+        return RUNTIME_REAL_ROOM;
+    case RUNTIME_FORMAT_CHAR:
+        return 1;
+    }
+
+    if (symbol->type == SYMBOL_LIT_REAL)
+        return RUNTIME_REAL_ROOM;
+    return symbol->type == SYMBOL_LIT_STRING ? strlen(symbol->text) : RUNTIME_INT_ROOM;
+}
+
+void asm_output_item(int item)
+{
+    if (compiler->assembly->out.in_text)
+        mbuffer_printf(&compiler->assembly->out.text, "\\000");
+    mbuffer_printf(&compiler->assembly->out.text, "\\%03o", item);
+    compiler->assembly->out.in_text = 0;
+    compiler->assembly->out.items++;
+}
 
-char *get_string_name(int string_id);
-char *get_string_name(int string_id)
+void asm_output_emit(MCODE *code)
 {
-    char *string_name = (char *)calloc(1, sizeof(char) * 100);
-    sprintf(string_name, "string_%d", string_id);
-    return string_name;
+    int i;
+    if (!compiler->assembly->out.items)
+        return;
+    mbuffer_printf(&compiler->assembly->out.text, "");
+
+    // a descriptor of text alone is printed from just past its item byte
+    if (compiler->assembly->out.items == 1 && compiler->assembly->out.in_text)
+    {
+        MOPERAND text = asm_format(compiler->assembly->out.text.data);
+        text.disp = 1;
+        minstr_emit(code, MI_LEA, 8, text, mop_reg(REG_RDI));
+        minstr_emit(code, MI_CALL, 8, mop_none(), mop_extern("out_string"));
+    }
+    else
+    {
+        // the zero byte .string adds is then the end item
+        if (compiler->assembly->out.in_text)
+            mbuffer_printf(&compiler->assembly->out.text, "\\000");
+        for (i = 0; i < compiler->assembly->out.int_count; i++)
+            minstr_emit(code, MI_MOV, 4, mop_hash(compiler->assembly->out.ints[i], 0), mop_reg(runtime_format_regs[i]));
+        for (i = 0; i < compiler->assembly->out.real_count; i++)
+            minstr_emit(code, MI_MOVSS, 4, mop_hash(compiler->assembly->out.reals[i], 0), mop_reg(REG_XMM0 + i));
+        minstr_emit(code, MI_MOV, 4, mop_imm(compiler->assembly->out.room), mop_reg(REG_RAX));
+        minstr_emit(code, MI_LEA, 8, asm_format(compiler->assembly->out.text.data), mop_reg(REG_RDI));
+        minstr_emit(code, MI_CALL, 8, mop_none(), mop_extern("out_format"));
+    }
+
+    compiler->assembly->out.text.length = 0;
+    compiler->assembly->out.items = 0;
+    compiler->assembly->out.in_text = 0;
+    compiler->assembly->out.room = 0;
+    compiler->assembly->out.int_count = 0;
+    compiler->assembly->out.real_count = 0;
+}
+
+// literals are folded into the text as the runtime would print them
+void asm_output_text(MCODE *code, HASH *symbol)
+{
+    int room = asm_output_room(RUNTIME_FORMAT_TEXT, symbol);
+    if (compiler->assembly->out.room + room > RUNTIME_BUFFER_SIZE)
+        asm_output_emit(code);
+    compiler->assembly->out.room += room;
+    if (!compiler->assembly->out.in_text)
+        asm_output_item(RUNTIME_FORMAT_TEXT);
+    compiler->assembly->out.in_text = 1;
+
+    switch (symbol->type)
+    {
+    case SYMBOL_LIT_STRING:
+        mbuffer_printf(&compiler->assembly->out.text, "%.*s", (int)strlen(symbol->text) - 2, symbol->text + 1);
+        break;
+    case SYMBOL_LIT_REAL:
+        mbuffer_printf(&compiler->assembly->out.text, "%f", (double)strtof(symbol->text, NULL));
+        break;
+    case SYMBOL_LIT_CHAR:
+        mbuffer_printf(&compiler->assembly->out.text, "\\%03o", (unsigned char)isel_literal_value(symbol));
+        break;
+    default:
+        mbuffer_printf(&compiler->assembly->out.text, "%d", isel_literal_value(symbol));
+    }
+}
+
+void asm_output_arg(MCODE *code, TAC *tac)
+{
+    HASH *symbol = tac->res;
+    int real = symbol->datatype == DATATYPE_REAL;
+    int item;
+    int room;
+
+    if (isel_is_string_arg(tac) || isel_is_literal(symbol) || symbol->type == SYMBOL_LIT_REAL)
+    {
+        asm_output_text(code, symbol);
+        return;
+    }
+
+    item = real ? RUNTIME_FORMAT_REAL : symbol->datatype == DATATYPE_CHAR ? RUNTIME_FORMAT_CHAR : RUNTIME_FORMAT_INT;
+    room = asm_output_room(item, symbol);
+    if (real ? compiler->assembly->out.real_count == RUNTIME_FORMAT_REALS : compiler->assembly->out.int_count == RUNTIME_FORMAT_INTS)
+        asm_output_emit(code);
+    else if (compiler->assembly->out.room + room > RUNTIME_BUFFER_SIZE)
+        asm_output_emit(code);
+    compiler->assembly->out.room += room;
+    asm_output_item(item);
+    if (real)
+        compiler->assembly->out.reals[compiler->assembly->out.real_count++] = symbol;
+    else
+        compiler->assembly->out.ints[compiler->assembly->out.int_count++] = symbol;
+}
+
+// what may sit between the arguments of a command without ending the descriptor
+int asm_output_keeps(TAC *tac)
+{
+    return tac->type == TAC_PRINT_ARG || tac->type == TAC_PRINT || tac->type == TAC_SYMBOL || isel_is_expression(tac);
+}
+
+// the format out_real hands to snprintf and every string literal
+void asm_rodata(MCODE *rodata)
+{
+    int i;
+    minstr_emit(rodata, MI_SECTION, 0, mop_none(), mop_extern(".rodata"));
+    asm_data(rodata, mop_name("print_str_real"), MI_STRING, mop_text("\"%f\""));
+
+    for (i = 0; i < HASH_SIZE; i++)
+    {
+        HASH *node;
+        for (node = compiler->symbols->buckets[i]; node; node = node->next)
+        {
+            if (node->type == SYMBOL_LIT_STRING && !node->is_vector && node->string_id != 0)
+                asm_data(rodata, mop_string(node->string_id), MI_STRING, mop_text(node->text));
+        }
+    }
+}
+
+TAC *asm_skip_symbols(TAC *tac)
+{
+    while (tac && tac->type == TAC_SYMBOL)
+        tac = tac->prev;
+    return tac;
+}
+
+// the body label of the loop a back-edge closes, when the condition has no branches of
+// its own and can be repeated at the bottom
+TAC *asm_loop_entry(TAC *jump)
+{
+    TAC *tac;
+    if (!compiler->block_layout || strncmp(jump->res->text, "loop_start_label", 16) != 0)
+        return NULL;
+
+    for (tac = jump->prev; tac && !(tac->type == TAC_LABEL && tac->res == jump->res); tac = tac->prev)
+        ;
+    for (tac = tac ? tac->next : NULL; tac; tac = tac->next)
+    {
+        if (tac->type == TAC_LABEL)
+            return strncmp(tac->res->text, "loop_body_label", 15) == 0 ? tac : NULL;
+        if (tac->type == TAC_JUMP || tac->type == TAC_BEGINFUN || tac->type == TAC_ENDFUN)
+            return NULL;
+    }
+    return NULL;
+}
+
+// the last tac of an if's then-block that runs rarely: without a profile one that ends in
+// a return, which the function rarely leaves through, with one a block taken at most
+// PROFILE_COLD_PERCENT times in a hundred; only the final test of the condition skips to
+// it, and the function has to end in a return so that nothing falls into the moved blocks
+TAC *asm_cold_block(TAC *jfalse)
+{
+    TAC *tac;
+    TAC *end = NULL;
+    long long taken = profile_fall_count(jfalse);
+    long long reached = profile_block_count(jfalse);
+    if (!compiler->block_layout || strncmp(jfalse->res->text, "if_label", 8) != 0)
+        return NULL;
+
+    for (tac = jfalse->next; tac && tac->type != TAC_ENDFUN; tac = tac->next)
+    {
+        if (end)
+            continue;
+        if (tac->type == TAC_JFALSE && tac->res == jfalse->res)
+            return NULL;
+        if (tac->type == TAC_LABEL && tac->res == jfalse->res)
+        {
+            end = asm_skip_symbols(tac->prev);
+            if (end == jfalse)
+                return NULL;
+            // a profile decides by how often the block ran, and blocks that fall through
+            // jump back when moved
+            if (taken >= 0 && reached >= 0 ? 100 * taken > PROFILE_COLD_PERCENT * reached : end->type != TAC_RET)
+                return NULL;
+            end = tac->prev;
+        }
+    }
+
+    tac = tac ? asm_skip_symbols(tac->prev) : NULL;
+    return tac && tac->type == TAC_RET ? end : NULL;
+}
+
+// jumps to the then-block after jfalse and leaves it for asm_cold_emit; returns its last tac
+TAC *asm_cold_defer(MCODE *code, TAC *jfalse, TAC *last)
+{
+    char *label = (char *)arena_alloc(&code->arena, strlen(jfalse->res->text) + 7);
+    sprintf(label, "_%s_cold", jfalse->res->text);
+    if (compiler->assembly->cold.count == compiler->assembly->cold.size)
+    {
+        compiler->assembly->cold.size = compiler->assembly->cold.size ? 2 * compiler->assembly->cold.size : 16;
+        compiler->assembly->cold.first = (TAC **)realloc(compiler->assembly->cold.first, compiler->assembly->cold.size * sizeof(TAC *));
+        compiler->assembly->cold.last = (TAC **)realloc(compiler->assembly->cold.last, compiler->assembly->cold.size * sizeof(TAC *));
+        compiler->assembly->cold.label = (char **)realloc(compiler->assembly->cold.label, compiler->assembly->cold.size * sizeof(char *));
+        compiler->assembly->cold.join = (HASH **)realloc(compiler->assembly->cold.join, compiler->assembly->cold.size * sizeof(HASH *));
+    }
+    compiler->assembly->cold.first[compiler->assembly->cold.count] = jfalse->next;
+    compiler->assembly->cold.last[compiler->assembly->cold.count] = last;
+    compiler->assembly->cold.label[compiler->assembly->cold.count] = label;
+    compiler->assembly->cold.join[compiler->assembly->cold.count++] = asm_skip_symbols(last)->type == TAC_RET ? NULL : jfalse->res;
+
+    // the peephole pass folds this into the branch, which then jumps when the test holds
+    minstr_emit(code, MI_JMP, 8, mop_none(), mop_extern(label));
+    return last;
+}
+
+// blocks may set aside others nested in them, which are placed after them
+void asm_cold_emit(MCODE *code)
+{
+    int i;
+    for (i = 0; i < compiler->assembly->cold.count; i++)
+    {
+        minstr_emit(code, MI_LABEL, 8, mop_none(), mop_extern(compiler->assembly->cold.label[i]));
+        asm_text(code, compiler->assembly->cold.first[i], compiler->assembly->cold.last[i]);
+        if (compiler->assembly->cold.join[i])
+            minstr_emit(code, MI_JMP, 8, mop_none(), mop_label(compiler->assembly->cold.join[i]));
+    }
+    compiler->assembly->cold.count = 0;
+}
+
+// instructions for tac up to and including last, or to the end of the list
+void asm_text(MCODE *code, TAC *first, TAC *last)
+{
+    TAC *tac;
+    TAC *cold;
+    for (tac = first; tac; tac = tac == last ? NULL : tac->next)
+    {
+        // calls and branches inside a command print what came before them first
+        if (compiler->assembly->out.items && !asm_output_keeps(tac))
+        {
+            isel_flush(code);
+            asm_output_emit(code);
+        }
+
+        // labels and function entries count once they are placed
+        if (tac->type != TAC_LABEL && tac->type != TAC_BEGINFUN)
+            profile_increment(code, tac);
+
+        if (isel_accepts(tac))
+        {
+            isel_tac(code, tac);
+            if (tac->type == TAC_JFALSE && (cold = asm_cold_block(tac)))
+                tac = asm_cold_defer(code, tac, cold);
+            continue;
+        }
+
+        if (tac->type != TAC_SYMBOL)
+        {
+            isel_flush(code);
+        }
+
+        switch (tac->type)
+        {
+        case TAC_BEGINFUN:
+        {
+            minstr_emit(code, MI_FUNCTION, 8, mop_none(), mop_function(tac->res));
+            minstr_emit(code, MI_PUSH, 8, mop_none(), mop_reg(REG_RBP));
+            minstr_emit(code, MI_MOV, 8, mop_reg(REG_RSP), mop_reg(REG_RBP));
+            // whatever is still buffered goes out when the program exits
+            if (strcmp(tac->res->text, "main") == 0)
+            {
+                minstr_emit(code, MI_LEA, 8, mop_name("out_flush"), mop_reg(REG_RDI));
+                minstr_emit(code, MI_CALL, 8, mop_none(), mop_extern("atexit@PLT"));
+                if (compiler->profile_generate)
+                {
+                    minstr_emit(code, MI_LEA, 8, mop_name("profile_write"), mop_reg(REG_RDI));
+                    minstr_emit(code, MI_CALL, 8, mop_none(), mop_extern("atexit@PLT"));
+                }
+            }
+            profile_increment(code, tac);
+            break;
+        }
+        case TAC_PRINT_ARG:
+        {
+            if (!asm_output_alone(tac))
+            {
+                asm_output_arg(code, tac);
+                break;
+            }
+            minstr_emit(code, MI_LEA, 8, mop_string(tac->res->string_id), mop_reg(REG_RDI));
+            minstr_emit(code, MI_CALL, 8, mop_none(), mop_extern("out_string"));
+            break;
+        }
+        case TAC_PRINT:
+        {
+            asm_output_emit(code);
+            break;
+        }
+        case TAC_LABEL:
+        {
+            VLOOP *loop = vectorize_find(tac->res);
+            if (loop)
+                vectorize_emit(code, loop);
+            minstr_emit(code, MI_LABEL, 8, mop_none(), mop_label(tac->res));
+            profile_increment(code, tac);
+            break;
+        }
+        case TAC_JUMP:
+        {
+            // a rotated loop tests its condition again at the bottom and branches back to
+            // the body while it holds, instead of jumping up to the test
+            TAC *entry = asm_loop_entry(tac);
+            if (entry)
+            {
+                TAC *start;
+                for (start = entry->prev; start->type != TAC_LABEL; start = start->prev)
+                    ;
+                profile_increment(code, start);
+                asm_text(code, start->next, entry->prev);
+                minstr_emit(code, MI_JMP, 8, mop_none(), mop_label(entry->res));
+                break;
+            }
+            minstr_emit(code, MI_JMP, 8, mop_none(), mop_label(tac->res));
+            break;
+        }
+        case TAC_ENDFUN:
+        {
+            asm_cold_emit(code);
+            break;
+        }
+        case TAC_CALL:
+        {
+            minstr_emit(code, MI_CALL, 8, mop_none(), mop_function(tac->op1));
+            minstr_emit(code, MI_MOV, 4, mop_reg(REG_RAX), mop_hash(tac->res, 0));
+            break;
+        }
+        case TAC_READ:
+        {
+            fprintf(compiler->diagnostics, "Datatype of %s is %s\n", tac->res->text, datatype_str[tac->res->datatype]);
+            char *routine = NULL;
+            switch (tac->res->datatype)
+            {
+                case DATATYPE_INT:
+                    routine = "in_int";
+                    break;
+                case DATATYPE_REAL:
+                    routine = "in_real";
+                    break;
+                case DATATYPE_CHAR:
+                    routine = "in_char";
+                    break;
+            }
+
+            if (routine)
+            {
+                minstr_emit(code, MI_LEA, 8, mop_hash(tac->res, 0), mop_reg(REG_RDI));
+                minstr_emit(code, MI_CALL, 8, mop_none(), mop_extern(routine));
+            }
+
+            break;
+        }
+        }
+    }
+    isel_flush(code);
+}
+
+// splits the program before each function
+ASM_JOB *asm_split(TAC *first, int *count)
+{
+    ASM_JOB *jobs = NULL;
+    int size = 0;
+    TAC *tac;
+
+    *count = 0;
+    for (tac = first; tac; tac = tac->next)
+    {
+        if (tac != first && tac->type != TAC_BEGINFUN)
+            continue;
+        if (*count == size)
+        {
+            size = size ? 2 * size : 16;
+            jobs = (ASM_JOB *)realloc(jobs, size * sizeof(ASM_JOB));
+        }
+        if (*count)
+            jobs[*count - 1].last = tac->prev;
+        memset(&jobs[*count], 0, sizeof(ASM_JOB));
+        jobs[(*count)++].first = tac;
+    }
+    return jobs;
+}
+
+// the selector, the pools, the peephole counters and the arena are the job's; the
+// symbols, the tac, the loops to vectorize and the profile are only read
+void asm_job_run(ASM_JOBS *jobs, ASM_JOB *job)
+{
+    COMPILER_CONTEXT worker = *jobs->context;
+    jmp_buf recover;
+    job->peephole_hits = (int *)calloc(PEEPHOLE_RULE_COUNT, sizeof(int));
+    worker.isel = &job->isel;
+    worker.assembly = &job->assembly;
+    worker.peephole_hits = job->peephole_hits;
+    worker.recover = &recover;
+    memset(&worker.arena, 0, sizeof(ARENA));
+
+    compiler = &worker;
+    if (setjmp(recover))
+    {
+        job->failed = 1;
+        job->arena = worker.arena;
+        compiler = jobs->context;
+        return;
+    }
+    asm_text(&job->code, job->first, job->last);
+    isel_reset();
+    peephole_optimize(&job->code);
+    job->arena = worker.arena;
+    compiler = jobs->context;
+}
+
+void *asm_worker(void *argument)
+{
+    ASM_JOBS *jobs = (ASM_JOBS *)argument;
+    for (;;)
+    {
+        int i;
+        pthread_mutex_lock(&jobs->lock);
+        i = jobs->next++;
+        pthread_mutex_unlock(&jobs->lock);
+        if (i >= jobs->count)
+            return NULL;
+        if (!jobs->jobs[i].cached)
+            asm_job_run(jobs, &jobs->jobs[i]);
+    }
+}
+
+// moves a finished job into the program: its constants and descriptors join the pools in
+// the order they were first used, which renumbers the descriptors it refers to
+void asm_job_merge(MCODE *code, ASM_JOB *job)
+{
+    ASM_FORMATS *formats = &job->assembly.formats;
+    int *ids = (int *)malloc((formats->next_id + 1) * sizeof(int));
+    MINSTR *instr;
+    int i;
+
+    for (i = 0; i < job->assembly.constants.count; i++)
+        asm_constant(job->assembly.constants.bits[i]);
+    for (i = 0; i < formats->count; i++)
+    {
+        ids[formats->id[i]] = asm_format(formats->text[i]).symbol.id;
+        free(formats->text[i]);
+    }
+    for (instr = job->code.first; instr; instr = instr->next)
+    {
+        if (instr->src.symbol.kind == MSYM_FORMAT)
+            instr->src.symbol.id = ids[instr->src.symbol.id];
+        if (instr->dst.symbol.kind == MSYM_FORMAT)
+            instr->dst.symbol.id = ids[instr->dst.symbol.id];
+    }
+    for (i = 0; i < PEEPHOLE_RULE_COUNT; i++)
+        compiler->peephole_hits[i] += job->peephole_hits[i];
+    minstr_append(code, &job->code);
+    arena_adopt(&compiler->arena, &job->arena);
+
+    free(ids);
+    free(job->peephole_hits);
+    free(job->assembly.constants.bits);
+    free(formats->text);
+    free(formats->id);
+    free(job->assembly.out.text.data);
+    free(job->assembly.cold.first);
+    free(job->assembly.cold.last);
+    free(job->assembly.cold.label);
+    free(job->assembly.cold.join);
+}
+
+// selects every function on up to compiler->jobs threads; the code is the same for any
+// number of them. Functions the cache has are not selected again, and the others are
+// stored there
+void asm_functions(MCODE *code, TAC *first)
+{
+    ASM_JOBS jobs;
+    pthread_t threads[ASM_MAX_THREADS];
+    int threads_count = compiler->jobs;
+    int i;
+
+    memset(&jobs, 0, sizeof(jobs));
+    jobs.jobs = asm_split(first, &jobs.count);
+    jobs.context = compiler;
+    pthread_mutex_init(&jobs.lock, NULL);
+    fragment_attach(jobs.jobs, jobs.count);
+
+    if (threads_count > ASM_MAX_THREADS)
+        threads_count = ASM_MAX_THREADS;
+    if (threads_count > jobs.count)
+        threads_count = jobs.count;
+    if (threads_count <= 1)
+        asm_worker(&jobs);
+    else
+    {
+        for (i = 0; i < threads_count; i++)
+            pthread_create(&threads[i], NULL, asm_worker, &jobs);
+        for (i = 0; i < threads_count; i++)
+            pthread_join(threads[i], NULL);
+    }
+
+    for (i = 0; i < jobs.count; i++)
+    {
+        if (jobs.jobs[i].failed)
+        {
+            // what the jobs selected is dropped with the compile
+            for (i = 0; i < jobs.count; i++)
+                arena_adopt(&compiler->arena, &jobs.jobs[i].arena);
+            free(jobs.jobs);
+            pthread_mutex_destroy(&jobs.lock);
+            compiler_fail(NULL);
+        }
+    }
+
+    fragment_store(jobs.jobs, jobs.count);
+    for (i = 0; i < jobs.count; i++)
+        asm_job_merge(code, &jobs.jobs[i]);
+    pthread_mutex_destroy(&jobs.lock);
+    free(jobs.jobs);
 }
 
 void generate_asm(TAC *first)
 {
-    int print_param_count = 0;
-    char *print_formatting_str = (char *)calloc(1, sizeof(char) * 100);
-    print_formatting_str = strdup("");
-    FILE *fout;
-    fout = fopen("./generated/out.s", "w");
+    MCODE rodata = {.first = NULL, .last = NULL};
+    MCODE data = {.first = NULL, .last = NULL};
+    MCODE bss = {.first = NULL, .last = NULL};
+    MCODE code = {.first = NULL, .last = NULL};
 
-    fprintf(fout, ".section .data\n\n");
-    fprintf(fout, "print_str_int:\n\t.string	\"%%d\"\nprint_str_real:\n\t.string	\"%%f\"\nprint_str_char:\n\t.string	\"%%c\"\n");
-    fprintf(fout, "read_str_char:\n\t.string \" %%c\"\n");
+    asm_rodata(&rodata);
+    minstr_emit(&data, MI_SECTION, 0, mop_none(), mop_extern(".data"));
+    minstr_emit(&bss, MI_SECTION, 0, mop_none(), mop_extern(".bss"));
+    minstr_emit(&code, MI_SECTION, 0, mop_none(), mop_extern(".text"));
 
     TAC *tac = tac_reverse(first);
 
     int i;
     for (i = 0; i < HASH_SIZE; i++)
     {
-        if (hash_table[i])
+        if (compiler->symbols->buckets[i])
         {
-            HASH *node = hash_table[i];
+            HASH *node = compiler->symbols->buckets[i];
             while (node)
             {
                 if (node->is_vector)
@@ -43,35 +666,26 @@ void generate_asm(TAC *first)
                 {
                 case SYMBOL_LIT_INTEGER:
                 case SYMBOL_LIT_CHAR:
+                case SYMBOL_LIT_REAL:
                 {
-                    fprintf(fout, "_%s: .long %s\n", node->text, node->text);
+                    // immediates, or entries of the constant pool
                     break;
                 }
                 case SYMBOL_IDENTIFIER:
                 {
-                    fprintf(fout, "_%s: .long 0\n", node->text);
-                    break;
-                }
-                case SYMBOL_LIT_REAL:
-                {
-                    fprintf(fout, "_%s: .float %s\n", remove_decimal_point(node->text), node->text);
+                    asm_bss(&bss, mop_hash(node, 0));
                     break;
                 }
                 case SYMBOL_LIT_STRING:
                 {
-                    if (node->string_id == 0)
-                    {
-                        break;
-                    }
-                    char *string_name = get_string_name(node->string_id);
-                    fprintf(fout, "_%s: .string %s\n", string_name, node->text);
+                    // already in .rodata
                     break;
                 }
                 case SYMBOL_VARIABLE:
                 {
                     if (node->datatype != DATATYPE_INT && node->datatype != DATATYPE_CHAR && node->datatype != DATATYPE_REAL)
                     {
-                        fprintf(fout, "_%s: .long 0\n", node->text);
+                        asm_bss(&bss, mop_hash(node, 0));
                     }
 
                     break;
@@ -86,12 +700,12 @@ void generate_asm(TAC *first)
                         case DATATYPE_CHAR:
                         case DATATYPE_BOOL:
                         {
-                            fprintf(fout, "_%s: .long 0\n", node->text);
+                            asm_bss(&bss, mop_hash(node, 0));
                             break;
                         }
                         case DATATYPE_REAL:
                         {
-                            fprintf(fout, "_%s: .float 0.0\n", node->text);
+                            asm_bss(&bss, mop_hash(node, 0));
                             break;
                         }
                         }
@@ -105,7 +719,8 @@ void generate_asm(TAC *first)
 
     TAC *origin = tac;
 
-    do
+    // an aborted parse leaves no code at all
+    while (tac)
     {
         if (tac->type == TAC_VARDEC)
         {
@@ -114,449 +729,94 @@ void generate_asm(TAC *first)
             case DATATYPE_INT:
             case DATATYPE_CHAR:
             {
-                fprintf(fout, "_%s: .long %s\n", tac->res->text, tac->op1->text);
-                break;
-            }
-            case DATATYPE_REAL:
-            {
-                fprintf(fout, "_%s: .float %s\n", tac->res->text, tac->op1->text);
-                break;
-            }
-            }
-        }
-        tac = tac->next;
-    } while (tac);
-
-    tac = origin;
-
-    fprintf(fout, "\n.section .text\n\n");
-    do
-    {
-        // fprintf(fout, "\t# %s\n", tac_type_str[tac->type]);
-        switch (tac->type)
-        {
-        case TAC_BEGINFUN:
-        {
-            fprintf(fout, ".%s:\n\t.text\n\t.globl	%s\n\t.type	%s, @function\n", tac->res->text, tac->res->text, tac->res->text);
-            fprintf(fout, "%s:\n\tpushq	%%rbp\n\tmovq	%%rsp, %%rbp\n", tac->res->text);
-            break;
-        }
-        case TAC_RET:
-        {
-            char* res_text = tac->res->text;
-            if (tac->res->datatype == DATATYPE_REAL) {
-                res_text = remove_decimal_point(res_text);
-            }
-
-            fprintf(fout, "\tmovl _%s(%%rip), %%eax\n", res_text);
-            fprintf(fout, "\tpopq	%%rbp\n\tret\n");
-            break;
-        }
-        case TAC_ENDFUN:
-        {
-            // ?
-            break;
-        }
-        case TAC_PRINT_ARG:
-        {
-            switch (tac->res->datatype)
-            {
-            case DATATYPE_INT:
-            {
-                fprintf(fout, "\tmovl _%s(%%rip), %%esi\n", tac->res->text);
-                fprintf(fout, "\tleaq	print_str_int(%%rip), %%rax\n\tmovq	%%rax, %%rdi\n\tcall	printf@PLT\n");
+                asm_data(&data, mop_hash(tac->res, 0), MI_LONG, mop_imm(isel_literal_value(tac->op1)));
                 break;
             }
             case DATATYPE_REAL:
             {
-                fprintf(fout, "\tmovss _%s(%%rip), %%xmm0\n\tpxor %%xmm1, %%xmm1\n\tcvtss2sd	%%xmm0, %%xmm1\n\tmovq %%xmm1, %%rax\n\tmovq %%rax, %%xmm0\n", tac->res->text);
-                fprintf(fout, "\tleaq	print_str_real(%%rip), %%rax\n\tmovq	%%rax, %%rdi\n\tcall	printf@PLT\n");
+                asm_data(&data, mop_hash(tac->res, 0), MI_FLOAT, mop_text(tac->op1->text));
                 break;
             }
-            case DATATYPE_CHAR:
-            {
-                fprintf(fout, "\tmovl _%s(%%rip), %%esi\n", tac->res->text);
-                fprintf(fout, "\tleaq	print_str_char(%%rip), %%rax\n\tmovq	%%rax, %%rdi\n\tcall	printf@PLT\n");
-                break;
-            }
-            case DATATYPE_BOOL:
-            {
-                fprintf(fout, "\tmovl _%s(%%rip), %%esi\n", tac->res->text);
-                fprintf(fout, "\tleaq	print_str_int(%%rip), %%rax\n\tmovq	%%rax, %%rdi\n\tcall	printf@PLT\n");
-                break;
-            }
-            default:
-            {
-                if (tac->res->is_temp)
-                {
-                    fprintf(fout, "\tmovl _%s(%%rip), %%esi\n", tac->res->text);
-                    fprintf(fout, "\tleaq	print_str_int(%%rip), %%rax\n\tmovq	%%rax, %%rdi\n\tcall	printf@PLT\n");
-                }
-                else
-                {
-                    fprintf(fout, "\tleaq _%s(%%rip), %%rax\n\tmovq	%%rax, %%rdi\n\tcall	printf@PLT\n", get_string_name(tac->res->string_id));
-                }
-
-                break;
-            }
-            }
-            break;
-        }
-        case TAC_ADD:
-        case TAC_SUB:
-        case TAC_MUL:
-        {
-            if (tac->res->datatype == DATATYPE_INT)
-            {
-                fprintf(fout, "\tmovl	_%s(%%rip), %%edx\n", tac->op1->text);
-                fprintf(fout, "\tmovl	_%s(%%rip), %%eax\n", tac->op2->text);
-                fprintf(fout, "\t%sl	%%eax, %%edx\n", arithmetic_tac_to_asm(tac));
-                fprintf(fout, "\tmovl	%%edx, _%s(%%rip)\n", tac->res->text);
-            }
-            else
-            {
-                fprintf(fout, "\tmovss	_%s(%%rip), %%xmm0\n", remove_decimal_point(tac->op1->text));
-                fprintf(fout, "\tmovss	_%s(%%rip), %%xmm1\n", remove_decimal_point(tac->op2->text));
-                fprintf(fout, "\t%sss	%%xmm1, %%xmm0\n", arithmetic_tac_to_asm(tac));
-                fprintf(fout, "\tmovss	%%xmm0, _%s(%%rip)\n", tac->res->text);
-            }
-            break;
-        }
-        case TAC_DIV:
-        {
-            if (tac->res->datatype == DATATYPE_INT)
-            {
-                fprintf(fout, "\tmovl _%s(%%rip), %%eax\n", tac->op1->text);
-                fprintf(fout, "\tmovl _%s(%%rip), %%ecx\n", tac->op2->text);
-                fprintf(fout, "\tcltd\n");
-                fprintf(fout, "\tidivl %%ecx\n");
-                fprintf(fout, "\tmovl %%eax, _%s(%%rip)\n", tac->res->text);
-            }
-            else
-            {
-                fprintf(fout, "\tmovss	_%s(%%rip), %%xmm0\n", remove_decimal_point(tac->op1->text));
-                fprintf(fout, "\tmovss	_%s(%%rip), %%xmm1\n", remove_decimal_point(tac->op2->text));
-                fprintf(fout, "\tdivss	%%xmm1, %%xmm0\n");
-                fprintf(fout, "\tmovss	%%xmm0, _%s(%%rip)\n", tac->res->text);
-            }
-            break;
-        }
-        case TAC_LE:
-        case TAC_GE:
-        case TAC_LT:
-        case TAC_GT:
-        case TAC_EQ:
-        case TAC_DIF:
-        {
-            if (tac->res->datatype == DATATYPE_INT)
-            {
-                fprintf(fout, "\tmovl _%s(%%rip), %%edx\n", tac->op1->text);
-                fprintf(fout, "\tmovl _%s(%%rip), %%eax\n", tac->op2->text);
-                fprintf(fout, "\tcmpl %%eax, %%edx\n");
-                fprintf(fout, "\t%s %%al\n", logic_tac_to_asm(tac));
-                fprintf(fout, "\tmovzbl %%al, %%eax\n");
-                fprintf(fout, "\tmovl %%eax, _%s(%%rip)\n", tac->res->text);
-            }
-            else
-            {
-                switch (tac->type)
-                {
-                case TAC_LT:
-                {
-                    fprintf(fout, "\tmovss _%s(%%rip), %%xmm1\n", remove_decimal_point(tac->op1->text));
-                    fprintf(fout, "\tmovss _%s(%%rip), %%xmm0\n", remove_decimal_point(tac->op2->text));
-                    fprintf(fout, "\tcomiss %%xmm1, %%xmm0\n");
-                    fprintf(fout, "\tseta %%al\n");
-                    fprintf(fout, "\tmovzbl %%al, %%eax\n");
-                    fprintf(fout, "\tmovl %%eax, _%s(%%rip)\n", tac->res->text);
-                    break;
-                }
-                case TAC_GT:
-                {
-                    fprintf(fout, "\tmovss _%s(%%rip), %%xmm0\n", remove_decimal_point(tac->op1->text));
-                    fprintf(fout, "\tmovss _%s(%%rip), %%xmm1\n", remove_decimal_point(tac->op2->text));
-                    fprintf(fout, "\tcomiss %%xmm1, %%xmm0\n");
-                    fprintf(fout, "\tseta %%al\n");
-                    fprintf(fout, "\tmovzbl %%al, %%eax\n");
-                    fprintf(fout, "\tmovl %%eax, _%s(%%rip)\n", tac->res->text);
-                    break;
-                }
-                case TAC_LE:
-                {
-                    fprintf(fout, "\tmovss _%s(%%rip), %%xmm1\n", remove_decimal_point(tac->op1->text));
-                    fprintf(fout, "\tmovss _%s(%%rip), %%xmm0\n", remove_decimal_point(tac->op2->text));
-                    fprintf(fout, "\tcomiss %%xmm1, %%xmm0\n");
-                    fprintf(fout, "\tsetnb %%al\n");
-                    fprintf(fout, "\tmovzbl %%al, %%eax\n");
-                    fprintf(fout, "\tmovl %%eax, _%s(%%rip)\n", tac->res->text);
-
-                    break;
-                }
-                case TAC_GE:
-                {
-                    fprintf(fout, "\tmovss _%s(%%rip), %%xmm0\n", remove_decimal_point(tac->op1->text));
-                    fprintf(fout, "\tmovss _%s(%%rip), %%xmm1\n", remove_decimal_point(tac->op2->text));
-                    fprintf(fout, "\tcomiss %%xmm1, %%xmm0\n");
-                    fprintf(fout, "\tsetnb %%al\n");
-                    fprintf(fout, "\tmovzbl %%al, %%eax\n");
-                    fprintf(fout, "\tmovl %%eax, _%s(%%rip)\n", tac->res->text);
-
-                    break;
-                }
-                case TAC_EQ:
-                case TAC_DIF:
-                {
-                    fprintf(fout, "\tmovss _%s(%%rip), %%xmm0\n", remove_decimal_point(tac->op1->text));
-                    fprintf(fout, "\tmovss _%s(%%rip), %%xmm1\n", remove_decimal_point(tac->op2->text));
-                    fprintf(fout, "\tucomiss %%xmm1, %%xmm0\n");
-                    fprintf(fout, "\tsetnp %%al\n");
-                    fprintf(fout, "\tmovl $%d, %%edx\n", tac->type == TAC_EQ ? 0 : 1);
-                    fprintf(fout, "\tucomiss %%xmm1, %%xmm0\n");
-                    fprintf(fout, "\tcmovne %%edx, %%eax\n");
-                    fprintf(fout, "\tmovzbl %%al, %%eax\n");
-                    fprintf(fout, "\tmovl %%eax, _%s(%%rip)\n", tac->res->text);
-                    break;
-                }
-                }
-            }
-            break;
-        }
-        case TAC_OR:
-        case TAC_AND:
-        {
-
-            fprintf(fout, "\tmovl _%s(%%rip), %%edx\n", tac->op1->text);
-            fprintf(fout, "\tmovl _%s(%%rip), %%eax\n", tac->op2->text);
-            fprintf(fout, "\t%s %%edx, %%eax\n", logic_tac_to_asm(tac));
-            fprintf(fout, "\tmovl %%eax, _%s(%%rip)\n", tac->res->text);
-
-            break;
-        }
-        case TAC_NOT:
-        {
-
-            fprintf(fout, "\tmovl _%s(%%rip), %%eax\n", tac->op1->text);
-            fprintf(fout, "\ttestl %%eax, %%eax\n");
-            fprintf(fout, "\tsete %%al\n");
-            fprintf(fout, "\tmovzbl %%al, %%eax\n");
-            fprintf(fout, "\tmovl %%eax, _%s(%%rip)\n", tac->res->text);
-
-            break;
-        }
-        case TAC_COPY:
-        case TAC_ARG:
-        {
-            if (tac->res->is_vector)
-            {
-                if (tac->op1->type == SYMBOL_VARIABLE ||
-                    tac->op1->type == SYMBOL_IDENTIFIER ||
-                    tac->op1->type == SYMBOL_PARAMETER)
-                {
-
-                    fprintf(fout, "\tmovl _%s(%%rip), %%eax\n", tac->op1->text);
-                    fprintf(fout, "\tcltq\n");
-                    fprintf(fout, "\tleaq	0(,%%rax,4), %%rdx\n");
-                    fprintf(fout, "\tleaq _%s(%%rip), %%rax\n", tac->res->text);
-                    fprintf(fout, "\tmovl _%s(%%rip), %%ecx\n", tac->op2->text);
-                    fprintf(fout, "\tmovl %%ecx, (%%rdx,%%rax)\n");
-                }
-                else
-                {
-                    int index = 4 * atoi(tac->op1->text);
-                    fprintf(fout, "\tmovl _%s(%%rip), %%eax\n", remove_decimal_point(tac->op2->text));
-                    fprintf(fout, "\tmovl %%eax, %d+_%s(%%rip)\n", index, tac->res->text);
-                }
-            }
-            else if (tac->op1->is_vector)
-            {
-                if (tac->op2->type == SYMBOL_VARIABLE ||
-                    tac->op2->type == SYMBOL_IDENTIFIER ||
-                    tac->op2->type == SYMBOL_PARAMETER)
-                {
-                    fprintf(fout, "\tmovl _%s(%%rip), %%eax\n", tac->op2->text);
-                    fprintf(fout, "\tcltq\n");
-                    fprintf(fout, "\tleaq 0(,%%rax,4), %%rdx\n");
-                    fprintf(fout, "\tleaq _%s(%%rip), %%rax\n", tac->op1->text);
-                    fprintf(fout, "\tmovl (%%rdx,%%rax), %%eax\n");
-                    fprintf(fout, "\tmovl %%eax, _%s(%%rip)\n", tac->res->text);
-                }
-                else
-                {
-                    int index = 4 * atoi(tac->op2->text);
-                    fprintf(fout, "\tmovl %d+_%s(%%rip), %%eax\n", index, tac->op1->text);
-                    fprintf(fout, "\tmovl %%eax, _%s(%%rip)\n", tac->res->text);
-                }
-            }
-            else
-            {
-                char * op_text = tac->op1->text;
-                if (tac->op1->datatype == DATATYPE_REAL) {
-                    op_text = remove_decimal_point(op_text);
-                }
-                fprintf(fout, "\tmovl _%s(%%rip), %%eax\n", op_text);
-                fprintf(fout, "\tmovl %%eax, _%s(%%rip)\n", tac->res->text);
-            }
-
-            break;
-        }
-        case TAC_LABEL:
-        {
-            fprintf(fout, "_%s:\n", tac->res->text);
-            break;
-        }
-        case TAC_JFALSE:
-        {
-            fprintf(fout, "\tmovl _%s(%%rip), %%eax\n", tac->op1->text);
-            fprintf(fout, "\ttestl %%eax, %%eax\n");
-            fprintf(fout, "\tje _%s\n", tac->res->text);
-            break;
-        }
-        case TAC_JUMP:
-        {
-            fprintf(fout, "\tjmp _%s\n", tac->res->text);
-            break;
-        }
-        case TAC_CALL:
-        {
-            fprintf(fout, "\tcall %s\n", tac->op1->text);
-            fprintf(fout, "\tmovl %%eax, _%s(%%rip)\n", tac->res->text);
-            break;
-        }
-        case TAC_READ:
-        {
-            fprintf(stderr, "Datatype of %s is %s\n", tac->res->text, datatype_str[tac->res->datatype]);
-            switch (tac->res->datatype)
-            {
-                case DATATYPE_INT:
-                {
-                    fprintf(fout, "\tleaq _%s(%%rip), %%rax\n", tac->res->text);
-                    fprintf(fout, "\tmovq %%rax, %%rsi\n");
-                    fprintf(fout, "\tleaq print_str_int(%%rip), %%rax\n");
-                    fprintf(fout, "\tmovq %%rax, %%rdi\n");
-                    fprintf(fout, "\tmovl $0, %%eax\n");
-                    fprintf(fout, "\tcall __isoc99_scanf@PLT\n");
-                    break;
-                }
-                case DATATYPE_REAL:
-                {
-                    fprintf(fout, "\tleaq _%s(%%rip), %%rax\n", tac->res->text);
-                    fprintf(fout, "\tmovq %%rax, %%rsi\n");
-                    fprintf(fout, "\tleaq print_str_real(%%rip), %%rax\n");
-                    fprintf(fout, "\tmovq %%rax, %%rdi\n");
-                    fprintf(fout, "\tmovl $0, %%eax\n");
-                    fprintf(fout, "\tcall __isoc99_scanf@PLT\n");
-                    break;
-                }
-                case DATATYPE_CHAR:
-                {
-                    fprintf(fout, "\tleaq _%s(%%rip), %%rax\n", tac->res->text);
-                    fprintf(fout, "\tmovq %%rax, %%rsi\n");
-                    fprintf(fout, "\tleaq read_str_char(%%rip), %%rax\n");
-                    fprintf(fout, "\tmovq %%rax, %%rdi\n");
-                    fprintf(fout, "\tmovl $0, %%eax\n");
-                    fprintf(fout, "\tcall __isoc99_scanf@PLT\n");
-                    break;
-                }
             }
-
-            break;
         }
-        case TAC_VECDEC:
+        else if (tac->type == TAC_VECDEC)
         {
+            MOPERAND vector = mop_hash(tac->res, 0);
+            minstr_emit(&data, MI_GLOBL, 0, mop_none(), vector);
+            minstr_emit(&data, MI_ALIGN, 0, mop_none(), mop_imm(8));
+            minstr_emit(&data, MI_OBJECT, 0, mop_imm(4 * atoi(tac->op1->text)), vector);
+            minstr_emit(&data, MI_LABEL, 0, mop_none(), vector);
 
-            /*.globl	vec
-    .data
-    .align 8
-    .type	vec, @object
-    .size	vec, 12*/
-
-            fprintf(fout, "\t.globl\t_%s\n", tac->res->text);
-            fprintf(fout, "\t.data\n");
-            fprintf(fout, "\t.align 8\n");
-            fprintf(fout, "\t.type\t_%s, @object\n", tac->res->text);
-            fprintf(fout, "\t.size\t_%s, %d\n", tac->res->text, 4 * atoi(tac->op1->text));
-
-            fprintf(fout, "_%s:\n", tac->res->text);
-
+            int vec_item_count = 0;
             TAC *first_vec_item = tac->next;
             while (first_vec_item && first_vec_item->type == TAC_SYMBOL)
             {
-                fprintf(fout, "\t.long %s\n", first_vec_item->res->text);
+                if (tac->res->datatype == DATATYPE_REAL)
+                    minstr_emit(&data, MI_FLOAT, 4, mop_none(), mop_text(first_vec_item->res->text));
+                else
+                    minstr_emit(&data, MI_LONG, 4, mop_none(), mop_imm(isel_literal_value(first_vec_item->res)));
                 first_vec_item = first_vec_item->next;
+                vec_item_count++;
             }
 
-            break;
-        }
+            if (vec_item_count < atoi(tac->op1->text))
+            {
+                minstr_emit(&data, MI_ZERO, 0, mop_none(), mop_imm(4 * (atoi(tac->op1->text) - vec_item_count)));
+            }
         }
         tac = tac->next;
-    } while (tac);
-
-    fclose(fout);
-}
+    }
 
-char *arithmetic_tac_to_asm(TAC *tac)
-{
-    switch (tac->type)
-    {
-    case TAC_ADD:
-        return strdup("add");
-    case TAC_SUB:
-        return strdup("sub");
-    case TAC_MUL:
+    tac = origin;
+    if (compiler->profile_generate || compiler->profile_use)
+        profile_number(tac);
+    if (compiler->profile_use && profile_load(compiler->profile_use))
+        profile_attach();
+    if (compiler->vectorize_loops)
+        vectorize_analyze(tac);
+    isel_count_uses(tac);
+    asm_functions(&code, tac);
+    runtime_emit(&code, &bss);
+    if (compiler->profile_generate)
+        profile_emit(&code, &rodata, &bss);
+    asm_pool(&rodata);
+    if (compiler->verbose)
     {
-        if (tac->res->datatype == DATATYPE_INT)
-            return strdup("imul");
-        else
-            return strdup("mul");
-    }
-    case TAC_DIV:
-        return strdup("idiv");
+        peephole_report(compiler->diagnostics);
     }
-}
 
-char *remove_decimal_point(char *str)
-{
-    // copy str to a new string
-    char *copy = strdup(str);
-    // split  string on "." and create "before" and "after"
-    char *before = strtok(copy, ".");
-    char *after = strtok(NULL, ".");
-
-    char *result = (char *)calloc(100, sizeof(char));
-
-    // if there was a decimal point, concatenate the two parts
-    strcat(result, before);
-    if (after)
+    if (compiler->emit_object || compiler->run_jit)
     {
-        strcat(result, "f");
-        strcat(result, after);
+        XOBJECT *object = (XOBJECT *)calloc(1, sizeof(XOBJECT));
+        x86_assemble(object, &rodata);
+        x86_assemble(object, &data);
+        x86_assemble(object, &bss);
+        x86_assemble(object, &code);
+        if (compiler->run_jit)
+            compiler->jit_status = jit_run(object);
+        else
+        {
+            XBUFFER image = {NULL, 0, 0};
+            elf_image(&image, object);
+            compiler->output = (char *)image.data;
+            compiler->output_length = image.length;
+        }
+        x86_release(object);
+        free(object);
     }
-
-    return result;
-}
-
-char *logic_tac_to_asm(TAC *tac)
-{
-
-    switch (tac->type)
+    else
     {
-    case TAC_LE:
-        return strdup("setle");
-    case TAC_GE:
-        return strdup("setge");
-    case TAC_EQ:
-        return strdup("sete");
-    case TAC_DIF:
-        return strdup("setne");
-    case TAC_LT:
-        return strdup("setl");
-    case TAC_GT:
-        return strdup("setg");
-    case TAC_OR:
-        return strdup("orl");
-    case TAC_AND:
-        return strdup("andl");
+        MBUFFER out = {NULL, 0, 0};
+        minstr_print(&out, &rodata);
+        minstr_print(&out, &data);
+        minstr_print(&out, &bss);
+        minstr_print(&out, &code);
+        compiler->output = out.data;
+        compiler->output_length = out.length;
     }
 
-    return strdup("ERROR");
-}
\ No newline at end of file
+    minstr_release(&rodata);
+    minstr_release(&bss);
+    minstr_release(&data);
+    minstr_release(&code);
+}
@@ -1,7 +1,99 @@
 #pragma once
+#include <pthread.h>
 #include "tac.h"
+#include "isel.h"
+#include "vectorize.h"
+#include "runtime.h"
+#include "peephole.h"
+#include "elfgen.h"
+#include "jit.h"
+#include "profile.h"
 
-char* arithmetic_tac_to_asm(TAC *tac);
-char* logic_tac_to_asm(TAC *tac);
-char* remove_decimal_point(char* str);
+// 4-byte constants the code loads from memory, each bit pattern emitted once
+typedef struct asm_pool
+{
+    int *bits;
+    int count;
+    int size;
+} ASM_POOL;
+
+// output descriptors used since the pool was last emitted
+typedef struct asm_formats
+{
+    char **text;
+    int *id;
+    int count;
+    int size;
+    int next_id;
+} ASM_FORMATS;
+
+// an output command collected into out_format calls; text is the descriptor spelled for
+// .string, room bounds what its items write, and the arguments are loaded from their
+// cells right before the call
+typedef struct asm_output
+{
+    MBUFFER text;
+    int items;
+    int in_text;
+    int room;
+    HASH *ints[RUNTIME_FORMAT_INTS];
+    int int_count;
+    HASH *reals[RUNTIME_FORMAT_REALS];
+    int real_count;
+} ASM_OUTPUT;
+
+// then-blocks set aside to be placed after the function, under their own labels; those
+// that do not return jump back to their join label
+typedef struct asm_cold
+{
+    TAC **first;
+    TAC **last;
+    char **label;
+    HASH **join;
+    int count;
+    int size;
+} ASM_COLD;
+
+// code generator state of one compilation
+typedef struct asm_state
+{
+    ASM_POOL constants;
+    ASM_FORMATS formats;
+    ASM_OUTPUT out;
+    ASM_COLD cold;
+} ASM_STATE;
+
+#define ASM_MAX_THREADS 64
+
+// a function, or the code before the first one, selected and cleaned up on its own with
+// its own selector and pools; the results are merged in source order
+typedef struct asm_job
+{
+    TAC *first;
+    TAC *last;
+    MCODE code;
+    ISEL_STATE isel;
+    ASM_STATE assembly;
+    int *peephole_hits;
+    ARENA arena; // what the job allocated with the context's, adopted when merged
+    int cached;  // its code was read back from the cache, not selected
+    int failed;  // compiler_fail gave up on it
+} ASM_JOB;
+
+typedef struct asm_jobs
+{
+    ASM_JOB *jobs;
+    int count;
+    int next;
+    COMPILER_CONTEXT *context;
+    pthread_mutex_t lock;
+} ASM_JOBS;
+
+MOPERAND asm_constant(int bits);
+MOPERAND asm_literal(HASH *literal);
+void asm_pool(MCODE *rodata);
+void asm_rodata(MCODE *rodata);
+int asm_output_alone(TAC *tac);
+void asm_text(MCODE *code, TAC *first, TAC *last);
+void asm_functions(MCODE *code, TAC *first);
 void generate_asm(TAC *first);
\ No newline at end of file
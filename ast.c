@@ -5,15 +5,10 @@
 #include <stdio.h>
 #include <stdlib.h>
 
-AST *root;
-int ast_node_id = 0;
-int ast_loop_id = 0;
-int ast_subloop_id = 0;
-
 AST *astCreate(int type, HASH *symbol, AST *s0, AST *s1, AST *s2, AST *s3, int line_number)
 {
     // fprintf(stderr, "astCreate(%s)\n", ast_type_str(type));
-    AST *ast = (AST *)calloc(1, sizeof(AST));
+    AST *ast = (AST *)arena_alloc(&compiler->arena, sizeof(AST));
     ast->type = type;
     ast->typechecked = 0;
     ast->symbol = symbol;
@@ -24,7 +19,7 @@ AST *astCreate(int type, HASH *symbol, AST *s0, AST *s1, AST *s2, AST *s3, int l
     ast->son[3] = s3;
     // ast->optimized = 0;
     ast->has_dependencies = 0;
-    ast->id = ++ast_node_id;
+    ast->id = ++compiler->ast_node_id;
     ast->remove_assignment = 0;
     ast->varies = 0;
 
@@ -85,13 +80,16 @@ int isLeaf(AST *node)
     return node->son[0] == 0 && node->son[1] == 0 && node->son[2] == 0 && node->son[3] == 0;
 }
 
-char code[50000000];
 inline char *astToCode(AST *node)
 {
+    char *code;
     if (node == 0)
     {
         return strdup("");
     }
+    if (!compiler->code)
+        compiler->code = (char *)malloc(AST_CODE_SIZE);
+    code = compiler->code;
 
     switch (node->type)
     {
@@ -547,7 +545,8 @@ void set_param_list_item_function(AST *node)
     if (!node)
         return;
 
-    if (node->type == AST_FUNC_DECL_INT || node->type == AST_FUNC_DECL_REAL || node->type == AST_FUNC_DECL_BOOL)
+    if (node->type == AST_FUNC_DECL_INT || node->type == AST_FUNC_DECL_REAL || node->type == AST_FUNC_DECL_CHAR ||
+        node->type == AST_FUNC_DECL_BOOL)
     {
         AST *param_list = node->son[0];
         while (param_list != NULL)
@@ -595,13 +594,13 @@ int ast_collect_loop_elements(AST *node)
 
     if (node->type == AST_CMD_LIST && node->son[0] && node->son[0]->type == AST_LOOP && node->loop_id == 0)
     {
-        int id = ast_loop_id + 1;
+        int id = compiler->ast_loop_id + 1;
         node->loop_id = id;
         node->subloop_id = 1;
         node->son[0]->subloop_id = 1;
         ast_mark_loop_elements(node->son[0], id, 1);
 
-        ast_loop_id++;
+        compiler->ast_loop_id++;
     }
 
     int i;
@@ -651,13 +650,13 @@ NODE_LIST *ast_cond_list_insert_at(int index, int subloop_id, AST *node)
         return new_node;
     }
 
-    if (cond_list[index] == NULL)
+    if (compiler->cond_list[index] == NULL)
     {
-        cond_list[index] = new_node;
+        compiler->cond_list[index] = new_node;
     }
     else
     {
-        NODE_LIST *current = cond_list[index];
+        NODE_LIST *current = compiler->cond_list[index];
         while (current->next != NULL)
         {
             current = current->next;
@@ -665,7 +664,7 @@ NODE_LIST *ast_cond_list_insert_at(int index, int subloop_id, AST *node)
         current->next = new_node;
     }
 
-    return cond_list[index];
+    return compiler->cond_list[index];
 }
 
 void ast_collect_loop_variables(AST *node)
@@ -690,7 +689,7 @@ void ast_collect_loop_variables(AST *node)
 }
 
 void ast_insert_variable(HASH * symbol, int loop_id) {
-    NODE_LIST* current = cond_list[loop_id];
+    NODE_LIST* current = compiler->cond_list[loop_id];
     if (current == NULL) {
         return;
     }
@@ -710,7 +709,7 @@ void ast_insert_variable(HASH * symbol, int loop_id) {
 }
 
 void ast_insert_attrib(HASH * symbol, int loop_id) {
-    NODE_LIST* current = cond_list[loop_id];
+    NODE_LIST* current = compiler->cond_list[loop_id];
     if (current == NULL) {
         return;
     }
@@ -739,14 +738,14 @@ void ast_set_cond_list_loop_variables(int id, AST *node)
 
     if (node->type == AST_IDENTIFIER)
     {
-        NODE_LIST *current = cond_list[id];
+        NODE_LIST *current = compiler->cond_list[id];
         current->right_side_vars[current->right_side_vars_count++] = node->symbol->text;
         ast_insert_variable(node->symbol, id);
     }
 
     if (node->type == AST_VAR_ATTRIB)
     {
-        NODE_LIST *current = cond_list[id];
+        NODE_LIST *current = compiler->cond_list[id];
         current->left_side_vars[current->left_side_vars_count++] = node->symbol->text;
         ast_insert_variable(node->symbol, id);
         ast_insert_attrib(node->symbol, id);
@@ -761,7 +760,7 @@ void ast_set_cond_list_loop_variables(int id, AST *node)
 
 int ast_appears_on_right_side(char *text, int loop_id)
 {
-    NODE_LIST *current = cond_list[loop_id];
+    NODE_LIST *current = compiler->cond_list[loop_id];
     int i;
     for (i = 0; i < current->right_side_vars_count; i++)
     {
@@ -780,10 +779,10 @@ void ast_print_cond_list()
     int i;
     for (i = 0; i < COND_LIST_SIZE; i++)
     {
-        if (cond_list[i] != NULL)
+        if (compiler->cond_list[i] != NULL)
         {
-            fprintf(stderr, "cond_list[%d]:\n", i);
-            NODE_LIST *current = cond_list[i];
+            fprintf(stderr, "compiler->cond_list[%d]:\n", i);
+            NODE_LIST *current = compiler->cond_list[i];
 
             int j;
             for (j = 0; j < VARIABLE_LIST_SIZE; j++) {
@@ -824,7 +823,7 @@ void ast_collect_has_dependencies(AST *node)
 
 int ast_appears_on_left_side(char *text, int loop_id)
 {
-    NODE_LIST *current = cond_list[loop_id];
+    NODE_LIST *current = compiler->cond_list[loop_id];
     int i;
     int c = 0;
     for (i = 0; i < current->left_side_vars_count; i++)
@@ -907,7 +906,7 @@ void ast_move_constant_assignments_out_of_loop(AST *cmdlist_before, AST *node)
         if (!node->has_dependencies)
         {
            // fprintf(stderr, "variable %s has no dependencies\n", node->symbol->text);
-            optimized = 1;
+            compiler->optimized = 1;
             node->remove_assignment = 1;
             AST *loop = cmdlist_before->son[0];
             AST *rest = cmdlist_before->son[1];
@@ -997,7 +996,7 @@ void ast_add_assignment_conds(AST *node)
     AST *current = node->son[0];
     if (current != NULL && current->type == AST_VAR_ATTRIB && current->loop_id != 0 && !current->has_dependencies)
     {
-        NODE_LIST *current_cond = cond_list[node->son[0]->loop_id];
+        NODE_LIST *current_cond = compiler->cond_list[node->son[0]->loop_id];
         AST *linked = NULL;
         AST *last = NULL;
         while (current_cond != NULL)
@@ -1166,7 +1165,7 @@ void ast_set_dependencies_handle_attrib(AST *node, int loop_id) {
 }
 
 void ast_update_variable_varies(HASH *symbol, int loop_id, int varies) {
-    NODE_LIST* current = cond_list[loop_id];
+    NODE_LIST* current = compiler->cond_list[loop_id];
     if (current == NULL) {
         return;
     }
@@ -1202,7 +1201,7 @@ int ast_identifiers_of_attrib_varies(AST *node) {
 
 int ast_variable_varies(HASH *symbol, int loop_id) {
    
-    NODE_LIST* current = cond_list[loop_id];
+    NODE_LIST* current = compiler->cond_list[loop_id];
     if (current == NULL) {
      
         return 0;
@@ -1327,7 +1326,7 @@ void ast_set_order_dependencies_handle_attrib(AST *attrib, AST *node, int loop_i
 
     if (node->type == AST_IDENTIFIER)
         {
-            VARIABLE **attribs = cond_list[loop_id]->attribs;
+            VARIABLE **attribs = compiler->cond_list[loop_id]->attribs;
             int mypos, theirpos;
             int i;
             for (i = 0; i < VARIABLE_LIST_SIZE; i++) {
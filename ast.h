@@ -4,12 +4,7 @@
 #define MAX_SONS 4
 #define COND_LIST_SIZE 10000000
 #define VARIABLE_LIST_SIZE 10000
-extern int SemanticErrors;
-
-extern int ast_node_id;
-extern int ast_loop_id;
-extern int ast_subloop_id;
-
+#define AST_CODE_SIZE 50000000
 typedef struct variable
 {
     HASH* symbol;
@@ -53,10 +48,6 @@ typedef struct ast_node
     int varies;
 } AST;
 
-int optimized = 0;
-AST *root;
-NODE_LIST *cond_list[COND_LIST_SIZE];
-
 AST *astCreate(int type, HASH *symbol, AST *s0, AST *s1, AST *s2, AST *s3, int line_number);
 void astPrint(AST *node, int level);
 char *astToCode(AST *node);
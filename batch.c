@@ -0,0 +1,177 @@
+#include <time.h>
+#include "batch.h"
+
+void batch_add(BATCH *batch, char *input, char *output)
+{
+    BATCH_FILE *file;
+    if (batch->count == batch->size)
+    {
+        batch->size = batch->size ? 2 * batch->size : 64;
+        batch->files = (BATCH_FILE *)realloc(batch->files, batch->size * sizeof(BATCH_FILE));
+    }
+    file = &batch->files[batch->count++];
+    memset(file, 0, sizeof(BATCH_FILE));
+    file->input = strdup(input);
+    file->output = output ? strdup(output) : NULL;
+}
+
+int batch_load(BATCH *batch, char *manifest)
+{
+    char line[BATCH_LINE_SIZE];
+    char input[BATCH_LINE_SIZE];
+    char output[BATCH_LINE_SIZE];
+    FILE *file = fopen(manifest, "r");
+
+    if (!file)
+        return 0;
+    while (fgets(line, sizeof(line), file))
+    {
+        int fields = sscanf(line, "%s %s", input, output);
+        if (fields >= 1 && input[0] != '#')
+            batch_add(batch, input, fields == 2 ? output : NULL);
+    }
+    fclose(file);
+    return 1;
+}
+
+// input.comp becomes input.s, or input.o for objects
+char *batch_output_name(char *input, int object)
+{
+    char *dot = strrchr(input, '.');
+    size_t stem = dot && !strchr(dot, '/') ? (size_t)(dot - input) : strlen(input);
+    char *name = (char *)malloc(stem + 3);
+    memcpy(name, input, stem);
+    strcpy(name + stem, object ? ".o" : ".s");
+    return name;
+}
+
+void batch_compile(BATCH_FILE *file, COMPILER_CONTEXT *options)
+{
+    COMPILER_CONTEXT *context;
+    size_t length;
+    char *source = compiler_read(file->input, &length);
+    FILE *out;
+
+    if (!source)
+    {
+        file->status = 2;
+        return;
+    }
+
+    context = compiler_create();
+    context->optimize = options->optimize;
+    context->verbose = options->verbose;
+    context->emit_object = options->emit_object;
+    context->vectorize_loops = options->vectorize_loops;
+    context->vectorize_avx2 = options->vectorize_avx2;
+    context->eager_logic = options->eager_logic;
+    context->block_layout = options->block_layout;
+    context->profile_generate = options->profile_generate;
+    context->profile_use = options->profile_use;
+
+    file->status = compiler_compile(context, source, length);
+    file->syntax_errors = context->syntax_errors;
+    file->semantic_errors = context->semantic_errors;
+    if (file->status == 0)
+    {
+        if (!file->output)
+            file->output = batch_output_name(file->input, options->emit_object);
+        if ((out = fopen(file->output, "wb")))
+        {
+            fwrite(context->output, 1, context->output_length, out);
+            fclose(out);
+        }
+        else
+            file->status = 2;
+    }
+    compiler_destroy(context);
+    free(source);
+}
+
+void *batch_worker(void *argument)
+{
+    BATCH *batch = (BATCH *)argument;
+    for (;;)
+    {
+        int i;
+        pthread_mutex_lock(&batch->lock);
+        i = batch->next++;
+        pthread_mutex_unlock(&batch->lock);
+        if (i >= batch->count)
+            return NULL;
+        batch_compile(&batch->files[i], batch->options);
+    }
+}
+
+double batch_seconds(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+// compiles every file of the manifest on jobs threads; returns 0 when all compiled, or
+// the status of the first one that did not
+int batch_run(char *manifest, COMPILER_CONTEXT *options, int jobs)
+{
+    BATCH batch;
+    pthread_t threads[BATCH_MAX_JOBS];
+    double start;
+    double elapsed;
+    int failed = 0;
+    int status = 0;
+    int i;
+
+    memset(&batch, 0, sizeof(batch));
+    batch.options = options;
+    pthread_mutex_init(&batch.lock, NULL);
+    if (!batch_load(&batch, manifest))
+    {
+        fprintf(stderr, "batch: cannot read %s\n", manifest);
+        return 2;
+    }
+
+    if (jobs < 1)
+        jobs = 1;
+    if (jobs > BATCH_MAX_JOBS)
+        jobs = BATCH_MAX_JOBS;
+    if (jobs > batch.count)
+        jobs = batch.count;
+
+    start = batch_seconds();
+    for (i = 0; i < jobs; i++)
+        pthread_create(&threads[i], NULL, batch_worker, &batch);
+    for (i = 0; i < jobs; i++)
+        pthread_join(threads[i], NULL);
+    elapsed = batch_seconds() - start;
+
+    for (i = 0; i < batch.count; i++)
+    {
+        BATCH_FILE *file = &batch.files[i];
+        if (file->status == 0)
+            continue;
+        if (file->status == 3)
+            fprintf(stderr, "batch: %s failed with %d syntax errors\n", file->input, file->syntax_errors);
+        else if (file->status == 4)
+            fprintf(stderr, "batch: %s failed with %d semantic errors\n", file->input, file->semantic_errors);
+        else if (file->status == 5)
+            fprintf(stderr, "batch: %s failed with an internal error\n", file->input);
+        else if (file->output)
+            fprintf(stderr, "batch: %s could not be written to %s\n", file->input, file->output);
+        else
+            fprintf(stderr, "batch: %s could not be read\n", file->input);
+        if (!failed++)
+            status = file->status;
+    }
+    fprintf(stderr, "batch: %d files, %d failed, %d jobs, %.3f s, %.1f files/s\n", batch.count, failed, jobs, elapsed,
+            elapsed > 0 ? batch.count / elapsed : 0.0);
+
+    for (i = 0; i < batch.count; i++)
+    {
+        free(batch.files[i].input);
+        free(batch.files[i].output);
+    }
+    free(batch.files);
+    pthread_mutex_destroy(&batch.lock);
+    return status;
+}
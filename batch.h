@@ -0,0 +1,30 @@
+#pragma once
+#include <pthread.h>
+#include "compiler.h"
+
+#define BATCH_MAX_JOBS 256
+#define BATCH_LINE_SIZE 4096
+
+// one line of the manifest: "<input> [output]"; without an output the input's name is
+// used with .s, or .o under -c
+typedef struct batch_file
+{
+    char *input;
+    char *output;
+    int status; // compiler_compile's, or 2 when a file could not be read or written
+    int syntax_errors;
+    int semantic_errors;
+} BATCH_FILE;
+
+// the manifest being compiled; workers take the next file under lock
+typedef struct batch
+{
+    BATCH_FILE *files;
+    int count;
+    int size;
+    int next;
+    COMPILER_CONTEXT *options; // every file is compiled with these options
+    pthread_mutex_t lock;
+} BATCH;
+
+int batch_run(char *manifest, COMPILER_CONTEXT *options, int jobs);
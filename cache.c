@@ -0,0 +1,364 @@
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "cache.h"
+#include "fragment.h"
+
+unsigned cache_rounds[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+};
+
+#define CACHE_ROTATE(x, n) (((x) >> (n)) | ((x) << (32 - (n))))
+
+void cache_hash_start(CACHE_HASH *hash)
+{
+    static const unsigned initial[8] = {0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+                                        0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19};
+    memcpy(hash->state, initial, sizeof(initial));
+    hash->length = 0;
+}
+
+void cache_hash_block(CACHE_HASH *hash)
+{
+    unsigned w[64], v[8], s0, s1, t1, t2;
+    int i;
+
+    for (i = 0; i < 16; i++)
+        w[i] = (unsigned)hash->block[4 * i] << 24 | (unsigned)hash->block[4 * i + 1] << 16 |
+               (unsigned)hash->block[4 * i + 2] << 8 | hash->block[4 * i + 3];
+    for (i = 16; i < 64; i++)
+    {
+        s0 = CACHE_ROTATE(w[i - 15], 7) ^ CACHE_ROTATE(w[i - 15], 18) ^ (w[i - 15] >> 3);
+        s1 = CACHE_ROTATE(w[i - 2], 17) ^ CACHE_ROTATE(w[i - 2], 19) ^ (w[i - 2] >> 10);
+        w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+    }
+
+    memcpy(v, hash->state, sizeof(v));
+    for (i = 0; i < 64; i++)
+    {
+        s1 = CACHE_ROTATE(v[4], 6) ^ CACHE_ROTATE(v[4], 11) ^ CACHE_ROTATE(v[4], 25);
+        t1 = v[7] + s1 + ((v[4] & v[5]) ^ (~v[4] & v[6])) + cache_rounds[i] + w[i];
+        s0 = CACHE_ROTATE(v[0], 2) ^ CACHE_ROTATE(v[0], 13) ^ CACHE_ROTATE(v[0], 22);
+        t2 = s0 + ((v[0] & v[1]) ^ (v[0] & v[2]) ^ (v[1] & v[2]));
+        memmove(v + 1, v, 7 * sizeof(unsigned));
+        v[4] += t1;
+        v[0] = t1 + t2;
+    }
+    for (i = 0; i < 8; i++)
+        hash->state[i] += v[i];
+}
+
+void cache_hash_bytes(CACHE_HASH *hash, const unsigned char *bytes, size_t length)
+{
+    size_t i;
+    for (i = 0; i < length; i++)
+    {
+        hash->block[hash->length++ % 64] = bytes[i];
+        if (hash->length % 64 == 0)
+            cache_hash_block(hash);
+    }
+}
+
+// each field is led by its length, so that fields cannot run into each other
+void cache_hash(CACHE_HASH *hash, const void *data, size_t length)
+{
+    unsigned long long size = length;
+    cache_hash_bytes(hash, (const unsigned char *)&size, sizeof(size));
+    cache_hash_bytes(hash, (const unsigned char *)data, length);
+}
+
+// pads the message as sha-256 does and writes the digest into key in hex
+void cache_hash_end(CACHE_HASH *hash, char *key)
+{
+    unsigned long long bits = hash->length * 8;
+    unsigned char end[8];
+    int i;
+
+    cache_hash_bytes(hash, (const unsigned char *)"\x80", 1);
+    while (hash->length % 64 != 56)
+        cache_hash_bytes(hash, (const unsigned char *)"", 1);
+    for (i = 0; i < 8; i++)
+        end[i] = (unsigned char)(bits >> (56 - 8 * i));
+    cache_hash_bytes(hash, end, 8);
+    for (i = 0; i < 8; i++)
+        snprintf(key + 8 * i, CACHE_KEY_SIZE - 8 * i, "%08x", hash->state[i]);
+}
+
+char cache_compiler[CACHE_KEY_SIZE] = CACHE_VERSION;
+pthread_once_t cache_once = PTHREAD_ONCE_INIT;
+
+// the digest of the running binary, so that any change to the compiler, and not only
+// a rebuild, makes new keys
+void cache_version_init(void)
+{
+    CACHE_HASH hash;
+    size_t length;
+    char *binary = compiler_read("/proc/self/exe", &length);
+
+    if (!binary)
+        return;
+    cache_hash_start(&hash);
+    cache_hash(&hash, binary, length);
+    cache_hash_end(&hash, cache_compiler);
+    free(binary);
+}
+
+const char *cache_version(void)
+{
+    pthread_once(&cache_once, cache_version_init);
+    return cache_compiler;
+}
+
+// names what compiling source with the options of context gives: the compiler, every
+// option that changes the output, the counts of a profile in use and the source
+void cache_key(COMPILER_CONTEXT *context, const char *source, size_t length, char *key)
+{
+    CACHE_HASH hash;
+    char options[COMPILER_PATH_SIZE + 64];
+    char *profile = NULL;
+    size_t profile_length = 0;
+    int written;
+
+    written = snprintf(options, sizeof(options), "%d %d %d %d %d %d %d %s", context->optimize, context->verbose,
+                       context->emit_object, context->vectorize_loops, context->vectorize_avx2, context->eager_logic,
+                       context->block_layout, context->profile_generate ? context->profile_generate : "");
+    if (written >= (int)sizeof(options))
+        written = sizeof(options) - 1;
+    if (context->profile_use)
+        profile = compiler_read(context->profile_use, &profile_length);
+
+    cache_hash_start(&hash);
+    cache_hash(&hash, cache_version(), strlen(cache_version()));
+    cache_hash(&hash, options, written);
+    cache_hash(&hash, profile ? profile : "", profile_length);
+    cache_hash(&hash, source, length);
+    free(profile);
+    cache_hash_end(&hash, key);
+}
+
+// reads the entry of key; one cut short or made by another format is a miss
+int cache_fetch(const char *cache, const char *key, CACHE_ENTRY *entry)
+{
+    char path[COMPILER_PATH_SIZE];
+    CACHE_HEADER *header;
+    size_t length;
+
+    memset(entry, 0, sizeof(CACHE_ENTRY));
+    snprintf(path, sizeof(path), "%s/%s", cache, key);
+    if (!(entry->data = compiler_read(path, &length)))
+        return 0;
+
+    header = (CACHE_HEADER *)entry->data;
+    if (length < sizeof(CACHE_HEADER) || header->magic != CACHE_MAGIC || header->messages > length ||
+        header->output > length || header->decomp > length ||
+        length != sizeof(CACHE_HEADER) + header->messages + header->output + header->decomp)
+    {
+        free(entry->data);
+        entry->data = NULL;
+        return 0;
+    }
+    entry->messages = entry->data + sizeof(CACHE_HEADER);
+    entry->messages_length = header->messages;
+    entry->output = entry->messages + entry->messages_length;
+    entry->output_length = header->output;
+    entry->decomp = entry->output + entry->output_length;
+    entry->decomp_length = header->decomp;
+
+    // eviction takes the entries used longest ago first
+    utimensat(AT_FDCWD, path, NULL, 0);
+    return 1;
+}
+
+// writes the entry of key beside its place and renames it there, so a reader sees all
+// of it or none
+int cache_store(const char *cache, const char *key, CACHE_ENTRY *entry)
+{
+    static unsigned serial;
+    char path[COMPILER_PATH_SIZE];
+    char temporary[COMPILER_PATH_SIZE];
+    CACHE_HEADER header;
+    FILE *file;
+    int written;
+
+    mkdir(cache, 0777);
+    snprintf(path, sizeof(path), "%s/%s", cache, key);
+    snprintf(temporary, sizeof(temporary), "%s/%s.tmp.%d.%u", cache, key, (int)getpid(),
+             __atomic_fetch_add(&serial, 1, __ATOMIC_RELAXED));
+    if (!(file = fopen(temporary, "wb")))
+        return 0;
+
+    header.magic = CACHE_MAGIC;
+    header.messages = (unsigned)entry->messages_length;
+    header.output = entry->output_length;
+    header.decomp = entry->decomp_length;
+    written = fwrite(&header, sizeof(header), 1, file) == 1 &&
+              fwrite(entry->messages, 1, entry->messages_length, file) == entry->messages_length &&
+              fwrite(entry->output, 1, entry->output_length, file) == entry->output_length &&
+              fwrite(entry->decomp, 1, entry->decomp_length, file) == entry->decomp_length;
+    if (fclose(file) != 0)
+        written = 0;
+    if (!written || rename(temporary, path) != 0)
+    {
+        unlink(temporary);
+        return 0;
+    }
+    return 1;
+}
+
+int cache_older(const void *a, const void *b)
+{
+    const CACHE_FILE *x = (const CACHE_FILE *)a;
+    const CACHE_FILE *y = (const CACHE_FILE *)b;
+    if (x->used.tv_sec != y->used.tv_sec)
+        return x->used.tv_sec < y->used.tv_sec ? -1 : 1;
+    if (x->used.tv_nsec != y->used.tv_nsec)
+        return x->used.tv_nsec < y->used.tv_nsec ? -1 : 1;
+    return 0;
+}
+
+// removes the entries used longest ago until the rest take at most limit bytes, and the
+// temporary files of writers that died
+void cache_evict(const char *cache, long limit)
+{
+    char path[COMPILER_PATH_SIZE];
+    CACHE_FILE *files = NULL;
+    struct dirent *item;
+    struct stat status;
+    time_t now = time(NULL);
+    long total = 0;
+    int count = 0;
+    int size = 0;
+    int i;
+    DIR *directory = opendir(cache);
+
+    if (!directory)
+        return;
+    while ((item = readdir(directory)))
+    {
+        if (item->d_name[0] == '.')
+            continue;
+        snprintf(path, sizeof(path), "%s/%s", cache, item->d_name);
+        if (stat(path, &status) != 0 || !S_ISREG(status.st_mode))
+            continue;
+        if (strstr(item->d_name, ".tmp."))
+        {
+            if (now - status.st_mtime > CACHE_STALE_SECONDS)
+                unlink(path);
+            continue;
+        }
+        if (count == size)
+        {
+            size = size ? 2 * size : 64;
+            files = (CACHE_FILE *)realloc(files, size * sizeof(CACHE_FILE));
+        }
+        files[count].name = strdup(item->d_name);
+        files[count].used = status.st_mtim;
+        files[count].size = status.st_size;
+        total += status.st_size;
+        count++;
+    }
+    closedir(directory);
+
+    if (total > limit)
+    {
+        qsort(files, count, sizeof(CACHE_FILE), cache_older);
+        for (i = 0; i < count && total > limit; i++)
+        {
+            snprintf(path, sizeof(path), "%s/%s", cache, files[i].name);
+            if (unlink(path) == 0 || errno == ENOENT)
+                total -= files[i].size;
+        }
+    }
+
+    for (i = 0; i < count; i++)
+        free(files[i].name);
+    free(files);
+}
+
+// gives the messages and files of a compile from its entry, as compiler_write does
+int cache_write(COMPILER_CONTEXT *context, CACHE_ENTRY *entry, const char *directory)
+{
+    char path[COMPILER_PATH_SIZE];
+    FILE *file;
+
+    fwrite(entry->messages, 1, entry->messages_length, context->diagnostics);
+
+    snprintf(path, sizeof(path), "%s/out.decomp", directory);
+    if (!(file = fopen(path, "w")))
+    {
+        fprintf(context->diagnostics, "could not open output file\n");
+        return 2;
+    }
+    fwrite(entry->decomp, 1, entry->decomp_length, file);
+    fclose(file);
+
+    snprintf(path, sizeof(path), "%s/generated/%s", directory, context->emit_object ? "out.o" : "out.s");
+    if (!(file = fopen(path, "wb")))
+    {
+        fprintf(context->diagnostics, "could not open %s\n", path);
+        return 2;
+    }
+    fwrite(entry->output, 1, entry->output_length, file);
+    fclose(file);
+    return 0;
+}
+
+// compiles as compiler_write does, unless the cache has the same source compiled with
+// the same options by the same compiler; compiles that succeed are kept there
+int cache_main(COMPILER_CONTEXT *context, const char *source, size_t length, const char *directory)
+{
+    char key[CACHE_KEY_SIZE];
+    char path[COMPILER_PATH_SIZE];
+    CACHE_ENTRY entry;
+    FILE *diagnostics = context->diagnostics;
+    char *messages = NULL;
+    size_t messages_length = 0;
+    int stored = 0;
+    int status;
+
+    cache_key(context, source, length, key);
+    if (cache_fetch(context->cache, key, &entry))
+    {
+        status = cache_write(context, &entry, directory);
+        free(entry.data);
+        fprintf(context->diagnostics, "cache: hit %s\n", key);
+        return status;
+    }
+
+    context->diagnostics = open_memstream(&messages, &messages_length);
+    status = compiler_write(context, source, length, directory);
+    fclose(context->diagnostics);
+    context->diagnostics = diagnostics;
+    fwrite(messages, 1, messages_length, diagnostics);
+
+    if (status == 0 && context->output)
+    {
+        entry.messages = messages;
+        entry.messages_length = messages_length;
+        entry.output = context->output;
+        entry.output_length = context->output_length;
+        snprintf(path, sizeof(path), "%s/out.decomp", directory);
+        if ((entry.decomp = compiler_read(path, &entry.decomp_length)))
+            stored = cache_store(context->cache, key, &entry);
+        if (stored)
+            cache_evict(context->cache, context->cache_size);
+        free(entry.decomp);
+    }
+    fprintf(diagnostics, "cache: miss %s", key);
+    if (context->fragments)
+        fprintf(diagnostics, ", %d of %d functions compiled", context->fragments->count - context->fragments->cached,
+                context->fragments->count);
+    fprintf(diagnostics, "%s\n", stored ? ", stored" : "");
+    free(messages);
+    return status;
+}
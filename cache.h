@@ -0,0 +1,59 @@
+#pragma once
+#include <time.h>
+#include "compiler.h"
+
+#define CACHE_MAGIC 0x68636163 // "cach"
+#define CACHE_DEFAULT_SIZE (256L << 20)
+#define CACHE_KEY_SIZE 65       // a sha-256 in hex
+#define CACHE_STALE_SECONDS 3600 // a temporary file this old was left by a writer that died
+
+// names the compiler when its binary cannot be read; entries made by another build are
+// never used
+#define CACHE_VERSION __DATE__ " " __TIME__
+
+// sha-256 of the bytes hashed so far
+typedef struct cache_hash
+{
+    unsigned state[8];
+    unsigned char block[64];
+    unsigned long long length;
+} CACHE_HASH;
+
+// an entry file is this header, then the messages, the output and out.decomp
+typedef struct cache_header
+{
+    unsigned magic;
+    unsigned messages;
+    unsigned long long output;
+    unsigned long long decomp;
+} CACHE_HEADER;
+
+// an entry read whole into data, which the others point into
+typedef struct cache_entry
+{
+    char *data;
+    char *messages;
+    size_t messages_length;
+    char *output;
+    size_t output_length;
+    char *decomp;
+    size_t decomp_length;
+} CACHE_ENTRY;
+
+// a file of the cache directory, as eviction sees it
+typedef struct cache_file
+{
+    char *name;
+    struct timespec used;
+    long size;
+} CACHE_FILE;
+
+void cache_hash_start(CACHE_HASH *hash);
+void cache_hash(CACHE_HASH *hash, const void *data, size_t length);
+void cache_hash_end(CACHE_HASH *hash, char *key);
+const char *cache_version(void);
+void cache_key(COMPILER_CONTEXT *context, const char *source, size_t length, char *key);
+int cache_fetch(const char *cache, const char *key, CACHE_ENTRY *entry);
+int cache_store(const char *cache, const char *key, CACHE_ENTRY *entry);
+void cache_evict(const char *cache, long limit);
+int cache_main(COMPILER_CONTEXT *context, const char *source, size_t length, const char *directory);
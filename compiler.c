@@ -0,0 +1,354 @@
+#include <stdarg.h>
+#include "compiler.h"
+#include "cache.h"
+#include "fragment.h"
+
+__thread COMPILER_CONTEXT *compiler = NULL;
+
+COMPILER_CONTEXT *compiler_create(void)
+{
+    COMPILER_CONTEXT *context = (COMPILER_CONTEXT *)calloc(1, sizeof(COMPILER_CONTEXT));
+    context->tier_threshold = 1000;
+    context->jobs = 1;
+    context->lex_chunk = LEXER_CHUNK_SIZE;
+    context->cache_size = CACHE_DEFAULT_SIZE;
+    context->vectorize_loops = 1;
+    context->block_layout = 1;
+    context->line_number = 1;
+    context->is_running = 1;
+    context->diagnostics = stderr;
+    context->symbols = (SYMBOL_TABLE *)calloc(1, sizeof(SYMBOL_TABLE));
+    context->symbols->string_id = 1;
+    context->symbols->function_id = 1;
+    context->isel = (ISEL_STATE *)calloc(1, sizeof(ISEL_STATE));
+    context->assembly = (ASM_STATE *)calloc(1, sizeof(ASM_STATE));
+    context->vector = (VECTOR_STATE *)calloc(1, sizeof(VECTOR_STATE));
+    context->profile = (PROFILE_STATE *)calloc(1, sizeof(PROFILE_STATE));
+    context->peephole_hits = (int *)calloc(PEEPHOLE_RULE_COUNT, sizeof(int));
+    return context;
+}
+
+void compiler_destroy(COMPILER_CONTEXT *context)
+{
+    if (!context)
+        return;
+    arena_free(&context->isel->arena);
+    arena_free(&context->arena);
+    free(context->symbols);
+    free(context->cond_list);
+    free(context->code);
+    free(context->assembly->constants.bits);
+    free(context->assembly->formats.text);
+    free(context->assembly->formats.id);
+    free(context->assembly->out.text.data);
+    free(context->assembly->cold.first);
+    free(context->assembly->cold.last);
+    free(context->assembly->cold.label);
+    free(context->assembly->cold.join);
+    free(context->vector->loops);
+    free(context->profile->program.functions);
+    free(context->profile->program.counts);
+    free(context->profile->taken.functions);
+    free(context->profile->taken.counts);
+    free(context->isel);
+    free(context->assembly);
+    free(context->vector);
+    free(context->profile);
+    free(context->peephole_hits);
+    fragment_free(context->fragments);
+    free(context->output);
+    free(context);
+}
+
+// the whole file, or NULL when it cannot be read
+char *compiler_read(char *path, size_t *length)
+{
+    FILE *file = fopen(path, "rb");
+    char *source;
+    long size;
+
+    if (!file)
+        return NULL;
+    fseek(file, 0, SEEK_END);
+    size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    source = (char *)malloc(size + 1);
+    *length = fread(source, 1, size, file);
+    source[*length] = 0;
+    fclose(file);
+    return source;
+}
+
+// a source larger than a chunk is lexed on the -j threads, any other by the scanner
+LEXER_STREAM *compiler_lex(const char *source, size_t length)
+{
+    if (compiler->jobs > 1 && length > (size_t)compiler->lex_chunk)
+        return lexer_stream(source, length, compiler->lex_chunk, compiler->jobs);
+    return lexer_scan(source, length);
+}
+
+// the parser reads the tokens on the context alone, at the same time as other contexts
+void compiler_parse(const char *source, size_t length)
+{
+    compiler->tokens = compiler_lex(source, length);
+    yyparse();
+
+    lexer_stream_free(compiler->tokens);
+    compiler->tokens = NULL;
+}
+
+void compiler_check(AST *root)
+{
+    set_param_list_item_function(root);
+    set_expr_list_item_function(root);
+    check_and_set_declarations(root);
+    check_undeclared();
+    check_bodies(root);
+}
+
+void compiler_optimize(AST *root)
+{
+    fprintf(compiler->diagnostics, "Generating optimized code...\n");
+    if (!compiler->cond_list)
+        compiler->cond_list = (NODE_LIST **)calloc(COND_LIST_SIZE, sizeof(NODE_LIST *));
+    ast_collect_loop_elements(root);
+    ast_collect_loop_conditions(root);
+    ast_collect_loop_variables(root);
+    ast_collect_varies(root);
+    ast_set_dependencies(root);
+    ast_set_varies(root);
+    ast_set_order_dependencies(root);
+    ast_optimize(root);
+    if (compiler->optimized > 0)
+    {
+        ast_handle_marked_assignments(root);
+        ast_add_assignment_conds(root);
+        fprintf(compiler->diagnostics, "Optimization done!\n");
+    }
+    else
+    {
+        fprintf(compiler->diagnostics, "No optimization done!\n");
+    }
+}
+
+// reports an error the compiler cannot go on from and returns to the recovery point of
+// the context on this thread; a process without one exits
+void compiler_fail(const char *format, ...)
+{
+    va_list args;
+    if (format)
+    {
+        va_start(args, format);
+        vfprintf(compiler ? compiler->diagnostics : stderr, format, args);
+        va_end(args);
+    }
+    if (!compiler || !compiler->recover)
+        exit(5);
+    longjmp(*compiler->recover, 1);
+}
+
+// compiles source into context->output, or runs it with run_jit and run_interp; returns
+// 0, or 3 after syntax and 4 after semantic errors, as the command line exits, or 5 when
+// compiler_fail gave up
+int compiler_compile(COMPILER_CONTEXT *context, const char *source, size_t length)
+{
+    COMPILER_CONTEXT *outer = compiler;
+    jmp_buf recover;
+    AST *root;
+    int status = 0;
+
+    compiler = context;
+    context->recover = &recover;
+    if (setjmp(recover))
+    {
+        lexer_stream_free(context->tokens);
+        context->tokens = NULL;
+        context->recover = NULL;
+        compiler = outer;
+        return 5;
+    }
+    compiler_parse(source, length);
+    root = context->root;
+
+    if (root)
+    {
+        compiler_check(root);
+        if (context->syntax_errors == 0 && context->semantic_errors == 0)
+        {
+            TAC *code;
+            if (context->optimize)
+                compiler_optimize(root);
+            else
+                fprintf(compiler->diagnostics, "Generating unoptimized code...\n");
+
+            // functions the cache has are left out of the tac
+            if (context->cache && !context->run_interp)
+                fragment_prepare(root);
+            code = generate_code(root);
+            code = generate_code(root);
+            fragment_restore();
+            if (context->run_interp)
+                context->interp_status = interp_run(code);
+            else
+                generate_asm(code);
+        }
+    }
+
+    if (context->syntax_errors > 0)
+        status = 3;
+    else if (context->semantic_errors > 0)
+        status = 4;
+    context->recover = NULL;
+    compiler = outer;
+    return status;
+}
+
+// the options of a command line from argv[first] on
+void compiler_options(COMPILER_CONTEXT *context, int argc, char **argv, int first)
+{
+    int i;
+    for (i = first; i < argc; i++) {
+        if (strcmp(argv[i], "-j") == 0 && i + 1 < argc) {
+            context->jobs = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--lex-chunk") == 0 && i + 1 < argc) {
+            context->lex_chunk = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--tokens") == 0) {
+            context->print_tokens = 1;
+        } else if (strcmp(argv[i], "--cache") == 0 && i + 1 < argc) {
+            context->cache = argv[++i];
+        } else if (strcmp(argv[i], "--cache-size") == 0 && i + 1 < argc) {
+            context->cache_size = atol(argv[++i]);
+        } else if (strcmp(argv[i], "-o") == 0) {
+            context->optimize = 1;
+            fprintf(context->diagnostics, "Optimization = %d\n", context->optimize);
+        } else if (strcmp(argv[i], "-v") == 0) {
+            context->verbose = 1;
+        } else if (strcmp(argv[i], "-c") == 0) {
+            context->emit_object = 1;
+        } else if (strcmp(argv[i], "--run") == 0) {
+            context->run_jit = 1;
+        } else if (strcmp(argv[i], "--interp") == 0) {
+            context->run_interp = 1;
+        } else if (strcmp(argv[i], "--tiered") == 0) {
+            context->run_interp = 1;
+            context->run_tiered = 1;
+        } else if (strcmp(argv[i], "--tier-threshold") == 0 && i + 1 < argc) {
+            context->tier_threshold = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--avx2") == 0) {
+            context->vectorize_avx2 = 1;
+        } else if (strcmp(argv[i], "--no-vectorize") == 0) {
+            context->vectorize_loops = 0;
+        } else if (strcmp(argv[i], "--eager-logic") == 0) {
+            context->eager_logic = 1;
+        } else if (strcmp(argv[i], "--no-layout") == 0) {
+            context->block_layout = 0;
+        } else if (strcmp(argv[i], "--profile-generate") == 0 && i + 1 < argc) {
+            context->profile_generate = argv[++i];
+        } else if (strcmp(argv[i], "--profile-use") == 0 && i + 1 < argc) {
+            context->profile_use = argv[++i];
+        }
+    }
+}
+
+// compiles source as the command line does, writing out.decomp and generated/out.s or
+// out.o under directory and reporting to context->diagnostics; returns the exit status
+int compiler_write(COMPILER_CONTEXT *context, const char *source, size_t length, const char *directory)
+{
+    COMPILER_CONTEXT *outer = compiler;
+    char path[COMPILER_PATH_SIZE];
+    FILE *output_file;
+
+    snprintf(path, sizeof(path), "%s/out.decomp", directory);
+    if (!(output_file = fopen(path, "w")))
+    {
+        fprintf(context->diagnostics, "could not open output file\n");
+        return 2;
+    }
+
+    if (compiler_compile(context, source, length) == 5)
+    {
+        fclose(output_file);
+        return 5;
+    }
+
+    if (context->syntax_errors > 0)
+    {
+        fprintf(context->diagnostics, "\n\nCompilation failed with %d syntax errors. Program had %d lines.\n\n", context->syntax_errors, context->line_number);
+        fclose(output_file);
+        return 3;
+    }
+
+    if (context->semantic_errors == 0)
+    {
+        fprintf(context->diagnostics, "\n\nSuccessful compilation. Program had %d lines.\n\n", context->line_number);
+    }
+    else
+    {
+        fprintf(context->diagnostics, "\n\nCompilation failed with %d Semantic errors. Program had %d lines.\n\n", context->semantic_errors, context->line_number);
+        fclose(output_file);
+        return 4;
+    }
+
+    if (context->output)
+    {
+        FILE *asm_file;
+        snprintf(path, sizeof(path), "%s/generated/%s", directory, context->emit_object ? "out.o" : "out.s");
+        if (!(asm_file = fopen(path, "wb")))
+        {
+            fprintf(context->diagnostics, "could not open %s\n", path);
+            fclose(output_file);
+            return 2;
+        }
+        fwrite(context->output, 1, context->output_length, asm_file);
+        fclose(asm_file);
+    }
+
+    compiler = context;
+    fprintf(output_file, "%s", astToCode(context->root));
+    compiler = outer;
+    fclose(output_file);
+
+    return context->run_jit ? context->jit_status : context->run_interp ? context->interp_status : 0;
+}
+
+// lists the tokens the parser would read from source instead of compiling it
+int compiler_tokens(COMPILER_CONTEXT *context, const char *source, size_t length)
+{
+    COMPILER_CONTEXT *outer = compiler;
+    LEXER_STREAM *stream;
+
+    compiler = context;
+    stream = compiler_lex(source, length);
+    lexer_print(stream, context->diagnostics);
+    lexer_stream_free(stream);
+    compiler = outer;
+    return 0;
+}
+
+// compiles source as the command line does, through the cache when there is one;
+// programs that are run are always compiled
+int compiler_source(COMPILER_CONTEXT *context, const char *source, size_t length, const char *directory)
+{
+    if (context->print_tokens)
+        return compiler_tokens(context, source, length);
+    if (context->cache && !context->run_jit && !context->run_interp)
+        return cache_main(context, source, length, directory);
+    return compiler_write(context, source, length, directory);
+}
+
+// compiles the file input
+int compiler_main(COMPILER_CONTEXT *context, char *input, const char *directory)
+{
+    size_t source_length = 0;
+    char *source;
+    int status;
+
+    if (!(source = compiler_read(input, &source_length)))
+    {
+        fprintf(context->diagnostics, "could not open input file\n");
+        return 2;
+    }
+    status = compiler_source(context, source, source_length, directory);
+    free(source);
+    return status;
+}
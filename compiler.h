@@ -0,0 +1,97 @@
+#pragma once
+#include <setjmp.h>
+#include <stddef.h>
+#include <stdio.h>
+#include "arena.h"
+
+// longest path compiler_main writes to
+#define COMPILER_PATH_SIZE 4096
+
+// longest of the optimizer's per-loop name lists
+#define COMPILER_NAME_LIST_SIZE 1000
+
+// everything one compilation owns: its options, symbols, trees, stage state and output;
+// the stages reach the context being compiled on their thread through compiler
+typedef struct compiler_context
+{
+    // options
+    int optimize;
+    int verbose;
+    int emit_object;
+    int run_jit;
+    int run_interp;
+    int run_tiered;
+    int tier_threshold;
+    int vectorize_loops;
+    int vectorize_avx2;
+    int eager_logic;
+    int block_layout;
+    char *profile_generate;
+    char *profile_use;
+    int jobs;         // threads lexing, checking and selecting functions
+    int lex_chunk;    // bytes a lexing thread takes at a time; smaller sources are not split
+    int print_tokens; // lists the tokens of the source instead of compiling it
+    char *cache;     // directory of compiled files, or NULL
+    long cache_size; // bytes the cache directory is evicted down to
+
+    // scanner and parser
+    int line_number;
+    int errored_line;
+    int is_running;
+    int syntax_errors;
+    int semantic_errors;
+    struct lexer_stream *tokens; // read by the parser in place of the scanner
+    FILE *diagnostics; // messages: stderr, or a check job's or server client's buffer
+    jmp_buf *recover;  // where compiler_fail returns to: the compile, or a worker's job
+
+    // symbols, which worker contexts share, and the serials of the names the compiler
+    // makes up
+    struct symbol_table *symbols;
+    int temp_serial;
+    int missing_serial;
+    int label_serial;
+    int missing_id_serial;
+
+    // the tree and the loop optimizer's view of it
+    struct ast_node *root;
+    int optimized;
+    int ast_node_id;
+    int ast_loop_id;
+    struct node_list **cond_list; // COND_LIST_SIZE entries, made when optimizing
+    char *code;                   // scratch of astToCode, made on first use
+    char *appeared_right_side[COMPILER_NAME_LIST_SIZE];
+    int appeared_right_side_index;
+    char *appeared_left_side[COMPILER_NAME_LIST_SIZE];
+    int appeared_left_side_index;
+    char *loop_expr_vars[COMPILER_NAME_LIST_SIZE];
+    int loop_expr_vars_index;
+
+    // back end
+    struct isel_state *isel;
+    struct asm_state *assembly;
+    struct vector_state *vector;
+    struct profile_state *profile;
+    int *peephole_hits;
+    struct fragment_state *fragments; // functions fingerprinted for the cache
+
+    // results: assembly text, or an ELF object with emit_object
+    char *output;
+    size_t output_length;
+    int jit_status;
+    int interp_status;
+
+    // trees, tac and symbols, released with the context
+    ARENA arena;
+} COMPILER_CONTEXT;
+
+extern __thread COMPILER_CONTEXT *compiler;
+
+COMPILER_CONTEXT *compiler_create(void);
+void compiler_destroy(COMPILER_CONTEXT *context);
+char *compiler_read(char *path, size_t *length);
+int compiler_compile(COMPILER_CONTEXT *context, const char *source, size_t length);
+void compiler_fail(const char *format, ...) __attribute__((noreturn));
+void compiler_options(COMPILER_CONTEXT *context, int argc, char **argv, int first);
+int compiler_write(COMPILER_CONTEXT *context, const char *source, size_t length, const char *directory);
+int compiler_source(COMPILER_CONTEXT *context, const char *source, size_t length, const char *directory);
+int compiler_main(COMPILER_CONTEXT *context, char *input, const char *directory);
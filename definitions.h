@@ -3,41 +3,37 @@
 #pragma once
 #include <stdio.h>
 #include <stdlib.h>
-
-int is_running = 1;
-int line_number = 1;
-
-int errored_line = 0;
+#include "compiler.h"
 
 int getLineNumber()
 {
-    return line_number;
+    return compiler->line_number;
 }
 
 void increment_line_number()
 {
-    line_number++;
+    compiler->line_number++;
 }
 
 int yywrap(void)
 {
-    is_running = 0;
+    compiler->is_running = 0;
     return 1;
 }
 
 int isRunning(void)
 {
-    return is_running;
+    return compiler->is_running;
 }
 
 int yyerror(char *s)
 {
 
-    if (errored_line == 0) {
-        fprintf(stderr, "Error: %s at line %d\n", s, getLineNumber());
+    if (compiler->errored_line == 0) {
+        fprintf(compiler->diagnostics, "Error: %s at line %d\n", s, getLineNumber());
     }
 
-    errored_line = 0;
+    compiler->errored_line = 0;
     
     
     
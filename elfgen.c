@@ -0,0 +1,202 @@
+#include <elf.h>
+#include "elfgen.h"
+
+#define ELF_SEC_RELA_TEXT 5
+#define ELF_SEC_SYMTAB 6
+#define ELF_SEC_STRTAB 7
+#define ELF_SEC_SHSTRTAB 8
+#define ELF_SEC_NOTE 9
+#define ELF_SEC_COUNT 10
+
+char *elf_section_names[ELF_SEC_COUNT] = {
+    "", ".text", ".data", ".rodata", ".bss", ".rela.text", ".symtab", ".strtab", ".shstrtab", ".note.GNU-stack"};
+
+void elf_bytes(XBUFFER *buffer, void *data, int size)
+{
+    int i;
+    for (i = 0; i < size; i++)
+        xb_byte(buffer, ((unsigned char *)data)[i]);
+}
+
+int elf_string(XBUFFER *table, char *text)
+{
+    int offset = table->length;
+    elf_bytes(table, text, strlen(text) + 1);
+    return offset;
+}
+
+void elf_align(XBUFFER *file, int alignment)
+{
+    while (file->length % alignment)
+        xb_byte(file, 0);
+}
+
+// references that land in the section they come from never need the linker
+void elf_resolve_local(XOBJECT *obj)
+{
+    int i;
+    int kept = 0;
+    for (i = 0; i < obj->reloc_count; i++)
+    {
+        XRELOC *reloc = &obj->relocs[i];
+        if (reloc->symbol->section == reloc->section)
+        {
+            int value = reloc->symbol->offset + reloc->addend - reloc->offset;
+            memcpy(obj->section[reloc->section].data + reloc->offset, &value, sizeof(value));
+            continue;
+        }
+        obj->relocs[kept++] = *reloc;
+    }
+    obj->reloc_count = kept;
+}
+
+void elf_symbol(XBUFFER *symtab, XBUFFER *strtab, XSYMBOL *symbol)
+{
+    Elf64_Sym sym;
+    int type = symbol->type == XSYM_FUNC ? STT_FUNC : symbol->type == XSYM_OBJECT ? STT_OBJECT : STT_NOTYPE;
+    memset(&sym, 0, sizeof(sym));
+    sym.st_name = elf_string(strtab, symbol->name);
+    sym.st_info = ELF64_ST_INFO(symbol->global || symbol->section == XSEC_UNDEF ? STB_GLOBAL : STB_LOCAL, type);
+    sym.st_shndx = symbol->section;
+    sym.st_value = symbol->offset;
+    sym.st_size = symbol->size;
+    elf_bytes(symtab, &sym, sizeof(sym));
+}
+
+void elf_image(XBUFFER *file, XOBJECT *obj)
+{
+    XBUFFER symtab = {NULL, 0, 0};
+    XBUFFER strtab = {NULL, 0, 0};
+    XBUFFER shstrtab = {NULL, 0, 0};
+    XBUFFER rela = {NULL, 0, 0};
+    Elf64_Ehdr header;
+    Elf64_Shdr sections[ELF_SEC_COUNT];
+    int offsets[ELF_SEC_COUNT];
+    int sizes[ELF_SEC_COUNT];
+    int names[ELF_SEC_COUNT];
+    int first_global;
+    int symbol_count = 0;
+    XSYMBOL *symbol;
+    int i;
+
+    elf_resolve_local(obj);
+
+    // null symbol, one symbol per section, then locals before globals
+    elf_string(&strtab, "");
+    {
+        Elf64_Sym sym;
+        memset(&sym, 0, sizeof(sym));
+        elf_bytes(&symtab, &sym, sizeof(sym));
+        for (i = XSEC_TEXT; i < XSEC_COUNT; i++)
+        {
+            sym.st_info = ELF64_ST_INFO(STB_LOCAL, STT_SECTION);
+            sym.st_shndx = i;
+            elf_bytes(&symtab, &sym, sizeof(sym));
+        }
+        symbol_count = XSEC_COUNT;
+    }
+    for (symbol = obj->first_symbol; symbol; symbol = symbol->next_list)
+    {
+        if (!symbol->global && symbol->section != XSEC_UNDEF)
+        {
+            symbol->index = symbol_count++;
+            elf_symbol(&symtab, &strtab, symbol);
+        }
+    }
+    first_global = symbol_count;
+    for (symbol = obj->first_symbol; symbol; symbol = symbol->next_list)
+    {
+        if (symbol->global || symbol->section == XSEC_UNDEF)
+        {
+            symbol->index = symbol_count++;
+            elf_symbol(&symtab, &strtab, symbol);
+        }
+    }
+
+    for (i = 0; i < obj->reloc_count; i++)
+    {
+        Elf64_Rela entry;
+        XRELOC *reloc = &obj->relocs[i];
+        if (reloc->section != XSEC_TEXT)
+        {
+            compiler_fail("elf: relocation outside .text\n");
+        }
+        entry.r_offset = reloc->offset;
+        entry.r_info = ELF64_R_INFO(reloc->symbol->index, reloc->type == XRELOC_PLT32 ? R_X86_64_PLT32 : R_X86_64_PC32);
+        entry.r_addend = reloc->addend;
+        elf_bytes(&rela, &entry, sizeof(entry));
+    }
+
+    for (i = 0; i < ELF_SEC_COUNT; i++)
+        names[i] = elf_string(&shstrtab, elf_section_names[i]);
+
+    // file image: header, section contents, section header table
+    memset(&header, 0, sizeof(header));
+    elf_bytes(file, &header, sizeof(header));
+    memset(offsets, 0, sizeof(offsets));
+    memset(sizes, 0, sizeof(sizes));
+    for (i = XSEC_TEXT; i < ELF_SEC_COUNT; i++)
+    {
+        XBUFFER *content = i < XSEC_COUNT ? &obj->section[i] : i == ELF_SEC_RELA_TEXT ? &rela : i == ELF_SEC_SYMTAB ? &symtab : i == ELF_SEC_STRTAB ? &strtab : i == ELF_SEC_SHSTRTAB ? &shstrtab : NULL;
+        elf_align(file, i == XSEC_TEXT ? 16 : 8);
+        offsets[i] = file->length;
+        if (i == XSEC_BSS)
+        {
+            sizes[i] = obj->bss_size;
+            continue;
+        }
+        if (content && content->length)
+        {
+            elf_bytes(file, content->data, content->length);
+            sizes[i] = content->length;
+        }
+    }
+
+    elf_align(file, 8);
+    memset(sections, 0, sizeof(sections));
+    for (i = XSEC_TEXT; i < ELF_SEC_COUNT; i++)
+    {
+        sections[i].sh_name = names[i];
+        sections[i].sh_offset = offsets[i];
+        sections[i].sh_size = sizes[i];
+        sections[i].sh_addralign = i == XSEC_TEXT ? 16 : i < XSEC_COUNT || i == ELF_SEC_RELA_TEXT || i == ELF_SEC_SYMTAB ? 8 : 1;
+        sections[i].sh_type = SHT_PROGBITS;
+    }
+    sections[XSEC_TEXT].sh_flags = SHF_ALLOC | SHF_EXECINSTR;
+    sections[XSEC_DATA].sh_flags = SHF_ALLOC | SHF_WRITE;
+    sections[XSEC_RODATA].sh_flags = SHF_ALLOC;
+    sections[XSEC_BSS].sh_flags = SHF_ALLOC | SHF_WRITE;
+    sections[XSEC_BSS].sh_type = SHT_NOBITS;
+    sections[ELF_SEC_RELA_TEXT].sh_type = SHT_RELA;
+    sections[ELF_SEC_RELA_TEXT].sh_flags = SHF_INFO_LINK;
+    sections[ELF_SEC_RELA_TEXT].sh_link = ELF_SEC_SYMTAB;
+    sections[ELF_SEC_RELA_TEXT].sh_info = XSEC_TEXT;
+    sections[ELF_SEC_RELA_TEXT].sh_entsize = sizeof(Elf64_Rela);
+    sections[ELF_SEC_SYMTAB].sh_type = SHT_SYMTAB;
+    sections[ELF_SEC_SYMTAB].sh_link = ELF_SEC_STRTAB;
+    sections[ELF_SEC_SYMTAB].sh_info = first_global;
+    sections[ELF_SEC_SYMTAB].sh_entsize = sizeof(Elf64_Sym);
+    sections[ELF_SEC_STRTAB].sh_type = SHT_STRTAB;
+    sections[ELF_SEC_SHSTRTAB].sh_type = SHT_STRTAB;
+
+    memcpy(header.e_ident, ELFMAG, SELFMAG);
+    header.e_ident[EI_CLASS] = ELFCLASS64;
+    header.e_ident[EI_DATA] = ELFDATA2LSB;
+    header.e_ident[EI_VERSION] = EV_CURRENT;
+    header.e_ident[EI_OSABI] = ELFOSABI_SYSV;
+    header.e_type = ET_REL;
+    header.e_machine = EM_X86_64;
+    header.e_version = EV_CURRENT;
+    header.e_shoff = file->length;
+    header.e_ehsize = sizeof(Elf64_Ehdr);
+    header.e_shentsize = sizeof(Elf64_Shdr);
+    header.e_shnum = ELF_SEC_COUNT;
+    header.e_shstrndx = ELF_SEC_SHSTRTAB;
+    memcpy(file->data, &header, sizeof(header));
+    elf_bytes(file, sections, sizeof(sections));
+
+    free(symtab.data);
+    free(strtab.data);
+    free(shstrtab.data);
+    free(rela.data);
+}
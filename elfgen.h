@@ -0,0 +1,5 @@
+#pragma once
+#include "x86enc.h"
+
+// the relocatable object holding obj, in a buffer the caller frees
+void elf_image(XBUFFER *file, XOBJECT *obj);
@@ -0,0 +1,566 @@
+#include "fragment.h"
+
+int fragment_is_function(AST *node)
+{
+    return node && (node->type == AST_FUNC_DECL_INT || node->type == AST_FUNC_DECL_REAL ||
+                    node->type == AST_FUNC_DECL_CHAR || node->type == AST_FUNC_DECL_BOOL);
+}
+
+// what code referring to symbol is made from: its name, kind and type, and for a
+// function its parameters
+void fragment_hash_symbol(CACHE_HASH *hash, HASH *symbol)
+{
+    int fields[5] = {symbol->type, symbol->datatype, symbol->is_vector, symbol->is_function, symbol->param_count};
+    STRING_LIST *name;
+
+    cache_hash(hash, symbol->text, strlen(symbol->text));
+    cache_hash(hash, fields, sizeof(fields));
+    if (symbol->params)
+        cache_hash(hash, symbol->params, symbol->param_count * sizeof(int));
+    for (name = symbol->param_list; name; name = name->next)
+        cache_hash(hash, name->text, strlen(name->text));
+}
+
+// the tree as the tac is made from it, with the signature of every symbol on the way
+void fragment_hash_tree(CACHE_HASH *hash, AST *node)
+{
+    int fields[3];
+    int i;
+
+    if (!node)
+    {
+        cache_hash(hash, "", 0);
+        return;
+    }
+    fields[0] = node->type;
+    fields[1] = node->result_datatype;
+    fields[2] = node->symbol != NULL;
+    cache_hash(hash, fields, sizeof(fields));
+    if (node->symbol)
+        fragment_hash_symbol(hash, node->symbol);
+    cache_hash(hash, node->func_param ? node->func_param : "", node->func_param ? strlen(node->func_param) : 0);
+    for (i = 0; i < MAX_SONS; i++)
+        fragment_hash_tree(hash, node->son[i]);
+}
+
+// the function's tree, the signatures it refers to, the options that change selected
+// code and the compiler; a function changes with its callees' signatures and the types
+// of the globals it uses
+void fragment_key(FRAGMENT *fragment)
+{
+    CACHE_HASH hash;
+    char options[64];
+    int written = snprintf(options, sizeof(options), "function %d %d %d %d %d", compiler->optimize,
+                           compiler->vectorize_loops, compiler->vectorize_avx2, compiler->eager_logic,
+                           compiler->block_layout);
+
+    cache_hash_start(&hash);
+    cache_hash(&hash, cache_version(), strlen(cache_version()));
+    cache_hash(&hash, options, written);
+    fragment_hash_tree(&hash, fragment->declaration);
+    cache_hash_end(&hash, fragment->key);
+}
+
+int fragment_int(FRAGMENT_READER *reader)
+{
+    const unsigned char *bytes = (const unsigned char *)reader->data + reader->at;
+    if (reader->failed || reader->length - reader->at < 4)
+    {
+        reader->failed = 1;
+        return 0;
+    }
+    reader->at += 4;
+    return (int)((unsigned)bytes[0] | (unsigned)bytes[1] << 8 | (unsigned)bytes[2] << 16 | (unsigned)bytes[3] << 24);
+}
+
+// a copy of the next text, in arena, or malloc'd without one
+char *fragment_text(FRAGMENT_READER *reader, ARENA *arena)
+{
+    int length = fragment_int(reader);
+    char *text;
+    if (reader->failed || length < 0 || (size_t)length > reader->length - reader->at)
+    {
+        reader->failed = 1;
+        return NULL;
+    }
+    text = arena ? (char *)arena_alloc(arena, length + 1) : (char *)malloc(length + 1);
+    memcpy(text, reader->data + reader->at, length);
+    text[length] = 0;
+    reader->at += length;
+    return text;
+}
+
+void fragment_put_text(XBUFFER *out, const char *text)
+{
+    int length = (int)strlen(text);
+    int i;
+    xb_int32(out, length);
+    for (i = 0; i < length; i++)
+        xb_byte(out, text[i]);
+}
+
+// names the compiler makes end in their serial; the serials go on after those of the
+// fragments read, so the functions compiled now get other names
+void fragment_bump(HASH *symbol, int flags)
+{
+    char *serial = strrchr(symbol->text, '_');
+    int next = serial ? atoi(serial + 1) + 1 : 0;
+    if ((flags & FRAGMENT_TEMP) && next > compiler->temp_serial)
+        compiler->temp_serial = next;
+    if (!(flags & FRAGMENT_TEMP) && next > compiler->label_serial)
+        compiler->label_serial = next;
+}
+
+MOPERAND fragment_read_operand(FRAGMENT_READER *reader, MCODE *code, HASH **symbols, int count)
+{
+    MOPERAND operand = mop_none();
+    int index;
+
+    operand.kind = fragment_int(reader);
+    operand.reg = fragment_int(reader);
+    operand.index = fragment_int(reader);
+    operand.scale = fragment_int(reader);
+    operand.disp = fragment_int(reader);
+    operand.symbol.kind = fragment_int(reader);
+    switch (operand.symbol.kind)
+    {
+    case MSYM_HASH:
+    case MSYM_FUNCTION:
+    case MSYM_STRING:
+        index = fragment_int(reader);
+        if (index < 0 || index >= count)
+        {
+            reader->failed = 1;
+            break;
+        }
+        operand.symbol.hash = symbols[index];
+        if (operand.symbol.kind == MSYM_STRING)
+        {
+            operand.symbol.id = symbols[index]->string_id;
+            operand.symbol.hash = NULL;
+        }
+        break;
+    case MSYM_CONST:
+    case MSYM_FORMAT:
+        operand.symbol.id = fragment_int(reader);
+        break;
+    case MSYM_NAME:
+        operand.symbol.name = fragment_text(reader, &code->arena);
+        break;
+    }
+    return operand;
+}
+
+// the selected code of a function as fragment_write left it; symbols the compiler named
+// are entered into the table, unless another fragment or the program has them already
+int fragment_read(ASM_JOB *job, const char *data, size_t length)
+{
+    FRAGMENT_READER reader = {data, length, 0, 0};
+    int count = fragment_int(&reader);
+    HASH **symbols;
+    char **texts;
+    int *flags;
+    int *types;
+    int *datatypes;
+    int i;
+
+    if (reader.failed || count < 0 || (size_t)count > length)
+        return 0;
+    symbols = (HASH **)calloc(count + 1, sizeof(HASH *));
+    texts = (char **)calloc(count + 1, sizeof(char *));
+    flags = (int *)calloc(count + 1, sizeof(int));
+    types = (int *)calloc(count + 1, sizeof(int));
+    datatypes = (int *)calloc(count + 1, sizeof(int));
+
+    for (i = 0; i < count && !reader.failed; i++)
+    {
+        flags[i] = fragment_int(&reader);
+        types[i] = fragment_int(&reader);
+        datatypes[i] = fragment_int(&reader);
+        if (!(texts[i] = fragment_text(&reader, NULL)))
+            break;
+        symbols[i] = hash_find(texts[i]);
+        if ((flags[i] & FRAGMENT_MADE) ? symbols[i] != NULL : symbols[i] == NULL)
+            reader.failed = 1;
+    }
+    for (i = 0; i < count && !reader.failed; i++)
+    {
+        if (!(flags[i] & FRAGMENT_MADE))
+            continue;
+        symbols[i] = hash_insert(texts[i], types[i], datatypes[i]);
+        symbols[i]->is_temp = (flags[i] & FRAGMENT_TEMP) != 0;
+        fragment_bump(symbols[i], flags[i]);
+    }
+
+    if (!reader.failed)
+    {
+        ASM_POOL *constants = &job->assembly.constants;
+        ASM_FORMATS *formats = &job->assembly.formats;
+        int instructions;
+
+        constants->count = constants->size = fragment_int(&reader);
+        if (constants->count < 0 || (size_t)constants->count > length)
+            reader.failed = 1;
+        else
+            constants->bits = (int *)calloc(constants->count + 1, sizeof(int));
+        for (i = 0; i < constants->count && !reader.failed; i++)
+            constants->bits[i] = fragment_int(&reader);
+
+        formats->count = formats->size = reader.failed ? 0 : fragment_int(&reader);
+        if (formats->count < 0 || (size_t)formats->count > length)
+            reader.failed = 1;
+        else
+        {
+            formats->text = (char **)calloc(formats->count + 1, sizeof(char *));
+            formats->id = (int *)calloc(formats->count + 1, sizeof(int));
+        }
+        for (i = 0; i < formats->count && !reader.failed; i++)
+        {
+            formats->id[i] = fragment_int(&reader);
+            if (formats->id[i] < 0 || formats->id[i] >= formats->count)
+                reader.failed = 1;
+            else if (formats->id[i] >= formats->next_id)
+                formats->next_id = formats->id[i] + 1;
+            formats->text[i] = fragment_text(&reader, NULL);
+        }
+
+        job->peephole_hits = (int *)calloc(PEEPHOLE_RULE_COUNT, sizeof(int));
+        for (i = 0; i < PEEPHOLE_RULE_COUNT; i++)
+            job->peephole_hits[i] = fragment_int(&reader);
+
+        instructions = fragment_int(&reader);
+        for (i = 0; i < instructions && !reader.failed; i++)
+        {
+            int op = fragment_int(&reader);
+            int size = fragment_int(&reader);
+            int cc = fragment_int(&reader);
+            MOPERAND src = fragment_read_operand(&reader, &job->code, symbols, count);
+            MOPERAND dst = fragment_read_operand(&reader, &job->code, symbols, count);
+            if (!reader.failed)
+                minstr_emit(&job->code, op, size, src, dst)->cc = cc;
+        }
+        if (reader.at != length)
+            reader.failed = 1;
+    }
+
+    for (i = 0; i < count; i++)
+        free(texts[i]);
+    free(symbols);
+    free(texts);
+    free(flags);
+    free(types);
+    free(datatypes);
+    return !reader.failed;
+}
+
+// gives every symbol the code refers to an index, in order of first use
+int fragment_index(HASH *symbol, HASH **symbols, int *count, int *table, int table_size)
+{
+    unsigned long slot = ((unsigned long)symbol >> 4) & (table_size - 1);
+    while (table[slot] >= 0)
+    {
+        if (symbols[table[slot]] == symbol)
+            return table[slot];
+        slot = (slot + 1) & (table_size - 1);
+    }
+    symbols[*count] = symbol;
+    table[slot] = *count;
+    return (*count)++;
+}
+
+HASH *fragment_operand_symbol(FRAGMENT_STATE *state, MOPERAND *operand)
+{
+    switch (operand->symbol.kind)
+    {
+    case MSYM_HASH:
+    case MSYM_FUNCTION:
+        return operand->symbol.hash;
+    case MSYM_STRING:
+        return operand->symbol.id >= 0 && operand->symbol.id < state->string_count ? state->strings[operand->symbol.id] : NULL;
+    }
+    return NULL;
+}
+
+void fragment_write_operand(XBUFFER *out, FRAGMENT_STATE *state, MOPERAND *operand, HASH **symbols, int *count,
+                            int *table, int table_size)
+{
+    xb_int32(out, operand->kind);
+    xb_int32(out, operand->reg);
+    xb_int32(out, operand->index);
+    xb_int32(out, operand->scale);
+    xb_int32(out, operand->disp);
+    xb_int32(out, operand->symbol.kind);
+    switch (operand->symbol.kind)
+    {
+    case MSYM_HASH:
+    case MSYM_FUNCTION:
+    case MSYM_STRING:
+        xb_int32(out, fragment_index(fragment_operand_symbol(state, operand), symbols, count, table, table_size));
+        break;
+    case MSYM_CONST:
+    case MSYM_FORMAT:
+        xb_int32(out, operand->symbol.id);
+        break;
+    case MSYM_NAME:
+        fragment_put_text(out, operand->symbol.name);
+        break;
+    }
+}
+
+// the selected code of a job, before it is merged: the symbols it refers to by name,
+// its constants and descriptors, its peephole counts and its instructions; 0 when it
+// refers to a string the table does not have
+int fragment_write(XBUFFER *out, FRAGMENT_STATE *state, ASM_JOB *job)
+{
+    XBUFFER code = {NULL, 0, 0};
+    HASH **symbols;
+    int *table;
+    int table_size = 16;
+    int operands = 0;
+    int instructions = 0;
+    int count = 0;
+    MINSTR *instr;
+    int i;
+
+    for (instr = job->code.first; instr; instr = instr->next)
+    {
+        operands += 2;
+        if ((instr->src.symbol.kind == MSYM_STRING && !fragment_operand_symbol(state, &instr->src)) ||
+            (instr->dst.symbol.kind == MSYM_STRING && !fragment_operand_symbol(state, &instr->dst)))
+            return 0;
+    }
+    while (table_size < 2 * operands)
+        table_size *= 2;
+    symbols = (HASH **)malloc((operands + 1) * sizeof(HASH *));
+    table = (int *)malloc(table_size * sizeof(int));
+    memset(table, -1, table_size * sizeof(int));
+
+    for (instr = job->code.first; instr; instr = instr->next, instructions++)
+    {
+        xb_int32(&code, instr->op);
+        xb_int32(&code, instr->size);
+        xb_int32(&code, instr->cc);
+        fragment_write_operand(&code, state, &instr->src, symbols, &count, table, table_size);
+        fragment_write_operand(&code, state, &instr->dst, symbols, &count, table, table_size);
+    }
+
+    xb_int32(out, count);
+    for (i = 0; i < count; i++)
+    {
+        int flags = 0;
+        if (symbols[i]->is_temp)
+            flags = FRAGMENT_MADE | FRAGMENT_TEMP;
+        else if (symbols[i]->type == SYMBOL_LABEL)
+            flags = FRAGMENT_MADE;
+        xb_int32(out, flags);
+        xb_int32(out, symbols[i]->type);
+        xb_int32(out, symbols[i]->datatype);
+        fragment_put_text(out, symbols[i]->text);
+    }
+    xb_int32(out, job->assembly.constants.count);
+    for (i = 0; i < job->assembly.constants.count; i++)
+        xb_int32(out, job->assembly.constants.bits[i]);
+    xb_int32(out, job->assembly.formats.count);
+    for (i = 0; i < job->assembly.formats.count; i++)
+    {
+        xb_int32(out, job->assembly.formats.id[i]);
+        fragment_put_text(out, job->assembly.formats.text[i]);
+    }
+    for (i = 0; i < PEEPHOLE_RULE_COUNT; i++)
+        xb_int32(out, job->peephole_hits[i]);
+    xb_int32(out, instructions);
+    for (i = 0; i < (int)code.length; i++)
+        xb_byte(out, code.data[i]);
+
+    free(code.data);
+    free(symbols);
+    free(table);
+    return 1;
+}
+
+// the pools and counts of a job whose code was not merged
+void fragment_release_job(ASM_JOB *job)
+{
+    int i;
+    for (i = 0; i < job->assembly.formats.count; i++)
+        free(job->assembly.formats.text[i]);
+    free(job->assembly.formats.text);
+    free(job->assembly.formats.id);
+    free(job->assembly.constants.bits);
+    free(job->peephole_hits);
+    memset(job, 0, sizeof(ASM_JOB));
+}
+
+int fragment_fetch(FRAGMENT *fragment)
+{
+    CACHE_ENTRY entry;
+    int read;
+
+    if (!cache_fetch(compiler->cache, fragment->key, &entry))
+        return 0;
+    if (!(read = fragment_read(&fragment->job, entry.output, entry.output_length)))
+    {
+        minstr_release(&fragment->job.code);
+        fragment_release_job(&fragment->job);
+    }
+    free(entry.data);
+    return read;
+}
+
+// fingerprints every function of the program and takes those the cache has out of the
+// tac, until fragment_restore
+void fragment_prepare(AST *root)
+{
+    FRAGMENT_STATE *state;
+    AST *list;
+    int i;
+
+    if (compiler->profile_generate || compiler->profile_use)
+        return;
+    fragment_free(compiler->fragments);
+    state = (FRAGMENT_STATE *)calloc(1, sizeof(FRAGMENT_STATE));
+    compiler->fragments = state;
+
+    for (list = root->son[0]; list && list->type == AST_DECL_LIST; list = list->son[1])
+    {
+        FRAGMENT *fragment;
+        if (!fragment_is_function(list->son[0]))
+            continue;
+        if (state->count == state->size)
+        {
+            state->size = state->size ? 2 * state->size : 16;
+            state->fragments = (FRAGMENT *)realloc(state->fragments, state->size * sizeof(FRAGMENT));
+        }
+        fragment = &state->fragments[state->count++];
+        memset(fragment, 0, sizeof(FRAGMENT));
+        fragment->declaration = list->son[0];
+        fragment->function = list->son[0]->symbol;
+        fragment_key(fragment);
+
+        if (!fragment_fetch(fragment))
+            continue;
+        fragment->cached = 1;
+        state->cached++;
+        for (i = 0; i < MAX_SONS; i++)
+        {
+            fragment->sons[i] = fragment->declaration->son[i];
+            fragment->declaration->son[i] = NULL;
+        }
+    }
+}
+
+void fragment_restore(void)
+{
+    FRAGMENT_STATE *state = compiler->fragments;
+    int i;
+    int j;
+
+    for (i = 0; state && i < state->count; i++)
+    {
+        if (!state->fragments[i].cached)
+            continue;
+        for (j = 0; j < MAX_SONS; j++)
+            state->fragments[i].declaration->son[j] = state->fragments[i].sons[j];
+    }
+}
+
+// the fragment of function, looked for from where the last one was found since both
+// come in source order
+FRAGMENT *fragment_find(FRAGMENT_STATE *state, HASH *function, int *cursor)
+{
+    int i;
+    for (i = 0; i < state->count; i++)
+    {
+        int at = (*cursor + i) % state->count;
+        if (state->fragments[at].function == function)
+        {
+            *cursor = (at + 1) % state->count;
+            return &state->fragments[at];
+        }
+    }
+    return NULL;
+}
+
+// gives the jobs of cached functions their code, which is not selected again
+void fragment_attach(ASM_JOB *jobs, int count)
+{
+    FRAGMENT_STATE *state = compiler->fragments;
+    int cursor = 0;
+    int i;
+
+    for (i = 0; state && state->cached && i < count; i++)
+    {
+        FRAGMENT *fragment;
+        if (jobs[i].first->type != TAC_BEGINFUN)
+            continue;
+        if (!(fragment = fragment_find(state, jobs[i].first->res, &cursor)) || !fragment->cached)
+            continue;
+        jobs[i].code = fragment->job.code;
+        jobs[i].assembly = fragment->job.assembly;
+        jobs[i].peephole_hits = fragment->job.peephole_hits;
+        jobs[i].cached = 1;
+        memset(&fragment->job, 0, sizeof(ASM_JOB));
+    }
+}
+
+// keeps the code of every function selected now under its fingerprint
+void fragment_store(ASM_JOB *jobs, int count)
+{
+    FRAGMENT_STATE *state = compiler->fragments;
+    XBUFFER out = {NULL, 0, 0};
+    HASH *item;
+    int cursor = 0;
+    int stored = 0;
+    int i;
+    int j;
+
+    if (!state)
+        return;
+    for (i = 0; i < count; i++)
+    {
+        FRAGMENT *fragment;
+        CACHE_ENTRY entry;
+        if (jobs[i].cached || jobs[i].first->type != TAC_BEGINFUN)
+            continue;
+        if (!(fragment = fragment_find(state, jobs[i].first->res, &cursor)))
+            continue;
+
+        if (!state->strings)
+        {
+            state->string_count = compiler->symbols->string_id;
+            state->strings = (HASH **)calloc(state->string_count + 1, sizeof(HASH *));
+            for (j = 0; j < HASH_SIZE; j++)
+                for (item = compiler->symbols->buckets[j]; item; item = item->next)
+                    if (item->type == SYMBOL_LIT_STRING && item->string_id < state->string_count)
+                        state->strings[item->string_id] = item;
+        }
+
+        out.length = 0;
+        if (!fragment_write(&out, state, &jobs[i]))
+            continue;
+        memset(&entry, 0, sizeof(entry));
+        entry.messages = "";
+        entry.output = (char *)out.data;
+        entry.output_length = out.length;
+        entry.decomp = "";
+        stored += cache_store(compiler->cache, fragment->key, &entry);
+    }
+    if (stored)
+        cache_evict(compiler->cache, compiler->cache_size);
+    free(out.data);
+}
+
+void fragment_free(FRAGMENT_STATE *state)
+{
+    int i;
+    if (!state)
+        return;
+    for (i = 0; i < state->count; i++)
+    {
+        minstr_release(&state->fragments[i].job.code);
+        fragment_release_job(&state->fragments[i].job);
+    }
+    free(state->fragments);
+    free(state->strings);
+    free(state);
+}
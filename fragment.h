@@ -0,0 +1,48 @@
+#pragma once
+#include "ast.h"
+#include "asmgen.h"
+#include "cache.h"
+
+// what the compiler named itself in a fragment: such symbols must not exist yet when
+// the fragment is read back
+#define FRAGMENT_MADE 1
+#define FRAGMENT_TEMP 2
+
+// a function of the program under the fingerprint of its tree and of the signatures of
+// the symbols it refers to; a cached one is left out of the tac and its selected code
+// read back into job instead
+typedef struct fragment
+{
+    AST *declaration;
+    HASH *function;
+    char key[CACHE_KEY_SIZE];
+    int cached;
+    AST *sons[MAX_SONS]; // of a cached declaration, while the tac is made
+    ASM_JOB job;
+} FRAGMENT;
+
+// the functions of one compilation, in source order
+typedef struct fragment_state
+{
+    FRAGMENT *fragments;
+    int count;
+    int size;
+    int cached;
+    HASH **strings; // string literals by id, made when the first fragment is stored
+    int string_count;
+} FRAGMENT_STATE;
+
+// a fragment being read back
+typedef struct fragment_reader
+{
+    const char *data;
+    size_t length;
+    size_t at;
+    int failed;
+} FRAGMENT_READER;
+
+void fragment_prepare(AST *root);
+void fragment_restore(void);
+void fragment_attach(ASM_JOB *jobs, int count);
+void fragment_store(ASM_JOB *jobs, int count);
+void fragment_free(FRAGMENT_STATE *state);
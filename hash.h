@@ -18,9 +18,6 @@
 
 char* datatype_str[] = { "invalid", "int",  "real", "bool", "char" };
 
-int string_id = 1;
-int function_id = 1;
-
 typedef struct STRING_LIST
 {
     char *text;
@@ -42,15 +39,29 @@ typedef struct HASH
     int function_id;
     int is_label;
     int is_temp;
+    int use_count;
+    int slot;       // interpreter cell, or code index for labels and functions
     STRING_LIST *param_list;
     struct HASH *beginfun_label;    
 } HASH;
 
+// HASH_SIZE chains that only grow at their end by compare-and-swap, so the contexts of
+// several threads can share one table: lookups take no lock, an item never moves once
+// linked, and the ids are taken atomically
+typedef struct symbol_table
+{
+    HASH *buckets[HASH_SIZE];
+    int string_id;
+    int function_id;
+} SYMBOL_TABLE;
+
+#include "compiler.h"
 
 
 int hash(char *key);
 HASH *hash_find(char *key);
-HASH *hash_insert(char *text, int type, int line_number);
+HASH *hash_item(char *text, int type, int datatype);
+HASH *hash_insert(char *text, int type, int datatype);
 char *get_key(HASH *hash);
 void hash_print();
 int hash_check_undeclared(void);
@@ -60,14 +71,12 @@ HASH *make_label(int type);
 HASH *make_missing(int datatype);
 HASH *make_value(int ty);
 
-HASH *hash_table[HASH_SIZE];
-
 void initMe(void)
 {
     int i;
     for (i = 0; i < HASH_SIZE; i++)
     {
-        hash_table[i] = 0;
+        compiler->symbols->buckets[i] = 0;
     }
 }
 
@@ -88,40 +97,21 @@ char *get_key(HASH *hash)
     return hash->text;
 }
 
+// the item of key, or NULL; sees every item whose insert has returned on any thread
 HASH *hash_find(char *key)
 {
-    int pos = hash(key);
-
-    HASH *item = hash_table[pos];
-    if (item == NULL)
+    HASH *item = __atomic_load_n(&compiler->symbols->buckets[hash(key)], __ATOMIC_ACQUIRE);
+    while (item && strcmp(get_key(item), key) != 0)
     {
-        return NULL;
-    }
-
-    if (item->next == NULL)
-    {
-        return item;
-    }
-
-    item = item->next;
-    while (item != NULL)
-    {
-        char *item_key = get_key(item);
-        if (strcmp(key, item_key))
-        {
-            return item;
-        }
-
-        item = item->next;
+        item = __atomic_load_n(&item->next, __ATOMIC_ACQUIRE);
     }
 
-    return NULL;
+    return item;
 }
 
 HASH *set_function_id(HASH *hash);
 HASH *set_function_id(HASH *hash) {
-    hash->function_id = function_id;
-    function_id++;
+    hash->function_id = __atomic_fetch_add(&compiler->symbols->function_id, 1, __ATOMIC_RELAXED);
     return hash;
 }
 
@@ -151,22 +141,23 @@ void hash_append_param_list(HASH *hash, HASH *param) {
    
 }
 
-HASH *hash_insert(char *text, int type, int datatype)
+// a new item from this thread's arena, not yet in the table
+HASH *hash_item(char *text, int type, int datatype)
 {
-    HASH *item = (HASH *)calloc(1, sizeof(HASH));
+    HASH *item = (HASH *)arena_alloc(&compiler->arena, sizeof(HASH));
     item->type = type;
-    item->text = (char *)calloc(strlen(text) + 1, sizeof(char));
-    item->line_number = line_number;
+    item->text = (char *)arena_alloc(&compiler->arena, strlen(text) + 1);
+    item->line_number = compiler->line_number;
     item->datatype = datatype;
-    item->params = (int *)calloc(100, sizeof(int));
+    item->params = (int *)arena_alloc(&compiler->arena, 100 * sizeof(int));
     item->param_count = 0;
     item->is_vector = 0;
     item->is_function = 0;
-    item->beginfun_label = (HASH *)calloc(1, sizeof(HASH));
     item->beginfun_label = NULL;
     item->string_id = 0;
     item->param_list = NULL;
     item->is_temp = 0;
+    item->next = NULL;
 
     if (strstr(text, "label") != NULL) {
         item->is_label = 1;
@@ -174,50 +165,51 @@ HASH *hash_insert(char *text, int type, int datatype)
         item->is_label = 0;
     }
 
-    if (type == SYMBOL_LIT_STRING) {
-        item->string_id = string_id++;
-    }
-
-    
     strcpy(item->text, text);
+    return item;
+}
 
-    char *key = get_key(item);
-    int pos = hash(key);
-
-    debug_printf("hash.h: INSERTING WITH KEY %s ON POS %d", key, pos);
+// the item of text, linked at the end of its chain when it is new; when two threads
+// insert the same text both get the item that was linked first. A string takes its id
+// once linked, so an item a thread drops leaves no gap in the ids
+HASH *hash_insert(char *text, int type, int datatype)
+{
+    HASH **link = &compiler->symbols->buckets[hash(text)];
+    HASH *item = NULL;
+    HASH *current;
 
-    if (hash_table[pos])
+    for (;;)
     {
-        debug_printf("hash.h: COLLISION ON POS %d", pos);
-        HASH *current_item = hash_table[pos];
-        HASH *prev_item = NULL;
-        while (current_item != NULL)
+        while ((current = __atomic_load_n(link, __ATOMIC_ACQUIRE)) != NULL)
         {
-            if (strcmp(get_key(current_item), key) == 0 /* current_item_key != key */)
+            if (strcmp(get_key(current), text) == 0)
             {
-                return current_item;
+                return current;
             }
 
-            prev_item = current_item;
-            current_item = current_item->next;
+            link = &current->next;
         }
 
-        debug_printf("hash.h: DIFFERENT KEY ON POS %d", pos);
-        prev_item->next = (HASH *)calloc(1, sizeof(HASH));
-        debug_printf("hash.h: LINKED LIST %d", pos);
-        prev_item->next = item;
-        return prev_item->next;
-    }
-
-    hash_table[pos] = (HASH *)calloc(1, sizeof(HASH));
-    hash_table[pos] = item;
+        if (!item)
+        {
+            item = hash_item(text, type, datatype);
+            debug_printf("hash.h: INSERTING WITH KEY %s ON POS %d", text, hash(text));
+        }
 
-    return hash_table[pos];
+        // another thread may have linked an item here since the walk, which is then
+        // compared like the rest
+        if (__atomic_compare_exchange_n(link, &current, item, 0, __ATOMIC_RELEASE, __ATOMIC_ACQUIRE))
+        {
+            if (type == SYMBOL_LIT_STRING)
+                item->string_id = __atomic_fetch_add(&compiler->symbols->string_id, 1, __ATOMIC_RELAXED);
+            return item;
+        }
+    }
 }
 
 void hash_print()
 {
-    if (hash_table == NULL)
+    if (compiler->symbols == NULL)
     {
         return;
     }
@@ -226,9 +218,9 @@ void hash_print()
 
     int i;
     for (i = 0; i < HASH_SIZE; i++) {
-        for (node = hash_table[i]; node; node = node->next) {
+        for (node = compiler->symbols->buckets[i]; node; node = node->next) {
             printf("Table[%d] has %s with type %s of %s datatype", i, node->text, symbol_type_str(node->type), datatype_str[node->datatype]);
-            if (hash_table[i]->type == SYMBOL_FUNCTION) {
+            if (compiler->symbols->buckets[i]->type == SYMBOL_FUNCTION) {
                 printf(" and params: ");
                 int j;
                 for (j = 0; j < 100; j++) {
@@ -258,9 +250,9 @@ int hash_check_undeclared(void)
 
     int i;
     for (i = 0; i < HASH_SIZE; i++) {
-        for (node = hash_table[i]; node; node = node->next) {
+        for (node = compiler->symbols->buckets[i]; node; node = node->next) {
             if (node->type == SYMBOL_IDENTIFIER) {
-                fprintf(stderr, "Semantic error: Undeclared identifier %s\n", node->text);
+                fprintf(compiler->diagnostics, "Semantic error: Undeclared identifier %s\n", node->text);
                 undeclared++;
             }
 
@@ -302,9 +294,8 @@ int ast_type_to_datatype(int ast_type) {
 }
 
 HASH *make_temp(int datatype) {
-    static int serial = 0;
     char buffer[100];
-    sprintf(buffer, "temp_%d", serial++);
+    sprintf(buffer, "temp_%d", compiler->temp_serial++);
     
     HASH * temp = hash_insert(buffer, SYMBOL_IDENTIFIER, datatype);
     temp->is_temp = 1;
@@ -312,9 +303,8 @@ HASH *make_temp(int datatype) {
 }
 
 HASH *make_missing(int datatype) {
-    static int missing_serial = 0;
     char buffer[100];
-    sprintf(buffer, "missing_%d", missing_serial++);
+    sprintf(buffer, "missing_%d", compiler->missing_serial++);
 
     HASH * missing = hash_insert(buffer, SYMBOL_IDENTIFIER, datatype);
     return missing;
@@ -368,34 +358,42 @@ HASH *make_value(int ty) {
 #define CONDITIONAL_ENDIF 4
 #define BEGINFUN 5
 #define ENDFUN 6
+#define CONDITION_TRUE 7
+#define CONDITION_FALSE 8
+#define LOOP_BODY 9
 
 HASH *make_label(int type) {
-    static int serial = 0;
+    int serial = compiler->label_serial++;
     char buffer[100];
    
     if (type == CONDITIONAL_IF) {
-         sprintf(buffer, "if_label_%d", serial++);
+         sprintf(buffer, "if_label_%d", serial);
     } else if (type == CONDITIONAL_ELSE) {
-            sprintf(buffer, "else_label_%d", serial++);
+            sprintf(buffer, "else_label_%d", serial);
     } else if (type == LOOP_START) {
-            sprintf(buffer, "loop_start_label_%d", serial++);
+            sprintf(buffer, "loop_start_label_%d", serial);
     } else if (type == CONDITIONAL_ENDIF) {
-            sprintf(buffer, "endif_label_%d", serial++);
+            sprintf(buffer, "endif_label_%d", serial);
     } else if (type == BEGINFUN) {
-            sprintf(buffer, "beginfun_label_%d", serial++);
+            sprintf(buffer, "beginfun_label_%d", serial);
     } else if (type == ENDFUN) {
-            sprintf(buffer, "endfun_label_%d", serial++);
+            sprintf(buffer, "endfun_label_%d", serial);
     } else if (type == LOOP_END) {
-            sprintf(buffer, "loop_end_label_%d", serial++);
+            sprintf(buffer, "loop_end_label_%d", serial);
+    } else if (type == CONDITION_TRUE) {
+            sprintf(buffer, "true_label_%d", serial);
+    } else if (type == CONDITION_FALSE) {
+            sprintf(buffer, "false_label_%d", serial);
+    } else if (type == LOOP_BODY) {
+            sprintf(buffer, "loop_body_label_%d", serial);
     }
 
     return hash_insert(buffer, SYMBOL_LABEL, DATATYPE_INT);
 }
 
 HASH *make_missing_id() {
-    static int serial = 0;
     char buffer[100];
-    sprintf(buffer, "missing_id_%d", serial++);
+    sprintf(buffer, "missing_id_%d", compiler->missing_id_serial++);
 
     return hash_insert(buffer, SYMBOL_IDENTIFIER, 0);
 }
\ No newline at end of file
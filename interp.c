@@ -0,0 +1,724 @@
+#include <time.h>
+#include "interp.h"
+#include "tier.h"
+
+void interp_grow_cells(IPROGRAM *program, int count)
+{
+    while (program->cell_count + count > program->cell_capacity)
+    {
+        int old = program->cell_capacity;
+        program->cell_capacity = old ? old * 2 : 1024;
+        program->cells = (ICELL *)realloc(program->cells, program->cell_capacity * sizeof(ICELL));
+        memset(program->cells + old, 0, (program->cell_capacity - old) * sizeof(ICELL));
+    }
+}
+
+int interp_cells(IPROGRAM *program, int count)
+{
+    int first;
+    interp_grow_cells(program, count);
+    first = program->cell_count;
+    program->cell_count += count;
+    return first;
+}
+
+// parameters reached through TAC_ARG carry a detached HASH with only the name
+HASH *interp_lookup(HASH *symbol)
+{
+    HASH *node;
+    for (node = compiler->symbols->buckets[hash(symbol->text)]; node; node = node->next)
+    {
+        if (strcmp(node->text, symbol->text) == 0)
+            return node;
+    }
+    return symbol;
+}
+
+// the cell a symbol lives in; literals start out holding their value
+int interp_slot(IPROGRAM *program, HASH *symbol)
+{
+    if (!symbol)
+        return 0;
+    if (symbol->slot)
+        return symbol->slot;
+
+    symbol->slot = interp_cells(program, 1);
+    if (isel_is_literal(symbol))
+        program->cells[symbol->slot].i = isel_literal_value(symbol);
+    else if (symbol->type == SYMBOL_LIT_REAL)
+        program->cells[symbol->slot].f = atof(symbol->text);
+    return symbol->slot;
+}
+
+// vectors keep their length in the cell before the first element
+int interp_vector(IPROGRAM *program, HASH *vector, int length)
+{
+    if (!vector->slot)
+    {
+        vector->slot = interp_cells(program, length + 1) + 1;
+        program->cells[vector->slot - 1].i = length;
+    }
+    return vector->slot;
+}
+
+IINSTR *interp_emit(IPROGRAM *program, int op, int a, int b, int c)
+{
+    IINSTR *instr;
+    if (program->count == program->capacity)
+    {
+        program->capacity = program->capacity ? program->capacity * 2 : 1024;
+        program->code = (IINSTR *)realloc(program->code, program->capacity * sizeof(IINSTR));
+    }
+    instr = &program->code[program->count++];
+    memset(instr, 0, sizeof(IINSTR));
+    instr->op = op;
+    instr->a = a;
+    instr->b = b;
+    instr->c = c;
+    return instr;
+}
+
+int interp_string(IPROGRAM *program, HASH *symbol)
+{
+    XBUFFER text = {NULL, 0, 0};
+    x86_string(&text, symbol->text);
+    program->strings = (char **)realloc(program->strings, (program->string_count + 1) * sizeof(char *));
+    program->strings[program->string_count] = (char *)text.data;
+    return program->string_count++;
+}
+
+int interp_compare(int type)
+{
+    switch (type)
+    {
+    case TAC_LT:
+        return 0;
+    case TAC_LE:
+        return 1;
+    case TAC_GT:
+        return 2;
+    case TAC_GE:
+        return 3;
+    case TAC_EQ:
+        return 4;
+    }
+    return 5;
+}
+
+int interp_writes_a(int op)
+{
+    return (op >= IOP_MOVE && op < IOP_STOREV) || op == IOP_CALL;
+}
+
+// the last instruction, when nothing can branch in between it and the next one
+IINSTR *interp_fusable(IPROGRAM *program, int barrier)
+{
+    return program->count - 1 >= barrier ? &program->code[program->count - 1] : NULL;
+}
+
+int interp_function(IPROGRAM *program, HASH *symbol)
+{
+    int i;
+    for (i = 0; i < program->function_count; i++)
+    {
+        if (program->functions[i].symbol == symbol)
+            return i;
+    }
+    compiler_fail("interp: undefined function %s\n", symbol->text);
+}
+
+// jumps back to a loop_start_label close a loop made by make_loop
+int interp_is_backedge(TAC *tac)
+{
+    return strncmp(tac->res->text, "loop_start_label", 16) == 0;
+}
+
+// literal, variable and vector initialisers, as the data sections would hold them
+void interp_data(IPROGRAM *program, TAC *first)
+{
+    TAC *tac;
+    int i;
+    for (i = 0; i < HASH_SIZE; i++)
+    {
+        HASH *node;
+        for (node = compiler->symbols->buckets[i]; node; node = node->next)
+            node->slot = 0;
+    }
+
+    for (tac = first; tac; tac = tac->next)
+    {
+        if (tac->type == TAC_VARDEC)
+        {
+            int slot = interp_slot(program, tac->res);
+            if (tac->res->datatype == DATATYPE_INT || tac->res->datatype == DATATYPE_CHAR)
+                program->cells[slot].i = isel_literal_value(tac->op1);
+            else if (tac->res->datatype == DATATYPE_REAL)
+                program->cells[slot].f = atof(tac->op1->text);
+        }
+        else if (tac->type == TAC_VECDEC)
+        {
+            int slot = interp_vector(program, tac->res, atoi(tac->op1->text));
+            int length = atoi(tac->op1->text);
+            TAC *item;
+            for (item = tac->next, i = 0; item && item->type == TAC_SYMBOL && i < length; item = item->next, i++)
+            {
+                if (tac->res->datatype == DATATYPE_REAL)
+                    program->cells[slot + i].f = atof(item->res->text);
+                else
+                    program->cells[slot + i].i = isel_literal_value(item->res);
+            }
+        }
+    }
+}
+
+IPROGRAM *interp_decode(TAC *first, int tiered)
+{
+    IPROGRAM *program = (IPROGRAM *)calloc(1, sizeof(IPROGRAM));
+    HASH *main_function = NULL;
+    IINSTR *prev;
+    TAC *tac;
+    int barrier = 0;
+    int i;
+
+    program->first = first;
+    program->tiered = tiered;
+
+    // cell 0 is scratch: unused results and main's return value
+    interp_cells(program, 1);
+    isel_count_uses(first);
+    interp_data(program, first);
+
+    interp_emit(program, IOP_CALL, 0, 0, 0);
+    interp_emit(program, IOP_HALT, 0, 0, 0);
+
+    for (tac = first; tac; tac = tac->next)
+    {
+        int real = tac->res && tac->res->datatype == DATATYPE_REAL;
+        switch (tac->type)
+        {
+        case TAC_ADD:
+        case TAC_SUB:
+        case TAC_MUL:
+        case TAC_DIV:
+        {
+            int op = (real ? IOP_ADDF : IOP_ADDI) + tac->type - TAC_ADD;
+            interp_emit(program, op, interp_slot(program, tac->res), interp_slot(program, tac->op1), interp_slot(program, tac->op2));
+            break;
+        }
+        case TAC_NEG:
+        {
+            interp_emit(program, real ? IOP_NEGF : IOP_NEGI, interp_slot(program, tac->res), interp_slot(program, tac->op1), 0);
+            break;
+        }
+        case TAC_NOT:
+        case TAC_AND:
+        case TAC_OR:
+        {
+            int op = tac->type == TAC_NOT ? IOP_NOT : tac->type == TAC_AND ? IOP_AND : IOP_OR;
+            interp_emit(program, op, interp_slot(program, tac->res), interp_slot(program, tac->op1), interp_slot(program, tac->op2));
+            break;
+        }
+        case TAC_LE:
+        case TAC_GE:
+        case TAC_EQ:
+        case TAC_DIF:
+        case TAC_GT:
+        case TAC_LT:
+        {
+            int op = (real ? IOP_LTF : IOP_LTI) + interp_compare(tac->type);
+            interp_emit(program, op, interp_slot(program, tac->res), interp_slot(program, tac->op1), interp_slot(program, tac->op2));
+            break;
+        }
+        case TAC_COPY:
+        case TAC_ARG:
+        {
+            if (tac->res->is_vector)
+            {
+                IINSTR *store = interp_emit(program, IOP_STOREV, interp_vector(program, tac->res, 1), interp_slot(program, tac->op1), interp_slot(program, tac->op2));
+                store->d = program->cells[store->a - 1].i;
+                break;
+            }
+            if (tac->op1->is_vector && tac->op2)
+            {
+                IINSTR *load = interp_emit(program, IOP_LOADV, interp_slot(program, tac->res), interp_vector(program, tac->op1, 1), interp_slot(program, tac->op2));
+                load->d = program->cells[load->b - 1].i;
+                break;
+            }
+
+            // t = x op y; v = t  =>  v = x op y
+            prev = interp_fusable(program, barrier);
+            if (prev && interp_writes_a(prev->op) && tac->op1->is_temp && tac->op1->use_count == 1 && prev->a == tac->op1->slot)
+            {
+                prev->a = interp_slot(program, tac->type == TAC_ARG ? interp_lookup(tac->res) : tac->res);
+                program->fused++;
+                break;
+            }
+            interp_emit(program, IOP_MOVE, interp_slot(program, tac->type == TAC_ARG ? interp_lookup(tac->res) : tac->res), interp_slot(program, tac->op1), 0);
+            break;
+        }
+        case TAC_JFALSE:
+        {
+            // t = x cc y; jfalse t, L  =>  jump to L unless x cc y
+            prev = interp_fusable(program, barrier);
+            if (prev && prev->op >= IOP_LTI && prev->op < IOP_LTF + 6 && tac->op1->is_temp && tac->op1->use_count == 1 && prev->a == tac->op1->slot)
+            {
+                prev->op += IOP_JLTI - IOP_LTI;
+                prev->a = prev->b;
+                prev->b = prev->c;
+                prev->c = 0;
+                prev->target = tac->res;
+                program->fused++;
+                break;
+            }
+            interp_emit(program, IOP_JFALSE, interp_slot(program, tac->op1), 0, 0)->target = tac->res;
+            break;
+        }
+        case TAC_JUMP:
+        {
+            if (tiered && interp_is_backedge(tac))
+            {
+                program->loops = (ILOOP *)realloc(program->loops, (program->loop_count + 1) * sizeof(ILOOP));
+                memset(&program->loops[program->loop_count], 0, sizeof(ILOOP));
+                program->loops[program->loop_count].label = tac->res;
+                program->loops[program->loop_count].function = program->function_count - 1;
+                interp_emit(program, IOP_BACKEDGE, 0, program->loop_count++, 0)->target = tac->res;
+                break;
+            }
+            prev = interp_fusable(program, barrier);
+            if (prev && prev->op == IOP_ADDI)
+            {
+                prev->op = IOP_ADDI_JUMP;
+                prev->target = tac->res;
+                program->fused++;
+                break;
+            }
+            interp_emit(program, IOP_JUMP, 0, 0, 0)->target = tac->res;
+            break;
+        }
+        case TAC_LABEL:
+        case TAC_BEGINFUN:
+        {
+            tac->res->slot = barrier = program->count;
+            if (tac->type == TAC_BEGINFUN)
+            {
+                program->functions = (IFUNCTION *)realloc(program->functions, (program->function_count + 1) * sizeof(IFUNCTION));
+                memset(&program->functions[program->function_count], 0, sizeof(IFUNCTION));
+                program->functions[program->function_count].symbol = tac->res;
+                program->functions[program->function_count++].begin = tac;
+                if (strcmp(tac->res->text, "main") == 0)
+                    main_function = tac->res;
+            }
+            break;
+        }
+        case TAC_ENDFUN:
+        {
+            if (program->function_count)
+                program->functions[program->function_count - 1].end = tac;
+            break;
+        }
+        case TAC_CALL:
+        {
+            interp_emit(program, tiered ? IOP_TCALL : IOP_CALL, interp_slot(program, tac->res), 0, 0)->target = tac->op1;
+            break;
+        }
+        case TAC_RET:
+        {
+            interp_emit(program, IOP_RET, interp_slot(program, tac->res), 0, 0);
+            break;
+        }
+        case TAC_PRINT_ARG:
+        {
+            if (!tac->res)
+                break;
+            if (isel_is_string_arg(tac))
+                interp_emit(program, IOP_PRINTS, interp_string(program, tac->res), 0, 0);
+            else
+                interp_emit(program, real ? IOP_PRINTF : tac->res->datatype == DATATYPE_CHAR ? IOP_PRINTC : IOP_PRINTI, interp_slot(program, tac->res), 0, 0);
+            break;
+        }
+        case TAC_READ:
+        {
+            int op = real ? IOP_READF : tac->res->datatype == DATATYPE_CHAR ? IOP_READC : IOP_READI;
+            interp_emit(program, op, interp_slot(program, tac->res), 0, 0);
+            break;
+        }
+        }
+    }
+    interp_emit(program, IOP_HALT, 0, 0, 0);
+
+    if (!main_function)
+    {
+        compiler_fail("interp: no main function\n");
+    }
+    program->code[0].target = main_function;
+
+    for (i = 0; i < program->count; i++)
+    {
+        HASH *target = program->code[i].target;
+        if (!target)
+            continue;
+        if (!target->slot)
+        {
+            compiler_fail("interp: undefined target %s\n", target->text);
+        }
+        program->code[i].d = target->slot;
+        if (program->code[i].op == IOP_TCALL)
+            program->code[i].b = interp_function(program, target);
+    }
+    return program;
+}
+
+void interp_bounds(int index, int length)
+{
+    compiler_fail("interp: index %d out of bounds for vector of %d\n", index, length);
+}
+
+// threaded dispatch: every handler jumps straight to the next one's label
+int interp_execute(IPROGRAM *program)
+{
+    static void *handlers[IOP_COUNT] = {
+        [IOP_HALT] = &&op_halt,
+        [IOP_MOVE] = &&op_move,
+        [IOP_ADDI] = &&op_addi,
+        [IOP_SUBI] = &&op_subi,
+        [IOP_MULI] = &&op_muli,
+        [IOP_DIVI] = &&op_divi,
+        [IOP_ADDF] = &&op_addf,
+        [IOP_SUBF] = &&op_subf,
+        [IOP_MULF] = &&op_mulf,
+        [IOP_DIVF] = &&op_divf,
+        [IOP_NEGI] = &&op_negi,
+        [IOP_NEGF] = &&op_negf,
+        [IOP_NOT] = &&op_not,
+        [IOP_AND] = &&op_and,
+        [IOP_OR] = &&op_or,
+        [IOP_LTI] = &&op_lti,
+        [IOP_LTI + 1] = &&op_lei,
+        [IOP_LTI + 2] = &&op_gti,
+        [IOP_LTI + 3] = &&op_gei,
+        [IOP_LTI + 4] = &&op_eqi,
+        [IOP_LTI + 5] = &&op_nei,
+        [IOP_LTF] = &&op_ltf,
+        [IOP_LTF + 1] = &&op_lef,
+        [IOP_LTF + 2] = &&op_gtf,
+        [IOP_LTF + 3] = &&op_gef,
+        [IOP_LTF + 4] = &&op_eqf,
+        [IOP_LTF + 5] = &&op_nef,
+        [IOP_LOADV] = &&op_loadv,
+        [IOP_STOREV] = &&op_storev,
+        [IOP_JUMP] = &&op_jump,
+        [IOP_JFALSE] = &&op_jfalse,
+        [IOP_CALL] = &&op_call,
+        [IOP_RET] = &&op_ret,
+        [IOP_PRINTI] = &&op_printi,
+        [IOP_PRINTF] = &&op_printf,
+        [IOP_PRINTC] = &&op_printc,
+        [IOP_PRINTS] = &&op_prints,
+        [IOP_READI] = &&op_readi,
+        [IOP_READF] = &&op_readf,
+        [IOP_READC] = &&op_readc,
+        [IOP_JLTI] = &&op_jlti,
+        [IOP_JLTI + 1] = &&op_jlei,
+        [IOP_JLTI + 2] = &&op_jgti,
+        [IOP_JLTI + 3] = &&op_jgei,
+        [IOP_JLTI + 4] = &&op_jeqi,
+        [IOP_JLTI + 5] = &&op_jnei,
+        [IOP_JLTF] = &&op_jltf,
+        [IOP_JLTF + 1] = &&op_jlef,
+        [IOP_JLTF + 2] = &&op_jgtf,
+        [IOP_JLTF + 3] = &&op_jgef,
+        [IOP_JLTF + 4] = &&op_jeqf,
+        [IOP_JLTF + 5] = &&op_jnef,
+        [IOP_ADDI_JUMP] = &&op_addi_jump,
+        [IOP_TCALL] = &&op_tcall,
+        [IOP_BACKEDGE] = &&op_backedge,
+    };
+    IINSTR *code = program->code;
+    ICELL *cells = program->cells;
+    IINSTR **stack = (IINSTR **)malloc(INTERP_MAX_DEPTH * sizeof(IINSTR *));
+    IINSTR **sp = stack;
+    IINSTR *ip = code;
+    long executed = 1;
+    ICELL result;
+    IFUNCTION *function;
+    ILOOP *loop;
+    int i;
+
+    if (!program->threaded)
+    {
+        for (i = 0; i < program->count; i++)
+            code[i].handler = handlers[code[i].op];
+        program->threaded = 1;
+    }
+
+// C leaves signed overflow undefined; the generated code wraps
+#define I(slot) cells[slot].i
+#define U(slot) (unsigned)cells[slot].i
+#define F(slot) cells[slot].f
+#define NEXT()               \
+    do                       \
+    {                        \
+        executed++;          \
+        ip++;                \
+        goto *ip->handler;   \
+    } while (0)
+#define JUMP(index)              \
+    do                           \
+    {                            \
+        executed++;              \
+        ip = code + (index);     \
+        goto *ip->handler;       \
+    } while (0)
+
+    goto *ip->handler;
+
+op_halt:
+    program->executed += executed;
+    free(stack);
+    return I(0);
+op_move:
+    cells[ip->a] = cells[ip->b];
+    NEXT();
+op_addi:
+    I(ip->a) = (int)(U(ip->b) + U(ip->c));
+    NEXT();
+op_subi:
+    I(ip->a) = (int)(U(ip->b) - U(ip->c));
+    NEXT();
+op_muli:
+    I(ip->a) = (int)(U(ip->b) * U(ip->c));
+    NEXT();
+op_divi:
+    I(ip->a) = I(ip->b) / I(ip->c);
+    NEXT();
+op_addf:
+    F(ip->a) = F(ip->b) + F(ip->c);
+    NEXT();
+op_subf:
+    F(ip->a) = F(ip->b) - F(ip->c);
+    NEXT();
+op_mulf:
+    F(ip->a) = F(ip->b) * F(ip->c);
+    NEXT();
+op_divf:
+    F(ip->a) = F(ip->b) / F(ip->c);
+    NEXT();
+op_negi:
+    I(ip->a) = (int)(0u - U(ip->b));
+    NEXT();
+op_negf:
+    F(ip->a) = 0.0f - F(ip->b);
+    NEXT();
+op_not:
+    I(ip->a) = I(ip->b) == 0;
+    NEXT();
+op_and:
+    I(ip->a) = I(ip->b) & I(ip->c);
+    NEXT();
+op_or:
+    I(ip->a) = I(ip->b) | I(ip->c);
+    NEXT();
+op_lti:
+    I(ip->a) = I(ip->b) < I(ip->c);
+    NEXT();
+op_lei:
+    I(ip->a) = I(ip->b) <= I(ip->c);
+    NEXT();
+op_gti:
+    I(ip->a) = I(ip->b) > I(ip->c);
+    NEXT();
+op_gei:
+    I(ip->a) = I(ip->b) >= I(ip->c);
+    NEXT();
+op_eqi:
+    I(ip->a) = I(ip->b) == I(ip->c);
+    NEXT();
+op_nei:
+    I(ip->a) = I(ip->b) != I(ip->c);
+    NEXT();
+op_ltf:
+    I(ip->a) = F(ip->b) < F(ip->c);
+    NEXT();
+op_lef:
+    I(ip->a) = F(ip->b) <= F(ip->c);
+    NEXT();
+op_gtf:
+    I(ip->a) = F(ip->b) > F(ip->c);
+    NEXT();
+op_gef:
+    I(ip->a) = F(ip->b) >= F(ip->c);
+    NEXT();
+op_eqf:
+    I(ip->a) = F(ip->b) == F(ip->c);
+    NEXT();
+op_nef:
+    I(ip->a) = F(ip->b) != F(ip->c);
+    NEXT();
+op_loadv:
+    if (U(ip->c) >= (unsigned)ip->d)
+        interp_bounds(I(ip->c), ip->d);
+    cells[ip->a] = cells[ip->b + I(ip->c)];
+    NEXT();
+op_storev:
+    if (U(ip->b) >= (unsigned)ip->d)
+        interp_bounds(I(ip->b), ip->d);
+    cells[ip->a + I(ip->b)] = cells[ip->c];
+    NEXT();
+op_jump:
+    JUMP(ip->d);
+op_jfalse:
+    if (!I(ip->a))
+        JUMP(ip->d);
+    NEXT();
+op_call:
+    if (sp == stack + INTERP_MAX_DEPTH)
+    {
+        compiler_fail("interp: call stack overflow\n");
+    }
+    *sp++ = ip;
+    JUMP(ip->d);
+op_ret:
+    result = cells[ip->a];
+    ip = *--sp;
+    cells[ip->a] = result;
+    NEXT();
+op_printi:
+    printf("%d", I(ip->a));
+    NEXT();
+op_printf:
+    printf("%f", (double)F(ip->a));
+    NEXT();
+op_printc:
+    printf("%c", I(ip->a));
+    NEXT();
+op_prints:
+    fputs(program->strings[ip->a], stdout);
+    NEXT();
+op_readi:
+    scanf("%d", &I(ip->a));
+    NEXT();
+op_readf:
+    scanf("%f", &F(ip->a));
+    NEXT();
+op_readc:
+    scanf(" %c", (char *)&cells[ip->a]);
+    NEXT();
+op_jlti:
+    if (!(I(ip->a) < I(ip->b)))
+        JUMP(ip->d);
+    NEXT();
+op_jlei:
+    if (!(I(ip->a) <= I(ip->b)))
+        JUMP(ip->d);
+    NEXT();
+op_jgti:
+    if (!(I(ip->a) > I(ip->b)))
+        JUMP(ip->d);
+    NEXT();
+op_jgei:
+    if (!(I(ip->a) >= I(ip->b)))
+        JUMP(ip->d);
+    NEXT();
+op_jeqi:
+    if (!(I(ip->a) == I(ip->b)))
+        JUMP(ip->d);
+    NEXT();
+op_jnei:
+    if (!(I(ip->a) != I(ip->b)))
+        JUMP(ip->d);
+    NEXT();
+op_jltf:
+    if (!(F(ip->a) < F(ip->b)))
+        JUMP(ip->d);
+    NEXT();
+op_jlef:
+    if (!(F(ip->a) <= F(ip->b)))
+        JUMP(ip->d);
+    NEXT();
+op_jgtf:
+    if (!(F(ip->a) > F(ip->b)))
+        JUMP(ip->d);
+    NEXT();
+op_jgef:
+    if (!(F(ip->a) >= F(ip->b)))
+        JUMP(ip->d);
+    NEXT();
+op_jeqf:
+    if (!(F(ip->a) == F(ip->b)))
+        JUMP(ip->d);
+    NEXT();
+op_jnef:
+    if (!(F(ip->a) != F(ip->b)))
+        JUMP(ip->d);
+    NEXT();
+op_addi_jump:
+    I(ip->a) = (int)(U(ip->b) + U(ip->c));
+    JUMP(ip->d);
+
+// compiled functions share the cells, so switching tiers needs no state transfer
+op_tcall:
+    function = &program->functions[ip->b];
+    if (!function->native && ++function->calls == compiler->tier_threshold)
+        tier_promote(program, ip->b);
+    if (!function->native)
+        goto op_call;
+    I(ip->a) = function->native();
+    NEXT();
+op_backedge:
+    loop = &program->loops[ip->b];
+    if (!loop->native && ++loop->count == compiler->tier_threshold)
+        tier_promote(program, loop->function);
+    if (!loop->native)
+        JUMP(ip->d);
+    // the native code finishes the call, so return from it here
+    result.i = loop->native();
+    ip = *--sp;
+    cells[ip->a] = result;
+    NEXT();
+
+#undef I
+#undef U
+#undef F
+#undef NEXT
+#undef JUMP
+}
+
+void interp_release(IPROGRAM *program)
+{
+    int i;
+    for (i = 0; i < program->string_count; i++)
+        free(program->strings[i]);
+    free(program->strings);
+    free(program->functions);
+    free(program->loops);
+    free(program->code);
+    free(program->cells);
+    free(program);
+}
+
+int interp_run(TAC *last)
+{
+    IPROGRAM *program = interp_decode(tac_reverse(last), compiler->run_tiered);
+    struct timespec start;
+    struct timespec end;
+    double seconds;
+    int status;
+
+    if (program->tiered)
+        tier_start(program);
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    status = interp_execute(program);
+    fflush(stdout);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    if (program->tiered)
+        tier_finish(program);
+
+    if (compiler->verbose)
+    {
+        seconds = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+        fprintf(stderr, "interp: %d instructions decoded, %d pairs fused\n", program->count, program->fused);
+        fprintf(stderr, "interp: %ld instructions in %.6f s (%.1f M/s)\n", program->executed, seconds, seconds > 0 ? program->executed / seconds / 1e6 : 0.0);
+    }
+    interp_release(program);
+    return status;
+}
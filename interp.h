@@ -0,0 +1,106 @@
+#pragma once
+#include "tac.h"
+
+// predecoded operations; operands are cell slots, branch targets code indices
+#define IOP_HALT 0
+#define IOP_MOVE 1
+#define IOP_ADDI 2
+#define IOP_SUBI 3
+#define IOP_MULI 4
+#define IOP_DIVI 5
+#define IOP_ADDF 6
+#define IOP_SUBF 7
+#define IOP_MULF 8
+#define IOP_DIVF 9
+#define IOP_NEGI 10
+#define IOP_NEGF 11
+#define IOP_NOT 12
+#define IOP_AND 13
+#define IOP_OR 14
+#define IOP_LTI 15 // LT LE GT GE EQ NE, int then real
+#define IOP_LTF 21
+#define IOP_LOADV 27  // a = vector b[c], d = length
+#define IOP_STOREV 28 // vector a[b] = c, d = length
+#define IOP_JUMP 29
+#define IOP_JFALSE 30
+#define IOP_CALL 31 // result in a
+#define IOP_RET 32
+#define IOP_PRINTI 33
+#define IOP_PRINTF 34
+#define IOP_PRINTC 35
+#define IOP_PRINTS 36
+#define IOP_READI 37
+#define IOP_READF 38
+#define IOP_READC 39
+
+// superinstructions
+#define IOP_JLTI 40 // compare + jfalse: jump to d unless a cc b
+#define IOP_JLTF 46
+#define IOP_ADDI_JUMP 52 // a = b + c; jump to d
+
+// tiered mode: calls and loop back-edges that count towards compilation
+#define IOP_TCALL 53    // CALL through function b
+#define IOP_BACKEDGE 54 // JUMP closing loop b
+#define IOP_COUNT 55
+
+#define INTERP_MAX_DEPTH 65536
+
+typedef union icell
+{
+    int i;
+    float f;
+} ICELL;
+
+typedef struct iinstr
+{
+    void *handler; // dispatch target, filled in on the first run
+    int op;
+    int a;
+    int b;
+    int c;
+    int d;
+    HASH *target;  // branch or call target until it is resolved into d
+} IINSTR;
+
+typedef struct ifunction
+{
+    HASH *symbol;
+    TAC *begin;
+    TAC *end;
+    int calls;
+    int (*native)(void);
+} IFUNCTION;
+
+typedef struct iloop
+{
+    HASH *label;   // loop_start_label of the loop
+    int function;
+    int count;     // back-edges taken
+    int (*native)(void); // runs the rest of the compiled function from the loop head
+} ILOOP;
+
+typedef struct iprogram
+{
+    IINSTR *code;
+    int count;
+    int capacity;
+    ICELL *cells;
+    int cell_count;
+    int cell_capacity;
+    char **strings;
+    int string_count;
+    int fused;
+    int threaded;
+    long executed;
+    TAC *first;
+    int tiered;
+    IFUNCTION *functions;
+    int function_count;
+    ILOOP *loops;
+    int loop_count;
+} IPROGRAM;
+
+IPROGRAM *interp_decode(TAC *first, int tiered);
+int interp_execute(IPROGRAM *program);
+void interp_release(IPROGRAM *program);
+int interp_run(TAC *last);
@@ -0,0 +1,1057 @@
+#include "isel.h"
+#include "hash.h"
+#include "asmgen.h"
+
+// per-datatype tile costs, rows indexed by DATATYPE_*
+int isel_costs[5][ISEL_COST_COUNT] = {
+    // load store alu mul div shift lea cmp addr
+    {1, 1, 1, 3, 26, 1, 1, 1, 1},                         // invalid, handled as int
+    {1, 1, 1, 3, 26, 1, 1, 1, 1},                         // int
+    {1, 1, 4, 4, 11, ISEL_INFINITE, ISEL_INFINITE, 3, 1}, // real
+    {1, 1, 1, 3, 26, 1, 1, 1, 1},                         // bool
+    {1, 1, 1, 3, 26, 1, 1, 1, 1},                         // char
+};
+
+// rax and rdx are kept out of the pools: idiv, setcc, calls and returns use them
+int isel_int_pool[] = {REG_RCX, REG_RSI, REG_RDI, REG_R8, REG_R9, REG_R10, REG_R11};
+int isel_real_pool[] = {REG_XMM1, REG_XMM1 + 1, REG_XMM1 + 2, REG_XMM1 + 3, REG_XMM1 + 4, REG_XMM1 + 5, REG_XMM7};
+#define ISEL_POOL_SIZE 7
+// trees needing more registers than this get cut at a temp
+#define ISEL_MAX_NEED 5
+
+void isel_count_uses(TAC *first)
+{
+    TAC *tac;
+    for (tac = first; tac; tac = tac->next)
+    {
+        if (tac->res)
+            tac->res->use_count = 0;
+        if (tac->op1)
+            tac->op1->use_count = 0;
+        if (tac->op2)
+            tac->op2->use_count = 0;
+    }
+
+    for (tac = first; tac; tac = tac->next)
+    {
+        if (tac->op1)
+            tac->op1->use_count++;
+        if (tac->op2)
+            tac->op2->use_count++;
+        if (tac->res && (tac->type == TAC_PRINT_ARG || tac->type == TAC_RET))
+            tac->res->use_count++;
+    }
+}
+
+int isel_is_string_arg(TAC *tac)
+{
+    switch (tac->res->datatype)
+    {
+    case DATATYPE_INT:
+    case DATATYPE_REAL:
+    case DATATYPE_CHAR:
+    case DATATYPE_BOOL:
+        return 0;
+    }
+
+    return !tac->res->is_temp;
+}
+
+int isel_accepts(TAC *tac)
+{
+    switch (tac->type)
+    {
+    case TAC_ADD:
+    case TAC_SUB:
+    case TAC_MUL:
+    case TAC_DIV:
+    case TAC_NEG:
+    case TAC_NOT:
+    case TAC_AND:
+    case TAC_OR:
+    case TAC_LE:
+    case TAC_GE:
+    case TAC_EQ:
+    case TAC_DIF:
+    case TAC_GT:
+    case TAC_LT:
+    case TAC_COPY:
+    case TAC_ARG:
+    case TAC_RET:
+    case TAC_JFALSE:
+        return 1;
+    case TAC_PRINT_ARG:
+        return !isel_is_string_arg(tac) && asm_output_alone(tac);
+    }
+
+    return 0;
+}
+
+int isel_is_compare(int op)
+{
+    return op == TAC_LE || op == TAC_GE || op == TAC_EQ || op == TAC_DIF || op == TAC_GT || op == TAC_LT;
+}
+
+int isel_is_expression(TAC *tac)
+{
+    switch (tac->type)
+    {
+    case TAC_ADD:
+    case TAC_SUB:
+    case TAC_MUL:
+    case TAC_DIV:
+    case TAC_NEG:
+    case TAC_NOT:
+    case TAC_AND:
+    case TAC_OR:
+        return 1;
+    case TAC_COPY:
+        return tac->op1 && tac->op1->is_vector && tac->op2 && !tac->res->is_vector;
+    }
+
+    return isel_is_compare(tac->type);
+}
+
+int isel_is_foldable(TAC *tac)
+{
+    return tac->res && tac->res->is_temp && tac->res->use_count == 1 && isel_is_expression(tac);
+}
+
+int isel_class_of(int datatype)
+{
+    return datatype == DATATYPE_REAL ? ISEL_CLASS_REAL : ISEL_CLASS_INT;
+}
+
+int isel_cost(ISEL_NODE *node, int column)
+{
+    int row = node->datatype >= 0 && node->datatype <= DATATYPE_CHAR ? node->datatype : 0;
+    return isel_costs[row][column];
+}
+
+ISEL_NODE *isel_node_create(int op, int datatype, HASH *symbol, ISEL_NODE *k0, ISEL_NODE *k1)
+{
+    ISEL_NODE *node = (ISEL_NODE *)arena_alloc(&compiler->isel->arena, sizeof(ISEL_NODE));
+    node->op = op;
+    node->datatype = datatype;
+    node->symbol = symbol;
+    node->kid[0] = k0;
+    node->kid[1] = k1;
+    return node;
+}
+
+ISEL_NODE *isel_operand_tree(HASH *symbol)
+{
+    int i;
+    for (i = 0; i < compiler->isel->pending_count; i++)
+    {
+        if (compiler->isel->pending[i]->temp == symbol)
+        {
+            ISEL_NODE *node = compiler->isel->pending[i];
+            for (; i < compiler->isel->pending_count - 1; i++)
+            {
+                compiler->isel->pending[i] = compiler->isel->pending[i + 1];
+            }
+            compiler->isel->pending_count--;
+            return node;
+        }
+    }
+
+    return isel_node_create(ISEL_VAR, symbol ? symbol->datatype : 0, symbol, NULL, NULL);
+}
+
+ISEL_NODE *isel_build(TAC *tac)
+{
+    ISEL_NODE *node;
+    if (tac->type == TAC_COPY || tac->type == TAC_ARG)
+    {
+        node = isel_node_create(ISEL_VEC, tac->op1->datatype, tac->op1, isel_operand_tree(tac->op2), NULL);
+    }
+    else
+    {
+        ISEL_NODE *k0 = isel_operand_tree(tac->op1);
+        ISEL_NODE *k1 = tac->op2 ? isel_operand_tree(tac->op2) : NULL;
+        node = isel_node_create(tac->type, tac->res->datatype, NULL, k0, k1);
+    }
+    node->temp = tac->res;
+    return node;
+}
+
+int isel_is_literal(HASH *symbol)
+{
+    return symbol && (symbol->type == SYMBOL_LIT_INTEGER || symbol->type == SYMBOL_LIT_CHAR);
+}
+
+int isel_literal_value(HASH *symbol)
+{
+    if (symbol->type == SYMBOL_LIT_CHAR)
+        return symbol->text[1];
+    return atoi(symbol->text);
+}
+
+// memory operand of a leaf; literals that cannot be immediates come from the constant pool
+MOPERAND isel_symbol(HASH *symbol)
+{
+    if (isel_is_literal(symbol) || symbol->type == SYMBOL_LIT_REAL)
+        return asm_literal(symbol);
+    return mop_hash(symbol, 0);
+}
+
+int isel_const_value(ISEL_NODE *node)
+{
+    return isel_literal_value(node->symbol);
+}
+
+int isel_log2(int value)
+{
+    int k = 0;
+    if (value <= 0 || (value & (value - 1)))
+        return -1;
+    while ((1 << k) != value)
+        k++;
+    return k;
+}
+
+void isel_set(ISEL_NODE *node, int nt, int rule, int cost)
+{
+    if (cost < node->cost[nt])
+    {
+        node->cost[nt] = cost;
+        node->rule[nt] = rule;
+    }
+}
+
+int isel_node_class(ISEL_NODE *node, int requested)
+{
+    switch (node->op)
+    {
+    case ISEL_VAR:
+    case ISEL_VEC:
+        return requested;
+    case TAC_AND:
+    case TAC_OR:
+    case TAC_NOT:
+        return ISEL_CLASS_INT;
+    }
+
+    if (isel_is_compare(node->op))
+        return ISEL_CLASS_INT;
+    return isel_class_of(node->datatype);
+}
+
+int isel_operand_class(ISEL_NODE *node)
+{
+    if (isel_is_compare(node->op))
+        return isel_class_of(node->datatype);
+    if (node->op == ISEL_VEC)
+        return ISEL_CLASS_INT;
+    return node->cls;
+}
+
+int isel_is_commutative(int op)
+{
+    return op == TAC_ADD || op == TAC_MUL || op == TAC_AND || op == TAC_OR || op == TAC_EQ || op == TAC_DIF;
+}
+
+// a commuted compare is fine for ints; reals only allow the forms that keep comiss NaN-safe
+int isel_allows_mem_right(ISEL_NODE *node)
+{
+    if (!isel_is_compare(node->op) || isel_operand_class(node) == ISEL_CLASS_INT)
+        return 1;
+    return node->op != TAC_LT && node->op != TAC_LE;
+}
+
+int isel_allows_mem_left(ISEL_NODE *node)
+{
+    if (isel_is_compare(node->op))
+        return isel_operand_class(node) == ISEL_CLASS_INT || (node->op != TAC_GT && node->op != TAC_GE);
+    return isel_is_commutative(node->op);
+}
+
+int isel_scale_of(ISEL_NODE *node)
+{
+    // SCALED: MUL(reg, const) with an addressing-mode scale; returns the index kid position
+    int c;
+    if (node->op != TAC_MUL || node->cls != ISEL_CLASS_INT)
+        return -1;
+    if (node->kid[1]->cost[ISEL_NT_CONST] == 0)
+    {
+        c = isel_const_value(node->kid[1]);
+        if (c == 1 || c == 2 || c == 4 || c == 8)
+            return 0;
+    }
+    if (node->kid[0]->cost[ISEL_NT_CONST] == 0)
+    {
+        c = isel_const_value(node->kid[0]);
+        if (c == 1 || c == 2 || c == 4 || c == 8)
+            return 1;
+    }
+    return -1;
+}
+
+void isel_label(ISEL_NODE *node, int cls)
+{
+    int i;
+    for (i = 0; i < ISEL_NT_COUNT; i++)
+    {
+        node->cost[i] = ISEL_INFINITE;
+        node->rule[i] = ISEL_R_NONE;
+    }
+    node->cls = isel_node_class(node, cls);
+
+    switch (node->op)
+    {
+    case ISEL_VAR:
+    {
+        if (!isel_is_literal(node->symbol) || node->cls == ISEL_CLASS_REAL)
+            isel_set(node, ISEL_NT_MEM, ISEL_R_MEM_VAR, 0);
+        if (isel_is_literal(node->symbol))
+        {
+            isel_set(node, ISEL_NT_CONST, ISEL_R_CONST_LIT, 0);
+            if (node->cls == ISEL_CLASS_INT)
+                isel_set(node, ISEL_NT_REG, ISEL_R_REG_CONST, isel_cost(node, ISEL_COST_LOAD));
+        }
+        node->need = 1;
+        break;
+    }
+    case ISEL_VEC:
+    {
+        ISEL_NODE *index = node->kid[0];
+        isel_label(index, ISEL_CLASS_INT);
+        if (index->cost[ISEL_NT_CONST] == 0)
+            isel_set(node, ISEL_NT_MEM, ISEL_R_MEM_VEC_CONST, 0);
+        isel_set(node, ISEL_NT_MEM, ISEL_R_MEM_VEC_REG, isel_cost(node, ISEL_COST_ADDR) + index->cost[ISEL_NT_REG]);
+        if (index->op == TAC_ADD)
+        {
+            if (index->kid[1]->cost[ISEL_NT_CONST] == 0)
+                isel_set(node, ISEL_NT_MEM, ISEL_R_MEM_VEC_DISP, isel_cost(node, ISEL_COST_ADDR) + index->kid[0]->cost[ISEL_NT_REG]);
+            else if (index->kid[0]->cost[ISEL_NT_CONST] == 0)
+                isel_set(node, ISEL_NT_MEM, ISEL_R_MEM_VEC_DISP, isel_cost(node, ISEL_COST_ADDR) + index->kid[1]->cost[ISEL_NT_REG]);
+        }
+        node->need = index->need + 1;
+        break;
+    }
+    case TAC_NEG:
+    case TAC_NOT:
+    {
+        isel_label(node->kid[0], isel_operand_class(node));
+        isel_set(node, ISEL_NT_REG, ISEL_R_REG_UNARY, isel_cost(node, ISEL_COST_ALU) + node->kid[0]->cost[ISEL_NT_REG]);
+        node->need = node->kid[0]->need;
+        break;
+    }
+    case TAC_DIV:
+    {
+        ISEL_NODE *k0 = node->kid[0];
+        ISEL_NODE *k1 = node->kid[1];
+        int divisor;
+        isel_label(k0, node->cls);
+        isel_label(k1, node->cls);
+        divisor = k1->cost[ISEL_NT_REG];
+        if (k1->cost[ISEL_NT_MEM] < divisor)
+            divisor = k1->cost[ISEL_NT_MEM];
+        isel_set(node, ISEL_NT_REG, ISEL_R_REG_DIV, isel_cost(node, ISEL_COST_DIV) + k0->cost[ISEL_NT_REG] + divisor);
+        node->need = k0->need > k1->need ? k0->need : k1->need + (k0->need == k1->need);
+        break;
+    }
+    default:
+    {
+        ISEL_NODE *k0 = node->kid[0];
+        ISEL_NODE *k1 = node->kid[1];
+        int oc = isel_operand_class(node);
+        int column = ISEL_COST_ALU;
+        int scaled;
+        if (node->op == TAC_MUL)
+            column = ISEL_COST_MUL;
+        else if (isel_is_compare(node->op))
+            column = ISEL_COST_CMP;
+
+        isel_label(k0, oc);
+        isel_label(k1, oc);
+
+        isel_set(node, ISEL_NT_REG, ISEL_R_REG_OP_REG, isel_cost(node, column) + k0->cost[ISEL_NT_REG] + k1->cost[ISEL_NT_REG]);
+        if (oc == ISEL_CLASS_INT)
+        {
+            isel_set(node, ISEL_NT_REG, ISEL_R_REG_OP_CONST, isel_cost(node, column) + k0->cost[ISEL_NT_REG] + k1->cost[ISEL_NT_CONST]);
+            if (isel_allows_mem_left(node))
+                isel_set(node, ISEL_NT_REG, ISEL_R_REG_CONST_OP, isel_cost(node, column) + k0->cost[ISEL_NT_CONST] + k1->cost[ISEL_NT_REG]);
+        }
+        if (isel_allows_mem_right(node))
+            isel_set(node, ISEL_NT_REG, ISEL_R_REG_OP_MEM, isel_cost(node, column) + k0->cost[ISEL_NT_REG] + k1->cost[ISEL_NT_MEM]);
+        if (isel_allows_mem_left(node))
+            isel_set(node, ISEL_NT_REG, ISEL_R_REG_MEM_OP, isel_cost(node, column) + k0->cost[ISEL_NT_MEM] + k1->cost[ISEL_NT_REG]);
+
+        if (node->op == TAC_MUL && node->cls == ISEL_CLASS_INT)
+        {
+            if (k1->cost[ISEL_NT_CONST] == 0 && isel_log2(isel_const_value(k1)) > 0)
+                isel_set(node, ISEL_NT_REG, ISEL_R_REG_SHIFT, isel_cost(node, ISEL_COST_SHIFT) + k0->cost[ISEL_NT_REG]);
+            if (k0->cost[ISEL_NT_CONST] == 0 && isel_log2(isel_const_value(k0)) > 0)
+                isel_set(node, ISEL_NT_REG, ISEL_R_REG_SHIFT, isel_cost(node, ISEL_COST_SHIFT) + k1->cost[ISEL_NT_REG]);
+
+            scaled = isel_scale_of(node);
+            if (scaled >= 0)
+                isel_set(node, ISEL_NT_SCALED, ISEL_R_SCALED_MUL, node->kid[scaled]->cost[ISEL_NT_REG]);
+        }
+
+        if (node->op == TAC_ADD && node->cls == ISEL_CLASS_INT)
+        {
+            isel_set(node, ISEL_NT_REG, ISEL_R_REG_LEA, isel_cost(node, ISEL_COST_LEA) + k0->cost[ISEL_NT_REG] + k1->cost[ISEL_NT_SCALED]);
+            isel_set(node, ISEL_NT_REG, ISEL_R_REG_LEA, isel_cost(node, ISEL_COST_LEA) + k0->cost[ISEL_NT_SCALED] + k1->cost[ISEL_NT_REG]);
+            if (k1->cost[ISEL_NT_CONST] == 0)
+            {
+                isel_set(node, ISEL_NT_REG, ISEL_R_REG_LEA_DISP, isel_cost(node, ISEL_COST_LEA) + k0->cost[ISEL_NT_REG]);
+                if (k0->rule[ISEL_NT_REG] == ISEL_R_REG_LEA)
+                    isel_set(node, ISEL_NT_REG, ISEL_R_REG_LEA_FULL, k0->cost[ISEL_NT_REG]);
+            }
+            else if (k0->cost[ISEL_NT_CONST] == 0)
+            {
+                isel_set(node, ISEL_NT_REG, ISEL_R_REG_LEA_DISP, isel_cost(node, ISEL_COST_LEA) + k1->cost[ISEL_NT_REG]);
+            }
+        }
+
+        if (node->op == TAC_SUB && node->cls == ISEL_CLASS_INT && k1->cost[ISEL_NT_CONST] == 0)
+            isel_set(node, ISEL_NT_REG, ISEL_R_REG_LEA_DISP, isel_cost(node, ISEL_COST_LEA) + k0->cost[ISEL_NT_REG]);
+
+        if (k0->need == k1->need)
+            node->need = k0->need + 1;
+        else
+            node->need = k0->need > k1->need ? k0->need : k1->need;
+        break;
+    }
+    }
+
+    // chain rule reg: mem
+    isel_set(node, ISEL_NT_REG, ISEL_R_REG_MEM, node->cost[ISEL_NT_MEM] + isel_cost(node, ISEL_COST_LOAD));
+}
+
+// register allocation
+
+int isel_alloc(int cls)
+{
+    int i;
+    int *pool = cls == ISEL_CLASS_REAL ? isel_real_pool : isel_int_pool;
+    for (i = 0; i < ISEL_POOL_SIZE; i++)
+    {
+        if (!compiler->isel->reg_used[pool[i]])
+        {
+            compiler->isel->reg_used[pool[i]] = 1;
+            return pool[i];
+        }
+    }
+
+    compiler_fail("isel: out of registers\n");
+}
+
+void isel_free(int reg)
+{
+    if (reg >= 0)
+        compiler->isel->reg_used[reg] = 0;
+}
+
+void isel_release(MOPERAND *operand)
+{
+    if (operand->kind == MOP_REG)
+    {
+        isel_free(operand->reg);
+    }
+    else if (operand->kind == MOP_MEM && operand->symbol.kind == MSYM_NONE)
+    {
+        isel_free(operand->reg);
+        isel_free(operand->index);
+    }
+}
+
+int isel_is_xmm(int reg)
+{
+    return reg >= REG_XMM0;
+}
+
+// moves a value between register classes, returning the new register
+int isel_convert(MCODE *code, int reg, int cls)
+{
+    int converted;
+    MOPERAND src;
+    MOPERAND dst;
+    if (isel_is_xmm(reg) == (cls == ISEL_CLASS_REAL))
+        return reg;
+
+    converted = isel_alloc(cls);
+    src = mop_reg(reg);
+    dst = mop_reg(converted);
+    minstr_emit(code, MI_MOVD, 4, src, dst);
+    isel_free(reg);
+    return converted;
+}
+
+MOPERAND isel_reduce_class(MCODE *code, ISEL_NODE *node, int nt, int cls)
+{
+    MOPERAND operand = isel_reduce(code, node, nt);
+    if (operand.kind == MOP_REG)
+        operand.reg = isel_convert(code, operand.reg, cls);
+    return operand;
+}
+
+// loads the index into a 64-bit register and the vector base into another
+MOPERAND isel_mem_indexed(MCODE *code, HASH *vector, ISEL_NODE *index, int disp)
+{
+    MOPERAND operand;
+    MOPERAND index_reg;
+    MOPERAND base;
+    MOPERAND vector_symbol = mop_hash(vector, 0);
+
+    if (index->rule[ISEL_NT_REG] == ISEL_R_REG_MEM && index->rule[ISEL_NT_MEM] == ISEL_R_MEM_VAR)
+    {
+        MOPERAND src = isel_symbol(index->symbol);
+        index_reg = mop_reg(isel_alloc(ISEL_CLASS_INT));
+        minstr_emit(code, MI_MOVSLQ, 8, src, index_reg);
+    }
+    else
+    {
+        index_reg = isel_reduce_class(code, index, ISEL_NT_REG, ISEL_CLASS_INT);
+        minstr_emit(code, MI_MOVSLQ, 8, index_reg, index_reg);
+    }
+
+    base = mop_reg(isel_alloc(ISEL_CLASS_INT));
+    minstr_emit(code, MI_LEA, 8, vector_symbol, base);
+
+    operand = mop_mem(base.reg, index_reg.reg, 4, disp);
+    return operand;
+}
+
+int isel_opcode(int op, int cls)
+{
+    if (cls == ISEL_CLASS_REAL)
+    {
+        switch (op)
+        {
+        case TAC_ADD:
+            return MI_ADDSS;
+        case TAC_SUB:
+            return MI_SUBSS;
+        case TAC_MUL:
+            return MI_MULSS;
+        case TAC_DIV:
+            return MI_DIVSS;
+        }
+    }
+
+    switch (op)
+    {
+    case TAC_ADD:
+        return MI_ADD;
+    case TAC_SUB:
+        return MI_SUB;
+    case TAC_MUL:
+        return MI_IMUL;
+    case TAC_AND:
+        return MI_AND;
+    case TAC_OR:
+        return MI_OR;
+    }
+
+    return MI_CMP;
+}
+
+int isel_setcc(int op, int swapped)
+{
+    switch (op)
+    {
+    case TAC_LT:
+        return swapped ? CC_G : CC_L;
+    case TAC_LE:
+        return swapped ? CC_GE : CC_LE;
+    case TAC_GT:
+        return swapped ? CC_L : CC_G;
+    case TAC_GE:
+        return swapped ? CC_LE : CC_GE;
+    case TAC_EQ:
+        return CC_E;
+    }
+
+    return CC_NE;
+}
+
+// reduces both kids, evaluating the one that needs more registers first
+void isel_reduce_pair(MCODE *code, ISEL_NODE *node, int nt0, int nt1, int cls, MOPERAND *o0, MOPERAND *o1)
+{
+    if (node->kid[1]->need > node->kid[0]->need)
+    {
+        *o1 = isel_reduce_class(code, node->kid[1], nt1, cls);
+        *o0 = isel_reduce_class(code, node->kid[0], nt0, cls);
+    }
+    else
+    {
+        *o0 = isel_reduce_class(code, node->kid[0], nt0, cls);
+        *o1 = isel_reduce_class(code, node->kid[1], nt1, cls);
+    }
+}
+
+// nonterminals the two kids of a binary rule are reduced to
+void isel_rule_operands(int rule, int *nt0, int *nt1)
+{
+    *nt0 = rule == ISEL_R_REG_MEM_OP ? ISEL_NT_MEM : rule == ISEL_R_REG_CONST_OP ? ISEL_NT_CONST : ISEL_NT_REG;
+    *nt1 = rule == ISEL_R_REG_OP_MEM ? ISEL_NT_MEM : rule == ISEL_R_REG_OP_CONST ? ISEL_NT_CONST : ISEL_NT_REG;
+}
+
+// emits the cmp, comiss or ucomiss of a comparison and returns the condition that holds
+// when it is true; real operands are ordered so that above and above-or-equal are false
+// when unordered, while equality also needs the parity flag clear
+int isel_compare(MCODE *code, ISEL_NODE *node)
+{
+    int oc = isel_operand_class(node);
+    int rule = node->rule[ISEL_NT_REG];
+    MOPERAND left;
+    MOPERAND right;
+    int swapped = rule == ISEL_R_REG_MEM_OP || rule == ISEL_R_REG_CONST_OP;
+    int nt0;
+    int nt1;
+    int cc;
+
+    isel_rule_operands(rule, &nt0, &nt1);
+    isel_reduce_pair(code, node, nt0, nt1, oc, &left, &right);
+
+    if (oc == ISEL_CLASS_INT)
+    {
+        if (swapped)
+            minstr_emit(code, MI_CMP, 4, left, right);
+        else
+            minstr_emit(code, MI_CMP, 4, right, left);
+        cc = isel_setcc(node->op, swapped);
+    }
+    else
+    {
+        // comiss src, dst sets the flags for dst ? src
+        MOPERAND *src = &right;
+        MOPERAND *dst = &left;
+        if (swapped || (rule == ISEL_R_REG_OP_REG && (node->op == TAC_LT || node->op == TAC_LE)))
+        {
+            src = &left;
+            dst = &right;
+        }
+
+        switch (node->op)
+        {
+        case TAC_LT:
+        case TAC_GT:
+            minstr_emit(code, MI_COMISS, 4, *src, *dst);
+            cc = CC_A;
+            break;
+        case TAC_LE:
+        case TAC_GE:
+            minstr_emit(code, MI_COMISS, 4, *src, *dst);
+            cc = CC_AE;
+            break;
+        case TAC_EQ:
+            minstr_emit(code, MI_UCOMISS, 4, *src, *dst);
+            cc = CC_E;
+            break;
+        default:
+            minstr_emit(code, MI_UCOMISS, 4, *src, *dst);
+            cc = CC_NE;
+            break;
+        }
+    }
+
+    isel_release(&left);
+    isel_release(&right);
+    return cc;
+}
+
+int isel_is_unordered_compare(ISEL_NODE *node)
+{
+    return isel_operand_class(node) == ISEL_CLASS_REAL && (node->op == TAC_EQ || node->op == TAC_DIF);
+}
+
+MOPERAND isel_reduce_compare(MCODE *code, ISEL_NODE *node)
+{
+    MOPERAND result;
+    MOPERAND al = mop_reg(REG_RAX);
+    MOPERAND dl = mop_reg(REG_RDX);
+    int unordered = isel_is_unordered_compare(node);
+    int cc = isel_compare(code, node);
+
+    minstr_emit_cc(code, MI_SETCC, cc, al);
+    if (unordered && cc == CC_E)
+    {
+        minstr_emit_cc(code, MI_SETCC, CC_NP, dl);
+        minstr_emit(code, MI_AND, 1, dl, al);
+    }
+    else if (unordered)
+    {
+        minstr_emit_cc(code, MI_SETCC, CC_P, dl);
+        minstr_emit(code, MI_OR, 1, dl, al);
+    }
+
+    result = mop_reg(isel_alloc(ISEL_CLASS_INT));
+    minstr_emit(code, MI_MOVZB, 4, al, result);
+    return result;
+}
+
+MOPERAND isel_reduce(MCODE *code, ISEL_NODE *node, int nt)
+{
+    MOPERAND o0;
+    MOPERAND o1;
+    int rule = node->rule[nt];
+
+    switch (rule)
+    {
+    case ISEL_R_MEM_VAR:
+        return isel_symbol(node->symbol);
+    case ISEL_R_CONST_LIT:
+        return mop_imm(isel_const_value(node));
+    case ISEL_R_REG_CONST:
+    {
+        o0 = mop_reg(isel_alloc(ISEL_CLASS_INT));
+        minstr_emit(code, MI_MOV, 4, mop_imm(isel_const_value(node)), o0);
+        return o0;
+    }
+    case ISEL_R_MEM_VEC_CONST:
+        return mop_hash(node->symbol, 4 * isel_const_value(node->kid[0]));
+    case ISEL_R_MEM_VEC_REG:
+        return isel_mem_indexed(code, node->symbol, node->kid[0], 0);
+    case ISEL_R_MEM_VEC_DISP:
+    {
+        ISEL_NODE *index = node->kid[0];
+        if (index->kid[1]->cost[ISEL_NT_CONST] == 0)
+            return isel_mem_indexed(code, node->symbol, index->kid[0], 4 * isel_const_value(index->kid[1]));
+        return isel_mem_indexed(code, node->symbol, index->kid[1], 4 * isel_const_value(index->kid[0]));
+    }
+    case ISEL_R_REG_MEM:
+    {
+        o0 = isel_reduce(code, node, ISEL_NT_MEM);
+        o1 = mop_reg(isel_alloc(node->cls));
+        minstr_emit(code, node->cls == ISEL_CLASS_REAL ? MI_MOVSS : MI_MOV, 4, o0, o1);
+        isel_release(&o0);
+        return o1;
+    }
+    case ISEL_R_REG_OP_REG:
+    case ISEL_R_REG_OP_MEM:
+    case ISEL_R_REG_MEM_OP:
+    case ISEL_R_REG_OP_CONST:
+    case ISEL_R_REG_CONST_OP:
+    {
+        int nt0;
+        int nt1;
+        if (isel_is_compare(node->op))
+            return isel_reduce_compare(code, node);
+
+        isel_rule_operands(rule, &nt0, &nt1);
+        if (rule == ISEL_R_REG_MEM_OP || rule == ISEL_R_REG_CONST_OP)
+        {
+            // commutative: the memory or constant operand is the left kid
+            isel_reduce_pair(code, node, nt0, nt1, node->cls, &o1, &o0);
+        }
+        else
+        {
+            isel_reduce_pair(code, node, nt0, nt1, node->cls, &o0, &o1);
+        }
+        minstr_emit(code, isel_opcode(node->op, node->cls), 4, o1, o0);
+        isel_release(&o1);
+        return o0;
+    }
+    case ISEL_R_REG_SHIFT:
+    {
+        int k = node->kid[1]->cost[ISEL_NT_CONST] == 0 && isel_log2(isel_const_value(node->kid[1])) > 0 ? 0 : 1;
+        MOPERAND shift = mop_imm(isel_log2(isel_const_value(node->kid[1 - k])));
+        o0 = isel_reduce_class(code, node->kid[k], ISEL_NT_REG, ISEL_CLASS_INT);
+        minstr_emit(code, MI_SHL, 4, shift, o0);
+        return o0;
+    }
+    case ISEL_R_SCALED_MUL:
+    {
+        int k = isel_scale_of(node);
+        o0 = isel_reduce_class(code, node->kid[k], ISEL_NT_REG, ISEL_CLASS_INT);
+        o0.scale = isel_const_value(node->kid[1 - k]);
+        return o0;
+    }
+    case ISEL_R_REG_LEA:
+    case ISEL_R_REG_LEA_FULL:
+    {
+        ISEL_NODE *add = rule == ISEL_R_REG_LEA ? node : node->kid[0];
+        int disp = rule == ISEL_R_REG_LEA ? 0 : isel_const_value(node->kid[1]);
+        int scaled_kid = add->kid[1]->cost[ISEL_NT_SCALED] + add->kid[0]->cost[ISEL_NT_REG] <= add->kid[0]->cost[ISEL_NT_SCALED] + add->kid[1]->cost[ISEL_NT_REG] ? 1 : 0;
+        if (scaled_kid == 1)
+            isel_reduce_pair(code, add, ISEL_NT_REG, ISEL_NT_SCALED, ISEL_CLASS_INT, &o0, &o1);
+        else
+            isel_reduce_pair(code, add, ISEL_NT_SCALED, ISEL_NT_REG, ISEL_CLASS_INT, &o1, &o0);
+
+        minstr_emit(code, MI_LEA, 4, mop_mem(o0.reg, o1.reg, o1.scale, disp), o0);
+        isel_free(o1.reg);
+        return o0;
+    }
+    case ISEL_R_REG_LEA_DISP:
+    {
+        int k = node->kid[1]->cost[ISEL_NT_CONST] == 0 ? 0 : 1;
+        int disp = isel_const_value(node->kid[1 - k]);
+        if (node->op == TAC_SUB)
+            disp = -disp;
+        o0 = isel_reduce_class(code, node->kid[k], ISEL_NT_REG, ISEL_CLASS_INT);
+        minstr_emit(code, MI_LEA, 4, mop_mem(o0.reg, REG_NONE, 0, disp), o0);
+        return o0;
+    }
+    case ISEL_R_REG_UNARY:
+    {
+        o0 = isel_reduce_class(code, node->kid[0], ISEL_NT_REG, isel_operand_class(node));
+        if (node->op == TAC_NOT)
+        {
+            MOPERAND al = mop_reg(REG_RAX);
+            minstr_emit(code, MI_TEST, 4, o0, o0);
+            minstr_emit_cc(code, MI_SETCC, CC_E, al);
+            minstr_emit(code, MI_MOVZB, 4, al, o0);
+            return o0;
+        }
+        if (node->cls == ISEL_CLASS_INT)
+        {
+            minstr_emit(code, MI_NEG, 4, mop_none(), o0);
+            return o0;
+        }
+        o1 = mop_reg(isel_alloc(ISEL_CLASS_REAL));
+        minstr_emit(code, MI_PXOR, 4, o1, o1);
+        minstr_emit(code, MI_SUBSS, 4, o0, o1);
+        isel_release(&o0);
+        return o1;
+    }
+    case ISEL_R_REG_DIV:
+    {
+        int divisor_nt = node->kid[1]->cost[ISEL_NT_MEM] < node->kid[1]->cost[ISEL_NT_REG] ? ISEL_NT_MEM : ISEL_NT_REG;
+        isel_reduce_pair(code, node, ISEL_NT_REG, divisor_nt, node->cls, &o0, &o1);
+        if (node->cls == ISEL_CLASS_REAL)
+        {
+            minstr_emit(code, MI_DIVSS, 4, o1, o0);
+        }
+        else
+        {
+            MOPERAND eax = mop_reg(REG_RAX);
+            minstr_emit(code, MI_MOV, 4, o0, eax);
+            minstr_emit(code, MI_CLTD, 4, mop_none(), mop_none());
+            minstr_emit(code, MI_IDIV, 4, mop_none(), o1);
+            minstr_emit(code, MI_MOV, 4, eax, o0);
+        }
+        isel_release(&o1);
+        return o0;
+    }
+    }
+
+    compiler_fail("isel: no rule for node %d\n", node->op);
+}
+
+void isel_emit_root(MCODE *code, TAC *tac, ISEL_NODE *target, ISEL_NODE *value);
+
+// evaluates subtrees that need too many registers into their own temps first
+ISEL_NODE *isel_cut(MCODE *code, ISEL_NODE *node)
+{
+    int i;
+    if (!node)
+        return NULL;
+    for (i = 0; i < 2; i++)
+    {
+        ISEL_NODE *kid = node->kid[i];
+        if (kid && kid->need > ISEL_MAX_NEED && kid->temp)
+        {
+            isel_cut(code, kid);
+            isel_label(kid, kid->cls);
+            isel_emit_root(code, NULL, isel_node_create(ISEL_VAR, kid->temp->datatype, kid->temp, NULL, NULL), kid);
+            node->kid[i] = isel_node_create(ISEL_VAR, kid->temp->datatype, kid->temp, NULL, NULL);
+        }
+        else if (kid)
+        {
+            isel_cut(code, kid);
+        }
+    }
+    return node;
+}
+
+// the cheapest operand a value can be used from directly
+int isel_operand_nt(ISEL_NODE *value)
+{
+    if (value->cls == ISEL_CLASS_INT && value->cost[ISEL_NT_CONST] == 0)
+        return ISEL_NT_CONST;
+    return value->cost[ISEL_NT_MEM] <= value->cost[ISEL_NT_REG] ? ISEL_NT_MEM : ISEL_NT_REG;
+}
+
+void isel_emit_root(MCODE *code, TAC *tac, ISEL_NODE *target, ISEL_NODE *value)
+{
+    MOPERAND src;
+    MOPERAND dst;
+    int cls = isel_class_of(value->datatype);
+    int nt;
+
+    isel_label(value, cls);
+    if (value->need > ISEL_MAX_NEED)
+    {
+        isel_cut(code, value);
+        isel_label(value, cls);
+    }
+    if (target)
+        isel_label(target, ISEL_CLASS_INT);
+
+    // integer constants are stored straight from the immediate
+    nt = value->cls == ISEL_CLASS_INT && value->cost[ISEL_NT_CONST] == 0 ? ISEL_NT_CONST : ISEL_NT_REG;
+    if (target && target->op == ISEL_VEC && target->need > value->need)
+    {
+        dst = isel_reduce(code, target, ISEL_NT_MEM);
+        src = isel_reduce(code, value, nt);
+    }
+    else if (target)
+    {
+        src = isel_reduce(code, value, nt);
+        dst = isel_reduce(code, target, ISEL_NT_MEM);
+    }
+
+    if (target)
+    {
+        minstr_emit(code, isel_is_xmm(src.reg) ? MI_MOVSS : MI_MOV, 4, src, dst);
+        isel_release(&src);
+        isel_release(&dst);
+        return;
+    }
+
+    switch (tac->type)
+    {
+    case TAC_PRINT_ARG:
+    {
+        if (value->cls == ISEL_CLASS_REAL)
+        {
+            MOPERAND xmm0 = mop_reg(REG_XMM0);
+            src = isel_reduce(code, value, isel_operand_nt(value));
+            minstr_emit(code, MI_MOVSS, 4, src, xmm0);
+            isel_release(&src);
+            minstr_emit(code, MI_CALL, 8, mop_none(), mop_extern("out_real"));
+        }
+        else
+        {
+            MOPERAND edi = mop_reg(REG_RDI);
+            src = isel_reduce(code, value, isel_operand_nt(value));
+            if (!(src.kind == MOP_REG && src.reg == REG_RDI))
+                minstr_emit(code, MI_MOV, 4, src, edi);
+            isel_release(&src);
+            minstr_emit(code, MI_CALL, 8, mop_none(), mop_extern(tac->res->datatype == DATATYPE_CHAR ? "out_char" : "out_int"));
+        }
+        break;
+    }
+    case TAC_RET:
+    {
+        MOPERAND eax = mop_reg(REG_RAX);
+        src = isel_reduce(code, value, isel_operand_nt(value));
+        minstr_emit(code, src.kind == MOP_REG && isel_is_xmm(src.reg) ? MI_MOVD : MI_MOV, 4, src, eax);
+        isel_release(&src);
+        minstr_emit(code, MI_POP, 8, mop_none(), mop_reg(REG_RBP));
+        minstr_emit(code, MI_RET, 8, mop_none(), mop_none());
+        break;
+    }
+    case TAC_JFALSE:
+    {
+        // a comparison used only here branches on its flags; real equality is false when
+        // unordered too, and real inequality only when equal and ordered
+        if (isel_is_compare(value->op))
+        {
+            int unordered = isel_is_unordered_compare(value);
+            int cc = isel_compare(code, value);
+            if (unordered && cc == CC_NE)
+            {
+                char *ordered = (char *)arena_alloc(&code->arena, strlen(tac->res->text) + 32);
+                sprintf(ordered, "_%s_ordered_%d", tac->res->text, compiler->isel->ordered_count++);
+                minstr_emit_cc(code, MI_JCC, CC_P, mop_extern(ordered));
+                minstr_emit_cc(code, MI_JCC, CC_E, mop_label(tac->res));
+                minstr_emit(code, MI_LABEL, 8, mop_none(), mop_extern(ordered));
+                break;
+            }
+            minstr_emit_cc(code, MI_JCC, cc_negate(cc), mop_label(tac->res));
+            if (unordered)
+                minstr_emit_cc(code, MI_JCC, CC_P, mop_label(tac->res));
+            break;
+        }
+        if (value->op == ISEL_VAR && value->cost[ISEL_NT_MEM] == 0)
+        {
+            MOPERAND zero = mop_imm(0);
+            src = isel_reduce(code, value, ISEL_NT_MEM);
+            minstr_emit(code, MI_CMP, 4, zero, src);
+        }
+        else
+        {
+            src = isel_reduce_class(code, value, ISEL_NT_REG, ISEL_CLASS_INT);
+            minstr_emit(code, MI_TEST, 4, src, src);
+        }
+        isel_release(&src);
+        minstr_emit_cc(code, MI_JCC, CC_E, mop_label(tac->res));
+        break;
+    }
+    }
+}
+
+void isel_flush(MCODE *code)
+{
+    int i;
+    for (i = 0; i < compiler->isel->pending_count; i++)
+    {
+        ISEL_NODE *node = compiler->isel->pending[i];
+        isel_emit_root(code, NULL, isel_node_create(ISEL_VAR, node->temp->datatype, node->temp, NULL, NULL), node);
+    }
+    compiler->isel->pending_count = 0;
+}
+
+void isel_reset(void)
+{
+    compiler->isel->pending_count = 0;
+    arena_free(&compiler->isel->arena);
+}
+
+void isel_tac(MCODE *code, TAC *tac)
+{
+    ISEL_NODE *target = NULL;
+    ISEL_NODE *value = NULL;
+
+    if (isel_is_foldable(tac))
+    {
+        ISEL_NODE *node = isel_build(tac);
+        if (compiler->isel->pending_count == ISEL_MAX_PENDING)
+            isel_flush(code);
+        compiler->isel->pending[compiler->isel->pending_count++] = node;
+        return;
+    }
+
+    switch (tac->type)
+    {
+    case TAC_COPY:
+    case TAC_ARG:
+    {
+        if (tac->res->is_vector)
+        {
+            target = isel_node_create(ISEL_VEC, tac->res->datatype, tac->res, isel_operand_tree(tac->op1), NULL);
+            value = isel_operand_tree(tac->op2);
+        }
+        else if (tac->op1->is_vector)
+        {
+            target = isel_node_create(ISEL_VAR, tac->res->datatype, tac->res, NULL, NULL);
+            value = isel_build(tac);
+        }
+        else
+        {
+            target = isel_node_create(ISEL_VAR, tac->res->datatype, tac->res, NULL, NULL);
+            value = isel_operand_tree(tac->op1);
+        }
+        break;
+    }
+    case TAC_PRINT_ARG:
+    case TAC_RET:
+    {
+        value = isel_operand_tree(tac->res);
+        if (tac->type == TAC_PRINT_ARG)
+            value->datatype = tac->res->datatype;
+        break;
+    }
+    case TAC_JFALSE:
+    {
+        value = isel_operand_tree(tac->op1);
+        break;
+    }
+    default:
+    {
+        // expression whose temp is used more than once
+        target = isel_node_create(ISEL_VAR, tac->res->datatype, tac->res, NULL, NULL);
+        value = isel_build(tac);
+        break;
+    }
+    }
+
+    isel_flush(code);
+    isel_emit_root(code, tac, target, value);
+}
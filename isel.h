@@ -0,0 +1,96 @@
+#pragma once
+#include "tac.h"
+#include "minstr.h"
+#include "arena.h"
+
+// tree node kinds that do not map to a TAC operation
+#define ISEL_VAR 100
+#define ISEL_VEC 101
+
+// nonterminals of the tiling grammar
+#define ISEL_NT_REG 0
+#define ISEL_NT_MEM 1
+#define ISEL_NT_CONST 2
+#define ISEL_NT_SCALED 3
+#define ISEL_NT_COUNT 4
+
+// tiling rules
+#define ISEL_R_NONE 0
+#define ISEL_R_MEM_VAR 1       // mem:    VAR
+#define ISEL_R_CONST_LIT 2     // const:  VAR (integer or char literal)
+#define ISEL_R_MEM_VEC_CONST 3 // mem:    VEC(const)            -> disp+_v(%rip)
+#define ISEL_R_MEM_VEC_REG 4   // mem:    VEC(reg)              -> (base,index,4)
+#define ISEL_R_MEM_VEC_DISP 5  // mem:    VEC(ADD(reg,const))   -> disp(base,index,4)
+#define ISEL_R_REG_MEM 6       // reg:    mem
+#define ISEL_R_REG_OP_MEM 7    // reg:    OP(reg,mem)
+#define ISEL_R_REG_OP_REG 8    // reg:    OP(reg,reg)
+#define ISEL_R_REG_MEM_OP 9    // reg:    OP(mem,reg), OP commutative
+#define ISEL_R_REG_SHIFT 10    // reg:    MUL(reg,const 2^k)    -> shl
+#define ISEL_R_SCALED_MUL 11   // scaled: MUL(reg,const 1|2|4|8)
+#define ISEL_R_REG_LEA 12      // reg:    ADD(reg,scaled)       -> lea (b,i,s)
+#define ISEL_R_REG_LEA_DISP 13 // reg:    ADD(reg,const)        -> lea c(b)
+#define ISEL_R_REG_LEA_FULL 14 // reg:    ADD(ADD(reg,scaled),const) -> lea c(b,i,s)
+#define ISEL_R_REG_UNARY 15    // reg:    NEG(reg) | NOT(reg)
+#define ISEL_R_REG_DIV 16      // reg:    DIV(reg,mem|reg)
+#define ISEL_R_REG_CONST 17    // reg:    const                 -> mov $c
+#define ISEL_R_REG_OP_CONST 18 // reg:    OP(reg,const)         -> op $c
+#define ISEL_R_REG_CONST_OP 19 // reg:    OP(const,reg), OP commutative
+
+// cost table columns
+#define ISEL_COST_LOAD 0
+#define ISEL_COST_STORE 1
+#define ISEL_COST_ALU 2
+#define ISEL_COST_MUL 3
+#define ISEL_COST_DIV 4
+#define ISEL_COST_SHIFT 5
+#define ISEL_COST_LEA 6
+#define ISEL_COST_CMP 7
+#define ISEL_COST_ADDR 8
+#define ISEL_COST_COUNT 9
+
+#define ISEL_INFINITE 1000000
+
+// register classes
+#define ISEL_CLASS_INT 0
+#define ISEL_CLASS_REAL 1
+
+#define ISEL_MAX_PENDING 256
+
+typedef struct isel_node
+{
+    int op;       // TAC_* operation, ISEL_VAR or ISEL_VEC
+    int datatype;
+    int cls;      // register class the value is computed in
+    HASH *symbol; // leaf symbol or vector base
+    HASH *temp;   // temp defined by the TAC this node was built from
+    struct isel_node *kid[2];
+    int cost[ISEL_NT_COUNT];
+    int rule[ISEL_NT_COUNT];
+    int need;     // registers needed to evaluate (Sethi-Ullman)
+} ISEL_NODE;
+
+// selector state of one compilation
+typedef struct isel_state
+{
+    int reg_used[REG_COUNT];
+    ARENA arena; // trees are rebuilt per root, their nodes are released together at the end
+    ISEL_NODE *pending[ISEL_MAX_PENDING];
+    int pending_count;
+    int ordered_count; // labels that skip a branch on unordered real operands
+} ISEL_STATE;
+
+void isel_count_uses(TAC *first);
+int isel_accepts(TAC *tac);
+int isel_is_expression(TAC *tac);
+int isel_is_string_arg(TAC *tac);
+void isel_tac(MCODE *code, TAC *tac);
+void isel_flush(MCODE *code);
+void isel_reset(void);
+
+int isel_is_literal(HASH *symbol);
+int isel_literal_value(HASH *symbol);
+MOPERAND isel_symbol(HASH *symbol);
+ISEL_NODE *isel_node_create(int op, int datatype, HASH *symbol, ISEL_NODE *k0, ISEL_NODE *k1);
+ISEL_NODE *isel_operand_tree(HASH *symbol);
+void isel_label(ISEL_NODE *node, int cls);
+MOPERAND isel_reduce(MCODE *code, ISEL_NODE *node, int nt);
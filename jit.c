@@ -0,0 +1,305 @@
+#include <sys/mman.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include "jit.h"
+#include "runtime.h"
+
+// tiered code is compiled without the runtime and shares stdio with the interpreter
+void jit_out_int(int value)
+{
+    printf("%d", value);
+}
+
+void jit_out_real(float value)
+{
+    printf("%f", (double)value);
+}
+
+void jit_out_char(int value)
+{
+    putchar(value);
+}
+
+void jit_out_string(char *text)
+{
+    fputs(text, stdout);
+}
+
+// walks an out_format descriptor, see runtime.h
+void jit_out_format(unsigned char *format, int i0, int i1, int i2, int i3, int i4,
+                    float r0, float r1, float r2, float r3, float r4, float r5, float r6, float r7)
+{
+    int ints[RUNTIME_FORMAT_INTS] = {i0, i1, i2, i3, i4};
+    float reals[RUNTIME_FORMAT_REALS] = {r0, r1, r2, r3, r4, r5, r6, r7};
+    int next_int = 0;
+    int next_real = 0;
+
+    for (;;)
+    {
+        switch (*format++)
+        {
+        case RUNTIME_FORMAT_INT:
+            printf("%d", ints[next_int++]);
+            break;
+        case RUNTIME_FORMAT_CHAR:
+            putchar(ints[next_int++]);
+            break;
+        case RUNTIME_FORMAT_REAL:
+            printf("%f", (double)reals[next_real++]);
+            break;
+        case RUNTIME_FORMAT_TEXT:
+            fputs((char *)format, stdout);
+            format += strlen((char *)format) + 1;
+            break;
+        default:
+            return;
+        }
+    }
+}
+
+void jit_out_flush(void)
+{
+    fflush(stdout);
+}
+
+void jit_in_int(int *value)
+{
+    scanf("%d", value);
+}
+
+void jit_in_real(float *value)
+{
+    scanf("%f", value);
+}
+
+void jit_in_char(char *value)
+{
+    scanf(" %c", value);
+}
+
+// host libc entry points the generated code may call
+JIT_EXTERN jit_externs[] = {
+    {"read", (void *)read},
+    {"write", (void *)write},
+    {"open", (void *)open},
+    {"close", (void *)close},
+    {"strtof", (void *)strtof},
+    {"snprintf", (void *)snprintf},
+    {"atexit", (void *)atexit},
+    {"out_int", (void *)jit_out_int},
+    {"out_real", (void *)jit_out_real},
+    {"out_char", (void *)jit_out_char},
+    {"out_string", (void *)jit_out_string},
+    {"out_format", (void *)jit_out_format},
+    {"out_flush", (void *)jit_out_flush},
+    {"in_int", (void *)jit_in_int},
+    {"in_real", (void *)jit_in_real},
+    {"in_char", (void *)jit_in_char},
+};
+
+#define JIT_EXTERN_COUNT (int)(sizeof(jit_externs) / sizeof(jit_externs[0]))
+
+size_t jit_page_align(size_t size)
+{
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    return (size + page - 1) & ~(page - 1);
+}
+
+void *jit_extern_address(char *name)
+{
+    int i;
+    for (i = 0; i < JIT_EXTERN_COUNT; i++)
+    {
+        if (strcmp(jit_externs[i].name, name) == 0)
+            return jit_externs[i].address;
+    }
+    return NULL;
+}
+
+// libc is usually out of rel32 range, so every external gets an absolute stub
+unsigned char *jit_stub(unsigned char *stubs, int *stub_count, XSYMBOL *symbol)
+{
+    unsigned char *stub;
+    void *address;
+    if (symbol->offset > 0)
+        return stubs + (symbol->offset - 1) * JIT_STUB_SIZE;
+
+    address = jit_extern_address(symbol->name);
+    if (!address || *stub_count == JIT_MAX_STUBS)
+    {
+        compiler_fail("jit: unresolved symbol %s\n", symbol->name);
+    }
+
+    stub = stubs + *stub_count * JIT_STUB_SIZE;
+    stub[0] = 0xFF;
+    stub[1] = 0x25;
+    memset(stub + 2, 0, 4);
+    memcpy(stub + 6, &address, sizeof(address));
+    symbol->offset = ++*stub_count;
+    return stub;
+}
+
+void jit_perf_map(XOBJECT *obj, unsigned char *text, unsigned char *stubs)
+{
+    char path[64];
+    FILE *map;
+    XSYMBOL *symbol;
+
+    sprintf(path, "/tmp/perf-%d.map", (int)getpid());
+    map = fopen(path, "w");
+    if (!map)
+        return;
+
+    for (symbol = obj->first_symbol; symbol; symbol = symbol->next_list)
+    {
+        if (symbol->section == XSEC_TEXT && symbol->type == XSYM_FUNC)
+        {
+            // a function runs up to the next function or the end of .text
+            int end = obj->section[XSEC_TEXT].length;
+            XSYMBOL *next;
+            for (next = obj->first_symbol; next; next = next->next_list)
+            {
+                if (next->section == XSEC_TEXT && next->type == XSYM_FUNC && next->offset > symbol->offset && next->offset < end)
+                    end = next->offset;
+            }
+            fprintf(map, "%lx %x %s\n", (unsigned long)(text + symbol->offset), end - symbol->offset, symbol->name);
+        }
+        else if (symbol->section == XSEC_UNDEF && symbol->offset > 0)
+        {
+            fprintf(map, "%lx %x stub:%s\n", (unsigned long)(stubs + (symbol->offset - 1) * JIT_STUB_SIZE), JIT_STUB_SIZE, symbol->name);
+        }
+    }
+    fclose(map);
+}
+
+// patches every relocation once each section sits at base + offset[section];
+// undefined symbols go to their bound address or through an absolute stub
+void jit_relocate(XOBJECT *obj, unsigned char *base, size_t *offset, unsigned char *stubs)
+{
+    XSYMBOL *symbol;
+    int stub_count = 0;
+    int i;
+
+    // undefined symbols use offset to remember their stub slot
+    for (symbol = obj->first_symbol; symbol; symbol = symbol->next_list)
+    {
+        if (symbol->section == XSEC_UNDEF)
+            symbol->offset = 0;
+    }
+
+    for (i = 0; i < obj->reloc_count; i++)
+    {
+        XRELOC *reloc = &obj->relocs[i];
+        unsigned char *site = base + offset[reloc->section] + reloc->offset;
+        unsigned char *target;
+        long value;
+        int value32;
+        if (reloc->symbol->section != XSEC_UNDEF)
+            target = base + offset[reloc->symbol->section] + reloc->symbol->offset;
+        else if (reloc->symbol->address)
+            target = (unsigned char *)reloc->symbol->address;
+        else
+            target = jit_stub(stubs, &stub_count, reloc->symbol);
+
+        value = (long)(target + reloc->addend - site);
+        value32 = (int)value;
+        if (value32 != value)
+        {
+            compiler_fail("jit: relocation to %s out of range\n", reloc->symbol->name);
+        }
+        memcpy(site, &value32, sizeof(value32));
+    }
+}
+
+// lays text, stubs and data out in one mapping, links it and calls main
+int jit_run(XOBJECT *obj)
+{
+    size_t text_size = jit_page_align(obj->section[XSEC_TEXT].length + JIT_MAX_STUBS * JIT_STUB_SIZE);
+    size_t data_offset[XSEC_COUNT];
+    size_t data_size = 0;
+    unsigned char *region;
+    unsigned char *stubs;
+    XSYMBOL *main_symbol = NULL;
+    XSYMBOL *symbol;
+    int (*entry)(void);
+    int i;
+
+    for (i = XSEC_DATA; i < XSEC_COUNT; i++)
+    {
+        data_offset[i] = text_size + data_size;
+        data_size += (x86_section_size(obj, i) + 15) & ~(size_t)15;
+    }
+    data_offset[XSEC_TEXT] = 0;
+
+    region = (unsigned char *)mmap(NULL, text_size + jit_page_align(data_size ? data_size : 1), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (region == MAP_FAILED)
+    {
+        compiler_fail("jit: mmap failed\n");
+    }
+    stubs = region + obj->section[XSEC_TEXT].length;
+
+    for (i = XSEC_TEXT; i < XSEC_BSS; i++)
+    {
+        if (obj->section[i].length)
+            memcpy(region + data_offset[i], obj->section[i].data, obj->section[i].length);
+    }
+
+    for (symbol = obj->first_symbol; symbol; symbol = symbol->next_list)
+    {
+        if (symbol->section == XSEC_TEXT && strcmp(symbol->name, "main") == 0)
+            main_symbol = symbol;
+    }
+    jit_relocate(obj, region, data_offset, stubs);
+
+    if (!main_symbol)
+    {
+        compiler_fail("jit: no main function\n");
+    }
+
+    if (mprotect(region, text_size, PROT_READ | PROT_EXEC) != 0)
+    {
+        compiler_fail("jit: mprotect failed\n");
+    }
+    jit_perf_map(obj, region, stubs);
+
+    entry = (int (*)(void))(region + main_symbol->offset);
+    i = entry();
+    fflush(stdout);
+    return i;
+}
+
+// appends an object to a reserved code space and returns where its text starts;
+// everything it places becomes read-only, so writable data must be bound outside
+unsigned char *jit_load(JIT_SPACE *space, XOBJECT *obj)
+{
+    size_t offset[XSEC_COUNT];
+    size_t size = obj->section[XSEC_TEXT].length + JIT_MAX_STUBS * JIT_STUB_SIZE;
+    unsigned char *start = space->base + space->used;
+    int i;
+
+    offset[XSEC_TEXT] = space->used;
+    for (i = XSEC_DATA; i < XSEC_COUNT; i++)
+    {
+        offset[i] = space->used + size;
+        size += (x86_section_size(obj, i) + 15) & ~(size_t)15;
+    }
+    size = jit_page_align(size);
+    if (space->used + size > space->size)
+    {
+        compiler_fail("jit: code space exhausted\n");
+    }
+
+    for (i = XSEC_TEXT; i < XSEC_BSS; i++)
+    {
+        if (obj->section[i].length)
+            memcpy(space->base + offset[i], obj->section[i].data, obj->section[i].length);
+    }
+    jit_relocate(obj, space->base, offset, start + obj->section[XSEC_TEXT].length);
+
+    if (mprotect(start, size, PROT_READ | PROT_EXEC) != 0)
+    {
+        compiler_fail("jit: mprotect failed\n");
+    }
+    space->used += size;
+    return start;
+}
@@ -0,0 +1,23 @@
+#pragma once
+#include "x86enc.h"
+
+// one stub per external: jmp *slot(%rip) followed by the 8-byte slot
+#define JIT_STUB_SIZE 16
+#define JIT_MAX_STUBS 16
+
+typedef struct jit_extern
+{
+    char *name;
+    void *address;
+} JIT_EXTERN;
+
+// executable memory handed out to objects loaded one after another
+typedef struct jit_space
+{
+    unsigned char *base;
+    size_t size;
+    size_t used;
+} JIT_SPACE;
+
+int jit_run(XOBJECT *obj);
+unsigned char *jit_load(JIT_SPACE *space, XOBJECT *obj);
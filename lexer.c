@@ -0,0 +1,460 @@
+#include "lexer.h"
+
+size_t lexer_comment_text(const char *s, const char *end)
+{
+    const char *p = s;
+    while (p < end && *p != '\n' && *p != '/')
+        p++;
+    return p - s;
+}
+
+size_t lexer_any(const char *s, const char *end)
+{
+    return s < end && *s != '\n';
+}
+
+// \\, one character that is not \, then the rest of the line with its newline
+size_t lexer_line_comment(const char *s, const char *end)
+{
+    const char *p = s + 3;
+    if (end - s < 3 || s[0] != '\\' || s[1] != '\\' || s[2] == '\\')
+        return 0;
+    while (p < end && *p != '\n')
+        p++;
+    return p < end ? p + 1 - s : 0;
+}
+
+size_t lexer_digits(const char *s, const char *end)
+{
+    const char *p = s;
+    while (p < end && *p >= '0' && *p <= '9')
+        p++;
+    return p - s;
+}
+
+size_t lexer_char(const char *s, const char *end)
+{
+    return end - s >= 3 && s[0] == '\'' && s[1] != '\'' && s[2] == '\'' ? 3 : 0;
+}
+
+size_t lexer_real(const char *s, const char *end)
+{
+    size_t whole = lexer_digits(s, end);
+    size_t fraction;
+    if (!whole || s + whole >= end || s[whole] != '.')
+        return 0;
+    fraction = lexer_digits(s + whole + 1, end);
+    return fraction ? whole + 1 + fraction : 0;
+}
+
+// a quote inside the string must follow a backslash, and the string ends at the last
+// quote reachable that way
+size_t lexer_string(const char *s, const char *end)
+{
+    const char *p;
+    size_t length = 0;
+    if (s >= end || *s != '"')
+        return 0;
+    for (p = s + 1; p < end && *p != '\n'; p++)
+    {
+        if (*p != '"')
+            continue;
+        length = p + 1 - s;
+        if (p[-1] != '\\' || p - 1 == s)
+            break;
+    }
+    return length;
+}
+
+size_t lexer_name(const char *s, const char *end)
+{
+    const char *p = s;
+    while (p < end && ((*p >= 'a' && *p <= 'z') || (*p >= 'A' && *p <= 'Z') || *p == '.' || *p == '_'))
+        p++;
+    return p - s;
+}
+
+size_t lexer_punctuation(const char *s, const char *end)
+{
+    return s < end && *s && strchr(",;()[]{}=+-*/%<>&|~", *s) ? 1 : 0;
+}
+
+size_t lexer_blank(const char *s, const char *end)
+{
+    return s < end && (*s == '\n' || *s == '\t' || *s == ' ');
+}
+
+size_t lexer_newline(const char *s, const char *end)
+{
+    return s < end && *s == '\n';
+}
+
+#define LEXER_DIGITS "0123456789"
+#define LEXER_LETTERS "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ._"
+#define LEXER_PUNCTUATION ",;()[]{}=+-*/%<>&|~"
+
+// scanner.l in its order; first lists the characters a match can begin with, and a rule
+// without it can begin with any
+LEXER_RULE lexer_rules[] = {
+    {.comment = 1, .text = "///", .action = LEXER_END_COMMENT},
+    {.comment = 1, .match = lexer_comment_text, .action = LEXER_IGNORE},
+    {.comment = 1, .match = lexer_newline, .first = "\n", .action = LEXER_NEWLINE},
+    {.comment = 1, .match = lexer_any, .action = LEXER_IGNORE},
+    {.text = "\\\\\\", .action = LEXER_BEGIN_COMMENT},
+    {.match = lexer_line_comment, .first = "\\", .action = LEXER_LINE_COMMENT},
+
+    {.text = "char", .action = LEXER_RETURN, .token = KW_CHAR},
+    {.text = "int", .action = LEXER_RETURN, .token = KW_INT},
+    {.text = "real", .action = LEXER_RETURN, .token = KW_REAL},
+    {.text = "bool", .action = LEXER_RETURN, .token = KW_BOOL},
+    {.text = "if", .action = LEXER_RETURN, .token = KW_IF},
+    {.text = "else", .action = LEXER_RETURN, .token = KW_ELSE},
+    {.text = "loop", .action = LEXER_RETURN, .token = KW_LOOP},
+    {.text = "input", .action = LEXER_RETURN, .token = KW_INPUT},
+    {.text = "output", .action = LEXER_RETURN, .token = KW_OUTPUT},
+    {.text = "return", .action = LEXER_RETURN, .token = KW_RETURN},
+
+    {.text = "<=", .action = LEXER_RETURN, .token = OPERATOR_LE},
+    {.text = ">=", .action = LEXER_RETURN, .token = OPERATOR_GE},
+    {.text = "==", .action = LEXER_RETURN, .token = OPERATOR_EQ},
+    {.text = "!=", .action = LEXER_RETURN, .token = OPERATOR_DIF},
+
+    {.match = lexer_digits, .first = LEXER_DIGITS, .action = LEXER_SYMBOL,
+      .token = LIT_INT, .symbol_type = SYMBOL_LIT_INTEGER, .datatype = DATATYPE_INT},
+    {.match = lexer_char, .first = "'", .action = LEXER_SYMBOL,
+      .token = LIT_CHAR, .symbol_type = SYMBOL_LIT_CHAR, .datatype = DATATYPE_CHAR},
+    {.match = lexer_real, .first = LEXER_DIGITS, .action = LEXER_SYMBOL,
+      .token = LIT_REAL, .symbol_type = SYMBOL_LIT_REAL, .datatype = DATATYPE_REAL},
+    {.match = lexer_string, .first = "\"", .action = LEXER_SYMBOL,
+      .token = LIT_STRING, .symbol_type = SYMBOL_LIT_STRING},
+
+    {.match = lexer_name, .first = LEXER_LETTERS, .action = LEXER_SYMBOL,
+      .token = TK_IDENTIFIER, .symbol_type = SYMBOL_IDENTIFIER},
+    {.match = lexer_punctuation, .first = LEXER_PUNCTUATION, .action = LEXER_CHAR},
+
+    {.match = lexer_blank, .first = " \t\n", .action = LEXER_NEWLINE},
+
+    {.match = lexer_any, .action = LEXER_RETURN, .token = TOKEN_ERROR},
+};
+
+#define LEXER_RULE_COUNT (int)(sizeof(lexer_rules) / sizeof(lexer_rules[0]))
+
+// for each character, the rules that can match at it, in order
+unsigned char lexer_candidates[256][LEXER_RULE_COUNT];
+int lexer_candidate_count[256];
+pthread_once_t lexer_once = PTHREAD_ONCE_INIT;
+
+void lexer_init(void)
+{
+    int c;
+    int i;
+    for (i = 0; i < LEXER_RULE_COUNT; i++)
+    {
+        LEXER_RULE *rule = &lexer_rules[i];
+        if (rule->text)
+            rule->length = strlen(rule->text);
+        for (c = 0; c < 256; c++)
+        {
+            if (rule->text ? c == (unsigned char)rule->text[0] : !rule->first || (c && strchr(rule->first, c)))
+                lexer_candidates[c][lexer_candidate_count[c]++] = i;
+        }
+    }
+}
+
+void lexer_add(LEXER_CHUNK *chunk, LEXER_RULE *rule, int token, const char *text, size_t length)
+{
+    LEXER_TOKEN *added;
+    if (chunk->count == chunk->size)
+    {
+        chunk->size = chunk->size ? 2 * chunk->size : 1024;
+        chunk->tokens = (LEXER_TOKEN *)realloc(chunk->tokens, chunk->size * sizeof(LEXER_TOKEN));
+    }
+    added = &chunk->tokens[chunk->count++];
+    added->token = token;
+    added->rule = rule;
+    added->line = chunk->lines;
+    added->text = text;
+    added->length = (int)length;
+}
+
+// tokenizes the chunk the way the flex scanner would from its state: the longest match
+// of the active rules, the first of them on a tie
+void lexer_chunk_run(LEXER_CHUNK *chunk)
+{
+    const char *s = chunk->start;
+    int state = chunk->state;
+
+    chunk->count = 0;
+    chunk->lines = 0;
+    while (s < chunk->end)
+    {
+        LEXER_RULE *best = NULL;
+        size_t best_length = 0;
+        int i;
+
+        unsigned char c = *s;
+        for (i = 0; i < lexer_candidate_count[c]; i++)
+        {
+            LEXER_RULE *rule = &lexer_rules[lexer_candidates[c][i]];
+            size_t length;
+            if (rule->comment && state != LEXER_COMMENT)
+                continue;
+            if (rule->text)
+            {
+                length = rule->length;
+                if ((size_t)(chunk->end - s) < length || memcmp(s, rule->text, length) != 0)
+                    continue;
+            }
+            else
+                length = rule->match(s, chunk->end);
+            if (length > best_length)
+            {
+                best = rule;
+                best_length = length;
+            }
+        }
+
+        switch (best->action)
+        {
+        case LEXER_NEWLINE:
+            if (s[0] == '\n')
+                chunk->lines++;
+            break;
+        case LEXER_BEGIN_COMMENT:
+            state = LEXER_COMMENT;
+            break;
+        case LEXER_END_COMMENT:
+            state = LEXER_INITIAL;
+            break;
+        case LEXER_LINE_COMMENT:
+            chunk->lines++;
+            break;
+        case LEXER_RETURN:
+        case LEXER_SYMBOL:
+            lexer_add(chunk, best, best->token, s, best_length);
+            break;
+        case LEXER_CHAR:
+            lexer_add(chunk, best, s[0], s, best_length);
+            break;
+        }
+        s += best_length;
+    }
+    chunk->end_state = state;
+}
+
+void *lexer_worker(void *argument)
+{
+    LEXER_JOBS *jobs = (LEXER_JOBS *)argument;
+    for (;;)
+    {
+        int i;
+        pthread_mutex_lock(&jobs->lock);
+        i = jobs->next++;
+        pthread_mutex_unlock(&jobs->lock);
+        if (i >= jobs->count)
+            return NULL;
+        lexer_chunk_run(&jobs->chunks[i]);
+    }
+}
+
+// chunks of about chunk_size bytes, each ending after a newline that no token runs
+// across: a char literal or a line comment only takes in a newline that follows a quote
+// or a backslash
+LEXER_CHUNK *lexer_split(const char *source, size_t length, int chunk_size, int *count)
+{
+    LEXER_CHUNK *chunks = NULL;
+    size_t start = 0;
+    int size = 0;
+
+    *count = 0;
+    while (start < length)
+    {
+        size_t end = start + chunk_size < length ? start + chunk_size : length;
+        while (end < length && (source[end - 1] != '\n' || source[end - 2] == '\\' || source[end - 2] == '\''))
+            end++;
+        if (*count == size)
+        {
+            size = size ? 2 * size : 16;
+            chunks = (LEXER_CHUNK *)realloc(chunks, size * sizeof(LEXER_CHUNK));
+        }
+        memset(&chunks[*count], 0, sizeof(LEXER_CHUNK));
+        chunks[*count].start = source + start;
+        chunks[(*count)++].end = source + end;
+        start = end;
+    }
+    return chunks;
+}
+
+// lexes source in chunks on up to jobs threads, each from the initial state; a chunk that
+// actually starts inside a comment is lexed again once the one before it is known. The
+// symbols are inserted as the parser takes them, as with the scanner
+LEXER_STREAM *lexer_stream(const char *source, size_t length, int chunk_size, int jobs)
+{
+    LEXER_JOBS work;
+    LEXER_STREAM *stream = (LEXER_STREAM *)calloc(1, sizeof(LEXER_STREAM));
+    pthread_t threads[LEXER_MAX_THREADS];
+    int state = LEXER_INITIAL;
+    int line = compiler->line_number;
+    int total = 0;
+    int i;
+    int j;
+
+    pthread_once(&lexer_once, lexer_init);
+    memset(&work, 0, sizeof(work));
+    work.chunks = lexer_split(source, length, chunk_size > 2 ? chunk_size : 2, &work.count);
+    pthread_mutex_init(&work.lock, NULL);
+
+    if (jobs > LEXER_MAX_THREADS)
+        jobs = LEXER_MAX_THREADS;
+    if (jobs > work.count)
+        jobs = work.count;
+    if (jobs <= 1)
+        lexer_worker(&work);
+    else
+    {
+        for (i = 0; i < jobs; i++)
+            pthread_create(&threads[i], NULL, lexer_worker, &work);
+        for (i = 0; i < jobs; i++)
+            pthread_join(threads[i], NULL);
+    }
+
+    for (i = 0; i < work.count; i++)
+    {
+        if (work.chunks[i].state != state)
+        {
+            work.chunks[i].state = state;
+            lexer_chunk_run(&work.chunks[i]);
+        }
+        state = work.chunks[i].end_state;
+        total += work.chunks[i].count;
+    }
+
+    stream->tokens = (LEXER_TOKEN *)malloc((total ? total : 1) * sizeof(LEXER_TOKEN));
+    for (i = 0; i < work.count; i++)
+    {
+        LEXER_CHUNK *chunk = &work.chunks[i];
+        for (j = 0; j < chunk->count; j++)
+        {
+            LEXER_TOKEN *token = &stream->tokens[stream->count++];
+            *token = chunk->tokens[j];
+            token->line += line;
+        }
+        line += chunk->lines;
+        free(chunk->tokens);
+    }
+    stream->lines = line;
+
+    free(work.chunks);
+    pthread_mutex_destroy(&work.lock);
+    return stream;
+}
+
+// the flex scanner keeps its state in globals, so one thread at a time runs it; it only
+// lexes, and the parse reads its tokens as those of the chunks
+pthread_mutex_t lexer_scanner_lock = PTHREAD_MUTEX_INITIALIZER;
+
+// the rule of lexer_rules that inserts the text of token, or NULL
+LEXER_RULE *lexer_symbol_rule(int token)
+{
+    int i;
+    for (i = 0; i < LEXER_RULE_COUNT; i++)
+    {
+        if (lexer_rules[i].action == LEXER_SYMBOL && lexer_rules[i].token == token)
+            return &lexer_rules[i];
+    }
+    return NULL;
+}
+
+// the tokens of source as the flex scanner gives them; the text of a symbol is copied to
+// the arena, since the scanner's buffer goes with it
+LEXER_STREAM *lexer_scan(const char *source, size_t length)
+{
+    LEXER_STREAM *stream = (LEXER_STREAM *)calloc(1, sizeof(LEXER_STREAM));
+    LEXER_CHUNK chunk;
+    int first_line = compiler->line_number;
+    int is_running = compiler->is_running;
+    int token;
+
+    pthread_once(&lexer_once, lexer_init);
+    memset(&chunk, 0, sizeof(chunk));
+    pthread_mutex_lock(&lexer_scanner_lock);
+    yy_scan_bytes(source, (int)length);
+    while ((token = (yylex)()) != 0)
+    {
+        LEXER_RULE *rule = lexer_symbol_rule(token);
+        char *text = NULL;
+        if (rule)
+        {
+            text = (char *)arena_alloc(&compiler->arena, yyleng + 1);
+            memcpy(text, yytext, yyleng + 1);
+        }
+        chunk.lines = compiler->line_number;
+        lexer_add(&chunk, rule, token, text, rule ? yyleng : 0);
+    }
+    yylex_destroy();
+    pthread_mutex_unlock(&lexer_scanner_lock);
+
+    stream->tokens = chunk.tokens;
+    stream->count = chunk.count;
+    stream->lines = compiler->line_number;
+    compiler->line_number = first_line;
+    compiler->is_running = is_running;
+    return stream;
+}
+
+// a token a line, with its line, its number and the text of a symbol, then the lines of
+// the source; both lexers give the same list
+void lexer_print(LEXER_STREAM *stream, FILE *out)
+{
+    int i;
+    for (i = 0; i < stream->count; i++)
+    {
+        LEXER_TOKEN *token = &stream->tokens[i];
+        fprintf(out, "%d %d", token->line, token->token);
+        if (token->rule && token->rule->action == LEXER_SYMBOL)
+            fprintf(out, " %.*s", token->length, token->text);
+        fputc('\n', out);
+    }
+    fprintf(out, "lines %d\n", stream->lines);
+}
+
+void lexer_stream_free(LEXER_STREAM *stream)
+{
+    if (!stream)
+        return;
+    free(stream->tokens);
+    free(stream->text);
+    free(stream);
+}
+
+HASH *lexer_insert(LEXER_STREAM *stream, LEXER_TOKEN *token)
+{
+    if (token->length >= stream->text_size)
+    {
+        stream->text_size = 2 * token->length + 64;
+        stream->text = (char *)realloc(stream->text, stream->text_size);
+    }
+    memcpy(stream->text, token->text, token->length);
+    stream->text[token->length] = 0;
+    return hash_insert(stream->text, token->rule->symbol_type, token->rule->datatype);
+}
+
+// the parser's yylex: the next token of the context's stream, whose text is inserted into
+// the symbols as the parser takes it
+int lexer_next(YYSTYPE *value)
+{
+    LEXER_STREAM *stream = compiler->tokens;
+    LEXER_TOKEN *token;
+
+    if (stream->next == stream->count)
+    {
+        compiler->line_number = stream->lines;
+        yywrap();
+        return 0;
+    }
+    token = &stream->tokens[stream->next++];
+    compiler->line_number = token->line;
+    if (token->rule && token->rule->action == LEXER_SYMBOL)
+        value->symbol = lexer_insert(stream, token);
+    return token->token;
+}
@@ -0,0 +1,84 @@
+#pragma once
+#include <pthread.h>
+#include "hash.h"
+#include "compiler.h"
+
+#define LEXER_CHUNK_SIZE (1 << 20)
+#define LEXER_MAX_THREADS 64
+
+// start conditions of scanner.l
+#define LEXER_INITIAL 0
+#define LEXER_COMMENT 1
+
+// what a rule does with its match, as the actions of scanner.l
+#define LEXER_IGNORE 0
+#define LEXER_NEWLINE 1       // counts the line when the match is a newline
+#define LEXER_BEGIN_COMMENT 2
+#define LEXER_END_COMMENT 3
+#define LEXER_LINE_COMMENT 4  // counts one line
+#define LEXER_RETURN 5        // returns token
+#define LEXER_SYMBOL 6        // inserts the text as symbol_type and returns token
+#define LEXER_CHAR 7          // returns the character
+
+// one rule of scanner.l: a fixed text, or a function giving the length it matches at s
+typedef struct lexer_rule
+{
+    int comment; // active only in LEXER_COMMENT; the others are active in both (%s)
+    const char *text;
+    size_t (*match)(const char *s, const char *end);
+    const char *first;
+    int action;
+    int token;
+    int symbol_type;
+    int datatype;
+    size_t length; // of text
+} LEXER_RULE;
+
+// lines count from the start of the chunk until the chunks are joined
+typedef struct lexer_token
+{
+    int token;
+    LEXER_RULE *rule;
+    int line;
+    const char *text;
+    int length;
+} LEXER_TOKEN;
+
+// text lexed from start, assumed to begin in state, into tokens
+typedef struct lexer_chunk
+{
+    const char *start;
+    const char *end;
+    int state;
+    int end_state;
+    int lines;
+    LEXER_TOKEN *tokens;
+    int count;
+    int size;
+} LEXER_CHUNK;
+
+// workers take the next chunk under lock
+typedef struct lexer_jobs
+{
+    LEXER_CHUNK *chunks;
+    int count;
+    int next;
+    pthread_mutex_t lock;
+} LEXER_JOBS;
+
+// the tokens of a whole source, which the parser reads
+typedef struct lexer_stream
+{
+    LEXER_TOKEN *tokens;
+    int count;
+    int next;
+    int lines;
+    char *text; // the text of the symbol being inserted
+    int text_size;
+} LEXER_STREAM;
+
+LEXER_STREAM *lexer_stream(const char *source, size_t length, int chunk_size, int jobs);
+LEXER_STREAM *lexer_scan(const char *source, size_t length);
+void lexer_print(LEXER_STREAM *stream, FILE *out);
+void lexer_stream_free(LEXER_STREAM *stream);
+int lexer_next(YYSTYPE *value);
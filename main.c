@@ -16,12 +16,66 @@
 #include "semantic.h"
 #include "semantic.c"
 
+#include "lexer.h"
+#include "lexer.c"
+
+#include "arena.h"
+#include "arena.c"
+
+#include "minstr.h"
+#include "minstr.c"
+
+#include "isel.h"
+#include "isel.c"
+
+#include "peephole.h"
+#include "peephole.c"
+
+#include "x86enc.h"
+#include "x86enc.c"
+
+#include "elfgen.h"
+#include "elfgen.c"
+
+#include "jit.h"
+#include "jit.c"
+
+#include "interp.h"
+#include "interp.c"
+
+#include "vectorize.h"
+#include "vectorize.c"
+
+#include "runtime.h"
+#include "runtime.c"
+
+#include "profile.h"
+#include "profile.c"
+
 #include "asmgen.h"
 #include "asmgen.c"
 
+#include "tier.h"
+#include "tier.c"
+
 #include "optimization.h"
 #include "optimization.c"
 
+#include "compiler.h"
+#include "compiler.c"
+
+#include "cache.h"
+#include "cache.c"
+
+#include "fragment.h"
+#include "fragment.c"
+
+#include "batch.h"
+#include "batch.c"
+
+#include "server.h"
+#include "server.c"
+
 
 int isRunning();
 int getLineNumber();
@@ -29,9 +83,8 @@ void initMe();
 
 int yylex();
 extern char *yytext;
-extern FILE *yyin;
-
 
+#ifndef COMPILER_LIBRARY
 int main(int argc, char **argv)
 {
 
@@ -41,48 +94,64 @@ int main(int argc, char **argv)
         exit(1);
     }
 
-    if (argc == 3) {
-        if (strcmp(argv[2], "-o") == 0) {
-            optimize = 1;
-            fprintf(stderr, "Optimization = %d\n", optimize);
-        }
-    }
-
-   
-    char *input_file_name = argv[1];
+    compiler = compiler_create();
 
-    if (!(yyin = fopen(input_file_name, "r")))
-    {
-        fprintf(stderr, "could not open input file\n");
-        exit(2);
+    // --connect SOCKET forwards the rest of the command line to a --server
+    char *server_socket = NULL;
+    if (strcmp(argv[1], "--connect") == 0 && argc > 3) {
+        server_socket = argv[2];
+        argv += 2;
+        argc -= 2;
     }
 
-    char *output_file_name = "out.decomp";
-    FILE *output_file;
-    if (!(output_file = fopen(output_file_name, "w")))
-    {
-        fprintf(stderr, "could not open output file\n");
-        exit(2);
+    // --batch takes a manifest and --server a socket where the others take the input
+    // file; -j threads work on its files, its requests, or the functions of a single one
+    char *batch_manifest = NULL;
+    char *server_listen = NULL;
+    int first_option = 2;
+    if (strcmp(argv[1], "--batch") == 0 && argc > 2) {
+        batch_manifest = argv[2];
+        first_option = 3;
+    } else if (strcmp(argv[1], "--server") == 0 && argc > 2) {
+        server_listen = argv[2];
+        first_option = 3;
     }
 
+    // a forwarded command line reports its options from the server
+    char *option_messages = NULL;
+    size_t option_messages_length = 0;
+    if (server_socket) {
+        compiler->diagnostics = open_memstream(&option_messages, &option_messages_length);
+    }
+    compiler_options(compiler, argc, argv, first_option);
 
-    int token = 0;
-    yyparse();
+    // code that runs in this process must not use instructions the cpu lacks
+    if (compiler->vectorize_avx2 && (compiler->run_jit || compiler->run_tiered) && !__builtin_cpu_supports("avx2")) {
+        fprintf(stderr, "vectorize: this cpu has no avx2, using sse2\n");
+        compiler->vectorize_avx2 = 0;
+    }
 
+    if (batch_manifest) {
+        exit(batch_run(batch_manifest, compiler, compiler->jobs));
+    }
 
-    if (SyntaxErrors > 0) {
-        fprintf(stderr, "\n\nCompilation failed with %d syntax errors. Program had %d lines.\n\n", SyntaxErrors, getLineNumber());
-        exit(3);
+    if (server_listen) {
+        exit(server_run(server_listen, compiler->jobs));
     }
 
-    if (SemanticErrors == 0) {
-        fprintf(stderr, "\n\nSuccessful compilation. Program had %d lines.\n\n", getLineNumber());
-    } else {
-        fprintf(stderr, "\n\nCompilation failed with %d Semantic errors. Program had %d lines.\n\n", SemanticErrors, getLineNumber());
-        exit(4);
+    // programs to run, and compiles no server answered, are done here
+    if (server_socket) {
+        fclose(compiler->diagnostics);
+        compiler->diagnostics = stderr;
+        if (!compiler->run_jit && !compiler->run_interp) {
+            int status = server_client(server_socket, argc, argv);
+            if (status >= 0) {
+                exit(status);
+            }
+        }
+        fputs(option_messages, stderr);
     }
-     
-   // hash_print();
-    fprintf(output_file, "%s", astToCode(root));
-    exit(0);
-}
\ No newline at end of file
+
+    exit(compiler_main(compiler, argv[1], "."));
+}
+#endif
@@ -0,0 +1,586 @@
+#include <stdarg.h>
+#include "minstr.h"
+
+#define MI_F_SUFFIX 1 // integer size suffix follows the name
+#define MI_F_SRC_READ 2
+#define MI_F_DST_READ 4
+#define MI_F_DST_WRITE 8
+#define MI_F_IMM8 16 // imm8 from cc is printed first
+#define MI_F_VEX 32  // only exists VEX-encoded, the name already carries the v
+
+typedef struct minstr_info
+{
+    char *name;
+    int flags;
+} MINSTR_INFO;
+
+MINSTR_INFO minstr_info[MI_OPCODE_COUNT] = {
+    {"", 0},
+    {"", 0},                                                  // MI_LABEL
+    {"", 0},                                                  // MI_FUNCTION
+    {"mov", MI_F_SUFFIX | MI_F_SRC_READ | MI_F_DST_WRITE},
+    {"movslq", MI_F_SRC_READ | MI_F_DST_WRITE},
+    {"movzbl", MI_F_SRC_READ | MI_F_DST_WRITE},
+    {"lea", MI_F_SUFFIX | MI_F_DST_WRITE},
+    {"add", MI_F_SUFFIX | MI_F_SRC_READ | MI_F_DST_READ | MI_F_DST_WRITE},
+    {"sub", MI_F_SUFFIX | MI_F_SRC_READ | MI_F_DST_READ | MI_F_DST_WRITE},
+    {"imul", MI_F_SUFFIX | MI_F_SRC_READ | MI_F_DST_READ | MI_F_DST_WRITE},
+    {"and", MI_F_SUFFIX | MI_F_SRC_READ | MI_F_DST_READ | MI_F_DST_WRITE},
+    {"or", MI_F_SUFFIX | MI_F_SRC_READ | MI_F_DST_READ | MI_F_DST_WRITE},
+    {"xor", MI_F_SUFFIX | MI_F_SRC_READ | MI_F_DST_READ | MI_F_DST_WRITE},
+    {"cmp", MI_F_SUFFIX | MI_F_SRC_READ | MI_F_DST_READ},
+    {"test", MI_F_SUFFIX | MI_F_SRC_READ | MI_F_DST_READ},
+    {"neg", MI_F_SUFFIX | MI_F_DST_READ | MI_F_DST_WRITE},
+    {"shl", MI_F_SUFFIX | MI_F_SRC_READ | MI_F_DST_READ | MI_F_DST_WRITE},
+    {"idiv", MI_F_SUFFIX | MI_F_DST_READ},
+    {"cltd", 0},
+    {"set", MI_F_DST_READ | MI_F_DST_WRITE}, // byte write keeps the rest of the register
+    {"j", 0},
+    {"jmp", 0},
+    {"call", 0},
+    {"ret", 0},
+    {"push", MI_F_SUFFIX | MI_F_DST_READ},
+    {"pop", MI_F_SUFFIX | MI_F_DST_WRITE},
+    {"movss", MI_F_SRC_READ | MI_F_DST_WRITE},
+    {"addss", MI_F_SRC_READ | MI_F_DST_READ | MI_F_DST_WRITE},
+    {"subss", MI_F_SRC_READ | MI_F_DST_READ | MI_F_DST_WRITE},
+    {"mulss", MI_F_SRC_READ | MI_F_DST_READ | MI_F_DST_WRITE},
+    {"divss", MI_F_SRC_READ | MI_F_DST_READ | MI_F_DST_WRITE},
+    {"comiss", MI_F_SRC_READ | MI_F_DST_READ},
+    {"ucomiss", MI_F_SRC_READ | MI_F_DST_READ},
+    {"cvtss2sd", MI_F_SRC_READ | MI_F_DST_WRITE},
+    {"pxor", MI_F_SRC_READ | MI_F_DST_READ | MI_F_DST_WRITE},
+    {"movd", MI_F_SRC_READ | MI_F_DST_WRITE},
+    {".section", 0},
+    {".globl", 0},
+    {".align", 0},
+    {".type", 0},
+    {".long", 0},
+    {".float", 0},
+    {".string", 0},
+    {".zero", 0},
+    {"movups", MI_F_SRC_READ | MI_F_DST_WRITE},
+    {"pshufd", MI_F_IMM8 | MI_F_SRC_READ | MI_F_DST_WRITE},
+    {"vpbroadcastd", MI_F_VEX | MI_F_SRC_READ | MI_F_DST_WRITE},
+    {"paddd", MI_F_SRC_READ | MI_F_DST_READ | MI_F_DST_WRITE},
+    {"psubd", MI_F_SRC_READ | MI_F_DST_READ | MI_F_DST_WRITE},
+    {"pmulld", MI_F_SRC_READ | MI_F_DST_READ | MI_F_DST_WRITE},
+    {"pslld", MI_F_SRC_READ | MI_F_DST_READ | MI_F_DST_WRITE},
+    {"psrld", MI_F_SRC_READ | MI_F_DST_READ | MI_F_DST_WRITE},
+    {"pand", MI_F_SRC_READ | MI_F_DST_READ | MI_F_DST_WRITE},
+    {"por", MI_F_SRC_READ | MI_F_DST_READ | MI_F_DST_WRITE},
+    {"pcmpeqd", MI_F_SRC_READ | MI_F_DST_READ | MI_F_DST_WRITE},
+    {"pcmpgtd", MI_F_SRC_READ | MI_F_DST_READ | MI_F_DST_WRITE},
+    {"addps", MI_F_SRC_READ | MI_F_DST_READ | MI_F_DST_WRITE},
+    {"subps", MI_F_SRC_READ | MI_F_DST_READ | MI_F_DST_WRITE},
+    {"mulps", MI_F_SRC_READ | MI_F_DST_READ | MI_F_DST_WRITE},
+    {"divps", MI_F_SRC_READ | MI_F_DST_READ | MI_F_DST_WRITE},
+    {"cmpps", MI_F_IMM8 | MI_F_SRC_READ | MI_F_DST_READ | MI_F_DST_WRITE},
+    {"vzeroupper", MI_F_VEX},
+    {"cvtsi2ss", MI_F_SRC_READ | MI_F_DST_WRITE},
+};
+
+char *cc_names[] = {"e", "ne", "l", "ge", "le", "g", "b", "ae", "be", "a", "p", "np"};
+
+char *reg_names_64[] = {
+    "rax", "rcx", "rdx", "rbx", "rsp", "rbp", "rsi", "rdi",
+    "r8", "r9", "r10", "r11", "r12", "r13", "r14", "r15",
+    "xmm0", "xmm1", "xmm2", "xmm3", "xmm4", "xmm5", "xmm6", "xmm7"};
+
+char *reg_names_32[] = {
+    "eax", "ecx", "edx", "ebx", "esp", "ebp", "esi", "edi",
+    "r8d", "r9d", "r10d", "r11d", "r12d", "r13d", "r14d", "r15d",
+    "xmm0", "xmm1", "xmm2", "xmm3", "xmm4", "xmm5", "xmm6", "xmm7"};
+
+char *reg_names_8[] = {
+    "al", "cl", "dl", "bl", "spl", "bpl", "sil", "dil",
+    "r8b", "r9b", "r10b", "r11b", "r12b", "r13b", "r14b", "r15b",
+    "xmm0", "xmm1", "xmm2", "xmm3", "xmm4", "xmm5", "xmm6", "xmm7"};
+
+MOPERAND mop_none(void)
+{
+    MOPERAND operand = {MOP_NONE, REG_NONE, REG_NONE, 0, 0, {MSYM_NONE, NULL, 0, NULL}};
+    return operand;
+}
+
+MOPERAND mop_reg(int reg)
+{
+    MOPERAND operand = mop_none();
+    operand.kind = MOP_REG;
+    operand.reg = reg;
+    return operand;
+}
+
+MOPERAND mop_imm(int value)
+{
+    MOPERAND operand = mop_none();
+    operand.kind = MOP_IMM;
+    operand.disp = value;
+    return operand;
+}
+
+MOPERAND mop_mem(int base, int index, int scale, int disp)
+{
+    MOPERAND operand = mop_none();
+    operand.kind = MOP_MEM;
+    operand.reg = base;
+    operand.index = index;
+    operand.scale = scale;
+    operand.disp = disp;
+    return operand;
+}
+
+MOPERAND mop_hash(HASH *hash, int disp)
+{
+    MOPERAND operand = mop_none();
+    operand.kind = MOP_MEM;
+    operand.disp = disp;
+    operand.symbol.kind = MSYM_HASH;
+    operand.symbol.hash = hash;
+    return operand;
+}
+
+MOPERAND mop_string(int string_id)
+{
+    MOPERAND operand = mop_none();
+    operand.kind = MOP_MEM;
+    operand.symbol.kind = MSYM_STRING;
+    operand.symbol.id = string_id;
+    return operand;
+}
+
+MOPERAND mop_name(char *name)
+{
+    MOPERAND operand = mop_none();
+    operand.kind = MOP_MEM;
+    operand.symbol.kind = MSYM_NAME;
+    operand.symbol.name = name;
+    return operand;
+}
+
+MOPERAND mop_const(int bits)
+{
+    MOPERAND operand = mop_none();
+    operand.kind = MOP_MEM;
+    operand.symbol.kind = MSYM_CONST;
+    operand.symbol.id = bits;
+    return operand;
+}
+
+MOPERAND mop_format(int id)
+{
+    MOPERAND operand = mop_none();
+    operand.kind = MOP_MEM;
+    operand.symbol.kind = MSYM_FORMAT;
+    operand.symbol.id = id;
+    return operand;
+}
+
+MOPERAND mop_label(HASH *label)
+{
+    MOPERAND operand = mop_none();
+    operand.kind = MOP_SYM;
+    operand.symbol.kind = MSYM_HASH;
+    operand.symbol.hash = label;
+    return operand;
+}
+
+MOPERAND mop_function(HASH *function)
+{
+    MOPERAND operand = mop_none();
+    operand.kind = MOP_SYM;
+    operand.symbol.kind = MSYM_FUNCTION;
+    operand.symbol.hash = function;
+    return operand;
+}
+
+MOPERAND mop_extern(char *name)
+{
+    MOPERAND operand = mop_none();
+    operand.kind = MOP_SYM;
+    operand.symbol.kind = MSYM_NAME;
+    operand.symbol.name = name;
+    return operand;
+}
+
+MOPERAND mop_text(char *text)
+{
+    MOPERAND operand = mop_none();
+    operand.kind = MOP_TEXT;
+    operand.symbol.kind = MSYM_NAME;
+    operand.symbol.name = text;
+    return operand;
+}
+
+MINSTR *minstr_emit(MCODE *code, int op, int size, MOPERAND src, MOPERAND dst)
+{
+    MINSTR *instr = (MINSTR *)arena_alloc(&code->arena, sizeof(MINSTR));
+    instr->op = op;
+    instr->size = size;
+    instr->src = src;
+    instr->dst = dst;
+    instr->prev = code->last;
+    if (code->last)
+        code->last->next = instr;
+    else
+        code->first = instr;
+    code->last = instr;
+    return instr;
+}
+
+MINSTR *minstr_emit_cc(MCODE *code, int op, int cc, MOPERAND dst)
+{
+    MINSTR *instr = minstr_emit(code, op, 1, mop_none(), dst);
+    instr->cc = cc;
+    return instr;
+}
+
+void minstr_remove(MCODE *code, MINSTR *instr)
+{
+    if (instr->prev)
+        instr->prev->next = instr->next;
+    else
+        code->first = instr->next;
+    if (instr->next)
+        instr->next->prev = instr->prev;
+    else
+        code->last = instr->prev;
+}
+
+// moves the instructions of other, and the memory holding them, to the end of code
+void minstr_append(MCODE *code, MCODE *other)
+{
+    if (!other->first)
+        return;
+    other->first->prev = code->last;
+    if (code->last)
+        code->last->next = other->first;
+    else
+        code->first = other->first;
+    code->last = other->last;
+    arena_adopt(&code->arena, &other->arena);
+    other->first = NULL;
+    other->last = NULL;
+}
+
+void minstr_release(MCODE *code)
+{
+    arena_free(&code->arena);
+    code->first = NULL;
+    code->last = NULL;
+}
+
+int cc_negate(int cc)
+{
+    // condition codes come in complementary pairs
+    return cc ^ 1;
+}
+
+// symbol names are spelled without the decimal point of real literals
+char *minstr_format_symbol(char *buffer, MSYMBOL *symbol)
+{
+    char *out = buffer;
+    char *text;
+    switch (symbol->kind)
+    {
+    case MSYM_HASH:
+    {
+        *out++ = '_';
+        for (text = symbol->hash->text; *text; text++)
+            *out++ = *text == '.' ? 'f' : *text;
+        *out = '\0';
+        break;
+    }
+    case MSYM_STRING:
+        sprintf(buffer, "_string_%d", symbol->id);
+        break;
+    case MSYM_CONST:
+        sprintf(buffer, "_const_%08x", (unsigned int)symbol->id);
+        break;
+    case MSYM_FORMAT:
+        sprintf(buffer, "_format_%d", symbol->id);
+        break;
+    case MSYM_FUNCTION:
+        strcpy(buffer, symbol->hash->text);
+        break;
+    default:
+        strcpy(buffer, symbol->name);
+    }
+
+    return buffer;
+}
+
+char *minstr_format_operand(char *buffer, MOPERAND *operand, int size)
+{
+    char symbol[128];
+    switch (operand->kind)
+    {
+    case MOP_REG:
+    {
+        if (size == 32 && operand->reg >= REG_XMM0)
+        {
+            sprintf(buffer, "%%ymm%d", operand->reg - REG_XMM0);
+            break;
+        }
+        char **names = size == 8 ? reg_names_64 : size == 1 ? reg_names_8 : reg_names_32;
+        sprintf(buffer, "%%%s", names[operand->reg]);
+        break;
+    }
+    case MOP_IMM:
+        sprintf(buffer, "$%d", operand->disp);
+        break;
+    case MOP_MEM:
+    {
+        if (operand->symbol.kind != MSYM_NONE && operand->disp)
+            sprintf(buffer, "%d+%s(%%rip)", operand->disp, minstr_format_symbol(symbol, &operand->symbol));
+        else if (operand->symbol.kind != MSYM_NONE)
+            sprintf(buffer, "%s(%%rip)", minstr_format_symbol(symbol, &operand->symbol));
+        else if (operand->index == REG_NONE && operand->disp)
+            sprintf(buffer, "%d(%%%s)", operand->disp, reg_names_64[operand->reg]);
+        else if (operand->index == REG_NONE)
+            sprintf(buffer, "(%%%s)", reg_names_64[operand->reg]);
+        else if (operand->disp)
+            sprintf(buffer, "%d(%%%s,%%%s,%d)", operand->disp, reg_names_64[operand->reg], reg_names_64[operand->index], operand->scale);
+        else
+            sprintf(buffer, "(%%%s,%%%s,%d)", reg_names_64[operand->reg], reg_names_64[operand->index], operand->scale);
+        break;
+    }
+    case MOP_SYM:
+    case MOP_TEXT:
+        minstr_format_symbol(buffer, &operand->symbol);
+        break;
+    default:
+        buffer[0] = '\0';
+    }
+
+    return buffer;
+}
+
+int minstr_src_size(MINSTR *instr)
+{
+    switch (instr->op)
+    {
+    case MI_MOVZB:
+        return 1;
+    case MI_MOVSLQ:
+        return 4;
+    }
+    return instr->size;
+}
+
+int minstr_dst_size(MINSTR *instr)
+{
+    switch (instr->op)
+    {
+    case MI_MOVZB:
+        return 4;
+    case MI_MOVSLQ:
+        return 8;
+    }
+    return instr->size;
+}
+
+char *minstr_mnemonic(char *buffer, MINSTR *instr)
+{
+    MINSTR_INFO *info = &minstr_info[instr->op];
+    if (instr->op == MI_SETCC || instr->op == MI_JCC)
+        sprintf(buffer, "%s%s", info->name, cc_names[instr->cc]);
+    else if (instr->size == 32 && !(info->flags & MI_F_VEX))
+        sprintf(buffer, "v%s", info->name);
+    else if (info->flags & MI_F_SUFFIX)
+        sprintf(buffer, "%s%c", info->name, instr->size == 8 ? 'q' : instr->size == 1 ? 'b' : 'l');
+    else
+        strcpy(buffer, info->name);
+    return buffer;
+}
+
+void mbuffer_printf(MBUFFER *buffer, const char *format, ...)
+{
+    va_list args;
+    int written;
+
+    for (;;)
+    {
+        size_t room = buffer->capacity - buffer->length;
+        va_start(args, format);
+        written = vsnprintf(buffer->data ? buffer->data + buffer->length : NULL, room, format, args);
+        va_end(args);
+        if (written >= 0 && (size_t)written < room)
+        {
+            buffer->length += written;
+            return;
+        }
+
+        // grows geometrically, so reallocations are rare compared to lines
+        buffer->capacity = buffer->capacity ? buffer->capacity * 2 : 65536;
+        buffer->data = (char *)realloc(buffer->data, buffer->capacity);
+    }
+}
+
+void mbuffer_write(FILE *fout, MBUFFER *buffer)
+{
+    fwrite(buffer->data, 1, buffer->length, fout);
+    free(buffer->data);
+    buffer->data = NULL;
+    buffer->length = 0;
+    buffer->capacity = 0;
+}
+
+void minstr_print(MBUFFER *buffer, MCODE *code)
+{
+    MINSTR *instr;
+    char mnemonic[16];
+    char imm[16];
+    char src[160];
+    char dst[160];
+
+    for (instr = code->first; instr; instr = instr->next)
+    {
+        switch (instr->op)
+        {
+        case MI_LABEL:
+            mbuffer_printf(buffer, "%s:\n", minstr_format_symbol(dst, &instr->dst.symbol));
+            break;
+        case MI_FUNCTION:
+            minstr_format_symbol(dst, &instr->dst.symbol);
+            mbuffer_printf(buffer, "\t.text\n\t.globl\t%s\n\t.type\t%s, @function\n%s:\n", dst, dst, dst);
+            break;
+        case MI_SECTION:
+            mbuffer_printf(buffer, "\n.section %s\n\n", minstr_format_symbol(dst, &instr->dst.symbol));
+            break;
+        case MI_OBJECT:
+            minstr_format_symbol(dst, &instr->dst.symbol);
+            mbuffer_printf(buffer, "\t.type\t%s, @object\n\t.size\t%s, %d\n", dst, dst, instr->src.disp);
+            break;
+        case MI_GLOBL:
+            mbuffer_printf(buffer, "\t.globl\t%s\n", minstr_format_symbol(dst, &instr->dst.symbol));
+            break;
+        case MI_ALIGN:
+        case MI_LONG:
+        case MI_ZERO:
+            mbuffer_printf(buffer, "\t%s %d\n", minstr_info[instr->op].name, instr->dst.disp);
+            break;
+        case MI_FLOAT:
+        case MI_STRING:
+            mbuffer_printf(buffer, "\t%s %s\n", minstr_info[instr->op].name, instr->dst.symbol.name);
+            break;
+        default:
+            minstr_mnemonic(mnemonic, instr);
+            if (minstr_info[instr->op].flags & MI_F_IMM8)
+                sprintf(imm, "$%d, ", instr->cc);
+            else
+                imm[0] = '\0';
+            // AVX names the destination twice: it is also the first source
+            if (instr->size == 32 && (minstr_info[instr->op].flags & MI_F_DST_READ))
+                mbuffer_printf(buffer, "\t%s %s%s, %s, %s\n", mnemonic, imm, minstr_format_operand(src, &instr->src, 32), minstr_format_operand(dst, &instr->dst, 32), dst);
+            else if (instr->src.kind != MOP_NONE)
+                mbuffer_printf(buffer, "\t%s %s%s, %s\n", mnemonic, imm, minstr_format_operand(src, &instr->src, minstr_src_size(instr)), minstr_format_operand(dst, &instr->dst, minstr_dst_size(instr)));
+            else if (instr->dst.kind != MOP_NONE)
+                mbuffer_printf(buffer, "\t%s %s\n", mnemonic, minstr_format_operand(dst, &instr->dst, minstr_dst_size(instr)));
+            else
+                mbuffer_printf(buffer, "\t%s\n", mnemonic);
+        }
+    }
+}
+
+int mop_equal(MOPERAND *a, MOPERAND *b)
+{
+    if (a->kind != b->kind)
+        return 0;
+    switch (a->kind)
+    {
+    case MOP_REG:
+        return a->reg == b->reg;
+    case MOP_IMM:
+        return a->disp == b->disp;
+    case MOP_MEM:
+    case MOP_SYM:
+        return a->reg == b->reg && a->index == b->index && a->scale == b->scale && a->disp == b->disp &&
+               a->symbol.kind == b->symbol.kind && a->symbol.hash == b->symbol.hash &&
+               a->symbol.id == b->symbol.id && a->symbol.name == b->symbol.name;
+    }
+    return 1;
+}
+
+int mop_uses_reg(MOPERAND *operand, int reg)
+{
+    if (operand->kind == MOP_REG)
+        return operand->reg == reg;
+    if (operand->kind == MOP_MEM)
+        return operand->reg == reg || operand->index == reg;
+    return 0;
+}
+
+int minstr_reads_reg(MINSTR *instr, int reg)
+{
+    int flags = minstr_info[instr->op].flags;
+
+    // address registers of a memory operand are read whatever the operand role
+    if (instr->src.kind == MOP_MEM && mop_uses_reg(&instr->src, reg))
+        return 1;
+    if (instr->dst.kind == MOP_MEM && mop_uses_reg(&instr->dst, reg))
+        return 1;
+    if ((flags & MI_F_SRC_READ) && instr->src.kind == MOP_REG && instr->src.reg == reg)
+        return 1;
+    if ((flags & MI_F_DST_READ) && instr->dst.kind == MOP_REG && instr->dst.reg == reg)
+        return 1;
+
+    switch (instr->op)
+    {
+    case MI_IDIV:
+        return reg == REG_RAX || reg == REG_RDX;
+    case MI_CLTD:
+        return reg == REG_RAX;
+    case MI_CALL:
+        return reg == REG_RDI || reg == REG_RSI || reg == REG_RAX || reg == REG_XMM0;
+    case MI_RET:
+        return reg == REG_RAX;
+    }
+    return 0;
+}
+
+int minstr_writes_reg(MINSTR *instr, int reg)
+{
+    int flags = minstr_info[instr->op].flags;
+
+    if ((flags & MI_F_DST_WRITE) && instr->dst.kind == MOP_REG && instr->dst.reg == reg)
+        return 1;
+
+    switch (instr->op)
+    {
+    case MI_IDIV:
+        return reg == REG_RAX || reg == REG_RDX;
+    case MI_CLTD:
+        return reg == REG_RDX;
+    case MI_CALL:
+        return reg <= REG_RDX || (reg >= REG_RSI && reg <= REG_R11) || reg >= REG_XMM0;
+    }
+    return 0;
+}
+
+// registers never carry a value across a label, a branch, a call or a return
+// (the selector frees them at every root), so the scan stops at the first one
+int minstr_reg_dead_after(MINSTR *instr, int reg)
+{
+    MINSTR *next;
+    for (next = instr->next; next; next = next->next)
+    {
+        if (minstr_reads_reg(next, reg))
+            return 0;
+        if (minstr_writes_reg(next, reg) && next->op != MI_SETCC)
+            return 1;
+
+        switch (next->op)
+        {
+        case MI_LABEL:
+        case MI_FUNCTION:
+        case MI_JCC:
+        case MI_JMP:
+        case MI_CALL:
+        case MI_RET:
+            return 1;
+        }
+    }
+
+    return 1;
+}
@@ -0,0 +1,200 @@
+#pragma once
+#include "hash.h"
+#include "arena.h"
+
+// opcodes
+#define MI_LABEL 1    // label definition
+#define MI_FUNCTION 2 // function header directives and entry label
+#define MI_MOV 3
+#define MI_MOVSLQ 4
+#define MI_MOVZB 5
+#define MI_LEA 6
+#define MI_ADD 7
+#define MI_SUB 8
+#define MI_IMUL 9
+#define MI_AND 10
+#define MI_OR 11
+#define MI_XOR 12
+#define MI_CMP 13
+#define MI_TEST 14
+#define MI_NEG 15
+#define MI_SHL 16
+#define MI_IDIV 17
+#define MI_CLTD 18
+#define MI_SETCC 19
+#define MI_JCC 20
+#define MI_JMP 21
+#define MI_CALL 22
+#define MI_RET 23
+#define MI_PUSH 24
+#define MI_POP 25
+#define MI_MOVSS 26
+#define MI_ADDSS 27
+#define MI_SUBSS 28
+#define MI_MULSS 29
+#define MI_DIVSS 30
+#define MI_COMISS 31
+#define MI_UCOMISS 32
+#define MI_CVTSS2SD 33
+#define MI_PXOR 34
+#define MI_MOVD 35
+
+// data directives
+#define MI_SECTION 36 // .section <name>
+#define MI_GLOBL 37   // .globl <symbol>
+#define MI_ALIGN 38   // .align <imm>
+#define MI_OBJECT 39  // .type <symbol>, @object and .size <symbol>, <imm>
+#define MI_LONG 40    // .long <imm>
+#define MI_FLOAT 41   // .float <text>
+#define MI_STRING 42  // .string <text>
+#define MI_ZERO 43    // .zero <imm>
+
+// packed operations of vectorized loops: size 16 is SSE on xmm, size 32 is AVX on ymm,
+// where the destination doubles as the first source; imm8 operands live in cc
+#define MI_MOVUPS 44
+#define MI_PSHUFD 45
+#define MI_VPBROADCASTD 46
+#define MI_PADDD 47
+#define MI_PSUBD 48
+#define MI_PMULLD 49
+#define MI_PSLLD 50
+#define MI_PSRLD 51
+#define MI_PAND 52
+#define MI_POR 53
+#define MI_PCMPEQD 54
+#define MI_PCMPGTD 55
+#define MI_ADDPS 56
+#define MI_SUBPS 57
+#define MI_MULPS 58
+#define MI_DIVPS 59
+#define MI_CMPPS 60
+#define MI_VZEROUPPER 61
+
+#define MI_CVTSI2SS 62 // from a 32 or 64 bit integer, by size
+#define MI_OPCODE_COUNT 63
+
+// condition codes
+#define CC_E 0
+#define CC_NE 1
+#define CC_L 2
+#define CC_GE 3
+#define CC_LE 4
+#define CC_G 5
+#define CC_B 6
+#define CC_AE 7
+#define CC_BE 8
+#define CC_A 9
+#define CC_P 10
+#define CC_NP 11
+
+// machine registers
+#define REG_NONE -1
+#define REG_RAX 0
+#define REG_RCX 1
+#define REG_RDX 2
+#define REG_RBX 3
+#define REG_RSP 4
+#define REG_RBP 5
+#define REG_RSI 6
+#define REG_RDI 7
+#define REG_R8 8
+#define REG_R9 9
+#define REG_R10 10
+#define REG_R11 11
+#define REG_XMM0 16
+#define REG_XMM1 17
+#define REG_XMM7 23
+#define REG_COUNT 24
+
+// operand kinds
+#define MOP_NONE 0
+#define MOP_REG 1
+#define MOP_IMM 2
+#define MOP_MEM 3 // disp(base,index,scale), or symbol+disp(%rip) when symbol is set
+#define MOP_SYM 4 // bare symbol, branch and call targets
+#define MOP_TEXT 5 // literal spelled verbatim, float and string initialisers
+
+// symbol kinds
+#define MSYM_NONE 0
+#define MSYM_HASH 1     // _<text>, real literals spelled without the decimal point
+#define MSYM_STRING 2   // _string_<id>
+#define MSYM_FUNCTION 3 // <text> of a function symbol
+#define MSYM_NAME 4     // fixed runtime name, printed verbatim
+#define MSYM_CONST 5    // _const_<bits>, an entry of the constant pool
+#define MSYM_FORMAT 6   // _format_<id>, an output descriptor
+
+typedef struct msymbol
+{
+    int kind;
+    HASH *hash;
+    int id;
+    char *name;
+} MSYMBOL;
+
+typedef struct moperand
+{
+    int kind;
+    int reg;   // register, or base register of a memory operand
+    int index;
+    int scale;
+    int disp;  // displacement, or the value of an immediate
+    MSYMBOL symbol;
+} MOPERAND;
+
+typedef struct minstr
+{
+    int op;
+    int size; // operand size in bytes for integer instructions
+    int cc;   // condition code of MI_SETCC and MI_JCC, imm8 of MI_PSHUFD and MI_CMPPS
+    MOPERAND src;
+    MOPERAND dst;
+    struct minstr *prev;
+    struct minstr *next;
+} MINSTR;
+
+typedef struct mcode
+{
+    MINSTR *first;
+    MINSTR *last;
+    ARENA arena; // instructions live here until the list is released
+} MCODE;
+
+// growable text buffer the printer writes into, flushed with a single fwrite
+typedef struct mbuffer
+{
+    char *data;
+    size_t length;
+    size_t capacity;
+} MBUFFER;
+
+MOPERAND mop_none(void);
+MOPERAND mop_reg(int reg);
+MOPERAND mop_imm(int value);
+MOPERAND mop_mem(int base, int index, int scale, int disp);
+MOPERAND mop_hash(HASH *hash, int disp);
+MOPERAND mop_string(int string_id);
+MOPERAND mop_name(char *name);
+MOPERAND mop_const(int bits);
+MOPERAND mop_format(int id);
+MOPERAND mop_label(HASH *label);
+MOPERAND mop_function(HASH *function);
+MOPERAND mop_extern(char *name);
+MOPERAND mop_text(char *text);
+
+MINSTR *minstr_emit(MCODE *code, int op, int size, MOPERAND src, MOPERAND dst);
+MINSTR *minstr_emit_cc(MCODE *code, int op, int cc, MOPERAND dst);
+void minstr_remove(MCODE *code, MINSTR *instr);
+void minstr_append(MCODE *code, MCODE *other);
+void minstr_release(MCODE *code);
+void minstr_print(MBUFFER *buffer, MCODE *code);
+void mbuffer_printf(MBUFFER *buffer, const char *format, ...);
+void mbuffer_write(FILE *fout, MBUFFER *buffer);
+char *minstr_format_operand(char *buffer, MOPERAND *operand, int size);
+char *minstr_format_symbol(char *buffer, MSYMBOL *symbol);
+
+int mop_equal(MOPERAND *a, MOPERAND *b);
+int mop_uses_reg(MOPERAND *operand, int reg);
+int minstr_reads_reg(MINSTR *instr, int reg);
+int minstr_writes_reg(MINSTR *instr, int reg);
+int minstr_reg_dead_after(MINSTR *instr, int reg);
+int cc_negate(int cc);
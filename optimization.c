@@ -2,17 +2,17 @@
 
 
 void optimization_reset_step() {
-    appeared_right_side_index = 0;
-    loop_expr_vars_index = 0;
-    for (int i = 0; i < 1000; i++) {
-        appeared_right_side[i] = NULL;
-        loop_expr_vars[i] = NULL;
+    compiler->appeared_right_side_index = 0;
+    compiler->loop_expr_vars_index = 0;
+    for (int i = 0; i < COMPILER_NAME_LIST_SIZE; i++) {
+        compiler->appeared_right_side[i] = NULL;
+        compiler->loop_expr_vars[i] = NULL;
     }
 }
 
 int optimization_is_loop_expr_var(char * var_name) {
-    for (int i = 0; i < loop_expr_vars_index; i++) {
-        if (strcmp(loop_expr_vars[i], var_name) == 0) {
+    for (int i = 0; i < compiler->loop_expr_vars_index; i++) {
+        if (strcmp(compiler->loop_expr_vars[i], var_name) == 0) {
             return 1;
         }
     }
@@ -24,8 +24,8 @@ void optimization_collect_loop_expr_vars(AST * loop_expr) {
         return;
 
     if (loop_expr->type == AST_IDENTIFIER) {
-        loop_expr_vars[loop_expr_vars_index] = loop_expr->symbol->text;
-        loop_expr_vars_index++;
+        compiler->loop_expr_vars[compiler->loop_expr_vars_index] = loop_expr->symbol->text;
+        compiler->loop_expr_vars_index++;
     }
 
     for (int i = 0; i < MAX_SONS; i++) {
@@ -40,8 +40,8 @@ void optimization_collect_right_side(AST *last_cmd_list)
 
     if (last_cmd_list->type == AST_IDENTIFIER)
     {
-        appeared_right_side[appeared_right_side_index] = last_cmd_list->symbol->text;
-        appeared_right_side_index++;
+        compiler->appeared_right_side[compiler->appeared_right_side_index] = last_cmd_list->symbol->text;
+        compiler->appeared_right_side_index++;
     }
 
     for (int i = 0; i < MAX_SONS; i++)
@@ -115,8 +115,8 @@ void optimization_collect_left_side(AST * last_cmd_list) {
         return;
     if (last_cmd_list->type == AST_VAR_ATTRIB) {
        
-        appeared_left_side[appeared_left_side_index] = last_cmd_list->symbol->text;
-        appeared_left_side_index++;
+        compiler->appeared_left_side[compiler->appeared_left_side_index] = last_cmd_list->symbol->text;
+        compiler->appeared_left_side_index++;
     }
 
     for (int i = 0; i < MAX_SONS; i++) {
@@ -130,8 +130,8 @@ int optimization_verify_right_side(AST * attrib) {
     }
 
     if (attrib->type == AST_IDENTIFIER) {
-        for (int i = 0; i < appeared_left_side_index; i++) {
-            if (strcmp(attrib->symbol->text, appeared_left_side[i]) == 0) {
+        for (int i = 0; i < compiler->appeared_left_side_index; i++) {
+            if (strcmp(attrib->symbol->text, compiler->appeared_left_side[i]) == 0) {
                 return 1;
             }
         }
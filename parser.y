@@ -7,10 +7,17 @@
 #include "semantic.h"
 #include "tac.h"
 #include "asmgen.h"
-int SyntaxErrors = 0;
-int optimize = 0;
+#include "interp.h"
+
+// the parser takes its tokens from lexer_next, which reads the tokens of the context
+// being compiled; the parser is pure, so contexts parse at the same time
+union YYSTYPE;
+int lexer_next(union YYSTYPE *value);
+#define yylex(value) lexer_next(value)
 %}
 
+%define api.pure full
+
 %union{
     HASH* symbol; 
     AST *ast;
@@ -76,74 +83,7 @@ int optimize = 0;
 
 %%
 
-program: declaration_list   { 
-                              
-                                    root = astCreate(AST_PROGRAM, NULL, $1, NULL, NULL, NULL, getLineNumber()); $1 = root; $$ = $1;
-                                   
-                                    set_param_list_item_function(root);
-                                    set_expr_list_item_function(root);
-                                    check_and_set_declarations($1);
-                                    check_undeclared();
-                                    
-                                    check_operands($1);
-                                    
-                                    check_assignments($1);	
-                                        
-                                    check_return($1);
-                                        
-                                    check_function_call($1);
-                                    
-                                    check_conditional_stmts($1);
-
-
-                                    if (SyntaxErrors == 0 && SemanticErrors == 0) {
-                                       
-                                        if (optimize) {
-                                            fprintf(stderr, "Generating optimized code...\n");
-                                            ast_collect_loop_elements($1);
-                                            ast_collect_loop_conditions($1);
-                                            ast_collect_loop_variables($1);
-                                            // ast_collect_has_dependencies($1);
-                                           
-                                            ast_collect_varies($1);
-                                            
-                                            ast_set_dependencies($1);
-
-                                            ast_set_varies($1);
-                                            ast_set_order_dependencies($1);
-                                     
-                                           // ast_print_cond_list();
-                                        
-                                            ast_optimize($1);
-                                            if (optimized > 0) {
-                                                ast_handle_marked_assignments($1);
-                                                ast_add_assignment_conds($1);
-                                                fprintf(stderr, "Optimization done!\n");
-                                            } else {
-                                                fprintf(stderr, "No optimization done!\n");
-                                            }
-                                            
-                                        } else {
-                                            fprintf(stderr, "Generating unoptimized code...\n");
-                                        }
-                                      
-                                        TAC * code = generate_code($1);
-                                        code = generate_code($1);
-                                        //tac_print_backwards(code);
-                                        generate_asm(code);
-                                        
-                                    }
-                                
-
-                                
-                                //astPrint($1, 0);
-                                /*AST * test = $1;
-                                test = test->son[0]->son[1]->son[0]->son[1]->son[0]->son[0]->son[0];
-                                int typecheck_result = expression_typecheck(test);
-                                fprintf(stderr, "typecheck result: %d\n", typecheck_result);*/
-
-                               
-                            }
+program: declaration_list   { compiler->root = astCreate(AST_PROGRAM, NULL, $1, NULL, NULL, NULL, getLineNumber()); $$ = compiler->root; }
     ;
 
 declaration_list: var_declaration ';' declaration_list  { $$ = astCreate(AST_DECL_LIST, NULL, $1, $3, NULL, NULL, getLineNumber()); }
@@ -151,8 +91,8 @@ declaration_list: var_declaration ';' declaration_list  { $$ = astCreate(AST_DEC
     | func_declaration declaration_list  { $$ = astCreate(AST_DECL_LIST, NULL, $1, $2, NULL, NULL, getLineNumber()); }
     
     //errors
-    |              var_declaration error declaration_list { $$ = astCreate(AST_DECL_LIST, NULL, $1, $3, NULL, NULL, getLineNumber()); fprintf(stderr, "Expecting ; on end of variable declaration\n"); SyntaxErrors++; }
-    |              vec_declaration error declaration_list { $$ = astCreate(AST_DECL_LIST, NULL, $1, $3, NULL, NULL, getLineNumber()); fprintf(stderr, "Expecting ; on end of vector declaration\n"); SyntaxErrors++; }
+    |              var_declaration error declaration_list { $$ = astCreate(AST_DECL_LIST, NULL, $1, $3, NULL, NULL, getLineNumber()); fprintf(compiler->diagnostics, "Expecting ; on end of variable declaration\n"); compiler->syntax_errors++; }
+    |              vec_declaration error declaration_list { $$ = astCreate(AST_DECL_LIST, NULL, $1, $3, NULL, NULL, getLineNumber()); fprintf(compiler->diagnostics, "Expecting ; on end of vector declaration\n"); compiler->syntax_errors++; }
     |            { $$ = 0; }
     ;
 
@@ -172,42 +112,42 @@ var_declaration: KW_INT TK_IDENTIFIER '=' LIT_INT   { $$ = astCreate(AST_VAR_DEC
     |            KW_REAL TK_IDENTIFIER '=' LIT_REAL      { $$ = astCreate(AST_VAR_DECL_REAL, $2, astCreate(AST_LIT_REAL, $4, NULL, NULL, NULL, NULL, getLineNumber()), NULL, NULL, NULL, getLineNumber()); }
     |            KW_BOOL TK_IDENTIFIER '=' LIT_REAL     { $$ = astCreate(AST_VAR_DECL_BOOL, $2, astCreate(AST_LIT_REAL, $4, NULL, NULL, NULL, NULL, getLineNumber()), NULL, NULL, NULL, getLineNumber()); }
     // errors
-    |            KW_INT error '='  LIT_INT { $$ = astCreate(AST_VAR_DECL_INT, make_missing(DATATYPE_INT), astCreate(AST_LIT_INT, $4, NULL, NULL, NULL, NULL, getLineNumber()), NULL, NULL, NULL, getLineNumber()); fprintf(stderr, "Expected identifier on variable declaration\n"); SyntaxErrors++; }
-    |            KW_CHAR error '=' LIT_INT { $$ = astCreate(AST_VAR_DECL_CHAR, make_missing(DATATYPE_CHAR), astCreate(AST_LIT_INT, $4, NULL, NULL, NULL, NULL, getLineNumber()), NULL, NULL, NULL, getLineNumber());  fprintf(stderr, "Expected identifier on variable declaration\n"); SyntaxErrors++; }
-    |            KW_REAL error '=' LIT_INT { $$ = astCreate(AST_VAR_DECL_REAL, make_missing(DATATYPE_REAL), astCreate(AST_LIT_INT, $4, NULL, NULL, NULL, NULL, getLineNumber()), NULL, NULL, NULL, getLineNumber());  fprintf(stderr, "Expected identifier on variable declaration\n"); SyntaxErrors++; }
-    |            KW_BOOL error '=' LIT_INT { $$ = astCreate(AST_VAR_DECL_BOOL, make_missing(DATATYPE_BOOL), astCreate(AST_LIT_INT, $4, NULL, NULL, NULL, NULL, getLineNumber()), NULL, NULL, NULL, getLineNumber());  fprintf(stderr, "Expected identifier on variable declaration\n"); SyntaxErrors++; }
-
-    |            KW_INT error '='  LIT_CHAR { $$ = astCreate(AST_VAR_DECL_INT, make_missing(DATATYPE_INT), astCreate(AST_LIT_CHAR, $4, NULL, NULL, NULL, NULL, getLineNumber()), NULL, NULL, NULL, getLineNumber()); fprintf(stderr, "Expected identifier on variable declaration\n"); SyntaxErrors++; }
-    |            KW_CHAR error '=' LIT_CHAR { $$ = astCreate(AST_VAR_DECL_CHAR, make_missing(DATATYPE_CHAR), astCreate(AST_LIT_CHAR, $4, NULL, NULL, NULL, NULL, getLineNumber()), NULL, NULL, NULL, getLineNumber());  fprintf(stderr, "Expected identifier on variable declaration\n"); SyntaxErrors++; }
-    |            KW_REAL error '=' LIT_CHAR { $$ = astCreate(AST_VAR_DECL_REAL, make_missing(DATATYPE_REAL), astCreate(AST_LIT_CHAR, $4, NULL, NULL, NULL, NULL, getLineNumber()), NULL, NULL, NULL, getLineNumber());  fprintf(stderr, "Expected identifier on variable declaration\n"); SyntaxErrors++; }
-    |            KW_BOOL error '=' LIT_CHAR { $$ = astCreate(AST_VAR_DECL_BOOL, make_missing(DATATYPE_BOOL), astCreate(AST_LIT_CHAR, $4, NULL, NULL, NULL, NULL, getLineNumber()), NULL, NULL, NULL, getLineNumber());  fprintf(stderr, "Expected identifier on variable declaration\n"); SyntaxErrors++; }
-
-    |            KW_INT error '='  LIT_REAL { $$ = astCreate(AST_VAR_DECL_INT, make_missing(DATATYPE_INT), astCreate(AST_LIT_REAL, $4, NULL, NULL, NULL, NULL, getLineNumber()), NULL, NULL, NULL, getLineNumber()); fprintf(stderr, "Expected identifier on variable declaration\n"); SyntaxErrors++; }
-    |            KW_CHAR error '=' LIT_REAL { $$ = astCreate(AST_VAR_DECL_CHAR, make_missing(DATATYPE_CHAR), astCreate(AST_LIT_REAL, $4, NULL, NULL, NULL, NULL, getLineNumber()), NULL, NULL, NULL, getLineNumber());  fprintf(stderr, "Expected identifier on variable declaration\n"); SyntaxErrors++; }
-    |            KW_REAL error '=' LIT_REAL { $$ = astCreate(AST_VAR_DECL_REAL, make_missing(DATATYPE_REAL), astCreate(AST_LIT_REAL, $4, NULL, NULL, NULL, NULL, getLineNumber()), NULL, NULL, NULL, getLineNumber());  fprintf(stderr, "Expected identifier on variable declaration\n"); SyntaxErrors++; }
-    |            KW_BOOL error '=' LIT_REAL { $$ = astCreate(AST_VAR_DECL_BOOL, make_missing(DATATYPE_BOOL), astCreate(AST_LIT_REAL, $4, NULL, NULL, NULL, NULL, getLineNumber()), NULL, NULL, NULL, getLineNumber());  fprintf(stderr, "Expected identifier on variable declaration\n"); SyntaxErrors++; }
-
-
-    |           KW_INT TK_IDENTIFIER error LIT_INT  { $$ = astCreate(AST_VAR_DECL_INT, $2, astCreate(AST_LIT_INT, $4, NULL, NULL, NULL, NULL, getLineNumber()), NULL, NULL, NULL, getLineNumber()); fprintf(stderr, "Expected = on variable declaration\n"); SyntaxErrors++; }
-    |KW_CHAR TK_IDENTIFIER error LIT_INT { $$ = astCreate(AST_VAR_DECL_CHAR, $2, astCreate(AST_LIT_INT, $4, NULL, NULL, NULL, NULL, getLineNumber()), NULL, NULL, NULL, getLineNumber());  fprintf(stderr, "Expected = on variable declaration\n"); SyntaxErrors++; }
-    |KW_REAL TK_IDENTIFIER error LIT_INT { $$ = astCreate(AST_VAR_DECL_REAL, $2, astCreate(AST_LIT_INT, $4, NULL, NULL, NULL, NULL, getLineNumber()), NULL, NULL, NULL, getLineNumber());  fprintf(stderr, "Expected = on variable declaration\n"); SyntaxErrors++; }
-    |KW_BOOL TK_IDENTIFIER error LIT_INT { $$ = astCreate(AST_VAR_DECL_BOOL, $2, astCreate(AST_LIT_INT, $4, NULL, NULL, NULL, NULL, getLineNumber()), NULL, NULL, NULL, getLineNumber());  fprintf(stderr, "Expected = on variable declaration\n"); SyntaxErrors++; }
+    |            KW_INT error '='  LIT_INT { $$ = astCreate(AST_VAR_DECL_INT, make_missing(DATATYPE_INT), astCreate(AST_LIT_INT, $4, NULL, NULL, NULL, NULL, getLineNumber()), NULL, NULL, NULL, getLineNumber()); fprintf(compiler->diagnostics, "Expected identifier on variable declaration\n"); compiler->syntax_errors++; }
+    |            KW_CHAR error '=' LIT_INT { $$ = astCreate(AST_VAR_DECL_CHAR, make_missing(DATATYPE_CHAR), astCreate(AST_LIT_INT, $4, NULL, NULL, NULL, NULL, getLineNumber()), NULL, NULL, NULL, getLineNumber());  fprintf(compiler->diagnostics, "Expected identifier on variable declaration\n"); compiler->syntax_errors++; }
+    |            KW_REAL error '=' LIT_INT { $$ = astCreate(AST_VAR_DECL_REAL, make_missing(DATATYPE_REAL), astCreate(AST_LIT_INT, $4, NULL, NULL, NULL, NULL, getLineNumber()), NULL, NULL, NULL, getLineNumber());  fprintf(compiler->diagnostics, "Expected identifier on variable declaration\n"); compiler->syntax_errors++; }
+    |            KW_BOOL error '=' LIT_INT { $$ = astCreate(AST_VAR_DECL_BOOL, make_missing(DATATYPE_BOOL), astCreate(AST_LIT_INT, $4, NULL, NULL, NULL, NULL, getLineNumber()), NULL, NULL, NULL, getLineNumber());  fprintf(compiler->diagnostics, "Expected identifier on variable declaration\n"); compiler->syntax_errors++; }
+
+    |            KW_INT error '='  LIT_CHAR { $$ = astCreate(AST_VAR_DECL_INT, make_missing(DATATYPE_INT), astCreate(AST_LIT_CHAR, $4, NULL, NULL, NULL, NULL, getLineNumber()), NULL, NULL, NULL, getLineNumber()); fprintf(compiler->diagnostics, "Expected identifier on variable declaration\n"); compiler->syntax_errors++; }
+    |            KW_CHAR error '=' LIT_CHAR { $$ = astCreate(AST_VAR_DECL_CHAR, make_missing(DATATYPE_CHAR), astCreate(AST_LIT_CHAR, $4, NULL, NULL, NULL, NULL, getLineNumber()), NULL, NULL, NULL, getLineNumber());  fprintf(compiler->diagnostics, "Expected identifier on variable declaration\n"); compiler->syntax_errors++; }
+    |            KW_REAL error '=' LIT_CHAR { $$ = astCreate(AST_VAR_DECL_REAL, make_missing(DATATYPE_REAL), astCreate(AST_LIT_CHAR, $4, NULL, NULL, NULL, NULL, getLineNumber()), NULL, NULL, NULL, getLineNumber());  fprintf(compiler->diagnostics, "Expected identifier on variable declaration\n"); compiler->syntax_errors++; }
+    |            KW_BOOL error '=' LIT_CHAR { $$ = astCreate(AST_VAR_DECL_BOOL, make_missing(DATATYPE_BOOL), astCreate(AST_LIT_CHAR, $4, NULL, NULL, NULL, NULL, getLineNumber()), NULL, NULL, NULL, getLineNumber());  fprintf(compiler->diagnostics, "Expected identifier on variable declaration\n"); compiler->syntax_errors++; }
+
+    |            KW_INT error '='  LIT_REAL { $$ = astCreate(AST_VAR_DECL_INT, make_missing(DATATYPE_INT), astCreate(AST_LIT_REAL, $4, NULL, NULL, NULL, NULL, getLineNumber()), NULL, NULL, NULL, getLineNumber()); fprintf(compiler->diagnostics, "Expected identifier on variable declaration\n"); compiler->syntax_errors++; }
+    |            KW_CHAR error '=' LIT_REAL { $$ = astCreate(AST_VAR_DECL_CHAR, make_missing(DATATYPE_CHAR), astCreate(AST_LIT_REAL, $4, NULL, NULL, NULL, NULL, getLineNumber()), NULL, NULL, NULL, getLineNumber());  fprintf(compiler->diagnostics, "Expected identifier on variable declaration\n"); compiler->syntax_errors++; }
+    |            KW_REAL error '=' LIT_REAL { $$ = astCreate(AST_VAR_DECL_REAL, make_missing(DATATYPE_REAL), astCreate(AST_LIT_REAL, $4, NULL, NULL, NULL, NULL, getLineNumber()), NULL, NULL, NULL, getLineNumber());  fprintf(compiler->diagnostics, "Expected identifier on variable declaration\n"); compiler->syntax_errors++; }
+    |            KW_BOOL error '=' LIT_REAL { $$ = astCreate(AST_VAR_DECL_BOOL, make_missing(DATATYPE_BOOL), astCreate(AST_LIT_REAL, $4, NULL, NULL, NULL, NULL, getLineNumber()), NULL, NULL, NULL, getLineNumber());  fprintf(compiler->diagnostics, "Expected identifier on variable declaration\n"); compiler->syntax_errors++; }
+
+
+    |           KW_INT TK_IDENTIFIER error LIT_INT  { $$ = astCreate(AST_VAR_DECL_INT, $2, astCreate(AST_LIT_INT, $4, NULL, NULL, NULL, NULL, getLineNumber()), NULL, NULL, NULL, getLineNumber()); fprintf(compiler->diagnostics, "Expected = on variable declaration\n"); compiler->syntax_errors++; }
+    |KW_CHAR TK_IDENTIFIER error LIT_INT { $$ = astCreate(AST_VAR_DECL_CHAR, $2, astCreate(AST_LIT_INT, $4, NULL, NULL, NULL, NULL, getLineNumber()), NULL, NULL, NULL, getLineNumber());  fprintf(compiler->diagnostics, "Expected = on variable declaration\n"); compiler->syntax_errors++; }
+    |KW_REAL TK_IDENTIFIER error LIT_INT { $$ = astCreate(AST_VAR_DECL_REAL, $2, astCreate(AST_LIT_INT, $4, NULL, NULL, NULL, NULL, getLineNumber()), NULL, NULL, NULL, getLineNumber());  fprintf(compiler->diagnostics, "Expected = on variable declaration\n"); compiler->syntax_errors++; }
+    |KW_BOOL TK_IDENTIFIER error LIT_INT { $$ = astCreate(AST_VAR_DECL_BOOL, $2, astCreate(AST_LIT_INT, $4, NULL, NULL, NULL, NULL, getLineNumber()), NULL, NULL, NULL, getLineNumber());  fprintf(compiler->diagnostics, "Expected = on variable declaration\n"); compiler->syntax_errors++; }
     
-    |KW_INT TK_IDENTIFIER error LIT_CHAR  { $$ = astCreate(AST_VAR_DECL_INT, $2, astCreate(AST_LIT_CHAR, $4, NULL, NULL, NULL, NULL, getLineNumber()), NULL, NULL, NULL, getLineNumber()); fprintf(stderr, "Expected = on variable declaration\n"); SyntaxErrors++; }
-    |KW_CHAR TK_IDENTIFIER error LIT_CHAR { $$ = astCreate(AST_VAR_DECL_CHAR, $2, astCreate(AST_LIT_CHAR, $4, NULL, NULL, NULL, NULL, getLineNumber()), NULL, NULL, NULL, getLineNumber());  fprintf(stderr, "Expected = on variable declaration\n"); SyntaxErrors++; }
-    |KW_REAL TK_IDENTIFIER error LIT_CHAR { $$ = astCreate(AST_VAR_DECL_REAL, $2, astCreate(AST_LIT_CHAR, $4, NULL, NULL, NULL, NULL, getLineNumber()), NULL, NULL, NULL, getLineNumber());  fprintf(stderr, "Expected = on variable declaration\n"); SyntaxErrors++; }
-    |KW_BOOL TK_IDENTIFIER error LIT_CHAR { $$ = astCreate(AST_VAR_DECL_BOOL, $2, astCreate(AST_LIT_CHAR, $4, NULL, NULL, NULL, NULL, getLineNumber()), NULL, NULL, NULL, getLineNumber());  fprintf(stderr, "Expected = on variable declaration\n"); SyntaxErrors++; }
+    |KW_INT TK_IDENTIFIER error LIT_CHAR  { $$ = astCreate(AST_VAR_DECL_INT, $2, astCreate(AST_LIT_CHAR, $4, NULL, NULL, NULL, NULL, getLineNumber()), NULL, NULL, NULL, getLineNumber()); fprintf(compiler->diagnostics, "Expected = on variable declaration\n"); compiler->syntax_errors++; }
+    |KW_CHAR TK_IDENTIFIER error LIT_CHAR { $$ = astCreate(AST_VAR_DECL_CHAR, $2, astCreate(AST_LIT_CHAR, $4, NULL, NULL, NULL, NULL, getLineNumber()), NULL, NULL, NULL, getLineNumber());  fprintf(compiler->diagnostics, "Expected = on variable declaration\n"); compiler->syntax_errors++; }
+    |KW_REAL TK_IDENTIFIER error LIT_CHAR { $$ = astCreate(AST_VAR_DECL_REAL, $2, astCreate(AST_LIT_CHAR, $4, NULL, NULL, NULL, NULL, getLineNumber()), NULL, NULL, NULL, getLineNumber());  fprintf(compiler->diagnostics, "Expected = on variable declaration\n"); compiler->syntax_errors++; }
+    |KW_BOOL TK_IDENTIFIER error LIT_CHAR { $$ = astCreate(AST_VAR_DECL_BOOL, $2, astCreate(AST_LIT_CHAR, $4, NULL, NULL, NULL, NULL, getLineNumber()), NULL, NULL, NULL, getLineNumber());  fprintf(compiler->diagnostics, "Expected = on variable declaration\n"); compiler->syntax_errors++; }
 
-    |KW_INT TK_IDENTIFIER error LIT_REAL  { $$ = astCreate(AST_VAR_DECL_INT, $2, astCreate(AST_LIT_REAL, $4, NULL, NULL, NULL, NULL, getLineNumber()), NULL, NULL, NULL, getLineNumber()); fprintf(stderr, "Expected = on variable declaration\n"); SyntaxErrors++; }
-    |KW_CHAR TK_IDENTIFIER error LIT_REAL { $$ = astCreate(AST_VAR_DECL_CHAR, $2, astCreate(AST_LIT_REAL, $4, NULL, NULL, NULL, NULL, getLineNumber()), NULL, NULL, NULL, getLineNumber());  fprintf(stderr, "Expected = on variable declaration\n"); SyntaxErrors++; }
-    |KW_REAL TK_IDENTIFIER error LIT_REAL { $$ = astCreate(AST_VAR_DECL_REAL, $2, astCreate(AST_LIT_REAL, $4, NULL, NULL, NULL, NULL, getLineNumber()), NULL, NULL, NULL, getLineNumber());  fprintf(stderr, "Expected = on variable declaration\n"); SyntaxErrors++; }
-    |KW_BOOL TK_IDENTIFIER error LIT_REAL { $$ = astCreate(AST_VAR_DECL_BOOL, $2, astCreate(AST_LIT_REAL, $4, NULL, NULL, NULL, NULL, getLineNumber()), NULL, NULL, NULL, getLineNumber());  fprintf(stderr, "Expected = on variable declaration\n"); SyntaxErrors++; }
+    |KW_INT TK_IDENTIFIER error LIT_REAL  { $$ = astCreate(AST_VAR_DECL_INT, $2, astCreate(AST_LIT_REAL, $4, NULL, NULL, NULL, NULL, getLineNumber()), NULL, NULL, NULL, getLineNumber()); fprintf(compiler->diagnostics, "Expected = on variable declaration\n"); compiler->syntax_errors++; }
+    |KW_CHAR TK_IDENTIFIER error LIT_REAL { $$ = astCreate(AST_VAR_DECL_CHAR, $2, astCreate(AST_LIT_REAL, $4, NULL, NULL, NULL, NULL, getLineNumber()), NULL, NULL, NULL, getLineNumber());  fprintf(compiler->diagnostics, "Expected = on variable declaration\n"); compiler->syntax_errors++; }
+    |KW_REAL TK_IDENTIFIER error LIT_REAL { $$ = astCreate(AST_VAR_DECL_REAL, $2, astCreate(AST_LIT_REAL, $4, NULL, NULL, NULL, NULL, getLineNumber()), NULL, NULL, NULL, getLineNumber());  fprintf(compiler->diagnostics, "Expected = on variable declaration\n"); compiler->syntax_errors++; }
+    |KW_BOOL TK_IDENTIFIER error LIT_REAL { $$ = astCreate(AST_VAR_DECL_BOOL, $2, astCreate(AST_LIT_REAL, $4, NULL, NULL, NULL, NULL, getLineNumber()), NULL, NULL, NULL, getLineNumber());  fprintf(compiler->diagnostics, "Expected = on variable declaration\n"); compiler->syntax_errors++; }
 
 
-    |KW_INT TK_IDENTIFIER '=' error  { $$ = astCreate(AST_VAR_DECL_INT, $2, astCreate(AST_LIT_REAL, make_value(SYMBOL_LIT_INTEGER), NULL, NULL, NULL, NULL, getLineNumber()), NULL, NULL, NULL, getLineNumber()); fprintf(stderr, "Expected literal as value on variable declaration\n"); SyntaxErrors++; }
-    |KW_CHAR TK_IDENTIFIER '=' error { $$ = astCreate(AST_VAR_DECL_CHAR, $2, astCreate(AST_LIT_REAL, make_value(SYMBOL_LIT_CHAR), NULL, NULL, NULL, NULL, getLineNumber()), NULL, NULL, NULL, getLineNumber());  fprintf(stderr, "Expected literal as value on variable declaration\n"); SyntaxErrors++; }
-    |KW_REAL TK_IDENTIFIER '=' error { $$ = astCreate(AST_VAR_DECL_REAL, $2, astCreate(AST_LIT_REAL, make_value(SYMBOL_LIT_REAL), NULL, NULL, NULL, NULL, getLineNumber()), NULL, NULL, NULL, getLineNumber());  fprintf(stderr, "Expected literal as value on variable declaration\n"); SyntaxErrors++; }
-    |KW_BOOL TK_IDENTIFIER '=' error { $$ = astCreate(AST_VAR_DECL_BOOL, $2, astCreate(AST_LIT_REAL, make_value(SYMBOL_LIT_INTEGER), NULL, NULL, NULL, NULL, getLineNumber()), NULL, NULL, NULL, getLineNumber());  fprintf(stderr, "Expected literal as value on variable declaration\n"); SyntaxErrors++; }
+    |KW_INT TK_IDENTIFIER '=' error  { $$ = astCreate(AST_VAR_DECL_INT, $2, astCreate(AST_LIT_REAL, make_value(SYMBOL_LIT_INTEGER), NULL, NULL, NULL, NULL, getLineNumber()), NULL, NULL, NULL, getLineNumber()); fprintf(compiler->diagnostics, "Expected literal as value on variable declaration\n"); compiler->syntax_errors++; }
+    |KW_CHAR TK_IDENTIFIER '=' error { $$ = astCreate(AST_VAR_DECL_CHAR, $2, astCreate(AST_LIT_REAL, make_value(SYMBOL_LIT_CHAR), NULL, NULL, NULL, NULL, getLineNumber()), NULL, NULL, NULL, getLineNumber());  fprintf(compiler->diagnostics, "Expected literal as value on variable declaration\n"); compiler->syntax_errors++; }
+    |KW_REAL TK_IDENTIFIER '=' error { $$ = astCreate(AST_VAR_DECL_REAL, $2, astCreate(AST_LIT_REAL, make_value(SYMBOL_LIT_REAL), NULL, NULL, NULL, NULL, getLineNumber()), NULL, NULL, NULL, getLineNumber());  fprintf(compiler->diagnostics, "Expected literal as value on variable declaration\n"); compiler->syntax_errors++; }
+    |KW_BOOL TK_IDENTIFIER '=' error { $$ = astCreate(AST_VAR_DECL_BOOL, $2, astCreate(AST_LIT_REAL, make_value(SYMBOL_LIT_INTEGER), NULL, NULL, NULL, NULL, getLineNumber()), NULL, NULL, NULL, getLineNumber());  fprintf(compiler->diagnostics, "Expected literal as value on variable declaration\n"); compiler->syntax_errors++; }
   
     ;
 
@@ -223,15 +163,15 @@ vec_declaration: KW_INT TK_IDENTIFIER '[' LIT_INT ']'  vec_init_opt  { $$ = astC
     |            KW_BOOL TK_IDENTIFIER '[' LIT_INT ']' vec_init_opt { $$ = astCreate(AST_VEC_DECL_BOOL, $2, astCreate(AST_LIT_INT, $4, NULL, NULL, NULL, NULL, getLineNumber()), $6, NULL, NULL, getLineNumber()); }
     
     // errors
-    |            KW_INT TK_IDENTIFIER '[' error ']' vec_init_opt  { $$ = 0; fprintf(stderr, "Expected size on vector declaration\n"); SyntaxErrors++; }
-    |            KW_CHAR TK_IDENTIFIER '[' error ']' vec_init_opt { $$ = 0;  fprintf(stderr, "Expected size on vector declaration\n"); SyntaxErrors++; }
-    |            KW_REAL TK_IDENTIFIER '[' error ']' vec_init_opt  { $$ = 0;  fprintf(stderr, "Expected size on vector declaration\n"); SyntaxErrors++; }
-    |            KW_BOOL TK_IDENTIFIER '[' error ']' vec_init_opt  { $$ = 0;  fprintf(stderr, "Expected size on vector declaration\n"); SyntaxErrors++; }
+    |            KW_INT TK_IDENTIFIER '[' error ']' vec_init_opt  { $$ = 0; fprintf(compiler->diagnostics, "Expected size on vector declaration\n"); compiler->syntax_errors++; }
+    |            KW_CHAR TK_IDENTIFIER '[' error ']' vec_init_opt { $$ = 0;  fprintf(compiler->diagnostics, "Expected size on vector declaration\n"); compiler->syntax_errors++; }
+    |            KW_REAL TK_IDENTIFIER '[' error ']' vec_init_opt  { $$ = 0;  fprintf(compiler->diagnostics, "Expected size on vector declaration\n"); compiler->syntax_errors++; }
+    |            KW_BOOL TK_IDENTIFIER '[' error ']' vec_init_opt  { $$ = 0;  fprintf(compiler->diagnostics, "Expected size on vector declaration\n"); compiler->syntax_errors++; }
     
-    |            KW_INT TK_IDENTIFIER '[' LIT_INT ']' error  { $$ = 0; fprintf(stderr, "Expected literal list on vector declaration opt\n"); SyntaxErrors++; }
-    |            KW_CHAR TK_IDENTIFIER '[' LIT_INT ']' error { $$ = 0;  fprintf(stderr, "Expected literal list on vector declaration opt\n"); SyntaxErrors++; }
-    |            KW_REAL TK_IDENTIFIER '[' LIT_INT ']' error  { $$ = 0;  fprintf(stderr, "Expected literal list on vector declaration opt\n"); SyntaxErrors++; }
-    |            KW_BOOL TK_IDENTIFIER '[' LIT_INT ']' error  { $$ = 0;  fprintf(stderr, "Expected literal list on vector declaration opt\n"); SyntaxErrors++; }
+    |            KW_INT TK_IDENTIFIER '[' LIT_INT ']' error  { $$ = 0; fprintf(compiler->diagnostics, "Expected literal list on vector declaration opt\n"); compiler->syntax_errors++; }
+    |            KW_CHAR TK_IDENTIFIER '[' LIT_INT ']' error { $$ = 0;  fprintf(compiler->diagnostics, "Expected literal list on vector declaration opt\n"); compiler->syntax_errors++; }
+    |            KW_REAL TK_IDENTIFIER '[' LIT_INT ']' error  { $$ = 0;  fprintf(compiler->diagnostics, "Expected literal list on vector declaration opt\n"); compiler->syntax_errors++; }
+    |            KW_BOOL TK_IDENTIFIER '[' LIT_INT ']' error  { $$ = 0;  fprintf(compiler->diagnostics, "Expected literal list on vector declaration opt\n"); compiler->syntax_errors++; }
     ;
 
 parameter: KW_INT TK_IDENTIFIER     { $$ = astCreate(AST_PARAM_INT, $2, NULL, NULL, NULL, NULL, getLineNumber()); }
@@ -256,15 +196,15 @@ func_declaration: KW_INT TK_IDENTIFIER '(' parameter_list ')' body      { $$ = a
 
 body: '{' cmd_list '}' { $$ = astCreate(AST_BODY, NULL, $2, NULL, NULL, NULL, getLineNumber()); }
 
-    //| error cmd_list '}' { $$ = astCreate(AST_BODY, NULL, $2, NULL, NULL, NULL, getLineNumber()); fprintf(stderr, "Expecting { on start of block\n"); SyntaxErrors++; }
-   // | '{' cmd_list error { $$ = astCreate(AST_BODY, NULL, $2, NULL, NULL, NULL, getLineNumber()); fprintf(stderr, "Expecting } on end of block\n"); SyntaxErrors++; }
+    //| error cmd_list '}' { $$ = astCreate(AST_BODY, NULL, $2, NULL, NULL, NULL, getLineNumber()); fprintf(compiler->diagnostics, "Expecting { on start of block\n"); compiler->syntax_errors++; }
+   // | '{' cmd_list error { $$ = astCreate(AST_BODY, NULL, $2, NULL, NULL, NULL, getLineNumber()); fprintf(compiler->diagnostics, "Expecting } on end of block\n"); compiler->syntax_errors++; }
     ;
 
 cmd_list: cmd ';' cmd_list { $$ = astCreate(AST_CMD_LIST, 0, $1, $3, NULL, NULL, getLineNumber()); }
     |     body cmd_list    { $$ = astCreate(AST_CMD_LIST, 0, $1, $2, NULL, NULL, getLineNumber()); }
     |     if_statement cmd_list     { $$ = astCreate(AST_CMD_LIST, 0, $1, $2, NULL, NULL, getLineNumber()); }
     
-    |   cmd error cmd_list { $$ = astCreate(AST_CMD_LIST, 0, $1, $3, NULL, NULL, getLineNumber()); fprintf(stderr, "Expecting ; on end of command\n"); SyntaxErrors++; }
+    |   cmd error cmd_list { $$ = astCreate(AST_CMD_LIST, 0, $1, $3, NULL, NULL, getLineNumber()); fprintf(compiler->diagnostics, "Expecting ; on end of command\n"); compiler->syntax_errors++; }
 
     |     { $$ = 0; }
     ;
@@ -278,19 +218,19 @@ if_statement: KW_IF '(' expr ')' if_body           { $$ = astCreate(AST_IF, 0, $
     | KW_IF '(' expr ')' KW_LOOP if_body           { $$ = astCreate(AST_LOOP, 0, $3, $6, NULL, NULL, getLineNumber()); }
 
     // errors
-   // | KW_IF '(' expr ')' if_body KW_ELSE error   { $$ = astCreate(AST_IF_ELSE, 0, $3, $5, NULL, NULL, getLineNumber()); fprintf(stderr, "Expecting else body\n"); SyntaxErrors++; }
-    | KW_IF '(' expr ')' KW_LOOP error           { $$ = astCreate(AST_LOOP, 0, $3, NULL, NULL, NULL, getLineNumber()); fprintf(stderr, "Expecting loop body\n"); SyntaxErrors++; }
+   // | KW_IF '(' expr ')' if_body KW_ELSE error   { $$ = astCreate(AST_IF_ELSE, 0, $3, $5, NULL, NULL, getLineNumber()); fprintf(compiler->diagnostics, "Expecting else body\n"); compiler->syntax_errors++; }
+    | KW_IF '(' expr ')' KW_LOOP error           { $$ = astCreate(AST_LOOP, 0, $3, NULL, NULL, NULL, getLineNumber()); fprintf(compiler->diagnostics, "Expecting loop body\n"); compiler->syntax_errors++; }
      
-    | KW_IF error expr ')' if_body           { $$ = astCreate(AST_IF, 0, $3, $5, NULL, NULL, getLineNumber()); fprintf(stderr, "Expecting ( at the start of if condition\n"); SyntaxErrors++; }
-    | KW_IF '(' expr error if_body           { $$ = astCreate(AST_IF, 0, $3, $5, NULL, NULL, getLineNumber()); fprintf(stderr, "Expecting ) at the end of if condition\n"); SyntaxErrors++; }
-    | KW_IF error expr ')' if_body KW_ELSE if_body   { $$ = astCreate(AST_IF_ELSE, 0, $3, $5, $7, NULL, getLineNumber()); fprintf(stderr, "Expecting ( at the start of if condition\n"); SyntaxErrors++; }
-    | KW_IF '(' expr error if_body KW_ELSE if_body   { $$ = astCreate(AST_IF_ELSE, 0, $3, $5, $7, NULL, getLineNumber()); fprintf(stderr, "Expecting ) at the end of if condition\n"); SyntaxErrors++; }
-    | KW_IF error expr ')' KW_LOOP if_body           { $$ = astCreate(AST_LOOP, 0, $3, $6, NULL, NULL, getLineNumber()); fprintf(stderr, "Expecting ( at the start of loop condition\n"); SyntaxErrors++;}
-    | KW_IF '(' expr error KW_LOOP if_body           { $$ = astCreate(AST_LOOP, 0, $3, $6, NULL, NULL, getLineNumber()); fprintf(stderr, "Expecting ) at the end of loop condition\n"); SyntaxErrors++;}
-
-    | KW_IF error expr error if_body           { $$ = astCreate(AST_IF, 0, $3, $5, NULL, NULL, getLineNumber()); fprintf(stderr, "Expecting if condition to be inside (...)\n"); SyntaxErrors++; }
-    | KW_IF error expr error if_body KW_ELSE if_body   { $$ = astCreate(AST_IF_ELSE, 0, $3, $5, $7, NULL, getLineNumber()); fprintf(stderr, "Expecting if condition to be inside (...)\n"); SyntaxErrors++; }
-    | KW_IF error expr error KW_LOOP if_body           { $$ = astCreate(AST_LOOP, 0, $3, $6, NULL, NULL, getLineNumber()); fprintf(stderr, "Expecting loop condition to be inside (...)\n"); SyntaxErrors++;}
+    | KW_IF error expr ')' if_body           { $$ = astCreate(AST_IF, 0, $3, $5, NULL, NULL, getLineNumber()); fprintf(compiler->diagnostics, "Expecting ( at the start of if condition\n"); compiler->syntax_errors++; }
+    | KW_IF '(' expr error if_body           { $$ = astCreate(AST_IF, 0, $3, $5, NULL, NULL, getLineNumber()); fprintf(compiler->diagnostics, "Expecting ) at the end of if condition\n"); compiler->syntax_errors++; }
+    | KW_IF error expr ')' if_body KW_ELSE if_body   { $$ = astCreate(AST_IF_ELSE, 0, $3, $5, $7, NULL, getLineNumber()); fprintf(compiler->diagnostics, "Expecting ( at the start of if condition\n"); compiler->syntax_errors++; }
+    | KW_IF '(' expr error if_body KW_ELSE if_body   { $$ = astCreate(AST_IF_ELSE, 0, $3, $5, $7, NULL, getLineNumber()); fprintf(compiler->diagnostics, "Expecting ) at the end of if condition\n"); compiler->syntax_errors++; }
+    | KW_IF error expr ')' KW_LOOP if_body           { $$ = astCreate(AST_LOOP, 0, $3, $6, NULL, NULL, getLineNumber()); fprintf(compiler->diagnostics, "Expecting ( at the start of loop condition\n"); compiler->syntax_errors++;}
+    | KW_IF '(' expr error KW_LOOP if_body           { $$ = astCreate(AST_LOOP, 0, $3, $6, NULL, NULL, getLineNumber()); fprintf(compiler->diagnostics, "Expecting ) at the end of loop condition\n"); compiler->syntax_errors++;}
+
+    | KW_IF error expr error if_body           { $$ = astCreate(AST_IF, 0, $3, $5, NULL, NULL, getLineNumber()); fprintf(compiler->diagnostics, "Expecting if condition to be inside (...)\n"); compiler->syntax_errors++; }
+    | KW_IF error expr error if_body KW_ELSE if_body   { $$ = astCreate(AST_IF_ELSE, 0, $3, $5, $7, NULL, getLineNumber()); fprintf(compiler->diagnostics, "Expecting if condition to be inside (...)\n"); compiler->syntax_errors++; }
+    | KW_IF error expr error KW_LOOP if_body           { $$ = astCreate(AST_LOOP, 0, $3, $6, NULL, NULL, getLineNumber()); fprintf(compiler->diagnostics, "Expecting loop condition to be inside (...)\n"); compiler->syntax_errors++;}
     ;
 
 cmd:  var_attrib {  $$ = $1; }
@@ -301,11 +241,11 @@ cmd:  var_attrib {  $$ = $1; }
     ;
 
 var_attrib: TK_IDENTIFIER '=' expr { $$ = astCreate(AST_VAR_ATTRIB, $1, $3, NULL, NULL, NULL, getLineNumber());  }
-    | TK_IDENTIFIER error expr { $$ = astCreate(AST_VAR_ATTRIB, $1, $3, NULL, NULL, NULL, getLineNumber()); fprintf(stderr, "Expecting = on variable assignment\n"); SyntaxErrors++;  }
+    | TK_IDENTIFIER error expr { $$ = astCreate(AST_VAR_ATTRIB, $1, $3, NULL, NULL, NULL, getLineNumber()); fprintf(compiler->diagnostics, "Expecting = on variable assignment\n"); compiler->syntax_errors++;  }
     ;
 
 vec_attrib: TK_IDENTIFIER '[' expr ']' '=' expr { $$ = astCreate(AST_VEC_ATTRIB, $1, $3, $6, NULL, NULL, getLineNumber()); }
-    | TK_IDENTIFIER '[' expr ']' error expr { $$ = astCreate(AST_VEC_ATTRIB, $1, $3, $6, NULL, NULL, getLineNumber());  fprintf(stderr, "Expecting = on vector assignment\n"); SyntaxErrors++; }
+    | TK_IDENTIFIER '[' expr ']' error expr { $$ = astCreate(AST_VEC_ATTRIB, $1, $3, $6, NULL, NULL, getLineNumber());  fprintf(compiler->diagnostics, "Expecting = on vector assignment\n"); compiler->syntax_errors++; }
     ;
 
 output_cmd: KW_OUTPUT output_param_list { $$ = astCreate(AST_OUTPUT_CMD, 0, $2, NULL, NULL, NULL, getLineNumber()); }
@@ -317,14 +257,14 @@ output_param_list: LIT_STRING ',' output_param_list     { $$ = astCreate(AST_OUT
     |              expr                                 { $$ = astCreate(AST_OUTPUT_PARAM_LIST, NULL, $1,  NULL, NULL, NULL, getLineNumber()); }
 
     // errors
-    |LIT_STRING error output_param_list     { $$ = astCreate(AST_OUTPUT_PARAM_LIST, NULL, astCreate(AST_LIT_STRING, $1, NULL, NULL, NULL, NULL, getLineNumber()), $3, NULL, NULL, getLineNumber()); fprintf(stderr, "Expecting , on output command\n"); SyntaxErrors++; }
-    |expr error output_param_list           { $$ = astCreate(AST_OUTPUT_PARAM_LIST, 0, $1, $3, NULL, NULL, getLineNumber()); fprintf(stderr, "Expecting , on output command\n"); SyntaxErrors++; }
+    |LIT_STRING error output_param_list     { $$ = astCreate(AST_OUTPUT_PARAM_LIST, NULL, astCreate(AST_LIT_STRING, $1, NULL, NULL, NULL, NULL, getLineNumber()), $3, NULL, NULL, getLineNumber()); fprintf(compiler->diagnostics, "Expecting , on output command\n"); compiler->syntax_errors++; }
+    |expr error output_param_list           { $$ = astCreate(AST_OUTPUT_PARAM_LIST, 0, $1, $3, NULL, NULL, getLineNumber()); fprintf(compiler->diagnostics, "Expecting , on output command\n"); compiler->syntax_errors++; }
     |              { $$ = 0; }
     ;
 
 return_cmd: KW_RETURN expr { $$ = astCreate(AST_RETURN_CMD, 0, $2, NULL, NULL, NULL, getLineNumber()); }
     // errors
-    // | KW_RETURN error { $$ = astCreate(AST_RETURN_CMD, 0, NULL, NULL, NULL, NULL, getLineNumber()); fprintf(stderr, "Expecting expression on return command\n"); SyntaxErrors++; }
+    // | KW_RETURN error { $$ = astCreate(AST_RETURN_CMD, 0, NULL, NULL, NULL, NULL, getLineNumber()); fprintf(compiler->diagnostics, "Expecting expression on return command\n"); compiler->syntax_errors++; }
     ;
     
 input_expr: KW_INPUT '(' KW_INT ')'  { $$ = astCreate(AST_INPUT_EXPR_INT, 0, NULL, NULL, NULL, NULL, getLineNumber()); }
@@ -333,24 +273,24 @@ input_expr: KW_INPUT '(' KW_INT ')'  { $$ = astCreate(AST_INPUT_EXPR_INT, 0, NUL
     |       KW_INPUT '(' KW_BOOL ')' { $$ = astCreate(AST_INPUT_EXPR_BOOL, 0, NULL, NULL, NULL, NULL, getLineNumber()); }
 
     // errors
-    |       KW_INPUT '(' error ')' { $$ = astCreate(AST_INPUT_EXPR_INT, 0, NULL, NULL, NULL, NULL, getLineNumber()); fprintf(stderr, "Expecting type on input command\n"); SyntaxErrors++; }
-    |       KW_INPUT error {  $$ =  astCreate(AST_INPUT_EXPR_INT, 0, NULL, NULL, NULL, NULL, getLineNumber()); fprintf(stderr, "Expecting (type) on input command\n"); SyntaxErrors++; }
+    |       KW_INPUT '(' error ')' { $$ = astCreate(AST_INPUT_EXPR_INT, 0, NULL, NULL, NULL, NULL, getLineNumber()); fprintf(compiler->diagnostics, "Expecting type on input command\n"); compiler->syntax_errors++; }
+    |       KW_INPUT error {  $$ =  astCreate(AST_INPUT_EXPR_INT, 0, NULL, NULL, NULL, NULL, getLineNumber()); fprintf(compiler->diagnostics, "Expecting (type) on input command\n"); compiler->syntax_errors++; }
 
-    |       KW_INPUT error KW_INT ')' { $$ =  astCreate(AST_INPUT_EXPR_INT, 0, NULL, NULL, NULL, NULL, getLineNumber()); fprintf(stderr, "Expecting ( after input command type, it should be input(int) instead\n"); SyntaxErrors++; }
-    |       KW_INPUT '(' KW_INT error {  $$ =  astCreate(AST_INPUT_EXPR_INT, 0, NULL, NULL, NULL, NULL, getLineNumber()); fprintf(stderr, "Expecting ) after input command type, it should be input(int) instead\n"); SyntaxErrors++; }
-    |       KW_INPUT error KW_INT error {  $$ =  astCreate(AST_INPUT_EXPR_INT, 0, NULL, NULL, NULL, NULL, getLineNumber()); fprintf(stderr, "Expecting input command type to be this way input(int)\n"); SyntaxErrors++; }
+    |       KW_INPUT error KW_INT ')' { $$ =  astCreate(AST_INPUT_EXPR_INT, 0, NULL, NULL, NULL, NULL, getLineNumber()); fprintf(compiler->diagnostics, "Expecting ( after input command type, it should be input(int) instead\n"); compiler->syntax_errors++; }
+    |       KW_INPUT '(' KW_INT error {  $$ =  astCreate(AST_INPUT_EXPR_INT, 0, NULL, NULL, NULL, NULL, getLineNumber()); fprintf(compiler->diagnostics, "Expecting ) after input command type, it should be input(int) instead\n"); compiler->syntax_errors++; }
+    |       KW_INPUT error KW_INT error {  $$ =  astCreate(AST_INPUT_EXPR_INT, 0, NULL, NULL, NULL, NULL, getLineNumber()); fprintf(compiler->diagnostics, "Expecting input command type to be this way input(int)\n"); compiler->syntax_errors++; }
 
-    |       KW_INPUT error KW_CHAR ')' {  $$ = astCreate(AST_INPUT_EXPR_CHAR, 0, NULL, NULL, NULL, NULL, getLineNumber()); fprintf(stderr, "Expecting ( after input command type, it should be input(char) instead\n"); SyntaxErrors++; }
-    |       KW_INPUT '(' KW_CHAR error {  $$ =  astCreate(AST_INPUT_EXPR_CHAR, 0, NULL, NULL, NULL, NULL, getLineNumber()); fprintf(stderr, "Expecting ) after input command type, it should be input(char) instead\n"); SyntaxErrors++; }
-    |       KW_INPUT error KW_CHAR error {  $$ =  astCreate(AST_INPUT_EXPR_CHAR, 0, NULL, NULL, NULL, NULL, getLineNumber()); fprintf(stderr, "Expecting input command type to be this way input(char)\n"); SyntaxErrors++; }
+    |       KW_INPUT error KW_CHAR ')' {  $$ = astCreate(AST_INPUT_EXPR_CHAR, 0, NULL, NULL, NULL, NULL, getLineNumber()); fprintf(compiler->diagnostics, "Expecting ( after input command type, it should be input(char) instead\n"); compiler->syntax_errors++; }
+    |       KW_INPUT '(' KW_CHAR error {  $$ =  astCreate(AST_INPUT_EXPR_CHAR, 0, NULL, NULL, NULL, NULL, getLineNumber()); fprintf(compiler->diagnostics, "Expecting ) after input command type, it should be input(char) instead\n"); compiler->syntax_errors++; }
+    |       KW_INPUT error KW_CHAR error {  $$ =  astCreate(AST_INPUT_EXPR_CHAR, 0, NULL, NULL, NULL, NULL, getLineNumber()); fprintf(compiler->diagnostics, "Expecting input command type to be this way input(char)\n"); compiler->syntax_errors++; }
 
-    |       KW_INPUT error KW_REAL ')' {  $$ = astCreate(AST_INPUT_EXPR_REAL, 0, NULL, NULL, NULL, NULL, getLineNumber()); fprintf(stderr, "Expecting ( after input command type, it should be input(real) instead\n"); SyntaxErrors++; }
-    |       KW_INPUT '(' KW_REAL error {  $$ =  astCreate(AST_INPUT_EXPR_REAL, 0, NULL, NULL, NULL, NULL, getLineNumber()); fprintf(stderr, "Expecting ) after input command type, it should be input(real) instead\n"); SyntaxErrors++; }
-    |       KW_INPUT error KW_REAL error {  $$ =  astCreate(AST_INPUT_EXPR_REAL, 0, NULL, NULL, NULL, NULL, getLineNumber()); fprintf(stderr, "Expecting input command type to be this way input(real)\n"); SyntaxErrors++; }
+    |       KW_INPUT error KW_REAL ')' {  $$ = astCreate(AST_INPUT_EXPR_REAL, 0, NULL, NULL, NULL, NULL, getLineNumber()); fprintf(compiler->diagnostics, "Expecting ( after input command type, it should be input(real) instead\n"); compiler->syntax_errors++; }
+    |       KW_INPUT '(' KW_REAL error {  $$ =  astCreate(AST_INPUT_EXPR_REAL, 0, NULL, NULL, NULL, NULL, getLineNumber()); fprintf(compiler->diagnostics, "Expecting ) after input command type, it should be input(real) instead\n"); compiler->syntax_errors++; }
+    |       KW_INPUT error KW_REAL error {  $$ =  astCreate(AST_INPUT_EXPR_REAL, 0, NULL, NULL, NULL, NULL, getLineNumber()); fprintf(compiler->diagnostics, "Expecting input command type to be this way input(real)\n"); compiler->syntax_errors++; }
 
-    |       KW_INPUT error KW_BOOL ')' {  $$ = astCreate(AST_INPUT_EXPR_BOOL, 0, NULL, NULL, NULL, NULL, getLineNumber()); fprintf(stderr, "Expecting ( before input command type, it should be input(bool) instead\n"); SyntaxErrors++; }
-    |       KW_INPUT '(' KW_BOOL error {  $$ =  astCreate(AST_INPUT_EXPR_BOOL, 0, NULL, NULL, NULL, NULL, getLineNumber()); fprintf(stderr, "Expecting ) after input command type, it should be input(bool) instead\n"); SyntaxErrors++; }
-    |       KW_INPUT error KW_BOOL error {   $$ = astCreate(AST_INPUT_EXPR_BOOL, 0, NULL, NULL, NULL, NULL, getLineNumber()); fprintf(stderr, "Expecting input command type to be this way input(bool)\n"); SyntaxErrors++; }
+    |       KW_INPUT error KW_BOOL ')' {  $$ = astCreate(AST_INPUT_EXPR_BOOL, 0, NULL, NULL, NULL, NULL, getLineNumber()); fprintf(compiler->diagnostics, "Expecting ( before input command type, it should be input(bool) instead\n"); compiler->syntax_errors++; }
+    |       KW_INPUT '(' KW_BOOL error {  $$ =  astCreate(AST_INPUT_EXPR_BOOL, 0, NULL, NULL, NULL, NULL, getLineNumber()); fprintf(compiler->diagnostics, "Expecting ) after input command type, it should be input(bool) instead\n"); compiler->syntax_errors++; }
+    |       KW_INPUT error KW_BOOL error {   $$ = astCreate(AST_INPUT_EXPR_BOOL, 0, NULL, NULL, NULL, NULL, getLineNumber()); fprintf(compiler->diagnostics, "Expecting input command type to be this way input(bool)\n"); compiler->syntax_errors++; }
 
     ;
 
@@ -382,9 +322,9 @@ expr: LIT_INT                               { $$ = astCreate(AST_LIT_INT, $1, NU
 
 func_call: TK_IDENTIFIER '(' expr_list ')' { $$ = astCreate(AST_FUNC_CALL, $1, $3, NULL, NULL, NULL, getLineNumber());  }
     // errors
-    | TK_IDENTIFIER '(' expr_list error { $$ = astCreate(AST_FUNC_CALL, $1, $3, NULL, NULL, NULL, getLineNumber()); fprintf(stderr, "Expecting ) on end of function call\n"); SyntaxErrors++; }
-    | TK_IDENTIFIER error expr_list ')' { $$ = astCreate(AST_FUNC_CALL, $1, $3, NULL, NULL, NULL, getLineNumber()); fprintf(stderr, "Expecting ( on start of function call\n"); SyntaxErrors++; }		
-    | TK_IDENTIFIER error expr_list error { $$ = astCreate(AST_FUNC_CALL, $1, $3, NULL, NULL, NULL, getLineNumber()); fprintf(stderr, "Expecting function parameters to be inside (...)\n"); SyntaxErrors++; }	
+    | TK_IDENTIFIER '(' expr_list error { $$ = astCreate(AST_FUNC_CALL, $1, $3, NULL, NULL, NULL, getLineNumber()); fprintf(compiler->diagnostics, "Expecting ) on end of function call\n"); compiler->syntax_errors++; }
+    | TK_IDENTIFIER error expr_list ')' { $$ = astCreate(AST_FUNC_CALL, $1, $3, NULL, NULL, NULL, getLineNumber()); fprintf(compiler->diagnostics, "Expecting ( on start of function call\n"); compiler->syntax_errors++; }		
+    | TK_IDENTIFIER error expr_list error { $$ = astCreate(AST_FUNC_CALL, $1, $3, NULL, NULL, NULL, getLineNumber()); fprintf(compiler->diagnostics, "Expecting function parameters to be inside (...)\n"); compiler->syntax_errors++; }	
     ;
 
 expr_list:  expr expr_list_aux        { $$ = astCreate(AST_EXPR_LIST, NULL, $1, $2, NULL, NULL, getLineNumber());}
@@ -393,7 +333,7 @@ expr_list:  expr expr_list_aux        { $$ = astCreate(AST_EXPR_LIST, NULL, $1,
 
 expr_list_aux: ',' expr expr_list_aux { $$ = astCreate(AST_EXPR_LIST, NULL, $2, $3, NULL, NULL, getLineNumber());}
     // errors
-    | error expr expr_list_aux { $$ = astCreate(AST_EXPR_LIST, NULL, $2, $3, NULL, NULL, getLineNumber()); fprintf(stderr, "Expecting function parameters to be separated by a ,\n"); SyntaxErrors++; }
+    | error expr expr_list_aux { $$ = astCreate(AST_EXPR_LIST, NULL, $2, $3, NULL, NULL, getLineNumber()); fprintf(compiler->diagnostics, "Expecting function parameters to be separated by a ,\n"); compiler->syntax_errors++; }
     |                                 { $$ = 0; }           
     ;
 
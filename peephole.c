@@ -0,0 +1,288 @@
+#include "peephole.h"
+
+int peephole_store_load(MCODE *code, MINSTR *instr);
+int peephole_dead_store(MCODE *code, MINSTR *instr);
+int peephole_redundant_move(MCODE *code, MINSTR *instr);
+int peephole_move_to_store(MCODE *code, MINSTR *instr);
+int peephole_jump_next(MCODE *code, MINSTR *instr);
+int peephole_branch_over_jump(MCODE *code, MINSTR *instr);
+int peephole_setcc_branch(MCODE *code, MINSTR *instr);
+int peephole_unordered_branch(MCODE *code, MINSTR *instr);
+
+PEEPHOLE_RULE peephole_rules[] = {
+    {"store-to-load forwarding", peephole_store_load},
+    {"dead temp store", peephole_dead_store},
+    {"redundant move", peephole_redundant_move},
+    {"move into store", peephole_move_to_store},
+    {"jump to next label", peephole_jump_next},
+    {"branch over jump", peephole_branch_over_jump},
+    {"setcc/test/jcc fusion", peephole_setcc_branch},
+    {"unordered setcc/test/jcc fusion", peephole_unordered_branch},
+};
+
+#define PEEPHOLE_RULE_COUNT (int)(sizeof(peephole_rules) / sizeof(peephole_rules[0]))
+
+int peephole_is_move(MINSTR *instr)
+{
+    return instr && (instr->op == MI_MOV || instr->op == MI_MOVSS);
+}
+
+int peephole_is_temp(MOPERAND *operand)
+{
+    return operand->kind == MOP_MEM && operand->symbol.kind == MSYM_HASH && operand->symbol.hash->is_temp;
+}
+
+// temp references are counted in use_count, which the selector no longer needs here
+void peephole_count_refs(MCODE *code)
+{
+    MINSTR *instr;
+    for (instr = code->first; instr; instr = instr->next)
+    {
+        if (peephole_is_temp(&instr->src))
+            instr->src.symbol.hash->use_count = 0;
+        if (peephole_is_temp(&instr->dst))
+            instr->dst.symbol.hash->use_count = 0;
+    }
+    for (instr = code->first; instr; instr = instr->next)
+    {
+        if (peephole_is_temp(&instr->src))
+            instr->src.symbol.hash->use_count++;
+        if (peephole_is_temp(&instr->dst))
+            instr->dst.symbol.hash->use_count++;
+    }
+}
+
+void peephole_unref(MOPERAND *operand)
+{
+    if (peephole_is_temp(operand))
+        operand->symbol.hash->use_count--;
+}
+
+void peephole_delete(MCODE *code, MINSTR *instr)
+{
+    peephole_unref(&instr->src);
+    peephole_unref(&instr->dst);
+    minstr_remove(code, instr);
+}
+
+// mov %r, M; mov M, %s  =>  mov %r, M; mov %r, %s
+int peephole_store_load(MCODE *code, MINSTR *instr)
+{
+    MINSTR *next = instr->next;
+    if (!peephole_is_move(instr) || instr->src.kind != MOP_REG || instr->dst.kind != MOP_MEM)
+        return 0;
+    if (!next || next->op != instr->op || next->size != instr->size || next->dst.kind != MOP_REG)
+        return 0;
+    if (!mop_equal(&next->src, &instr->dst))
+        return 0;
+
+    if (next->dst.reg == instr->src.reg)
+    {
+        peephole_delete(code, next);
+        return 1;
+    }
+    peephole_unref(&next->src);
+    next->src = instr->src;
+    return 1;
+}
+
+// stores to a temp nobody loads any more
+int peephole_dead_store(MCODE *code, MINSTR *instr)
+{
+    if (!peephole_is_move(instr) || !peephole_is_temp(&instr->dst) || instr->dst.symbol.hash->use_count != 1)
+        return 0;
+
+    peephole_delete(code, instr);
+    return 1;
+}
+
+// mov %r, %r  and  mov A, B; mov B, A
+int peephole_redundant_move(MCODE *code, MINSTR *instr)
+{
+    MINSTR *next = instr->next;
+    if (!peephole_is_move(instr))
+        return 0;
+
+    if (instr->src.kind == MOP_REG && mop_equal(&instr->src, &instr->dst))
+    {
+        peephole_delete(code, instr);
+        return 1;
+    }
+
+    if (next && next->op == instr->op && next->size == instr->size && instr->src.kind != MOP_IMM &&
+        mop_equal(&next->src, &instr->dst) && mop_equal(&next->dst, &instr->src))
+    {
+        peephole_delete(code, next);
+        return 1;
+    }
+    return 0;
+}
+
+// mov X, %r; mov %r, Y  =>  mov X, Y  when %r dies and X, Y are not both in memory
+int peephole_move_to_store(MCODE *code, MINSTR *instr)
+{
+    MINSTR *next = instr->next;
+    if (!peephole_is_move(instr) || instr->dst.kind != MOP_REG)
+        return 0;
+    if (!next || next->op != instr->op || next->size != instr->size || !mop_equal(&next->src, &instr->dst))
+        return 0;
+    if (instr->src.kind == MOP_MEM && next->dst.kind == MOP_MEM)
+        return 0;
+    if (instr->op == MI_MOVSS && instr->src.kind == MOP_REG && next->dst.kind == MOP_REG)
+        return 0;
+    if (mop_uses_reg(&next->dst, instr->dst.reg) || !minstr_reg_dead_after(next, instr->dst.reg))
+        return 0;
+
+    next->src = instr->src;
+    minstr_remove(code, instr);
+    return 1;
+}
+
+int peephole_label_follows(MINSTR *instr, MOPERAND *label)
+{
+    MINSTR *next;
+    for (next = instr->next; next && next->op == MI_LABEL; next = next->next)
+    {
+        if (mop_equal(&next->dst, label))
+            return 1;
+    }
+    return 0;
+}
+
+// jmp L; L:  =>  L:
+int peephole_jump_next(MCODE *code, MINSTR *instr)
+{
+    if (instr->op != MI_JMP && instr->op != MI_JCC)
+        return 0;
+    if (!peephole_label_follows(instr, &instr->dst))
+        return 0;
+
+    minstr_remove(code, instr);
+    return 1;
+}
+
+// jcc L1; jmp L2; L1:  =>  jncc L2; L1:
+int peephole_branch_over_jump(MCODE *code, MINSTR *instr)
+{
+    MINSTR *next = instr->next;
+    if (instr->op != MI_JCC || !next || next->op != MI_JMP)
+        return 0;
+    if (instr->cc == CC_P || instr->cc == CC_NP || !peephole_label_follows(next, &instr->dst))
+        return 0;
+
+    instr->cc = cc_negate(instr->cc);
+    instr->dst = next->dst;
+    minstr_remove(code, next);
+    return 1;
+}
+
+// matches movzbl %al, %r; testl %r, %r; je|jne L after the setcc chain
+MINSTR *peephole_test_branch(MINSTR *movzb)
+{
+    MINSTR *test = movzb ? movzb->next : NULL;
+    MINSTR *branch = test ? test->next : NULL;
+    if (!movzb || movzb->op != MI_MOVZB || movzb->src.kind != MOP_REG || movzb->src.reg != REG_RAX || movzb->dst.kind != MOP_REG)
+        return NULL;
+    if (!test || test->op != MI_TEST || !mop_equal(&test->src, &movzb->dst) || !mop_equal(&test->dst, &movzb->dst))
+        return NULL;
+    if (!branch || branch->op != MI_JCC || (branch->cc != CC_E && branch->cc != CC_NE))
+        return NULL;
+    if (!minstr_reg_dead_after(branch, movzb->dst.reg) || !minstr_reg_dead_after(branch, REG_RAX))
+        return NULL;
+    return branch;
+}
+
+// setcc %al; movzbl %al, %r; testl %r, %r; je L  =>  jncc L
+int peephole_setcc_branch(MCODE *code, MINSTR *instr)
+{
+    MINSTR *branch;
+    if (instr->op != MI_SETCC || instr->dst.reg != REG_RAX || instr->cc == CC_P || instr->cc == CC_NP)
+        return 0;
+    branch = peephole_test_branch(instr->next);
+    if (!branch)
+        return 0;
+
+    branch->cc = branch->cc == CC_E ? cc_negate(instr->cc) : instr->cc;
+    minstr_remove(code, instr->next->next);
+    minstr_remove(code, instr->next);
+    minstr_remove(code, instr);
+    return 1;
+}
+
+// ucomiss equality chains become two branches when both jump to the same place:
+// sete %al; setnp %dl; andb %dl, %al; ...; je L  =>  jne L; jp L
+// setne %al; setp %dl; orb %dl, %al; ...; jne L  =>  jne L; jp L
+int peephole_unordered_branch(MCODE *code, MINSTR *instr)
+{
+    MINSTR *parity = instr->next;
+    MINSTR *combine = parity ? parity->next : NULL;
+    MINSTR *branch;
+    if (instr->op != MI_SETCC || instr->dst.reg != REG_RAX || (instr->cc != CC_E && instr->cc != CC_NE))
+        return 0;
+    if (!parity || parity->op != MI_SETCC || parity->dst.reg != REG_RDX || parity->cc != (instr->cc == CC_E ? CC_NP : CC_P))
+        return 0;
+    if (!combine || combine->op != (instr->cc == CC_E ? MI_AND : MI_OR) || combine->size != 1)
+        return 0;
+    branch = peephole_test_branch(combine->next);
+    if (!branch || branch->cc != instr->cc || !minstr_reg_dead_after(branch, REG_RDX))
+        return 0;
+
+    branch->cc = CC_NE;
+    minstr_remove(code, combine->next->next);
+    minstr_remove(code, combine->next);
+    minstr_remove(code, combine);
+    minstr_remove(code, instr);
+    parity->op = MI_JCC;
+    parity->cc = CC_P;
+    parity->dst = branch->dst;
+    minstr_remove(code, parity);
+    parity->prev = branch;
+    parity->next = branch->next;
+    if (branch->next)
+        branch->next->prev = parity;
+    else
+        code->last = parity;
+    branch->next = parity;
+    return 1;
+}
+
+void peephole_optimize(MCODE *code)
+{
+    int changed = 1;
+    while (changed)
+    {
+        MINSTR *instr;
+        changed = 0;
+        peephole_count_refs(code);
+        for (instr = code->first; instr;)
+        {
+            MINSTR *prev = instr->prev;
+            int i;
+            for (i = 0; i < PEEPHOLE_RULE_COUNT; i++)
+            {
+                if (peephole_rules[i].apply(code, instr))
+                {
+                    compiler->peephole_hits[i]++;
+                    changed = 1;
+                    break;
+                }
+            }
+
+            // rules only rewrite the instruction and its successors, so the
+            // predecessor survives and is revisited against the new neighbours
+            if (i < PEEPHOLE_RULE_COUNT)
+                instr = prev ? prev : code->first;
+            else
+                instr = instr->next;
+        }
+    }
+}
+
+void peephole_report(FILE *fout)
+{
+    int i;
+    for (i = 0; i < PEEPHOLE_RULE_COUNT; i++)
+    {
+        fprintf(fout, "peephole: %-32s %d\n", peephole_rules[i].name, compiler->peephole_hits[i]);
+    }
+}
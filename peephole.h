@@ -0,0 +1,11 @@
+#pragma once
+#include "minstr.h"
+
+typedef struct peephole_rule
+{
+    char *name;
+    int (*apply)(MCODE *code, MINSTR *instr); // returns 1 when the code was rewritten
+} PEEPHOLE_RULE;
+
+void peephole_optimize(MCODE *code);
+void peephole_report(FILE *fout);
@@ -0,0 +1,239 @@
+#include "profile.h"
+
+PROFILE_FUNCTION *profile_add(PROFILE *profile, char *name)
+{
+    PROFILE_FUNCTION *function;
+    if (profile->function_count == profile->function_size)
+    {
+        profile->function_size = profile->function_size ? 2 * profile->function_size : 16;
+        profile->functions = (PROFILE_FUNCTION *)realloc(profile->functions, profile->function_size * sizeof(PROFILE_FUNCTION));
+    }
+    function = &profile->functions[profile->function_count++];
+    function->name = strdup(name);
+    function->checksum = 2166136261u;
+    function->first = profile->counter_count;
+    function->count = 0;
+    return function;
+}
+
+// blocks start at the function entry, at labels and after a branch that does not fall
+// into a label; every call site is counted as well
+int profile_is_point(TAC *tac, TAC *prev)
+{
+    switch (tac->type)
+    {
+    case TAC_BEGINFUN:
+    case TAC_LABEL:
+    case TAC_CALL:
+        return 1;
+    case TAC_SYMBOL:
+        return 0;
+    }
+    return prev && prev->type == TAC_JFALSE;
+}
+
+// gives every counted tac its counter and every function the fnv-1a hash of its blocks,
+// branches and calls
+void profile_number(TAC *first)
+{
+    PROFILE_FUNCTION *function = NULL;
+    TAC *prev = NULL;
+    TAC *tac;
+
+    for (tac = first; tac; tac = tac->next)
+    {
+        if (tac->type == TAC_BEGINFUN)
+            function = profile_add(&compiler->profile->program, tac->res->text);
+        if (!function || tac->type == TAC_SYMBOL)
+            continue;
+
+        if (profile_is_point(tac, prev))
+        {
+            tac->counter = compiler->profile->program.counter_count++;
+            function->count++;
+        }
+        if (tac->counter >= 0 || tac->type == TAC_JFALSE || tac->type == TAC_JUMP || tac->type == TAC_RET)
+            function->checksum = (function->checksum ^ tac->type) * 16777619u;
+        prev = tac;
+
+        if (tac->type == TAC_ENDFUN)
+        {
+            function->checksum = (function->checksum ^ function->count) * 16777619u;
+            function = NULL;
+            prev = NULL;
+        }
+    }
+}
+
+int profile_load(char *path)
+{
+    char line[PROFILE_LINE_SIZE];
+    char name[PROFILE_LINE_SIZE];
+    int functions = 0;
+    int counters = 0;
+    int i;
+    FILE *file = fopen(path, "rb");
+
+    if (!file)
+    {
+        fprintf(compiler->diagnostics, "profile: cannot read %s\n", path);
+        return 0;
+    }
+    if (!fgets(line, sizeof(line), file) || sscanf(line, "profile %d %d", &functions, &counters) != 2)
+    {
+        fprintf(compiler->diagnostics, "profile: %s is not a profile\n", path);
+        fclose(file);
+        return 0;
+    }
+
+    // lines are read whole, the counters after them are binary
+    for (i = 0; i < functions; i++)
+    {
+        PROFILE_FUNCTION *function;
+        unsigned checksum;
+        int count;
+        if (!fgets(line, sizeof(line), file) || sscanf(line, "%s %u %d", name, &checksum, &count) != 3)
+            break;
+        function = profile_add(&compiler->profile->taken, name);
+        function->checksum = checksum;
+        function->count = count;
+        compiler->profile->taken.counter_count += count;
+    }
+
+    compiler->profile->taken.counts = (long long *)calloc(counters + 1, sizeof(long long));
+    if (i < functions || compiler->profile->taken.counter_count != counters ||
+        fread(compiler->profile->taken.counts, sizeof(long long), counters, file) != (size_t)counters)
+    {
+        fprintf(compiler->diagnostics, "profile: %s is truncated\n", path);
+        compiler->profile->taken.function_count = 0;
+    }
+    fclose(file);
+    return compiler->profile->taken.function_count;
+}
+
+// copies the counts of each function that kept its name and control flow; the others
+// are compiled as if there were no profile
+void profile_attach(void)
+{
+    int i;
+    int j;
+
+    compiler->profile->program.counts = (long long *)malloc((compiler->profile->program.counter_count + 1) * sizeof(long long));
+    for (i = 0; i < compiler->profile->program.counter_count; i++)
+        compiler->profile->program.counts[i] = -1;
+
+    for (i = 0; i < compiler->profile->program.function_count; i++)
+    {
+        PROFILE_FUNCTION *function = &compiler->profile->program.functions[i];
+        for (j = 0; j < compiler->profile->taken.function_count && strcmp(compiler->profile->taken.functions[j].name, function->name) != 0; j++)
+            ;
+        if (j == compiler->profile->taken.function_count)
+            continue;
+        if (compiler->profile->taken.functions[j].checksum != function->checksum || compiler->profile->taken.functions[j].count != function->count)
+        {
+            fprintf(compiler->diagnostics, "profile: %s changed since it was profiled, its counts are ignored\n", function->name);
+            continue;
+        }
+        memcpy(compiler->profile->program.counts + function->first, compiler->profile->taken.counts + compiler->profile->taken.functions[j].first,
+               function->count * sizeof(long long));
+    }
+}
+
+// how often the block or call at tac ran, or -1 without a profile
+long long profile_count(TAC *tac)
+{
+    if (!tac || tac->counter < 0 || !compiler->profile->program.counts)
+        return -1;
+    return compiler->profile->program.counts[tac->counter];
+}
+
+// how often a branch fell through into the block after it
+long long profile_fall_count(TAC *branch)
+{
+    TAC *tac;
+    for (tac = branch->next; tac && tac->type == TAC_SYMBOL; tac = tac->next)
+        ;
+    return profile_count(tac);
+}
+
+// how often the block holding tac ran: calls run as often as their block
+long long profile_block_count(TAC *tac)
+{
+    if (!compiler->profile->program.counts)
+        return -1;
+    while (tac && tac->counter < 0)
+        tac = tac->prev;
+    return profile_count(tac);
+}
+
+void profile_increment(MCODE *code, TAC *tac)
+{
+    MOPERAND counter = mop_name("profile_counts");
+    if (!compiler->profile_generate || tac->counter < 0)
+        return;
+    counter.disp = 8 * tac->counter;
+    minstr_emit(code, MI_ADD, 8, mop_imm(1), counter);
+}
+
+// .string spelling of text
+char *profile_quote(char *text)
+{
+    MBUFFER buffer = {NULL, 0, 0};
+    char *c;
+    mbuffer_printf(&buffer, "\"");
+    for (c = text; *c; c++)
+    {
+        if (*c == '\n')
+            mbuffer_printf(&buffer, "\\n");
+        else if (*c == '"' || *c == '\\')
+            mbuffer_printf(&buffer, "\\%c", *c);
+        else
+            mbuffer_printf(&buffer, "%c", *c);
+    }
+    mbuffer_printf(&buffer, "\"");
+    return buffer.data;
+}
+
+// the counters, the lines naming them and profile_write, which main registers with atexit
+void profile_emit(MCODE *code, MCODE *rodata, MCODE *bss)
+{
+    MBUFFER map = {NULL, 0, 0};
+    int i;
+
+    mbuffer_printf(&map, "profile %d %d\n", compiler->profile->program.function_count, compiler->profile->program.counter_count);
+    for (i = 0; i < compiler->profile->program.function_count; i++)
+    {
+        PROFILE_FUNCTION *function = &compiler->profile->program.functions[i];
+        mbuffer_printf(&map, "%s %u %d\n", function->name, function->checksum, function->count);
+    }
+
+    minstr_emit(rodata, MI_LABEL, 0, mop_none(), mop_name("profile_path"));
+    minstr_emit(rodata, MI_STRING, 4, mop_none(), mop_text(profile_quote(compiler->profile_generate)));
+    minstr_emit(rodata, MI_LABEL, 0, mop_none(), mop_name("profile_map"));
+    minstr_emit(rodata, MI_STRING, 4, mop_none(), mop_text(profile_quote(map.data)));
+    minstr_emit(bss, MI_ALIGN, 0, mop_none(), mop_imm(8));
+    minstr_emit(bss, MI_LABEL, 0, mop_none(), mop_name("profile_counts"));
+    minstr_emit(bss, MI_ZERO, 4, mop_none(), mop_imm(8 * compiler->profile->program.counter_count));
+
+    runtime_enter(code, "profile_write");
+    minstr_emit(code, MI_LEA, 8, mop_name("profile_path"), mop_reg(REG_RDI));
+    minstr_emit(code, MI_MOV, 4, mop_imm(PROFILE_OPEN_FLAGS), mop_reg(REG_RSI));
+    minstr_emit(code, MI_MOV, 4, mop_imm(PROFILE_OPEN_MODE), mop_reg(REG_RDX));
+    minstr_emit(code, MI_MOV, 4, mop_imm(0), mop_reg(REG_RAX));
+    minstr_emit(code, MI_CALL, 8, mop_none(), mop_extern("open@PLT"));
+    minstr_emit(code, MI_TEST, 4, mop_reg(REG_RAX), mop_reg(REG_RAX));
+    runtime_jump(code, CC_L, "profile_write_done");
+    minstr_emit(code, MI_MOV, 4, mop_reg(REG_RAX), runtime_frame(-8));
+    minstr_emit(code, MI_MOV, 4, mop_reg(REG_RAX), mop_reg(REG_RDI));
+    minstr_emit(code, MI_LEA, 8, mop_name("profile_map"), mop_reg(REG_RSI));
+    minstr_emit(code, MI_MOV, 4, mop_imm((int)map.length), mop_reg(REG_RDX));
+    minstr_emit(code, MI_CALL, 8, mop_none(), mop_extern("write@PLT"));
+    minstr_emit(code, MI_MOV, 4, runtime_frame(-8), mop_reg(REG_RDI));
+    minstr_emit(code, MI_LEA, 8, mop_name("profile_counts"), mop_reg(REG_RSI));
+    minstr_emit(code, MI_MOV, 4, mop_imm(8 * compiler->profile->program.counter_count), mop_reg(REG_RDX));
+    minstr_emit(code, MI_CALL, 8, mop_none(), mop_extern("write@PLT"));
+    minstr_emit(code, MI_MOV, 4, runtime_frame(-8), mop_reg(REG_RDI));
+    minstr_emit(code, MI_CALL, 8, mop_none(), mop_extern("close@PLT"));
+    runtime_label(code, "profile_write_done");
+    runtime_leave(code);
+}
@@ -0,0 +1,47 @@
+#pragma once
+#include "tac.h"
+#include "minstr.h"
+
+// a profile file starts with "profile <functions> <counters>", then has one line
+// "<name> <checksum> <counters>" per function and ends in the 8-byte counters of all
+// functions in the same order
+#define PROFILE_LINE_SIZE 256
+
+// with a profile, then-blocks taken at most this often out of a hundred are laid out of line
+#define PROFILE_COLD_PERCENT 10
+
+// open(2) flags of the profile file: O_WRONLY | O_CREAT | O_TRUNC, mode 0644
+#define PROFILE_OPEN_FLAGS 0x241
+#define PROFILE_OPEN_MODE 0644
+
+typedef struct profile_function
+{
+    char *name;
+    unsigned checksum; // of the control flow, so that a changed function drops its counts
+    int first;         // index of its first counter
+    int count;
+} PROFILE_FUNCTION;
+
+typedef struct profile
+{
+    PROFILE_FUNCTION *functions;
+    int function_count;
+    int function_size;
+    long long *counts; // NULL until counts are loaded or matched
+    int counter_count;
+} PROFILE;
+
+typedef struct profile_state
+{
+    PROFILE program; // counters of this compilation, holding the matched counts of --profile-use
+    PROFILE taken;   // the file read by --profile-use
+} PROFILE_STATE;
+
+void profile_number(TAC *first);
+int profile_load(char *path);
+void profile_attach(void);
+long long profile_count(TAC *tac);
+long long profile_fall_count(TAC *branch);
+long long profile_block_count(TAC *tac);
+void profile_increment(MCODE *code, TAC *tac);
+void profile_emit(MCODE *code, MCODE *rodata, MCODE *bss);
@@ -0,0 +1,610 @@
+#include "runtime.h"
+
+int runtime_format_regs[RUNTIME_FORMAT_INTS] = {REG_RSI, REG_RDX, REG_RCX, REG_R8, REG_R9};
+
+// the routines take their argument in edi, rdi or xmm0 and clobber only caller-saved
+// registers, which generated code never keeps live across a call
+
+void runtime_enter(MCODE *code, char *name)
+{
+    minstr_emit(code, MI_FUNCTION, 8, mop_none(), mop_extern(name));
+    minstr_emit(code, MI_PUSH, 8, mop_none(), mop_reg(REG_RBP));
+    minstr_emit(code, MI_MOV, 8, mop_reg(REG_RSP), mop_reg(REG_RBP));
+    minstr_emit(code, MI_SUB, 8, mop_imm(16), mop_reg(REG_RSP));
+}
+
+void runtime_leave(MCODE *code)
+{
+    minstr_emit(code, MI_MOV, 8, mop_reg(REG_RBP), mop_reg(REG_RSP));
+    minstr_emit(code, MI_POP, 8, mop_none(), mop_reg(REG_RBP));
+    minstr_emit(code, MI_RET, 8, mop_none(), mop_none());
+}
+
+void runtime_label(MCODE *code, char *name)
+{
+    minstr_emit(code, MI_LABEL, 8, mop_none(), mop_extern(name));
+}
+
+void runtime_jump(MCODE *code, int cc, char *name)
+{
+    minstr_emit_cc(code, MI_JCC, cc, mop_extern(name));
+}
+
+MOPERAND runtime_frame(int disp)
+{
+    return mop_mem(REG_RBP, REG_NONE, 0, disp);
+}
+
+// flushes first unless room more bytes still fit
+void runtime_reserve(MCODE *code, int room, char *fits)
+{
+    minstr_emit(code, MI_CMP, 4, mop_imm(RUNTIME_BUFFER_SIZE - room), mop_name("out_used"));
+    runtime_jump(code, CC_LE, fits);
+    minstr_emit(code, MI_CALL, 8, mop_none(), mop_extern("out_flush"));
+    runtime_label(code, fits);
+}
+
+// rsi = out_buffer + out_used
+void runtime_cursor(MCODE *code)
+{
+    minstr_emit(code, MI_MOVSLQ, 8, mop_name("out_used"), mop_reg(REG_RSI));
+    minstr_emit(code, MI_LEA, 8, mop_name("out_buffer"), mop_reg(REG_RCX));
+    minstr_emit(code, MI_ADD, 8, mop_reg(REG_RCX), mop_reg(REG_RSI));
+}
+
+// out_used = rsi - out_buffer
+void runtime_commit(MCODE *code)
+{
+    minstr_emit(code, MI_LEA, 8, mop_name("out_buffer"), mop_reg(REG_RCX));
+    minstr_emit(code, MI_SUB, 8, mop_reg(REG_RCX), mop_reg(REG_RSI));
+    minstr_emit(code, MI_MOV, 4, mop_reg(REG_RSI), mop_name("out_used"));
+}
+
+// write(1, out_buffer, out_used) until everything is out or the write fails
+void runtime_flush(MCODE *code)
+{
+    runtime_enter(code, "out_flush");
+    minstr_emit(code, MI_LEA, 8, mop_name("out_buffer"), mop_reg(REG_RAX));
+    minstr_emit(code, MI_MOV, 8, mop_reg(REG_RAX), runtime_frame(-8));
+    minstr_emit(code, MI_MOVSLQ, 8, mop_name("out_used"), mop_reg(REG_RAX));
+    minstr_emit(code, MI_MOV, 8, mop_reg(REG_RAX), runtime_frame(-16));
+    minstr_emit(code, MI_MOV, 4, mop_imm(0), mop_name("out_used"));
+    runtime_label(code, "out_flush_write");
+    minstr_emit(code, MI_CMP, 8, mop_imm(0), runtime_frame(-16));
+    runtime_jump(code, CC_LE, "out_flush_done");
+    minstr_emit(code, MI_MOV, 4, mop_imm(1), mop_reg(REG_RDI));
+    minstr_emit(code, MI_MOV, 8, runtime_frame(-8), mop_reg(REG_RSI));
+    minstr_emit(code, MI_MOV, 8, runtime_frame(-16), mop_reg(REG_RDX));
+    minstr_emit(code, MI_CALL, 8, mop_none(), mop_extern("write@PLT"));
+    minstr_emit(code, MI_TEST, 8, mop_reg(REG_RAX), mop_reg(REG_RAX));
+    runtime_jump(code, CC_LE, "out_flush_done");
+    minstr_emit(code, MI_ADD, 8, mop_reg(REG_RAX), runtime_frame(-8));
+    minstr_emit(code, MI_SUB, 8, mop_reg(REG_RAX), runtime_frame(-16));
+    minstr_emit(code, MI_JMP, 8, mop_none(), mop_extern("out_flush_write"));
+    runtime_label(code, "out_flush_done");
+    runtime_leave(code);
+}
+
+// labels of one copy of the integer conversion
+char *runtime_int_labels[] = {"out_int_sign", "out_int_digits", "out_int_divide", "out_int_copy"};
+char *runtime_format_labels[] = {"out_format_sign", "out_format_digits", "out_format_divide", "out_format_copy"};
+
+// writes eax at rsi and advances it; digits come out of idiv lowest first into the frame
+// below end and are copied forward, and the value is kept negative so that the most
+// negative int needs no special case
+void runtime_digits(MCODE *code, char **labels, int end)
+{
+    minstr_emit(code, MI_TEST, 4, mop_reg(REG_RAX), mop_reg(REG_RAX));
+    runtime_jump(code, CC_L, labels[0]);
+    minstr_emit(code, MI_NEG, 4, mop_none(), mop_reg(REG_RAX));
+    minstr_emit(code, MI_JMP, 8, mop_none(), mop_extern(labels[1]));
+    runtime_label(code, labels[0]);
+    minstr_emit(code, MI_MOV, 1, mop_imm('-'), mop_mem(REG_RSI, REG_NONE, 0, 0));
+    minstr_emit(code, MI_ADD, 8, mop_imm(1), mop_reg(REG_RSI));
+    runtime_label(code, labels[1]);
+    minstr_emit(code, MI_LEA, 8, runtime_frame(end), mop_reg(REG_R8));
+    minstr_emit(code, MI_MOV, 4, mop_imm(10), mop_reg(REG_RCX));
+    runtime_label(code, labels[2]);
+    minstr_emit(code, MI_CLTD, 4, mop_none(), mop_none());
+    minstr_emit(code, MI_IDIV, 4, mop_none(), mop_reg(REG_RCX));
+    minstr_emit(code, MI_NEG, 4, mop_none(), mop_reg(REG_RDX));
+    minstr_emit(code, MI_ADD, 4, mop_imm('0'), mop_reg(REG_RDX));
+    minstr_emit(code, MI_SUB, 8, mop_imm(1), mop_reg(REG_R8));
+    minstr_emit(code, MI_MOV, 1, mop_reg(REG_RDX), mop_mem(REG_R8, REG_NONE, 0, 0));
+    minstr_emit(code, MI_TEST, 4, mop_reg(REG_RAX), mop_reg(REG_RAX));
+    runtime_jump(code, CC_NE, labels[2]);
+    minstr_emit(code, MI_LEA, 8, runtime_frame(end), mop_reg(REG_R9));
+    runtime_label(code, labels[3]);
+    minstr_emit(code, MI_MOVZB, 4, mop_mem(REG_R8, REG_NONE, 0, 0), mop_reg(REG_RDX));
+    minstr_emit(code, MI_MOV, 1, mop_reg(REG_RDX), mop_mem(REG_RSI, REG_NONE, 0, 0));
+    minstr_emit(code, MI_ADD, 8, mop_imm(1), mop_reg(REG_RSI));
+    minstr_emit(code, MI_ADD, 8, mop_imm(1), mop_reg(REG_R8));
+    minstr_emit(code, MI_CMP, 8, mop_reg(REG_R9), mop_reg(REG_R8));
+    runtime_jump(code, CC_B, labels[3]);
+}
+
+void runtime_int(MCODE *code)
+{
+    runtime_enter(code, "out_int");
+    minstr_emit(code, MI_MOV, 4, mop_reg(REG_RDI), runtime_frame(-16));
+    runtime_reserve(code, RUNTIME_INT_ROOM, "out_int_room");
+    runtime_cursor(code);
+    minstr_emit(code, MI_MOV, 4, runtime_frame(-16), mop_reg(REG_RAX));
+    runtime_digits(code, runtime_int_labels, 0);
+    runtime_commit(code);
+    runtime_leave(code);
+}
+
+void runtime_char(MCODE *code)
+{
+    runtime_enter(code, "out_char");
+    minstr_emit(code, MI_MOV, 4, mop_reg(REG_RDI), runtime_frame(-4));
+    runtime_reserve(code, 1, "out_char_room");
+    runtime_cursor(code);
+    minstr_emit(code, MI_MOV, 4, runtime_frame(-4), mop_reg(REG_RAX));
+    minstr_emit(code, MI_MOV, 1, mop_reg(REG_RAX), mop_mem(REG_RSI, REG_NONE, 0, 0));
+    minstr_emit(code, MI_ADD, 4, mop_imm(1), mop_name("out_used"));
+    runtime_leave(code);
+}
+
+// copies up to the terminating zero, flushing whenever the buffer fills; rdx marks its end
+// and the address after the zero is returned, where the next item of a descriptor starts
+void runtime_string(MCODE *code)
+{
+    runtime_enter(code, "out_string");
+    runtime_cursor(code);
+    minstr_emit(code, MI_LEA, 8, mop_name("out_buffer"), mop_reg(REG_RDX));
+    minstr_emit(code, MI_ADD, 8, mop_imm(RUNTIME_BUFFER_SIZE), mop_reg(REG_RDX));
+    runtime_label(code, "out_string_next");
+    minstr_emit(code, MI_MOVZB, 4, mop_mem(REG_RDI, REG_NONE, 0, 0), mop_reg(REG_RAX));
+    minstr_emit(code, MI_TEST, 4, mop_reg(REG_RAX), mop_reg(REG_RAX));
+    runtime_jump(code, CC_E, "out_string_done");
+    minstr_emit(code, MI_CMP, 8, mop_reg(REG_RDX), mop_reg(REG_RSI));
+    runtime_jump(code, CC_B, "out_string_room");
+    minstr_emit(code, MI_MOV, 8, mop_reg(REG_RDI), runtime_frame(-8));
+    minstr_emit(code, MI_MOV, 4, mop_imm(RUNTIME_BUFFER_SIZE), mop_name("out_used"));
+    minstr_emit(code, MI_CALL, 8, mop_none(), mop_extern("out_flush"));
+    minstr_emit(code, MI_MOV, 8, runtime_frame(-8), mop_reg(REG_RDI));
+    runtime_cursor(code);
+    minstr_emit(code, MI_LEA, 8, mop_name("out_buffer"), mop_reg(REG_RDX));
+    minstr_emit(code, MI_ADD, 8, mop_imm(RUNTIME_BUFFER_SIZE), mop_reg(REG_RDX));
+    minstr_emit(code, MI_MOVZB, 4, mop_mem(REG_RDI, REG_NONE, 0, 0), mop_reg(REG_RAX));
+    runtime_label(code, "out_string_room");
+    minstr_emit(code, MI_MOV, 1, mop_reg(REG_RAX), mop_mem(REG_RSI, REG_NONE, 0, 0));
+    minstr_emit(code, MI_ADD, 8, mop_imm(1), mop_reg(REG_RSI));
+    minstr_emit(code, MI_ADD, 8, mop_imm(1), mop_reg(REG_RDI));
+    minstr_emit(code, MI_JMP, 8, mop_none(), mop_extern("out_string_next"));
+    runtime_label(code, "out_string_done");
+    runtime_commit(code);
+    minstr_emit(code, MI_LEA, 8, mop_mem(REG_RDI, REG_NONE, 0, 1), mop_reg(REG_RAX));
+    runtime_leave(code);
+}
+
+// the float comes in xmm0; snprintf formats it straight into the buffer
+void runtime_real(MCODE *code)
+{
+    runtime_enter(code, "out_real");
+    minstr_emit(code, MI_MOVSS, 4, mop_reg(REG_XMM0), runtime_frame(-4));
+    runtime_reserve(code, RUNTIME_REAL_ROOM, "out_real_room");
+    minstr_emit(code, MI_CVTSS2SD, 4, runtime_frame(-4), mop_reg(REG_XMM0));
+    runtime_cursor(code);
+    minstr_emit(code, MI_MOV, 8, mop_reg(REG_RSI), mop_reg(REG_RDI));
+    minstr_emit(code, MI_MOV, 4, mop_imm(RUNTIME_REAL_ROOM), mop_reg(REG_RSI));
+    minstr_emit(code, MI_LEA, 8, mop_name("print_str_real"), mop_reg(REG_RDX));
+    minstr_emit(code, MI_MOV, 4, mop_imm(1), mop_reg(REG_RAX));
+    minstr_emit(code, MI_CALL, 8, mop_none(), mop_extern("snprintf@PLT"));
+    minstr_emit(code, MI_ADD, 4, mop_reg(REG_RAX), mop_name("out_used"));
+    runtime_leave(code);
+}
+
+// next integer argument into eax; -88 points at it
+void runtime_format_int(MCODE *code)
+{
+    minstr_emit(code, MI_MOV, 8, runtime_frame(-88), mop_reg(REG_RCX));
+    minstr_emit(code, MI_MOV, 4, mop_mem(REG_RCX, REG_NONE, 0, 0), mop_reg(REG_RAX));
+    minstr_emit(code, MI_SUB, 8, mop_imm(8), runtime_frame(-88));
+}
+
+// the arguments are spilled to the frame and the room the caller worked out is reserved
+// once, so that items are written at rsi while rdi walks the descriptor; only reals
+// leave for out_real, with the cursor committed around the call
+void runtime_format(MCODE *code)
+{
+    int i;
+    minstr_emit(code, MI_FUNCTION, 8, mop_none(), mop_extern("out_format"));
+    minstr_emit(code, MI_PUSH, 8, mop_none(), mop_reg(REG_RBP));
+    minstr_emit(code, MI_MOV, 8, mop_reg(REG_RSP), mop_reg(REG_RBP));
+    minstr_emit(code, MI_SUB, 8, mop_imm(112), mop_reg(REG_RSP));
+    for (i = 0; i < RUNTIME_FORMAT_INTS; i++)
+        minstr_emit(code, MI_MOV, 8, mop_reg(runtime_format_regs[i]), runtime_frame(-8 - 8 * i));
+    for (i = 0; i < RUNTIME_FORMAT_REALS; i++)
+        minstr_emit(code, MI_MOVSS, 4, mop_reg(REG_XMM0 + i), runtime_frame(-44 - 4 * i));
+    minstr_emit(code, MI_MOV, 8, mop_reg(REG_RDI), runtime_frame(-80));
+    minstr_emit(code, MI_ADD, 4, mop_name("out_used"), mop_reg(REG_RAX));
+    minstr_emit(code, MI_CMP, 4, mop_imm(RUNTIME_BUFFER_SIZE), mop_reg(REG_RAX));
+    runtime_jump(code, CC_LE, "out_format_room");
+    minstr_emit(code, MI_CALL, 8, mop_none(), mop_extern("out_flush"));
+    runtime_label(code, "out_format_room");
+    minstr_emit(code, MI_LEA, 8, runtime_frame(-8), mop_reg(REG_RAX));
+    minstr_emit(code, MI_MOV, 8, mop_reg(REG_RAX), runtime_frame(-88));
+    minstr_emit(code, MI_LEA, 8, runtime_frame(-44), mop_reg(REG_RAX));
+    minstr_emit(code, MI_MOV, 8, mop_reg(REG_RAX), runtime_frame(-96));
+    minstr_emit(code, MI_MOV, 8, runtime_frame(-80), mop_reg(REG_RDI));
+    runtime_cursor(code);
+
+    runtime_label(code, "out_format_next");
+    minstr_emit(code, MI_MOVZB, 4, mop_mem(REG_RDI, REG_NONE, 0, 0), mop_reg(REG_RAX));
+    minstr_emit(code, MI_ADD, 8, mop_imm(1), mop_reg(REG_RDI));
+    minstr_emit(code, MI_CMP, 4, mop_imm(RUNTIME_FORMAT_TEXT), mop_reg(REG_RAX));
+    runtime_jump(code, CC_E, "out_format_text");
+    minstr_emit(code, MI_CMP, 4, mop_imm(RUNTIME_FORMAT_INT), mop_reg(REG_RAX));
+    runtime_jump(code, CC_E, "out_format_int");
+    minstr_emit(code, MI_CMP, 4, mop_imm(RUNTIME_FORMAT_CHAR), mop_reg(REG_RAX));
+    runtime_jump(code, CC_E, "out_format_char");
+    minstr_emit(code, MI_CMP, 4, mop_imm(RUNTIME_FORMAT_REAL), mop_reg(REG_RAX));
+    runtime_jump(code, CC_E, "out_format_real");
+    runtime_commit(code);
+    runtime_leave(code);
+
+    runtime_label(code, "out_format_text");
+    minstr_emit(code, MI_MOVZB, 4, mop_mem(REG_RDI, REG_NONE, 0, 0), mop_reg(REG_RAX));
+    minstr_emit(code, MI_ADD, 8, mop_imm(1), mop_reg(REG_RDI));
+    minstr_emit(code, MI_TEST, 4, mop_reg(REG_RAX), mop_reg(REG_RAX));
+    runtime_jump(code, CC_E, "out_format_next");
+    minstr_emit(code, MI_MOV, 1, mop_reg(REG_RAX), mop_mem(REG_RSI, REG_NONE, 0, 0));
+    minstr_emit(code, MI_ADD, 8, mop_imm(1), mop_reg(REG_RSI));
+    minstr_emit(code, MI_JMP, 8, mop_none(), mop_extern("out_format_text"));
+
+    runtime_label(code, "out_format_int");
+    runtime_format_int(code);
+    runtime_digits(code, runtime_format_labels, -96);
+    minstr_emit(code, MI_JMP, 8, mop_none(), mop_extern("out_format_next"));
+
+    runtime_label(code, "out_format_char");
+    runtime_format_int(code);
+    minstr_emit(code, MI_MOV, 1, mop_reg(REG_RAX), mop_mem(REG_RSI, REG_NONE, 0, 0));
+    minstr_emit(code, MI_ADD, 8, mop_imm(1), mop_reg(REG_RSI));
+    minstr_emit(code, MI_JMP, 8, mop_none(), mop_extern("out_format_next"));
+
+    runtime_label(code, "out_format_real");
+    minstr_emit(code, MI_MOV, 8, runtime_frame(-96), mop_reg(REG_RCX));
+    minstr_emit(code, MI_MOVSS, 4, mop_mem(REG_RCX, REG_NONE, 0, 0), mop_reg(REG_XMM0));
+    minstr_emit(code, MI_SUB, 8, mop_imm(4), runtime_frame(-96));
+    runtime_commit(code);
+    minstr_emit(code, MI_MOV, 8, mop_reg(REG_RDI), runtime_frame(-80));
+    minstr_emit(code, MI_CALL, 8, mop_none(), mop_extern("out_real"));
+    minstr_emit(code, MI_MOV, 8, runtime_frame(-80), mop_reg(REG_RDI));
+    runtime_cursor(code);
+    minstr_emit(code, MI_JMP, 8, mop_none(), mop_extern("out_format_next"));
+}
+
+// the next input byte in eax, or -1 at the end of input; in_next only moves when the
+// caller consumes the byte. Output is flushed before the program may wait for input
+void runtime_peek(MCODE *code)
+{
+    runtime_enter(code, "in_peek");
+    minstr_emit(code, MI_MOVSLQ, 8, mop_name("in_next"), mop_reg(REG_RAX));
+    minstr_emit(code, MI_CMP, 4, mop_name("in_end"), mop_reg(REG_RAX));
+    runtime_jump(code, CC_L, "in_peek_byte");
+    minstr_emit(code, MI_CALL, 8, mop_none(), mop_extern("out_flush"));
+    minstr_emit(code, MI_MOV, 4, mop_imm(0), mop_reg(REG_RDI));
+    minstr_emit(code, MI_LEA, 8, mop_name("in_buffer"), mop_reg(REG_RSI));
+    minstr_emit(code, MI_MOV, 4, mop_imm(RUNTIME_BUFFER_SIZE), mop_reg(REG_RDX));
+    minstr_emit(code, MI_CALL, 8, mop_none(), mop_extern("read@PLT"));
+    minstr_emit(code, MI_MOV, 4, mop_imm(0), mop_name("in_next"));
+    minstr_emit(code, MI_MOV, 4, mop_imm(0), mop_name("in_end"));
+    minstr_emit(code, MI_TEST, 8, mop_reg(REG_RAX), mop_reg(REG_RAX));
+    runtime_jump(code, CC_G, "in_peek_fill");
+    minstr_emit(code, MI_MOV, 4, mop_imm(-1), mop_reg(REG_RAX));
+    runtime_leave(code);
+    runtime_label(code, "in_peek_fill");
+    minstr_emit(code, MI_MOV, 4, mop_reg(REG_RAX), mop_name("in_end"));
+    minstr_emit(code, MI_MOV, 4, mop_imm(0), mop_reg(REG_RAX));
+    runtime_label(code, "in_peek_byte");
+    minstr_emit(code, MI_LEA, 8, mop_name("in_buffer"), mop_reg(REG_RCX));
+    minstr_emit(code, MI_MOVZB, 4, mop_mem(REG_RCX, REG_RAX, 1, 0), mop_reg(REG_RAX));
+    runtime_leave(code);
+}
+
+// consumes the byte in_peek returned
+void runtime_take(MCODE *code)
+{
+    minstr_emit(code, MI_ADD, 4, mop_imm(1), mop_name("in_next"));
+}
+
+// skips white space like scanf does and leaves the first other byte in eax
+void runtime_skip(MCODE *code, char **labels)
+{
+    runtime_label(code, labels[0]);
+    minstr_emit(code, MI_CALL, 8, mop_none(), mop_extern("in_peek"));
+    minstr_emit(code, MI_CMP, 4, mop_imm(' '), mop_reg(REG_RAX));
+    runtime_jump(code, CC_E, labels[1]);
+    minstr_emit(code, MI_LEA, 4, mop_mem(REG_RAX, REG_NONE, 0, -'\t'), mop_reg(REG_RCX));
+    minstr_emit(code, MI_CMP, 4, mop_imm('\r' - '\t'), mop_reg(REG_RCX));
+    runtime_jump(code, CC_A, labels[2]);
+    runtime_label(code, labels[1]);
+    runtime_take(code);
+    minstr_emit(code, MI_JMP, 8, mop_none(), mop_extern(labels[0]));
+    runtime_label(code, labels[2]);
+}
+
+char *runtime_in_int_labels[] = {"in_int_skip", "in_int_space", "in_int_sign"};
+char *runtime_in_char_labels[] = {"in_char_skip", "in_char_space", "in_char_byte"};
+char *runtime_in_real_labels[] = {"in_real_skip", "in_real_space", "in_real_next"};
+
+// an optional sign and decimal digits into the int rdi points at, which is left alone
+// when no digit follows; -8 keeps the pointer, -12 the sign and -16 the value
+void runtime_in_int(MCODE *code)
+{
+    runtime_enter(code, "in_int");
+    minstr_emit(code, MI_MOV, 8, mop_reg(REG_RDI), runtime_frame(-8));
+    minstr_emit(code, MI_MOV, 4, mop_imm(0), runtime_frame(-12));
+    minstr_emit(code, MI_MOV, 4, mop_imm(0), runtime_frame(-16));
+    runtime_skip(code, runtime_in_int_labels);
+    minstr_emit(code, MI_CMP, 4, mop_imm('+'), mop_reg(REG_RAX));
+    runtime_jump(code, CC_E, "in_int_signed");
+    minstr_emit(code, MI_CMP, 4, mop_imm('-'), mop_reg(REG_RAX));
+    runtime_jump(code, CC_NE, "in_int_first");
+    minstr_emit(code, MI_MOV, 4, mop_imm(1), runtime_frame(-12));
+    runtime_label(code, "in_int_signed");
+    runtime_take(code);
+    minstr_emit(code, MI_CALL, 8, mop_none(), mop_extern("in_peek"));
+    runtime_label(code, "in_int_first");
+    minstr_emit(code, MI_LEA, 4, mop_mem(REG_RAX, REG_NONE, 0, -'0'), mop_reg(REG_RCX));
+    minstr_emit(code, MI_CMP, 4, mop_imm(9), mop_reg(REG_RCX));
+    runtime_jump(code, CC_A, "in_int_done");
+    runtime_label(code, "in_int_digit");
+    minstr_emit(code, MI_MOV, 4, runtime_frame(-16), mop_reg(REG_RDX));
+    minstr_emit(code, MI_LEA, 4, mop_mem(REG_RDX, REG_RDX, 4, 0), mop_reg(REG_RDX));
+    minstr_emit(code, MI_LEA, 4, mop_mem(REG_RCX, REG_RDX, 2, 0), mop_reg(REG_RDX));
+    minstr_emit(code, MI_MOV, 4, mop_reg(REG_RDX), runtime_frame(-16));
+    runtime_take(code);
+    minstr_emit(code, MI_CALL, 8, mop_none(), mop_extern("in_peek"));
+    minstr_emit(code, MI_LEA, 4, mop_mem(REG_RAX, REG_NONE, 0, -'0'), mop_reg(REG_RCX));
+    minstr_emit(code, MI_CMP, 4, mop_imm(9), mop_reg(REG_RCX));
+    runtime_jump(code, CC_BE, "in_int_digit");
+    minstr_emit(code, MI_MOV, 4, runtime_frame(-16), mop_reg(REG_RAX));
+    minstr_emit(code, MI_CMP, 4, mop_imm(0), runtime_frame(-12));
+    runtime_jump(code, CC_E, "in_int_store");
+    minstr_emit(code, MI_NEG, 4, mop_none(), mop_reg(REG_RAX));
+    runtime_label(code, "in_int_store");
+    minstr_emit(code, MI_MOV, 8, runtime_frame(-8), mop_reg(REG_RCX));
+    minstr_emit(code, MI_MOV, 4, mop_reg(REG_RAX), mop_mem(REG_RCX, REG_NONE, 0, 0));
+    runtime_label(code, "in_int_done");
+    runtime_leave(code);
+}
+
+// the first byte that is not white space, as " %c" reads it
+void runtime_in_char(MCODE *code)
+{
+    runtime_enter(code, "in_char");
+    minstr_emit(code, MI_MOV, 8, mop_reg(REG_RDI), runtime_frame(-8));
+    runtime_skip(code, runtime_in_char_labels);
+    minstr_emit(code, MI_CMP, 4, mop_imm(-1), mop_reg(REG_RAX));
+    runtime_jump(code, CC_E, "in_char_done");
+    runtime_take(code);
+    minstr_emit(code, MI_MOV, 8, runtime_frame(-8), mop_reg(REG_RCX));
+    minstr_emit(code, MI_MOV, 1, mop_reg(REG_RAX), mop_mem(REG_RCX, REG_NONE, 0, 0));
+    runtime_label(code, "in_char_done");
+    runtime_leave(code);
+}
+
+// the next token byte less '0' in edx, leaving for other when it is no digit
+void runtime_token_digit(MCODE *code, char *other)
+{
+    minstr_emit(code, MI_MOVZB, 4, mop_mem(REG_RDI, REG_NONE, 0, 0), mop_reg(REG_RDX));
+    minstr_emit(code, MI_SUB, 4, mop_imm('0'), mop_reg(REG_RDX));
+    minstr_emit(code, MI_CMP, 4, mop_imm(9), mop_reg(REG_RDX));
+    runtime_jump(code, CC_A, other);
+}
+
+// rax = 10 * rax + rdx for the next mantissa digit, which must keep it exact in a float
+void runtime_token_mantissa(MCODE *code)
+{
+    minstr_emit(code, MI_LEA, 8, mop_mem(REG_RAX, REG_RAX, 4, 0), mop_reg(REG_RAX));
+    minstr_emit(code, MI_LEA, 8, mop_mem(REG_RDX, REG_RAX, 2, 0), mop_reg(REG_RAX));
+    minstr_emit(code, MI_ADD, 4, mop_imm(1), mop_reg(REG_R9));
+    minstr_emit(code, MI_ADD, 8, mop_imm(1), mop_reg(REG_RDI));
+    minstr_emit(code, MI_CMP, 8, mop_imm(1 << RUNTIME_REAL_MANTISSA), mop_reg(REG_RAX));
+    runtime_jump(code, CC_A, "in_real_slow");
+}
+
+// the token is parsed into an integer mantissa in rax, a decimal exponent in ecx and
+// a sign in r8d; when the mantissa and the power of ten are exact floats, one mulss or
+// divss rounds like strtof would, which is left the other spellings
+void runtime_in_real_parse(MCODE *code)
+{
+    minstr_emit(code, MI_LEA, 8, runtime_frame(-88), mop_reg(REG_RDI));
+    minstr_emit(code, MI_MOV, 4, mop_imm(0), mop_reg(REG_RAX));
+    minstr_emit(code, MI_MOV, 4, mop_imm(0), mop_reg(REG_RCX));
+    minstr_emit(code, MI_MOV, 4, mop_imm(0), mop_reg(REG_R8));
+    minstr_emit(code, MI_MOV, 4, mop_imm(0), mop_reg(REG_R9));
+    minstr_emit(code, MI_MOVZB, 4, mop_mem(REG_RDI, REG_NONE, 0, 0), mop_reg(REG_RDX));
+    minstr_emit(code, MI_CMP, 4, mop_imm('-'), mop_reg(REG_RDX));
+    runtime_jump(code, CC_NE, "in_real_plus");
+    minstr_emit(code, MI_MOV, 4, mop_imm(1), mop_reg(REG_R8));
+    minstr_emit(code, MI_JMP, 8, mop_none(), mop_extern("in_real_signed"));
+    runtime_label(code, "in_real_plus");
+    minstr_emit(code, MI_CMP, 4, mop_imm('+'), mop_reg(REG_RDX));
+    runtime_jump(code, CC_NE, "in_real_whole");
+    runtime_label(code, "in_real_signed");
+    minstr_emit(code, MI_ADD, 8, mop_imm(1), mop_reg(REG_RDI));
+
+    runtime_label(code, "in_real_whole");
+    runtime_token_digit(code, "in_real_point");
+    runtime_token_mantissa(code);
+    minstr_emit(code, MI_JMP, 8, mop_none(), mop_extern("in_real_whole"));
+    runtime_label(code, "in_real_point");
+    minstr_emit(code, MI_CMP, 1, mop_imm('.'), mop_mem(REG_RDI, REG_NONE, 0, 0));
+    runtime_jump(code, CC_NE, "in_real_exponent");
+    minstr_emit(code, MI_ADD, 8, mop_imm(1), mop_reg(REG_RDI));
+    runtime_label(code, "in_real_fraction");
+    runtime_token_digit(code, "in_real_exponent");
+    runtime_token_mantissa(code);
+    minstr_emit(code, MI_SUB, 4, mop_imm(1), mop_reg(REG_RCX));
+    minstr_emit(code, MI_JMP, 8, mop_none(), mop_extern("in_real_fraction"));
+
+    // r9d counted the mantissa digits and holds the exponent from here on, r10d its sign
+    runtime_label(code, "in_real_exponent");
+    minstr_emit(code, MI_TEST, 4, mop_reg(REG_R9), mop_reg(REG_R9));
+    runtime_jump(code, CC_E, "in_real_slow");
+    minstr_emit(code, MI_MOVZB, 4, mop_mem(REG_RDI, REG_NONE, 0, 0), mop_reg(REG_RDX));
+    minstr_emit(code, MI_TEST, 4, mop_reg(REG_RDX), mop_reg(REG_RDX));
+    runtime_jump(code, CC_E, "in_real_scale");
+    minstr_emit(code, MI_OR, 4, mop_imm(' '), mop_reg(REG_RDX));
+    minstr_emit(code, MI_CMP, 4, mop_imm('e'), mop_reg(REG_RDX));
+    runtime_jump(code, CC_NE, "in_real_slow");
+    minstr_emit(code, MI_ADD, 8, mop_imm(1), mop_reg(REG_RDI));
+    minstr_emit(code, MI_MOV, 4, mop_imm(0), mop_reg(REG_R9));
+    minstr_emit(code, MI_MOV, 4, mop_imm(0), mop_reg(REG_R10));
+    minstr_emit(code, MI_MOVZB, 4, mop_mem(REG_RDI, REG_NONE, 0, 0), mop_reg(REG_RDX));
+    minstr_emit(code, MI_CMP, 4, mop_imm('-'), mop_reg(REG_RDX));
+    runtime_jump(code, CC_NE, "in_real_exponent_plus");
+    minstr_emit(code, MI_MOV, 4, mop_imm(1), mop_reg(REG_R10));
+    minstr_emit(code, MI_JMP, 8, mop_none(), mop_extern("in_real_exponent_signed"));
+    runtime_label(code, "in_real_exponent_plus");
+    minstr_emit(code, MI_CMP, 4, mop_imm('+'), mop_reg(REG_RDX));
+    runtime_jump(code, CC_NE, "in_real_exponent_first");
+    runtime_label(code, "in_real_exponent_signed");
+    minstr_emit(code, MI_ADD, 8, mop_imm(1), mop_reg(REG_RDI));
+    runtime_label(code, "in_real_exponent_first");
+    runtime_token_digit(code, "in_real_slow");
+    runtime_label(code, "in_real_exponent_digit");
+    runtime_token_digit(code, "in_real_exponent_end");
+    minstr_emit(code, MI_LEA, 4, mop_mem(REG_R9, REG_R9, 4, 0), mop_reg(REG_R9));
+    minstr_emit(code, MI_LEA, 4, mop_mem(REG_RDX, REG_R9, 2, 0), mop_reg(REG_R9));
+    minstr_emit(code, MI_ADD, 8, mop_imm(1), mop_reg(REG_RDI));
+    minstr_emit(code, MI_CMP, 4, mop_imm(RUNTIME_REAL_EXACT), mop_reg(REG_R9));
+    runtime_jump(code, CC_A, "in_real_slow");
+    minstr_emit(code, MI_JMP, 8, mop_none(), mop_extern("in_real_exponent_digit"));
+    runtime_label(code, "in_real_exponent_end");
+    minstr_emit(code, MI_CMP, 1, mop_imm(0), mop_mem(REG_RDI, REG_NONE, 0, 0));
+    runtime_jump(code, CC_NE, "in_real_slow");
+    minstr_emit(code, MI_TEST, 4, mop_reg(REG_R10), mop_reg(REG_R10));
+    runtime_jump(code, CC_E, "in_real_exponent_add");
+    minstr_emit(code, MI_NEG, 4, mop_none(), mop_reg(REG_R9));
+    runtime_label(code, "in_real_exponent_add");
+    minstr_emit(code, MI_ADD, 4, mop_reg(REG_R9), mop_reg(REG_RCX));
+
+    // rdx = 10 ^ |ecx|, exact in a float up to RUNTIME_REAL_EXACT
+    runtime_label(code, "in_real_scale");
+    minstr_emit(code, MI_CMP, 4, mop_imm(RUNTIME_REAL_EXACT), mop_reg(REG_RCX));
+    runtime_jump(code, CC_G, "in_real_slow");
+    minstr_emit(code, MI_CMP, 4, mop_imm(-RUNTIME_REAL_EXACT), mop_reg(REG_RCX));
+    runtime_jump(code, CC_L, "in_real_slow");
+    minstr_emit(code, MI_TEST, 4, mop_reg(REG_R8), mop_reg(REG_R8));
+    runtime_jump(code, CC_E, "in_real_positive");
+    minstr_emit(code, MI_TEST, 8, mop_reg(REG_RAX), mop_reg(REG_RAX));
+    runtime_jump(code, CC_E, "in_real_slow");
+    minstr_emit(code, MI_NEG, 8, mop_none(), mop_reg(REG_RAX));
+    runtime_label(code, "in_real_positive");
+    minstr_emit(code, MI_CVTSI2SS, 8, mop_reg(REG_RAX), mop_reg(REG_XMM0));
+    minstr_emit(code, MI_MOV, 4, mop_imm(1), mop_reg(REG_RDX));
+    minstr_emit(code, MI_MOV, 4, mop_reg(REG_RCX), mop_reg(REG_R9));
+    minstr_emit(code, MI_TEST, 4, mop_reg(REG_R9), mop_reg(REG_R9));
+    runtime_jump(code, CC_GE, "in_real_power");
+    minstr_emit(code, MI_NEG, 4, mop_none(), mop_reg(REG_R9));
+    runtime_label(code, "in_real_power");
+    minstr_emit(code, MI_TEST, 4, mop_reg(REG_R9), mop_reg(REG_R9));
+    runtime_jump(code, CC_E, "in_real_powered");
+    minstr_emit(code, MI_LEA, 8, mop_mem(REG_RDX, REG_RDX, 4, 0), mop_reg(REG_RDX));
+    minstr_emit(code, MI_ADD, 8, mop_reg(REG_RDX), mop_reg(REG_RDX));
+    minstr_emit(code, MI_SUB, 4, mop_imm(1), mop_reg(REG_R9));
+    minstr_emit(code, MI_JMP, 8, mop_none(), mop_extern("in_real_power"));
+    runtime_label(code, "in_real_powered");
+    minstr_emit(code, MI_CVTSI2SS, 8, mop_reg(REG_RDX), mop_reg(REG_XMM1));
+    minstr_emit(code, MI_TEST, 4, mop_reg(REG_RCX), mop_reg(REG_RCX));
+    runtime_jump(code, CC_L, "in_real_divide");
+    minstr_emit(code, MI_MULSS, 4, mop_reg(REG_XMM1), mop_reg(REG_XMM0));
+    minstr_emit(code, MI_JMP, 8, mop_none(), mop_extern("in_real_store"));
+    runtime_label(code, "in_real_divide");
+    minstr_emit(code, MI_DIVSS, 4, mop_reg(REG_XMM1), mop_reg(REG_XMM0));
+    minstr_emit(code, MI_JMP, 8, mop_none(), mop_extern("in_real_store"));
+}
+
+// the bytes a decimal float may be spelled with are copied into the frame, a sign only
+// first or after an exponent mark. -8 keeps the pointer, -16 the length, -24 the end
+// strtof reports, and the token lives at -88
+void runtime_in_real(MCODE *code)
+{
+    minstr_emit(code, MI_FUNCTION, 8, mop_none(), mop_extern("in_real"));
+    minstr_emit(code, MI_PUSH, 8, mop_none(), mop_reg(REG_RBP));
+    minstr_emit(code, MI_MOV, 8, mop_reg(REG_RSP), mop_reg(REG_RBP));
+    minstr_emit(code, MI_SUB, 8, mop_imm(96), mop_reg(REG_RSP));
+    minstr_emit(code, MI_MOV, 8, mop_reg(REG_RDI), runtime_frame(-8));
+    minstr_emit(code, MI_MOV, 8, mop_imm(0), runtime_frame(-16));
+    runtime_skip(code, runtime_in_real_labels);
+
+    runtime_label(code, "in_real_next");
+    minstr_emit(code, MI_MOV, 8, runtime_frame(-16), mop_reg(REG_RCX));
+    minstr_emit(code, MI_CMP, 8, mop_imm(RUNTIME_REAL_TOKEN), mop_reg(REG_RCX));
+    runtime_jump(code, CC_AE, "in_real_convert");
+    minstr_emit(code, MI_LEA, 4, mop_mem(REG_RAX, REG_NONE, 0, -'0'), mop_reg(REG_RDX));
+    minstr_emit(code, MI_CMP, 4, mop_imm(9), mop_reg(REG_RDX));
+    runtime_jump(code, CC_BE, "in_real_take");
+    minstr_emit(code, MI_CMP, 4, mop_imm('.'), mop_reg(REG_RAX));
+    runtime_jump(code, CC_E, "in_real_take");
+    minstr_emit(code, MI_MOV, 4, mop_reg(REG_RAX), mop_reg(REG_RDX));
+    minstr_emit(code, MI_OR, 4, mop_imm(' '), mop_reg(REG_RDX));
+    minstr_emit(code, MI_CMP, 4, mop_imm('e'), mop_reg(REG_RDX));
+    runtime_jump(code, CC_E, "in_real_take");
+    minstr_emit(code, MI_CMP, 4, mop_imm('+'), mop_reg(REG_RAX));
+    runtime_jump(code, CC_E, "in_real_sign");
+    minstr_emit(code, MI_CMP, 4, mop_imm('-'), mop_reg(REG_RAX));
+    runtime_jump(code, CC_NE, "in_real_convert");
+    runtime_label(code, "in_real_sign");
+    minstr_emit(code, MI_TEST, 8, mop_reg(REG_RCX), mop_reg(REG_RCX));
+    runtime_jump(code, CC_E, "in_real_take");
+    minstr_emit(code, MI_MOVZB, 4, mop_mem(REG_RBP, REG_RCX, 1, -89), mop_reg(REG_RDX));
+    minstr_emit(code, MI_OR, 4, mop_imm(' '), mop_reg(REG_RDX));
+    minstr_emit(code, MI_CMP, 4, mop_imm('e'), mop_reg(REG_RDX));
+    runtime_jump(code, CC_NE, "in_real_convert");
+    runtime_label(code, "in_real_take");
+    minstr_emit(code, MI_MOV, 1, mop_reg(REG_RAX), mop_mem(REG_RBP, REG_RCX, 1, -88));
+    minstr_emit(code, MI_ADD, 8, mop_imm(1), runtime_frame(-16));
+    runtime_take(code);
+    minstr_emit(code, MI_CALL, 8, mop_none(), mop_extern("in_peek"));
+    minstr_emit(code, MI_JMP, 8, mop_none(), mop_extern("in_real_next"));
+
+    runtime_label(code, "in_real_convert");
+    minstr_emit(code, MI_MOV, 1, mop_imm(0), mop_mem(REG_RBP, REG_RCX, 1, -88));
+    runtime_in_real_parse(code);
+
+    runtime_label(code, "in_real_slow");
+    minstr_emit(code, MI_LEA, 8, runtime_frame(-88), mop_reg(REG_RDI));
+    minstr_emit(code, MI_LEA, 8, runtime_frame(-24), mop_reg(REG_RSI));
+    minstr_emit(code, MI_CALL, 8, mop_none(), mop_extern("strtof@PLT"));
+    minstr_emit(code, MI_LEA, 8, runtime_frame(-88), mop_reg(REG_RAX));
+    minstr_emit(code, MI_CMP, 8, runtime_frame(-24), mop_reg(REG_RAX));
+    runtime_jump(code, CC_E, "in_real_done");
+    runtime_label(code, "in_real_store");
+    minstr_emit(code, MI_MOV, 8, runtime_frame(-8), mop_reg(REG_RCX));
+    minstr_emit(code, MI_MOVSS, 4, mop_reg(REG_XMM0), mop_mem(REG_RCX, REG_NONE, 0, 0));
+    runtime_label(code, "in_real_done");
+    runtime_leave(code);
+}
+
+void runtime_emit(MCODE *code, MCODE *bss)
+{
+    minstr_emit(bss, MI_LABEL, 0, mop_none(), mop_name("out_buffer"));
+    minstr_emit(bss, MI_ZERO, 4, mop_none(), mop_imm(RUNTIME_BUFFER_SIZE));
+    minstr_emit(bss, MI_LABEL, 0, mop_none(), mop_name("out_used"));
+    minstr_emit(bss, MI_ZERO, 4, mop_none(), mop_imm(4));
+    minstr_emit(bss, MI_LABEL, 0, mop_none(), mop_name("in_buffer"));
+    minstr_emit(bss, MI_ZERO, 4, mop_none(), mop_imm(RUNTIME_BUFFER_SIZE));
+    minstr_emit(bss, MI_LABEL, 0, mop_none(), mop_name("in_next"));
+    minstr_emit(bss, MI_ZERO, 4, mop_none(), mop_imm(4));
+    minstr_emit(bss, MI_LABEL, 0, mop_none(), mop_name("in_end"));
+    minstr_emit(bss, MI_ZERO, 4, mop_none(), mop_imm(4));
+
+    runtime_flush(code);
+    runtime_int(code);
+    runtime_char(code);
+    runtime_string(code);
+    runtime_real(code);
+    runtime_format(code);
+    runtime_peek(code);
+    runtime_in_int(code);
+    runtime_in_char(code);
+    runtime_in_real(code);
+}
@@ -0,0 +1,32 @@
+#pragma once
+#include "minstr.h"
+
+// output of native programs collects in one buffer that is written out when full,
+// before input is read and at exit; input is read into another of the same size
+#define RUNTIME_BUFFER_SIZE 65536
+
+// longest spelling of a real input; inputs of at most 2^24 as mantissa and a decimal
+// exponent of at most 10 are exact floats and converted by hand, others by strtof
+#define RUNTIME_REAL_TOKEN 63
+#define RUNTIME_REAL_MANTISSA 24
+#define RUNTIME_REAL_EXACT 10
+
+// room one call may need: a sign and ten digits, or "%f" of the largest float
+#define RUNTIME_INT_ROOM 11
+#define RUNTIME_REAL_ROOM 64
+
+// items of an out_format descriptor, which ends with a zero item; a text item runs up
+// to its own zero byte, the others take the next integer or real argument
+#define RUNTIME_FORMAT_INT 1
+#define RUNTIME_FORMAT_CHAR 2
+#define RUNTIME_FORMAT_REAL 3
+#define RUNTIME_FORMAT_TEXT 4
+
+// arguments after the descriptor: integers in rsi, rdx, rcx, r8, r9, reals in xmm0-xmm7,
+// and in eax the room the items may take, which must fit the buffer
+#define RUNTIME_FORMAT_INTS 5
+#define RUNTIME_FORMAT_REALS 8
+
+extern int runtime_format_regs[RUNTIME_FORMAT_INTS];
+
+void runtime_emit(MCODE *code, MCODE *bss);
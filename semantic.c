@@ -7,7 +7,6 @@
 #include "debug.h"
 #include "semantic_utils.h"
 
-int SemanticErrors = 0;
 
 void check_and_set_declarations(AST *node)
 {
@@ -27,8 +26,8 @@ void check_and_set_declarations(AST *node)
         {
             if (node->symbol->type != SYMBOL_IDENTIFIER)
             {
-                fprintf(stderr, "Semantic error: identifier %s already declared at line %d\n", node->symbol->text, node->line_number);
-                ++SemanticErrors;
+                fprintf(compiler->diagnostics, "Semantic error: identifier %s already declared at line %d\n", node->symbol->text, node->line_number);
+                ++compiler->semantic_errors;
             }
 
             node->symbol->type = SYMBOL_VARIABLE;
@@ -54,8 +53,8 @@ void check_and_set_declarations(AST *node)
         {
             if (node->symbol->type != SYMBOL_IDENTIFIER)
             {
-                fprintf(stderr, "Semantic error: identifier %s already declared at line %d\n", node->symbol->text, node->line_number);
-                ++SemanticErrors;
+                fprintf(compiler->diagnostics, "Semantic error: identifier %s already declared at line %d\n", node->symbol->text, node->line_number);
+                ++compiler->semantic_errors;
             }
 
             node->symbol->type = SYMBOL_VECTOR;
@@ -71,10 +70,10 @@ void check_and_set_declarations(AST *node)
                 {
                     if (!(verify_literal_compatibility(initialization_item->son[0]->type, required_vec_type)))
                     {
-                        fprintf(stderr, "Semantic error: vector %s has initialization item with wrong type (expected type %s got %s) at line %d\n",
+                        fprintf(compiler->diagnostics, "Semantic error: vector %s has initialization item with wrong type (expected type %s got %s) at line %d\n",
                                 node->symbol->text, ast_type_str(required_vec_type),
                                 ast_type_str(initialization_item->son[0]->type), node->line_number);
-                        ++SemanticErrors;
+                        ++compiler->semantic_errors;
                     }
                     initialization_item = initialization_item->son[1];
                     ++initialization_count;
@@ -82,9 +81,9 @@ void check_and_set_declarations(AST *node)
 
                 if (initialization_count != vec_size)
                 {
-                    fprintf(stderr, "Semantic error: vector %s has %d initialization items, but its size is %d at line %d\n",
+                    fprintf(compiler->diagnostics, "Semantic error: vector %s has %d initialization items, but its size is %d at line %d\n",
                             node->symbol->text, initialization_count, vec_size, node->line_number);
-                    ++SemanticErrors;
+                    ++compiler->semantic_errors;
                 }
             }
         }
@@ -100,8 +99,8 @@ void check_and_set_declarations(AST *node)
         {
             if (node->symbol->type != SYMBOL_IDENTIFIER)
             {
-                fprintf(stderr, "Semantic error: identifier %s already declared at line %d\n", node->symbol->text, node->son[0]->line_number);
-                ++SemanticErrors;
+                fprintf(compiler->diagnostics, "Semantic error: identifier %s already declared at line %d\n", node->symbol->text, node->son[0]->line_number);
+                ++compiler->semantic_errors;
             }
 
             node->symbol->type = SYMBOL_FUNCTION;
@@ -138,8 +137,8 @@ void check_and_set_declarations(AST *node)
         {
             if (node->symbol->type != SYMBOL_IDENTIFIER)
             {
-                fprintf(stderr, "Semantic error: identifier %s already declared at line %d\n", node->symbol->text, node->line_number);
-                ++SemanticErrors;
+                fprintf(compiler->diagnostics, "Semantic error: identifier %s already declared at line %d\n", node->symbol->text, node->line_number);
+                ++compiler->semantic_errors;
             }
 
             node->symbol->type = SYMBOL_PARAMETER;
@@ -158,7 +157,7 @@ void check_and_set_declarations(AST *node)
 
 void check_undeclared(void)
 {
-    SemanticErrors += hash_check_undeclared();
+    compiler->semantic_errors += hash_check_undeclared();
 }
 
 void check_operands(AST *node)
@@ -183,13 +182,13 @@ void check_operands(AST *node)
     {
         if (node->symbol) {
             if (node->symbol->is_function) {
-                fprintf(stderr, "Semantic error: function %s used as value at line %d (should be called instead)\n", node->symbol->text, node->line_number);
-                ++SemanticErrors;
+                fprintf(compiler->diagnostics, "Semantic error: function %s used as value at line %d (should be called instead)\n", node->symbol->text, node->line_number);
+                ++compiler->semantic_errors;
             }
 
             if (node->symbol->is_vector && node->son[0] == NULL) {
-                fprintf(stderr, "Semantic error: vector %s used as value at line %d (should be indexed instead)\n", node->symbol->text, node->line_number);
-                ++SemanticErrors;
+                fprintf(compiler->diagnostics, "Semantic error: vector %s used as value at line %d (should be indexed instead)\n", node->symbol->text, node->line_number);
+                ++compiler->semantic_errors;
             }
         }
         node->result_datatype = expression_typecheck(node);
@@ -201,8 +200,8 @@ void check_operands(AST *node)
     {
         if (node->symbol && !node->symbol->is_function)
         {
-            fprintf(stderr, "Semantic error: tried to call %s which is not a function at line %d\n", node->symbol->text, node->line_number);
-            ++SemanticErrors;
+            fprintf(compiler->diagnostics, "Semantic error: tried to call %s which is not a function at line %d\n", node->symbol->text, node->line_number);
+            ++compiler->semantic_errors;
         }
         break;
     }
@@ -210,30 +209,34 @@ void check_operands(AST *node)
     {
         if (node->symbol && !node->symbol->is_vector)
         {
-            fprintf(stderr, "Semantic error: tried to index %s which is not a vector at line %d\n", node->symbol->text, node->line_number);
-            ++SemanticErrors;
+            fprintf(compiler->diagnostics, "Semantic error: tried to index %s which is not a vector at line %d\n", node->symbol->text, node->line_number);
+            ++compiler->semantic_errors;
         }
 
         if (node->son[0]->type == AST_IDENTIFIER && node->son[0]->symbol) {
             if (node->son[0]->symbol->is_function) {
-                fprintf(stderr, "Semantic error: cannot use function %s as vector index at line %d\n", node->son[0]->symbol->text, node->line_number);
-                ++SemanticErrors;
+                fprintf(compiler->diagnostics, "Semantic error: cannot use function %s as vector index at line %d\n", node->son[0]->symbol->text, node->line_number);
+                ++compiler->semantic_errors;
             }
             if (node->son[0]->symbol->is_vector) {
-                fprintf(stderr, "Semantic error: cannot use vector %s as vector index at line %d\n", node->son[0]->symbol->text, node->line_number);
-                ++SemanticErrors;
+                fprintf(compiler->diagnostics, "Semantic error: cannot use vector %s as vector index at line %d\n", node->son[0]->symbol->text, node->line_number);
+                ++compiler->semantic_errors;
             }
         }
 
         if (node->son[0]->symbol && node->son[0]->symbol->datatype == 0) {
-            node->son[0]->symbol->datatype = expression_typecheck(node->son[0]);
+            // the symbol is shared with the functions checked alongside, so it is only
+            // written when the index tells us its type
+            int datatype = expression_typecheck(node->son[0]);
+            if (datatype != 0)
+                node->son[0]->symbol->datatype = datatype;
         } else if (node->son[0]->result_datatype == 0) {
             node->son[0]->result_datatype = expression_typecheck(node->son[0]);
         }
 
         if ((node->son[0]->symbol && node->son[0]->symbol->datatype != DATATYPE_INT) || node->son[0]->result_datatype != DATATYPE_INT) {
-            fprintf(stderr, "Semantic error: tried to index %s with non-integer expression at line %d\n", node->symbol->text, node->line_number);
-            ++SemanticErrors;
+            fprintf(compiler->diagnostics, "Semantic error: tried to index %s with non-integer expression at line %d\n", node->symbol->text, node->line_number);
+            ++compiler->semantic_errors;
         }
 
         break;
@@ -262,26 +265,26 @@ void check_operands(AST *node)
 
         if (left_operand->symbol != NULL && left_operand->symbol->is_vector && left_operand->type != AST_VEC_ACCESS)
         {
-            fprintf(stderr, "Semantic error: invalid left operand (vector should be indexed) at line %d\n", node->line_number);
-            ++SemanticErrors;
+            fprintf(compiler->diagnostics, "Semantic error: invalid left operand (vector should be indexed) at line %d\n", node->line_number);
+            ++compiler->semantic_errors;
         }
 
         if (right_operand->symbol != NULL && right_operand->symbol->is_vector && right_operand->type != AST_VEC_ACCESS)
         {
-            fprintf(stderr, "Semantic error: invalid right operand (vector should be indexed) at line %d\n", node->line_number);
-            ++SemanticErrors;
+            fprintf(compiler->diagnostics, "Semantic error: invalid right operand (vector should be indexed) at line %d\n", node->line_number);
+            ++compiler->semantic_errors;
         }
 
         if (left_operand->symbol != NULL && left_operand->symbol->is_function && left_operand->type != AST_FUNC_CALL)
         {
-            fprintf(stderr, "Semantic error: invalid left operand (function should be called) at line %d\n", node->line_number);
-            ++SemanticErrors;
+            fprintf(compiler->diagnostics, "Semantic error: invalid left operand (function should be called) at line %d\n", node->line_number);
+            ++compiler->semantic_errors;
         }
 
         if (right_operand->symbol != NULL && right_operand->symbol->is_function && right_operand->type != AST_FUNC_CALL)
         {
-            fprintf(stderr, "Semantic error: invalid right operand (function should be called) at line %d\n", node->line_number);
-            ++SemanticErrors;
+            fprintf(compiler->diagnostics, "Semantic error: invalid right operand (function should be called) at line %d\n", node->line_number);
+            ++compiler->semantic_errors;
         }
 
         int errored = 0;
@@ -290,15 +293,15 @@ void check_operands(AST *node)
         {
 
             errored = 1;
-            fprintf(stderr, "Semantic error: invalid left operand at line %d\n", node->line_number);
-            ++SemanticErrors;
+            fprintf(compiler->diagnostics, "Semantic error: invalid left operand at line %d\n", node->line_number);
+            ++compiler->semantic_errors;
         }
 
         if (!(is_bool(right_operand)) && !(right_operand->type == AST_NESTED_EXPR) && !(right_operand->type == AST_NEG) && !is_numeric(right_operand) && !is_arithmetic(right_operand) && !is_input_cmd(right_operand))
         {
             errored = 1;
-            fprintf(stderr, "Semantic error: invalid right operand at line %d\n", node->line_number);
-            ++SemanticErrors;
+            fprintf(compiler->diagnostics, "Semantic error: invalid right operand at line %d\n", node->line_number);
+            ++compiler->semantic_errors;
         }
 
         if (!errored)
@@ -333,23 +336,23 @@ void check_operands(AST *node)
                 !compare_datatypes(left_datatype, right_datatype))
             {
 
-                fprintf(stderr, "Semantic error: operands should have same type at line %d\n", node->line_number);
-                ++SemanticErrors;
+                fprintf(compiler->diagnostics, "Semantic error: operands should have same type at line %d\n", node->line_number);
+                ++compiler->semantic_errors;
             }
             else
             {
                 if (left_datatype != right_datatype && !compare_datatypes(left_datatype, right_datatype))
                 {
-                    fprintf(stderr, "Semantic error: operands should have same type at line %d\n", node->line_number);
-                    ++SemanticErrors;
+                    fprintf(compiler->diagnostics, "Semantic error: operands should have same type at line %d\n", node->line_number);
+                    ++compiler->semantic_errors;
                 }
             }
 
             if (is_arithmetic(node) && !is_arithmetic(left_operand) && !is_arithmetic(right_operand) && !is_numeric(left_operand) && !is_numeric(right_operand))
             {
-                fprintf(stderr, "Node ID: %d\n", node->id);
-                fprintf(stderr, "Semantic error: operands should be arithmetic at line %d\n", node->line_number);
-                ++SemanticErrors;
+                fprintf(compiler->diagnostics, "Node ID: %d\n", node->id);
+                fprintf(compiler->diagnostics, "Semantic error: operands should be arithmetic at line %d\n", node->line_number);
+                ++compiler->semantic_errors;
             }
 
             errored = 1;
@@ -357,8 +360,8 @@ void check_operands(AST *node)
 
         if (!errored && !expression_typecheck(node))
         {
-            fprintf(stderr, "Semantic error: invalid resulting expression type for %s at line %d\n", ast_type_str(node->type), node->line_number);
-            ++SemanticErrors;
+            fprintf(compiler->diagnostics, "Semantic error: invalid resulting expression type for %s at line %d\n", ast_type_str(node->type), node->line_number);
+            ++compiler->semantic_errors;
         }
         else
         {
@@ -375,34 +378,34 @@ void check_operands(AST *node)
 
         if (operand->symbol && operand->symbol->is_vector && operand->type != AST_VEC_ACCESS)
         {
-            fprintf(stderr, "Semantic error: invalid unary operand (vector should be indexed) at line %d\n", node->line_number);
-            ++SemanticErrors;
+            fprintf(compiler->diagnostics, "Semantic error: invalid unary operand (vector should be indexed) at line %d\n", node->line_number);
+            ++compiler->semantic_errors;
         }
 
         if (operand->symbol && operand->symbol->is_function && operand->type != AST_FUNC_CALL)
         {
-            fprintf(stderr, "Semantic error: invalid unary operand (function should be called) at line %d\n", node->line_number);
-            ++SemanticErrors;
+            fprintf(compiler->diagnostics, "Semantic error: invalid unary operand (function should be called) at line %d\n", node->line_number);
+            ++compiler->semantic_errors;
         }
 
         if (operand->type != AST_NESTED_EXPR && !is_numeric(operand) && !is_arithmetic(operand) && !is_input_cmd(operand))
         {
-            fprintf(stderr, "Semantic error: invalid unary arithmetic/numeric operand at line %d\n", node->line_number);
-            ++SemanticErrors;
+            fprintf(compiler->diagnostics, "Semantic error: invalid unary arithmetic/numeric operand at line %d\n", node->line_number);
+            ++compiler->semantic_errors;
         }
 
         if (!expression_typecheck(node))
         {
-            fprintf(stderr, "Semantic error: invalid resulting expression type for %s at line %d\n", ast_type_str(node->type), node->line_number);
-            ++SemanticErrors;
+            fprintf(compiler->diagnostics, "Semantic error: invalid resulting expression type for %s at line %d\n", ast_type_str(node->type), node->line_number);
+            ++compiler->semantic_errors;
         }
         else
         {
             node->result_datatype = expression_typecheck(node);
             if (node->result_datatype == DATATYPE_BOOL)
             {
-                fprintf(stderr, "Semantic error: invalid resulting expression type for %s (got bool, expected numeric-compatible type) at line %d\n", ast_type_str(node->type), node->line_number);
-                ++SemanticErrors;
+                fprintf(compiler->diagnostics, "Semantic error: invalid resulting expression type for %s (got bool, expected numeric-compatible type) at line %d\n", ast_type_str(node->type), node->line_number);
+                ++compiler->semantic_errors;
             }
         }
         break;
@@ -416,40 +419,40 @@ void check_operands(AST *node)
 
         if (left_operand->symbol && left_operand->symbol->is_vector && left_operand->type != AST_VEC_ACCESS)
         {
-            fprintf(stderr, "Semantic error: invalid left operand (vector should be indexed) at line %d\n", node->line_number);
-            ++SemanticErrors;
+            fprintf(compiler->diagnostics, "Semantic error: invalid left operand (vector should be indexed) at line %d\n", node->line_number);
+            ++compiler->semantic_errors;
         }
 
         if (right_operand->symbol && right_operand->symbol->is_vector && right_operand->type != AST_VEC_ACCESS)
         {
-            fprintf(stderr, "Semantic error: invalid right operand (vector should be indexed) at line %d\n", node->line_number);
-            ++SemanticErrors;
+            fprintf(compiler->diagnostics, "Semantic error: invalid right operand (vector should be indexed) at line %d\n", node->line_number);
+            ++compiler->semantic_errors;
         }
 
         if (left_operand->symbol && left_operand->symbol->is_function && left_operand->type != AST_FUNC_CALL)
         {
-            fprintf(stderr, "Semantic error: invalid left operand (function should be called) at line %d\n", node->line_number);
-            ++SemanticErrors;
+            fprintf(compiler->diagnostics, "Semantic error: invalid left operand (function should be called) at line %d\n", node->line_number);
+            ++compiler->semantic_errors;
         }
 
         if (right_operand->symbol && right_operand->symbol->is_function && right_operand->type != AST_FUNC_CALL)
         {
-            fprintf(stderr, "Semantic error: invalid right operand (function should be called) at line %d\n", node->line_number);
-            ++SemanticErrors;
+            fprintf(compiler->diagnostics, "Semantic error: invalid right operand (function should be called) at line %d\n", node->line_number);
+            ++compiler->semantic_errors;
         }
 
         int errored = 0;
 
         if (!is_bool(left_operand) && !(left_operand->type == AST_NESTED_EXPR) && !is_logic(left_operand) && !is_input_cmd(left_operand))
         {
-            fprintf(stderr, "Semantic error: invalid left operand for %s at line %d\n", ast_type_str(node->type), node->line_number);
-            ++SemanticErrors;
+            fprintf(compiler->diagnostics, "Semantic error: invalid left operand for %s at line %d\n", ast_type_str(node->type), node->line_number);
+            ++compiler->semantic_errors;
         }
 
         if (!is_bool(right_operand) && !(right_operand->type == AST_NESTED_EXPR) && !is_logic(right_operand) && !is_input_cmd(right_operand))
         {
-            fprintf(stderr, "Semantic error: invalid right operand for %s at line %d\n", ast_type_str(node->type), node->line_number);
-            ++SemanticErrors;
+            fprintf(compiler->diagnostics, "Semantic error: invalid right operand for %s at line %d\n", ast_type_str(node->type), node->line_number);
+            ++compiler->semantic_errors;
         }
 
         if (!errored)
@@ -479,15 +482,15 @@ void check_operands(AST *node)
 
             if ((left_operand->symbol || is_input_cmd(left_operand)) && (right_operand->symbol || is_input_cmd(right_operand)) && left_datatype != right_datatype)
             {
-                fprintf(stderr, "Semantic error: operands should have same type at line %d\n", node->line_number);
-                ++SemanticErrors;
+                fprintf(compiler->diagnostics, "Semantic error: operands should have same type at line %d\n", node->line_number);
+                ++compiler->semantic_errors;
             }
         }
 
         if (!expression_typecheck(node))
         {
-            fprintf(stderr, "Semantic error: invalid resulting expression type for %s at line %d\n", ast_type_str(node->type), node->line_number);
-            ++SemanticErrors;
+            fprintf(compiler->diagnostics, "Semantic error: invalid resulting expression type for %s at line %d\n", ast_type_str(node->type), node->line_number);
+            ++compiler->semantic_errors;
         }
         else
         {
@@ -503,34 +506,34 @@ void check_operands(AST *node)
 
         if (operand->symbol && operand->symbol->is_vector && operand->type != AST_VEC_ACCESS)
         {
-            fprintf(stderr, "Semantic error: invalid unary logical operand (vector should be indexed) at line %d\n", node->line_number);
-            ++SemanticErrors;
+            fprintf(compiler->diagnostics, "Semantic error: invalid unary logical operand (vector should be indexed) at line %d\n", node->line_number);
+            ++compiler->semantic_errors;
         }
 
         if (operand->symbol && operand->symbol->is_function && operand->type != AST_FUNC_CALL)
         {
-            fprintf(stderr, "Semantic error: invalid unary logical operand (function should be called) at line %d\n", node->line_number);
-            ++SemanticErrors;
+            fprintf(compiler->diagnostics, "Semantic error: invalid unary logical operand (function should be called) at line %d\n", node->line_number);
+            ++compiler->semantic_errors;
         }
 
         if (operand->type != AST_NESTED_EXPR && !is_logic(operand) && !is_bool(operand) && !is_input_cmd(operand))
         {
             if (operand->symbol)
             {
-                fprintf(stderr, "Semantic error: invalid unary logical operand (%s) at line %d\n", datatype_str[operand->symbol->datatype], node->line_number);
-                ++SemanticErrors;
+                fprintf(compiler->diagnostics, "Semantic error: invalid unary logical operand (%s) at line %d\n", datatype_str[operand->symbol->datatype], node->line_number);
+                ++compiler->semantic_errors;
             }
             else
             {
-                fprintf(stderr, "Semantic error: invalid unary logical operand (%s) at line %d\n", datatype_str[get_input_cmd_type(operand)], node->line_number);
-                ++SemanticErrors;
+                fprintf(compiler->diagnostics, "Semantic error: invalid unary logical operand (%s) at line %d\n", datatype_str[get_input_cmd_type(operand)], node->line_number);
+                ++compiler->semantic_errors;
             }
         }
 
         if (!expression_typecheck(node))
         {
-            fprintf(stderr, "Semantic error: invalid resulting expression type for %s at line %d\n", ast_type_str(node->type), node->line_number);
-            ++SemanticErrors;
+            fprintf(compiler->diagnostics, "Semantic error: invalid resulting expression type for %s at line %d\n", ast_type_str(node->type), node->line_number);
+            ++compiler->semantic_errors;
         }
         else
         {
@@ -694,8 +697,8 @@ int check_assignments(AST *node)
     {
         if (node->symbol && node->symbol->is_function)
         {
-            fprintf(stderr, "Semantic error: invalid assignment to function %s at line %d\n", node->symbol->text, node->line_number);
-            ++SemanticErrors;
+            fprintf(compiler->diagnostics, "Semantic error: invalid assignment to function %s at line %d\n", node->symbol->text, node->line_number);
+            ++compiler->semantic_errors;
         }
 
         int expected_datatype = node->symbol->datatype;
@@ -705,48 +708,48 @@ int check_assignments(AST *node)
         {
             if (node->symbol && node->symbol->is_vector && node->son[0]->symbol && !node->son[0]->symbol->is_vector)
             {
-                fprintf(stderr, "Semantic error: invalid assignment of scalar/function to vector at line %d\n", node->line_number);
-                ++SemanticErrors;
+                fprintf(compiler->diagnostics, "Semantic error: invalid assignment of scalar/function to vector at line %d\n", node->line_number);
+                ++compiler->semantic_errors;
             }
             else
             {
                 if (node->son[0]->symbol->is_vector && !node->symbol->is_vector && !node->symbol->is_function)
                 {
-                    fprintf(stderr, "Semantic error: invalid assignment of vector to scalar at line %d\n", node->line_number);
-                    ++SemanticErrors;
+                    fprintf(compiler->diagnostics, "Semantic error: invalid assignment of vector to scalar at line %d\n", node->line_number);
+                    ++compiler->semantic_errors;
                 }
                 else if (node->son[0]->symbol->is_function && !node->symbol->is_vector && !node->symbol->is_function)
                 {
-                    fprintf(stderr, "Semantic error: invalid assignment of function %s to scalar %s at line %d\n",
+                    fprintf(compiler->diagnostics, "Semantic error: invalid assignment of function %s to scalar %s at line %d\n",
                             node->symbol->text, node->son[0]->symbol->text, node->line_number);
-                    ++SemanticErrors;
+                    ++compiler->semantic_errors;
                 }
                 else if (node->son[0]->symbol->is_function && node->symbol->is_vector)
                 {
-                    fprintf(stderr, "Semantic error: invalid assignment of function %s to vector %s at line %d\n",
+                    fprintf(compiler->diagnostics, "Semantic error: invalid assignment of function %s to vector %s at line %d\n",
                             node->symbol->text, node->son[0]->symbol->text, node->line_number);
-                    ++SemanticErrors;
+                    ++compiler->semantic_errors;
                 }
             }
         }
         else if (node->symbol && node->symbol->is_vector)
         {
-            fprintf(stderr, "Semantic error: invalid assignment of expression to vector %s at line %d\n", node->symbol->text, node->line_number);
-            ++SemanticErrors;
+            fprintf(compiler->diagnostics, "Semantic error: invalid assignment of expression to vector %s at line %d\n", node->symbol->text, node->line_number);
+            ++compiler->semantic_errors;
         }
 
         if (expected_datatype != resulting_datatype && resulting_datatype != 0 && !compare_datatypes(expected_datatype, resulting_datatype))
         {
-            fprintf(stderr, "Semantic error: invalid assignment of %s to %s at line %d\n", datatype_str[resulting_datatype], datatype_str[expected_datatype], node->line_number);
-            ++SemanticErrors;
+            fprintf(compiler->diagnostics, "Semantic error: invalid assignment of %s to %s at line %d\n", datatype_str[resulting_datatype], datatype_str[expected_datatype], node->line_number);
+            ++compiler->semantic_errors;
         }
         else if (resulting_datatype == 0)
         {
             if (node->symbol && node->son[0]->symbol &&
                 !compare_datatypes(node->symbol->datatype, node->son[0]->symbol->datatype))
             {
-                fprintf(stderr, "Semantic error: invalid assignment of %s to %s at line %d\n", datatype_str[node->son[0]->symbol->datatype], datatype_str[node->symbol->datatype], node->line_number);
-                ++SemanticErrors;
+                fprintf(compiler->diagnostics, "Semantic error: invalid assignment of %s to %s at line %d\n", datatype_str[node->son[0]->symbol->datatype], datatype_str[node->symbol->datatype], node->line_number);
+                ++compiler->semantic_errors;
             }
         }
         else
@@ -765,9 +768,9 @@ int check_assignments(AST *node)
                 int func_datatype = vec_indexer->symbol->datatype;
                 if (func_datatype != DATATYPE_INT && func_datatype != DATATYPE_CHAR)
                 {
-                    fprintf(stderr, "Semantic error: invalid vector indexer type (expected int or char, got %s -> %s) at line %d\n",
+                    fprintf(compiler->diagnostics, "Semantic error: invalid vector indexer type (expected int or char, got %s -> %s) at line %d\n",
                             ast_type_str(vec_indexer->type), datatype_str[func_datatype], node->line_number);
-                    ++SemanticErrors;
+                    ++compiler->semantic_errors;
                 }
             }
             else
@@ -777,8 +780,8 @@ int check_assignments(AST *node)
                 int vec_indexer_result_type = vec_indexer->result_datatype;
                 if (vec_indexer_result_type != DATATYPE_INT && vec_indexer_result_type != DATATYPE_CHAR)
                 {
-                    fprintf(stderr, "Semantic error: invalid vector indexer type (expected int or char, got %s) at line %d\n", datatype_str[vec_indexer_result_type], node->line_number);
-                    ++SemanticErrors;
+                    fprintf(compiler->diagnostics, "Semantic error: invalid vector indexer type (expected int or char, got %s) at line %d\n", datatype_str[vec_indexer_result_type], node->line_number);
+                    ++compiler->semantic_errors;
                 }
             }
         }
@@ -790,21 +793,21 @@ int check_assignments(AST *node)
         {
             if (node->son[1]->symbol->is_vector && node->son[1]->type != AST_VEC_ACCESS)
             {
-                fprintf(stderr, "Semantic error: invalid assignment of vector to vector index at line %d\n", node->line_number);
-                ++SemanticErrors;
+                fprintf(compiler->diagnostics, "Semantic error: invalid assignment of vector to vector index at line %d\n", node->line_number);
+                ++compiler->semantic_errors;
             }
 
             if (node->son[1]->symbol->is_function && node->son[1]->type != AST_FUNC_CALL)
             {
-                fprintf(stderr, "Semantic error: invalid assignment of function to vector index at line %d\n", node->line_number);
-                ++SemanticErrors;
+                fprintf(compiler->diagnostics, "Semantic error: invalid assignment of function to vector index at line %d\n", node->line_number);
+                ++compiler->semantic_errors;
             }
         }
 
         if (expected_datatype != resulting_datatype && resulting_datatype != 0)
         {
-            fprintf(stderr, "Semantic error: invalid assignment of %s to %s[] at line %d\n", datatype_str[resulting_datatype], datatype_str[expected_datatype], node->line_number);
-            ++SemanticErrors;
+            fprintf(compiler->diagnostics, "Semantic error: invalid assignment of %s to %s[] at line %d\n", datatype_str[resulting_datatype], datatype_str[expected_datatype], node->line_number);
+            ++compiler->semantic_errors;
         }
     }
 
@@ -833,26 +836,9 @@ void check_return(AST *node)
 
             if (!check_return_aux(node, node->symbol->datatype))
             {
-                fprintf(stderr, "Semantic error: function %s is missing return statement at line %d\n", node->symbol->text, node->line_number);
-                ++SemanticErrors;
+                fprintf(compiler->diagnostics, "Semantic error: function %s is missing return statement at line %d\n", node->symbol->text, node->line_number);
+                ++compiler->semantic_errors;
             }
-
-            AST *param = node->son[0];
-            if (param->type == AST_EMPTY_PARAM_LIST)
-            {
-                break;
-            }
-
-            int count = 0;
-            while (param)
-            {
-
-                node->symbol->params[count] = ast_type_to_datatype(param->son[0]->type);
-                param = param->son[1];
-                ++count;
-            }
-
-            node->symbol->param_count = count;
         }
 
         break;
@@ -880,28 +866,28 @@ int check_return_aux(AST *node, int required_datatype)
 
         if (node->son[0]->symbol && node->son[0]->symbol->is_vector && node->son[0]->type != AST_VEC_ACCESS)
         {
-            fprintf(stderr, "Semantic error: invalid return type (expected %s, got vector) at line %d\n", datatype_str[required_datatype], node->line_number);
-            ++SemanticErrors;
+            fprintf(compiler->diagnostics, "Semantic error: invalid return type (expected %s, got vector) at line %d\n", datatype_str[required_datatype], node->line_number);
+            ++compiler->semantic_errors;
         }
 
         if (node->son[0]->symbol && node->son[0]->symbol->is_function && node->son[0]->type != AST_FUNC_CALL)
         {
-            fprintf(stderr, "Semantic error: invalid return type (expected %s, got function) at line %d\n", datatype_str[required_datatype], node->line_number);
-            ++SemanticErrors;
+            fprintf(compiler->diagnostics, "Semantic error: invalid return type (expected %s, got function) at line %d\n", datatype_str[required_datatype], node->line_number);
+            ++compiler->semantic_errors;
         }
 
         if (return_datatype != required_datatype && !validate_return_type(required_datatype, node->son[0]))
         {
             if (return_datatype != 0)
             {
-                fprintf(stderr, "Semantic error: invalid return type (expected %s, got %s) at line %d\n", datatype_str[required_datatype], datatype_str[return_datatype], node->line_number);
+                fprintf(compiler->diagnostics, "Semantic error: invalid return type (expected %s, got %s) at line %d\n", datatype_str[required_datatype], datatype_str[return_datatype], node->line_number);
             }
             else
             {
-                fprintf(stderr, "Semantic error: invalid return type (expected %s, got incompatible type) at line %d\n", datatype_str[required_datatype], node->line_number);
+                fprintf(compiler->diagnostics, "Semantic error: invalid return type (expected %s, got incompatible type) at line %d\n", datatype_str[required_datatype], node->line_number);
             }
 
-            ++SemanticErrors;
+            ++compiler->semantic_errors;
         }
 
         if (node->son[0]->type == AST_NESTED_EXPR)
@@ -910,12 +896,12 @@ int check_return_aux(AST *node, int required_datatype)
             if (first_nested_expr_item->type == AST_IDENTIFIER &&
                 (first_nested_expr_item->symbol->is_vector || first_nested_expr_item->symbol->is_function))
             {
-                fprintf(stderr, "Semantic error: invalid return type (expected %s, got %s %s) at line %d\n", 
+                fprintf(compiler->diagnostics, "Semantic error: invalid return type (expected %s, got %s %s) at line %d\n", 
                 datatype_str[required_datatype], 
                 datatype_str[return_datatype], 
                 first_nested_expr_item->symbol->is_vector ? "vector" : "function",
                 node->line_number);
-                ++SemanticErrors;
+                ++compiler->semantic_errors;
             }
         }
 
@@ -941,8 +927,8 @@ void check_function_call(AST *node)
     {
         if (node->symbol->type == SYMBOL_IDENTIFIER)
         {
-            // fprintf(stderr, "Semantic error: call to undeclared function %s at line %d\n", node->symbol->text, node->line_number);
-            //++SemanticErrors;
+            // fprintf(compiler->diagnostics, "Semantic error: call to undeclared function %s at line %d\n", node->symbol->text, node->line_number);
+            //++compiler->semantic_errors;
             return;
         }
        
@@ -993,9 +979,9 @@ void check_function_call(AST *node)
 
                 if (!compare_datatypes(expected_datatype, actual_datatype) && expected_datatype != 0)
                 {
-                    fprintf(stderr, "Semantic error: invalid parameter type (expected %s, got %s) at line %d\n",
+                    fprintf(compiler->diagnostics, "Semantic error: invalid parameter type (expected %s, got %s) at line %d\n",
                             datatype_str[expected_datatype], datatype_str[actual_datatype], node->line_number);
-                    ++SemanticErrors;
+                    ++compiler->semantic_errors;
                 }
 
                 index++;
@@ -1035,14 +1021,14 @@ void check_function_call(AST *node)
         {
             if (parameter_count == 0)
             {
-                fprintf(stderr, "Semantic error: invalid number of parameters (expected %d, got none) at line %d\n", node->symbol->param_count, node->line_number);
+                fprintf(compiler->diagnostics, "Semantic error: invalid number of parameters (expected %d, got none) at line %d\n", node->symbol->param_count, node->line_number);
             }
             else
             {
-                fprintf(stderr, "Semantic error: invalid number of parameters (expected %d, got %d) at line %d\n", node->symbol->param_count, parameter_count, node->line_number);
+                fprintf(compiler->diagnostics, "Semantic error: invalid number of parameters (expected %d, got %d) at line %d\n", node->symbol->param_count, parameter_count, node->line_number);
             }
 
-            ++SemanticErrors;
+            ++compiler->semantic_errors;
         }
     }
 
@@ -1063,8 +1049,8 @@ void check_conditional_stmts(AST *node)
     {
         if (node->son[0]->result_datatype != DATATYPE_BOOL && (node->son[0]->symbol && node->son[0]->symbol->datatype != DATATYPE_BOOL))
         {
-            fprintf(stderr, "Semantic error: invalid conditional statement (expected bool, got %s) at line %d\n", datatype_str[node->son[0]->result_datatype], node->line_number);
-            ++SemanticErrors;
+            fprintf(compiler->diagnostics, "Semantic error: invalid conditional statement (expected bool, got %s) at line %d\n", datatype_str[node->son[0]->result_datatype], node->line_number);
+            ++compiler->semantic_errors;
         }
     }
 
@@ -1072,4 +1058,113 @@ void check_conditional_stmts(AST *node)
     {
         check_conditional_stmts(node->son[i]);
     }
-}
\ No newline at end of file
+}
+SEMANTIC_JOB *semantic_split(AST *root, int *count)
+{
+    SEMANTIC_JOB *jobs = NULL;
+    int size = 0;
+    AST *list;
+
+    *count = 0;
+    for (list = root->son[0]; list && list->type == AST_DECL_LIST; list = list->son[1])
+    {
+        if (*count == size)
+        {
+            size = size ? 2 * size : 16;
+            jobs = (SEMANTIC_JOB *)realloc(jobs, size * sizeof(SEMANTIC_JOB));
+        }
+        memset(&jobs[*count], 0, sizeof(SEMANTIC_JOB));
+        jobs[(*count)++].declaration = list->son[0];
+    }
+    return jobs;
+}
+
+// the declaration's tree, the diagnostics and the arena are the job's; the symbols are
+// only read
+void semantic_job_run(SEMANTIC_JOBS *jobs, SEMANTIC_JOB *job)
+{
+    COMPILER_CONTEXT worker = *jobs->context;
+    jmp_buf recover;
+    worker.diagnostics = open_memstream(&job->text, &job->length);
+    worker.semantic_errors = 0;
+    worker.recover = &recover;
+    memset(&worker.arena, 0, sizeof(ARENA));
+    compiler = &worker;
+
+    if (setjmp(recover))
+        job->failed = 1;
+    else
+    {
+        check_operands(job->declaration);
+        check_assignments(job->declaration);
+        check_return(job->declaration);
+        check_function_call(job->declaration);
+        check_conditional_stmts(job->declaration);
+    }
+
+    fclose(worker.diagnostics);
+    job->errors = worker.semantic_errors;
+    job->arena = worker.arena;
+}
+
+void *semantic_worker(void *argument)
+{
+    SEMANTIC_JOBS *jobs = (SEMANTIC_JOBS *)argument;
+    COMPILER_CONTEXT *outer = compiler;
+    for (;;)
+    {
+        int i;
+        pthread_mutex_lock(&jobs->lock);
+        i = jobs->next++;
+        pthread_mutex_unlock(&jobs->lock);
+        if (i >= jobs->count)
+            break;
+        semantic_job_run(jobs, &jobs->jobs[i]);
+    }
+    compiler = outer;
+    return NULL;
+}
+
+// checks the body of every declaration on up to compiler->jobs threads, after the
+// declarations have set the symbols; the diagnostics come out in source order, the same
+// for any number of threads
+void check_bodies(AST *root)
+{
+    SEMANTIC_JOBS jobs;
+    pthread_t threads[SEMANTIC_MAX_THREADS];
+    int threads_count = compiler->jobs;
+    int failed = 0;
+    int i;
+
+    memset(&jobs, 0, sizeof(jobs));
+    jobs.jobs = semantic_split(root, &jobs.count);
+    jobs.context = compiler;
+    pthread_mutex_init(&jobs.lock, NULL);
+
+    if (threads_count > SEMANTIC_MAX_THREADS)
+        threads_count = SEMANTIC_MAX_THREADS;
+    if (threads_count > jobs.count)
+        threads_count = jobs.count;
+    if (threads_count <= 1)
+        semantic_worker(&jobs);
+    else
+    {
+        for (i = 0; i < threads_count; i++)
+            pthread_create(&threads[i], NULL, semantic_worker, &jobs);
+        for (i = 0; i < threads_count; i++)
+            pthread_join(threads[i], NULL);
+    }
+
+    for (i = 0; i < jobs.count; i++)
+    {
+        fwrite(jobs.jobs[i].text, 1, jobs.jobs[i].length, compiler->diagnostics);
+        compiler->semantic_errors += jobs.jobs[i].errors;
+        free(jobs.jobs[i].text);
+        arena_adopt(&compiler->arena, &jobs.jobs[i].arena);
+        failed |= jobs.jobs[i].failed;
+    }
+    free(jobs.jobs);
+    pthread_mutex_destroy(&jobs.lock);
+    if (failed)
+        compiler_fail(NULL);
+}
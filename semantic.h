@@ -1,5 +1,31 @@
 #pragma once
+#include <pthread.h>
 #include "ast.h"
+#include "compiler.h"
+
+#define SEMANTIC_MAX_THREADS 64
+
+// one top level declaration whose body is checked on its own; the diagnostics wait in
+// text until every job is done
+typedef struct semantic_job
+{
+    AST *declaration;
+    char *text;
+    size_t length;
+    int errors;
+    ARENA arena; // what the job allocated with the context's, adopted after the join
+    int failed;  // compiler_fail gave up on it
+} SEMANTIC_JOB;
+
+// workers take the next declaration under lock
+typedef struct semantic_jobs
+{
+    SEMANTIC_JOB *jobs;
+    int count;
+    int next;
+    COMPILER_CONTEXT *context;
+    pthread_mutex_t lock;
+} SEMANTIC_JOBS;
 
 void check_and_set_declarations(AST *node);
 void check_undeclared(void);
@@ -10,4 +36,5 @@ int check_assignments(AST *node);
 void check_return(AST *node);
 int check_return_aux(AST *node, int required_datatype);
 void check_conditional_stmts(AST *node);
-void check_function_call(AST *node);
\ No newline at end of file
+void check_function_call(AST *node);
+void check_bodies(AST *root);
@@ -0,0 +1,267 @@
+#include <errno.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "server.h"
+
+// a request is the client's working directory, its command line from the input file on
+// and the bytes of the input file, each as a length and its bytes; the reply is the exit
+// status and the messages
+
+int server_write(int fd, const void *data, size_t length)
+{
+    const char *p = (const char *)data;
+    while (length > 0)
+    {
+        ssize_t written = send(fd, p, length, MSG_NOSIGNAL);
+        if (written < 0 && errno == EINTR)
+            continue;
+        if (written <= 0)
+            return 0;
+        p += written;
+        length -= written;
+    }
+    return 1;
+}
+
+int server_read(int fd, void *data, size_t length)
+{
+    char *p = (char *)data;
+    while (length > 0)
+    {
+        ssize_t got = read(fd, p, length);
+        if (got < 0 && errno == EINTR)
+            continue;
+        if (got <= 0)
+            return 0;
+        p += got;
+        length -= got;
+    }
+    return 1;
+}
+
+int server_write_string(int fd, const char *text, unsigned length)
+{
+    return server_write(fd, &length, sizeof(length)) && server_write(fd, text, length);
+}
+
+// a string of at most limit bytes, or NULL; its length goes to length unless that is NULL
+char *server_read_string(int fd, unsigned limit, size_t *length)
+{
+    unsigned size;
+    char *text;
+    if (!server_read(fd, &size, sizeof(size)) || size > limit)
+        return NULL;
+    text = (char *)malloc(size + 1);
+    if (!server_read(fd, text, size))
+    {
+        free(text);
+        return NULL;
+    }
+    text[size] = 0;
+    if (length)
+        *length = size;
+    return text;
+}
+
+int server_address(struct sockaddr_un *address, char *path)
+{
+    memset(address, 0, sizeof(*address));
+    address->sun_family = AF_UNIX;
+    if (strlen(path) >= sizeof(address->sun_path))
+        return 0;
+    strcpy(address->sun_path, path);
+    return 1;
+}
+
+// path as the client meant it, from its directory
+char *server_path(const char *directory, char *path)
+{
+    char *full;
+    if (path[0] == '/')
+        return strdup(path);
+    full = (char *)malloc(strlen(directory) + strlen(path) + 2);
+    sprintf(full, "%s/%s", directory, path);
+    return full;
+}
+
+// compiles one request in a context that borrows the worker's arena; the source comes with
+// the request, and the files of the compile are written under the client's directory
+void server_serve(SERVER_WORKER *worker, int connection)
+{
+    char *args[SERVER_MAX_ARGS];
+    COMPILER_CONTEXT *context;
+    char *directory;
+    char *source;
+    size_t source_length;
+    char *messages = NULL;
+    size_t messages_length = 0;
+    char *profile_generate = NULL;
+    char *profile_use = NULL;
+    char *cache = NULL;
+    unsigned count;
+    int status;
+    unsigned i;
+
+    if (!server_read(connection, &count, sizeof(count)) || count < 2 || count > SERVER_MAX_ARGS)
+        return;
+    for (i = 0; i < count; i++)
+    {
+        if (!(args[i] = server_read_string(connection, COMPILER_PATH_SIZE, NULL)))
+        {
+            while (i > 0)
+                free(args[--i]);
+            return;
+        }
+    }
+    if (!(source = server_read_string(connection, SERVER_MAX_SOURCE, &source_length)))
+    {
+        for (i = 0; i < count; i++)
+            free(args[i]);
+        return;
+    }
+    directory = args[0];
+
+    context = compiler_create();
+    context->arena = worker->arena;
+    context->diagnostics = open_memstream(&messages, &messages_length);
+    // args[1] is the input; the options start after it, as main reads them
+    compiler_options(context, count, args, 2);
+    if (context->profile_generate)
+        context->profile_generate = profile_generate = server_path(directory, context->profile_generate);
+    if (context->profile_use)
+        context->profile_use = profile_use = server_path(directory, context->profile_use);
+    if (context->cache)
+        context->cache = cache = server_path(directory, context->cache);
+
+    if (context->run_jit || context->run_interp)
+    {
+        fprintf(context->diagnostics, "server: programs are only run by the client\n");
+        status = 2;
+    }
+    else
+        status = compiler_source(context, source, source_length, directory);
+    fclose(context->diagnostics);
+
+    server_write(connection, &status, sizeof(status));
+    server_write_string(connection, messages, (unsigned)messages_length);
+
+    for (i = 0; i < count; i++)
+        free(args[i]);
+    free(source);
+    free(profile_generate);
+    free(profile_use);
+    free(cache);
+    free(messages);
+    arena_reset(&context->arena);
+    worker->arena = context->arena;
+    memset(&context->arena, 0, sizeof(ARENA));
+    compiler_destroy(context);
+}
+
+void *server_worker(void *argument)
+{
+    SERVER_WORKER *worker = (SERVER_WORKER *)argument;
+    for (;;)
+    {
+        int connection = accept(worker->listener, NULL, NULL);
+        if (connection < 0)
+        {
+            if (errno == EINTR || errno == ECONNABORTED)
+                continue;
+            return NULL;
+        }
+        server_serve(worker, connection);
+        close(connection);
+    }
+}
+
+// listens on the socket at path and compiles the requests of clients on jobs threads
+// until it is killed
+int server_run(char *path, int jobs)
+{
+    SERVER_WORKER workers[SERVER_MAX_THREADS];
+    pthread_t threads[SERVER_MAX_THREADS];
+    struct sockaddr_un address;
+    int listener;
+    int i;
+
+    if (!server_address(&address, path))
+    {
+        fprintf(stderr, "server: socket path %s is too long\n", path);
+        return 2;
+    }
+    listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    unlink(path);
+    if (listener < 0 || bind(listener, (struct sockaddr *)&address, sizeof(address)) < 0 || listen(listener, SOMAXCONN) < 0)
+    {
+        fprintf(stderr, "server: cannot listen on %s\n", path);
+        return 2;
+    }
+
+    if (jobs < 1)
+        jobs = 1;
+    if (jobs > SERVER_MAX_THREADS)
+        jobs = SERVER_MAX_THREADS;
+    fprintf(stderr, "server: listening on %s with %d threads\n", path, jobs);
+    for (i = 0; i < jobs; i++)
+    {
+        memset(&workers[i], 0, sizeof(SERVER_WORKER));
+        workers[i].listener = listener;
+        pthread_create(&threads[i], NULL, server_worker, &workers[i]);
+    }
+    for (i = 0; i < jobs; i++)
+        pthread_join(threads[i], NULL);
+    close(listener);
+    return 0;
+}
+
+// sends the command line and the input file to the server at path and reports as if it
+// had been compiled here; returns the exit status, or -1 when no server answered or the
+// input cannot be sent, which a local compile then reports
+int server_client(char *path, int argc, char **argv)
+{
+    struct sockaddr_un address;
+    char directory[COMPILER_PATH_SIZE];
+    char *messages;
+    char *source;
+    size_t source_length;
+    unsigned count = argc;
+    int connection;
+    int status;
+    int i;
+
+    if (argc < 2 || !server_address(&address, path) || !getcwd(directory, sizeof(directory)))
+        return -1;
+    if (!(source = compiler_read(argv[1], &source_length)) || source_length > SERVER_MAX_SOURCE)
+    {
+        free(source);
+        return -1;
+    }
+    connection = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (connection < 0 || connect(connection, (struct sockaddr *)&address, sizeof(address)) < 0)
+    {
+        if (connection >= 0)
+            close(connection);
+        free(source);
+        return -1;
+    }
+
+    // argv[0] is the program; the directory goes in its place
+    server_write(connection, &count, sizeof(count));
+    server_write_string(connection, directory, strlen(directory));
+    for (i = 1; i < argc; i++)
+        server_write_string(connection, argv[i], strlen(argv[i]));
+    server_write_string(connection, source, (unsigned)source_length);
+    free(source);
+
+    if (!server_read(connection, &status, sizeof(status)) || !(messages = server_read_string(connection, SERVER_MAX_MESSAGES, NULL)))
+    {
+        close(connection);
+        return -1;
+    }
+    fputs(messages, stderr);
+    free(messages);
+    close(connection);
+    return status;
+}
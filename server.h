@@ -0,0 +1,18 @@
+#pragma once
+#include <pthread.h>
+#include "compiler.h"
+
+#define SERVER_MAX_THREADS 64
+#define SERVER_MAX_ARGS 256
+#define SERVER_MAX_MESSAGES (1 << 30)
+#define SERVER_MAX_SOURCE (1 << 30)
+
+// a thread accepting compile requests; its arena stays allocated between them
+typedef struct server_worker
+{
+    int listener;
+    ARENA arena;
+} SERVER_WORKER;
+
+int server_run(char *path, int jobs);
+int server_client(char *path, int argc, char **argv);
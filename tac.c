@@ -1,8 +1,6 @@
 #include "tac.h"
 #include "optimization.h"
 
-AST *last_cmd_list;
-AST *last_loop_cmd_list;
 
 char *tac_type_str[] = {
     "",
@@ -42,7 +40,7 @@ char *tac_type_str[] = {
 TAC *tac_create(int type, HASH *res, HASH *op1, HASH *op2)
 {
     TAC *tac = NULL;
-    tac = (TAC *)calloc(1, sizeof(TAC));
+    tac = (TAC *)arena_alloc(&compiler->arena, sizeof(TAC));
 
     tac->type = type;
     tac->res = res;
@@ -50,6 +48,7 @@ TAC *tac_create(int type, HASH *res, HASH *op1, HASH *op2)
     tac->op2 = op2;
     tac->prev = NULL;
     tac->next = NULL;
+    tac->counter = -1;
 
     return tac;
 }
@@ -103,7 +102,103 @@ TAC *make_binary_operation(AST *node, int type, TAC *code0, TAC *code1)
     return tac_join(tac_join(code0, code1), tac_create(type, make_temp(datatype), code0 ? code0->res : NULL, code1 ? code1->res : NULL));
 }
 
-TAC *make_if(TAC *code0, TAC *code1)
+// conditions that only ever hold 0 or 1, so that jumping on them matches & and |
+int tac_is_logic(AST *node)
+{
+    switch (node->type)
+    {
+    case AST_NESTED_EXPR:
+        return tac_is_logic(node->son[0]);
+    case AST_AND:
+    case AST_OR:
+        return tac_is_logic(node->son[0]) && tac_is_logic(node->son[1]);
+    case AST_NOT:
+    case AST_LE:
+    case AST_GE:
+    case AST_EQ:
+    case AST_DIF:
+    case AST_GT:
+    case AST_LT:
+        return 1;
+    }
+
+    // bool variables may have been initialized with any value, which & combines bitwise
+    return 0;
+}
+
+// & and | of an if or loop condition become jumps, so the right side only runs when the
+// left one does not decide the result; --eager-logic keeps evaluating both sides
+int tac_jumps_on(AST *condition)
+{
+    if (compiler->eager_logic || !condition)
+        return 0;
+    while (condition->type == AST_NESTED_EXPR)
+        condition = condition->son[0];
+    return (condition->type == AST_AND || condition->type == AST_OR) && tac_is_logic(condition);
+}
+
+TAC *make_jump_true(AST *condition, HASH *true_label);
+
+// falls through when the condition holds and jumps to false_label otherwise
+TAC *make_jump_false(AST *condition, HASH *false_label)
+{
+    TAC *code = NULL;
+    TAC *jumptac = NULL;
+
+    while (condition->type == AST_NESTED_EXPR)
+        condition = condition->son[0];
+
+    if (condition->type == AST_AND && tac_is_logic(condition))
+        return tac_join(make_jump_false(condition->son[0], false_label), make_jump_false(condition->son[1], false_label));
+
+    if (condition->type == AST_OR && tac_is_logic(condition))
+    {
+        HASH *true_label = make_label(CONDITION_TRUE);
+        code = tac_join(make_jump_true(condition->son[0], true_label), make_jump_false(condition->son[1], false_label));
+        return tac_join(code, tac_create(TAC_LABEL, true_label, NULL, NULL));
+    }
+
+    code = generate_code(condition);
+    jumptac = tac_create(TAC_JFALSE, false_label, code ? code->res : NULL, NULL);
+    jumptac->prev = code;
+    return jumptac;
+}
+
+// falls through when the condition fails and jumps to true_label otherwise
+TAC *make_jump_true(AST *condition, HASH *true_label)
+{
+    HASH *false_label = NULL;
+    TAC *code = NULL;
+
+    while (condition->type == AST_NESTED_EXPR)
+        condition = condition->son[0];
+
+    if (condition->type == AST_OR && tac_is_logic(condition))
+        return tac_join(make_jump_true(condition->son[0], true_label), make_jump_true(condition->son[1], true_label));
+
+    // the back end turns jfalse over a jump into a single inverted branch
+    false_label = make_label(CONDITION_FALSE);
+    if (condition->type == AST_AND && tac_is_logic(condition))
+        code = tac_join(make_jump_false(condition->son[0], false_label), make_jump_true(condition->son[1], true_label));
+    else
+        code = tac_join(make_jump_false(condition, false_label), tac_create(TAC_JUMP, true_label, NULL, NULL));
+    return tac_join(code, tac_create(TAC_LABEL, false_label, NULL, NULL));
+}
+
+// the condition code of an if or loop, ending in a jump to false_label when it fails
+TAC *make_condition(AST *condition, TAC *code0, HASH *false_label)
+{
+    TAC *jumptac = NULL;
+
+    if (tac_jumps_on(condition))
+        return make_jump_false(condition, false_label);
+
+    jumptac = tac_create(TAC_JFALSE, false_label, code0 ? code0->res : NULL, NULL);
+    jumptac->prev = code0;
+    return jumptac;
+}
+
+TAC *make_if(AST *condition, TAC *code0, TAC *code1)
 {
     TAC *jumptac = NULL;
     TAC *labeltac = NULL;
@@ -111,15 +206,14 @@ TAC *make_if(TAC *code0, TAC *code1)
 
     if_label = make_label(CONDITIONAL_IF);
 
-    jumptac = tac_create(TAC_JFALSE, if_label, code0 ? code0->res : NULL, NULL);
-    jumptac->prev = code0;
+    jumptac = make_condition(condition, code0, if_label);
     labeltac = tac_create(TAC_LABEL, if_label, NULL, NULL);
     labeltac->prev = code1;
 
     return tac_join(jumptac, labeltac);
 }
 
-TAC *make_if_else(TAC *code0, TAC *code1, TAC *code2)
+TAC *make_if_else(AST *condition, TAC *code0, TAC *code1, TAC *code2)
 {
     TAC *jumptac = NULL;
     TAC *labeltac = NULL;
@@ -134,8 +228,7 @@ TAC *make_if_else(TAC *code0, TAC *code1, TAC *code2)
 
     end_label = make_label(CONDITIONAL_ENDIF);
 
-    jumptac = tac_create(TAC_JFALSE, else_label, code0 ? code0->res : NULL, NULL);
-    jumptac->prev = code0;
+    jumptac = make_condition(condition, code0, else_label);
     labeltac = tac_create(TAC_LABEL, else_label, NULL, NULL);
     unconditional_jump_tac = tac_create(TAC_JUMP, end_label, NULL, NULL);
     labeltac->prev = unconditional_jump_tac;
@@ -148,10 +241,11 @@ TAC *make_if_else(TAC *code0, TAC *code1, TAC *code2)
     return tac_join(tac_join(jumptac, labeltac), endtac);
 }
 
-TAC *make_loop(TAC *code0, TAC *code1)
+TAC *make_loop(AST *condition, TAC *code0, TAC *code1)
 {
     TAC *loop_start_tac = NULL;
     TAC *loop_jump_tac = NULL;
+    TAC *loop_body_tac = NULL;
     TAC *loop_end_tac = NULL;
     TAC *unconditional_jump_tac = NULL;
 
@@ -162,13 +256,15 @@ TAC *make_loop(TAC *code0, TAC *code1)
     loop_start_tac = tac_create(TAC_LABEL, loop_start_label, NULL, NULL);
 
     loop_end_label = make_label(LOOP_END);
-    loop_jump_tac = tac_create(TAC_JFALSE, loop_end_label, code0 ? code0->res : NULL, NULL);
-    loop_jump_tac->prev = code0;
+    loop_jump_tac = make_condition(condition, code0, loop_end_label);
+
+    // where the back end rotates the loop to, repeating the condition at the bottom
+    loop_body_tac = tac_create(TAC_LABEL, make_label(LOOP_BODY), NULL, NULL);
 
     unconditional_jump_tac = tac_create(TAC_JUMP, loop_start_label, NULL, NULL);
     loop_end_tac = tac_create(TAC_LABEL, loop_end_label, NULL, NULL);
 
-    return tac_join(tac_join(tac_join(loop_start_tac, loop_jump_tac), tac_join(code1, unconditional_jump_tac)), loop_end_tac);
+    return tac_join(tac_join(tac_join(tac_join(loop_start_tac, loop_jump_tac), loop_body_tac), tac_join(code1, unconditional_jump_tac)), loop_end_tac);
 }
 
 TAC *make_unary_operation(int type, TAC *code0)
@@ -242,7 +338,11 @@ TAC *generate_code(AST *node)
 
     for (i = 0; i < MAX_SONS; i++)
     {
-        code[i] = generate_code(node->son[i]);
+        // conditions lowered to jumps generate their code on their own
+        if (i == 0 && (node->type == AST_IF || node->type == AST_IF_ELSE || node->type == AST_LOOP) && tac_jumps_on(node->son[0]))
+            code[i] = NULL;
+        else
+            code[i] = generate_code(node->son[i]);
     }
 
     switch (node->type)
@@ -291,23 +391,23 @@ TAC *generate_code(AST *node)
     }
     case AST_VEC_ACCESS:
     {
-        int datatype = code[0] ? code[0]->res->datatype : 0;
+        int datatype = node->symbol ? node->symbol->datatype : 0;
         result = tac_join(code[0], tac_create(TAC_COPY, make_temp(datatype), node->symbol, code[0] ? code[0]->res : NULL));
         break;
     }
     case AST_IF:
     {
-        result = make_if(code[0], code[1]);
+        result = make_if(node->son[0], code[0], code[1]);
         break;
     }
     case AST_IF_ELSE:
     {
-        result = make_if_else(code[0], code[1], code[2]);
+        result = make_if_else(node->son[0], code[0], code[1], code[2]);
         break;
     }
     case AST_LOOP:
     {
-        result = make_loop(code[0], code[1]);
+        result = make_loop(node->son[0], code[0], code[1]);
         break;
     }
     case AST_RETURN_CMD:
@@ -384,7 +484,9 @@ TAC *generate_code(AST *node)
     case AST_VEC_DECL_CHAR:
     case AST_VEC_DECL_BOOL:
     {
-        result = tac_join(tac_join(code[0], tac_create(TAC_VECDEC, node->symbol, code[0] ? code[0]->res : NULL, NULL)), code[1]);
+        // only the initial values follow the declaration: its size would read as the first
+        // value of the vector declared before it when this one has none
+        result = tac_join(tac_create(TAC_VECDEC, node->symbol, node->son[0]->symbol, NULL), code[1]);
         break;
     }
     default:
@@ -44,6 +44,7 @@ typedef struct tac_node {
     HASH * op2;
     struct tac_node * prev;
     struct tac_node * next;
+    int counter; // profile counter of the block or call starting here, or -1
 } TAC;
 
 
@@ -57,9 +58,10 @@ TAC * tac_reverse(TAC * tac);
 // Code Generation
 TAC * generate_code(AST * node);
 TAC * make_binary_operation(AST * node, int type, TAC * code0, TAC * code1);
-TAC * make_if(TAC * code0, TAC * code1);
-TAC * make_if_else(TAC * code0, TAC * code1, TAC * code2);
-TAC * make_loop(TAC * code0, TAC * code1);
+TAC * make_if(AST * condition, TAC * code0, TAC * code1);
+TAC * make_if_else(AST * condition, TAC * code0, TAC * code1, TAC * code2);
+TAC * make_loop(AST * condition, TAC * code0, TAC * code1);
+TAC * make_condition(AST * condition, TAC * code0, HASH * false_label);
 TAC * make_unary_operation(int type, TAC * code0);
 TAC * make_function(AST *node, TAC * code0, TAC * code1);
 TAC * make_call(AST *node, TAC * code0, TAC * code1);
@@ -0,0 +1,64 @@
+// compiles one program from memory on several threads at once through the library
+// build of the compiler and checks that every context made the same assembly
+#define COMPILER_LIBRARY
+#include "../../lex.yy.c"
+
+#define EMBED_THREADS 4
+
+char *embed_source;
+size_t embed_length;
+
+void *embed_compile(void *context)
+{
+    compiler_compile((COMPILER_CONTEXT *)context, embed_source, embed_length);
+    return NULL;
+}
+
+int main(int argc, char **argv)
+{
+    COMPILER_CONTEXT *contexts[EMBED_THREADS];
+    pthread_t threads[EMBED_THREADS];
+    COMPILER_CONTEXT *object;
+    int i;
+
+    if (argc < 2 || !(embed_source = compiler_read(argv[1], &embed_length)))
+    {
+        fprintf(stderr, "usage: embed input.comp\n");
+        return 1;
+    }
+
+    for (i = 0; i < EMBED_THREADS; i++)
+    {
+        contexts[i] = compiler_create();
+        pthread_create(&threads[i], NULL, embed_compile, contexts[i]);
+    }
+    for (i = 0; i < EMBED_THREADS; i++)
+        pthread_join(threads[i], NULL);
+
+    for (i = 0; i < EMBED_THREADS; i++)
+    {
+        if (!contexts[i]->output || contexts[i]->output_length != contexts[0]->output_length ||
+            memcmp(contexts[i]->output, contexts[0]->output, contexts[0]->output_length) != 0)
+        {
+            fprintf(stderr, "embed: context %d made different assembly\n", i);
+            return 1;
+        }
+    }
+
+    // a context compiled on this thread after the others were released
+    for (i = 1; i < EMBED_THREADS; i++)
+        compiler_destroy(contexts[i]);
+    object = compiler_create();
+    object->emit_object = 1;
+    if (compiler_compile(object, embed_source, embed_length) != 0 || object->output_length < 4 ||
+        memcmp(object->output, "\177ELF", 4) != 0)
+    {
+        fprintf(stderr, "embed: no object\n");
+        return 1;
+    }
+
+    fwrite(contexts[0]->output, 1, contexts[0]->output_length, stdout);
+    compiler_destroy(contexts[0]);
+    compiler_destroy(object);
+    return 0;
+}
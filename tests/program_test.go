@@ -1,8 +1,14 @@
 package program_test
 
 import (
-	"testing"
+	"bytes"
+	"os"
 	"os/exec"
+	"path/filepath"
+	"regexp"
+	"strconv"
+	"strings"
+	"testing"
 	"time"
 )
 
@@ -13,11 +19,21 @@ func compile(programName string) error {
 	return err
 }
 
+func compileObject(programName string) error {
+	_, err := exec.Command("./comp", programName, "void", "-c").Output()
+	return err
+}
+
 func generateBinary() error {
 	_, err := exec.Command("gcc", "./generated/out.s").Output()
 	return err
 }
 
+func linkObject() error {
+	_, err := exec.Command("gcc", "./generated/out.o").Output()
+	return err
+}
+
 func run() ([]byte, error) {
 	return exec.Command("./a.out").Output()
 }
@@ -33,26 +49,33 @@ func cleanup() error {
 	return err
 }
 
+var tests = []struct{
+	programName string
+	expectedOutput string
+}{
+	{ "program1.comp", "Hello, world!"},
+	{ "program2.comp", "10"},
+	{ "program3.comp", "a b c 96 97 98"},
+	{ "program4.comp", "1000"},
+	{ "program5.comp", "542.250000"},
+	{ "program6.comp", "6\n9\n5\n2\n7\n8\n1\n10\n3\n4\n--\n\n10\n9\n8\n7\n6\n5\n4\n3\n2\n1\n"},
+	{ "program7.comp", "9 15 21 27 33 39 45 0 6"},
+	{ "program8.comp", "3 3.750000 0\n21 7.500000 0\n65 10.500000 0\n30 19.125000 0\n31 2.750000 0\n56 39.000000 0\n55 56.250000 0\n64 72.000000 1\n-4 9.000000 0\n74 1.500000 0\n14 7.000000 1\n"},
+	{ "program9.comp", "10111010010000101001\n"},
+	{ "program10.comp", "abzac2 bzb4 zac\n8 1\n"},
+	{ "program11.comp", "2 7 99 5050\n3m2010\n"},
+	{ "program12.comp", "499500 1 3\n"},
+	{ "program13.comp", "0 0 0 1 2.500000 0.000000"},
+	{ "program14.comp", "2 42"},
+}
+
 func TestPrograms(t *testing.T) {
 	defer cleanup()
 
-	tests := []struct{
-		programName string
-		expectedOutput string
-	}{
-		{ "program1.comp", "Hello, world!"},
-		{ "program2.comp", "10"},
-		{ "program3.comp", "a b c 96 97 98"},
-		{ "program4.comp", "1000"},
-		{ "program5.comp", "542.250000"},
-		{ "program6.comp", "6\n9\n5\n2\n7\n8\n1\n10\n3\n4\n--\n\n10\n9\n8\n7\n6\n5\n4\n3\n2\n1\n"},
-	}
-
 	for _, test := range tests {
-		go func() {
-			time.Sleep(time.Duration(timeout) * time.Second)
+		timer := time.AfterFunc(time.Duration(timeout)*time.Second, func() {
 			t.Errorf("%s did not finished in time\n", test.programName)
-		}()
+		})
 		
 		err := compile(test.programName)
 		if err != nil {
@@ -74,5 +97,850 @@ func TestPrograms(t *testing.T) {
 		}
 
 		t.Logf("\n\n%s%s%s%s", test.programName, ":\n", string(output), "\n\n")
+		timer.Stop()
+	}
+}
+
+func TestObjectPrograms(t *testing.T) {
+	defer exec.Command("rm", "-f", "a.out", "generated/out.o").Output()
+
+	for _, test := range tests {
+		err := compileObject(test.programName)
+		if err != nil {
+			t.Errorf("failed to compile %s to an object (%s)\n", test.programName, err.Error())
+		}
+
+		err = linkObject()
+		if err != nil {
+			t.Errorf("failed to link %s object (%s)\n", test.programName, err.Error())
+		}
+
+		output, err := run()
+		if err != nil {
+			t.Errorf("failed to run %s (%s)", test.programName, err.Error())
+		}
+
+		if string(output) != test.expectedOutput {
+			t.Errorf("invalid output, expected [%s] got [%s] on %s\n", test.expectedOutput, string(output), test.programName)
+		}
+	}
+}
+
+func TestRunPrograms(t *testing.T) {
+	for _, test := range tests {
+		output, err := exec.Command("./comp", test.programName, "void", "--run").Output()
+		if err != nil {
+			t.Errorf("failed to run %s in process (%s)\n", test.programName, err.Error())
+		}
+
+		if string(output) != test.expectedOutput {
+			t.Errorf("invalid output, expected [%s] got [%s] on %s\n", test.expectedOutput, string(output), test.programName)
+		}
+	}
+}
+
+func TestInterpPrograms(t *testing.T) {
+	for _, test := range tests {
+		output, err := exec.Command("./comp", test.programName, "void", "--interp").Output()
+		if err != nil {
+			t.Errorf("failed to interpret %s (%s)\n", test.programName, err.Error())
+		}
+
+		if string(output) != test.expectedOutput {
+			t.Errorf("invalid output, expected [%s] got [%s] on %s\n", test.expectedOutput, string(output), test.programName)
+		}
+	}
+}
+
+// a threshold of one compiles each function on its first call or back-edge
+func TestTieredPrograms(t *testing.T) {
+	for _, test := range tests {
+		output, err := exec.Command("./comp", test.programName, "void", "--tiered", "--tier-threshold", "1").Output()
+		if err != nil {
+			t.Errorf("failed to run %s tiered (%s)\n", test.programName, err.Error())
+		}
+
+		if string(output) != test.expectedOutput {
+			t.Errorf("invalid output, expected [%s] got [%s] on %s\n", test.expectedOutput, string(output), test.programName)
+		}
+	}
+}
+
+// the compiler falls back to SSE2 when the cpu has no AVX2
+func TestAvx2Programs(t *testing.T) {
+	for _, test := range tests {
+		output, err := exec.Command("./comp", test.programName, "void", "--run", "--avx2").Output()
+		if err != nil {
+			t.Errorf("failed to run %s with avx2 (%s)\n", test.programName, err.Error())
+		}
+
+		if string(output) != test.expectedOutput {
+			t.Errorf("invalid output, expected [%s] got [%s] on %s\n", test.expectedOutput, string(output), test.programName)
+		}
+	}
+}
+
+func TestVectorizeReport(t *testing.T) {
+	var stderr bytes.Buffer
+	cmd := exec.Command("./comp", "program8.comp", "void", "-v")
+	cmd.Stderr = &stderr
+	if _, err := cmd.Output(); err != nil {
+		t.Fatalf("failed to compile program8.comp (%s)", err.Error())
+	}
+
+	report := stderr.String()
+	if !regexp.MustCompile(`vectorize: loop_start_label_\d+ vectorized over i, 4 lanes of sse2`).MatchString(report) {
+		t.Errorf("compute loop not vectorized:\n%s", report)
+	}
+	if !regexp.MustCompile(`vectorize: loop_start_label_\d+ not vectorized: output in the body`).MatchString(report) {
+		t.Errorf("output loop not rejected:\n%s", report)
+	}
+
+	// a scalar written in the body is named for what it is to the loop
+	stderr.Reset()
+	cmd = exec.Command("./comp", "vectorize1.comp", "void", "-v")
+	cmd.Stderr = &stderr
+	if _, err := cmd.Output(); err != nil {
+		t.Fatalf("failed to compile vectorize1.comp (%s)", err.Error())
+	}
+	report = stderr.String()
+	for _, reason := range []string{"bound n is written in the body", "loop-invariant k is written in the body", "reduction into s"} {
+		if !regexp.MustCompile(`vectorize: loop_start_label_\d+ not vectorized: ` + reason + `\n`).MatchString(report) {
+			t.Errorf("no loop rejected with [%s]:\n%s", reason, report)
+		}
+	}
+}
+
+// integer literals are immediates; real literals share one pool entry per value
+func TestLiteralOperands(t *testing.T) {
+	defer exec.Command("rm", "-f", "generated/out.s").Output()
+
+	for _, programName := range []string{"program4.comp", "program5.comp"} {
+		if err := compile(programName); err != nil {
+			t.Fatalf("failed to compile %s (%s)", programName, err.Error())
+		}
+		asm, err := os.ReadFile("generated/out.s")
+		if err != nil {
+			t.Fatalf("no assembly for %s (%s)", programName, err.Error())
+		}
+
+		if match := regexp.MustCompile(`(?m)^_\d+:`).Find(asm); match != nil {
+			t.Errorf("%s still defines literal %s", programName, match)
+		}
+		for _, constant := range regexp.MustCompile(`(?m)^_const_[0-9a-f]+:`).FindAll(asm, -1) {
+			if bytes.Count(asm, constant) != 1 {
+				t.Errorf("%s defines %s more than once", programName, constant)
+			}
+		}
+	}
+}
+
+// a comparison that only decides a branch sets flags for the jump and nothing else
+func TestBranchFusion(t *testing.T) {
+	defer exec.Command("rm", "-f", "generated/out.s").Output()
+
+	for _, test := range tests {
+		if err := compile(test.programName); err != nil {
+			t.Fatalf("failed to compile %s (%s)", test.programName, err.Error())
+		}
+		asm, err := os.ReadFile("generated/out.s")
+		if err != nil {
+			t.Fatalf("no assembly for %s (%s)", test.programName, err.Error())
+		}
+		if match := regexp.MustCompile(`set\w+ %al\n(\tset\w+ %dl\n\t\w+ %dl, %al\n)?\tmovzbl %al, (%\w+)\n\ttestl`).Find(asm); match != nil {
+			t.Errorf("%s materializes a branch condition:\n%s", test.programName, match)
+		}
+	}
+}
+
+// program10.comp counts the calls made by its conditions: short-circuit branches skip
+// 7 of the 15 that --eager-logic evaluates
+func TestShortCircuit(t *testing.T) {
+	for _, mode := range []string{"--run", "--interp"} {
+		output, err := exec.Command("./comp", "program10.comp", "void", mode, "--eager-logic").Output()
+		if err != nil {
+			t.Fatalf("failed to run program10.comp with %s (%s)", mode, err.Error())
+		}
+		if expected := "abzac2 bzb4 zac\n15 1\n"; string(output) != expected {
+			t.Errorf("invalid output, expected [%s] got [%s] with %s --eager-logic", expected, string(output), mode)
+		}
+	}
+}
+
+// loops of program11.comp test their condition again at the bottom instead of jumping back
+// to it, and the then-blocks that return are placed after the code of their function
+func TestBlockLayout(t *testing.T) {
+	defer exec.Command("rm", "-f", "generated/out.s").Output()
+
+	if err := compile("program11.comp"); err != nil {
+		t.Fatalf("failed to compile program11.comp (%s)", err.Error())
+	}
+	asm, err := os.ReadFile("generated/out.s")
+	if err != nil {
+		t.Fatalf("no assembly for program11.comp (%s)", err.Error())
+	}
+
+	if match := regexp.MustCompile(`jmp _loop_start_label_\d+`).Find(asm); match != nil {
+		t.Errorf("program11.comp has a loop that was not rotated (%s)", match)
+	}
+	if count := len(regexp.MustCompile(`j\w+ _loop_body_label_\d+\n`).FindAll(asm, -1)); count != 2 {
+		t.Errorf("expected 2 bottom-tested loops, found %d", count)
+	}
+	for _, label := range regexp.MustCompile(`(?m)^_if_label_\d+_cold:`).FindAll(asm, -1) {
+		if bytes.Index(asm, label) < bytes.Index(asm, []byte("\tret\n")) {
+			t.Errorf("%s is placed before the first return", label)
+		}
+	}
+	if count := len(regexp.MustCompile(`(?m)^_if_label_\d+_cold:`).FindAll(asm, -1)); count != 4 {
+		t.Errorf("expected 4 then-blocks out of line, found %d", count)
+	}
+}
+
+// a run of the instrumented program12.comp writes its block counts, and compiling with
+// them moves the then-block taken once in 1000 iterations out of the loop
+func TestProfile(t *testing.T) {
+	defer cleanup()
+	defer os.Remove("program12.profile")
+
+	if _, err := exec.Command("./comp", "program12.comp", "void", "--profile-generate", "program12.profile").Output(); err != nil {
+		t.Fatalf("failed to compile program12.comp with counters (%s)", err.Error())
+	}
+	if err := generateBinary(); err != nil {
+		t.Fatalf("failed to generate program12.comp binary (%s)", err.Error())
+	}
+	if output, err := run(); err != nil || string(output) != "499500 1 3\n" {
+		t.Fatalf("instrumented program12.comp printed [%s]", string(output))
+	}
+	profile, err := os.ReadFile("program12.profile")
+	if err != nil {
+		t.Fatalf("program12.comp wrote no profile (%s)", err.Error())
+	}
+	if !regexp.MustCompile(`^profile 1 9\nmain \d+ 9\n`).Match(profile) {
+		t.Errorf("unexpected profile header [%s]", profile)
+	}
+
+	if _, err := exec.Command("./comp", "program12.comp", "void", "--profile-use", "program12.profile").Output(); err != nil {
+		t.Fatalf("failed to compile program12.comp with its profile (%s)", err.Error())
+	}
+	asm, err := os.ReadFile("generated/out.s")
+	if err != nil {
+		t.Fatalf("no assembly for program12.comp (%s)", err.Error())
+	}
+	if !regexp.MustCompile(`(?m)^_if_label_\d+_cold:\n(.*\n){3}\tjmp _if_label_\d+\n`).Match(asm) {
+		t.Errorf("the rare then-block of program12.comp stayed in the loop")
+	}
+	if err := generateBinary(); err != nil {
+		t.Fatalf("failed to generate program12.comp binary (%s)", err.Error())
+	}
+	if output, err := run(); err != nil || string(output) != "499500 1 3\n" {
+		t.Errorf("program12.comp compiled with its profile printed [%s]", string(output))
+	}
+}
+
+// embed/embed.c links the compiler as a library and compiles program8.comp from memory on
+// several threads, each with its own context
+func TestLibrary(t *testing.T) {
+	defer cleanup()
+	defer os.Remove("embed/embed")
+
+	if output, err := exec.Command("gcc", "-o", "embed/embed", "embed/embed.c").CombinedOutput(); err != nil {
+		t.Fatalf("failed to build embed/embed.c (%s)\n%s", err.Error(), output)
+	}
+	asm, err := exec.Command("./embed/embed", "program8.comp").Output()
+	if err != nil {
+		t.Fatalf("embed failed on program8.comp (%s)", err.Error())
+	}
+	if err := os.WriteFile("generated/out.s", asm, 0644); err != nil {
+		t.Fatalf("cannot write the assembly of embed (%s)", err.Error())
+	}
+	if err := generateBinary(); err != nil {
+		t.Fatalf("failed to generate the binary of embed (%s)", err.Error())
+	}
+	if output, err := run(); err != nil || string(output) != tests[7].expectedOutput {
+		t.Errorf("program8.comp compiled by embed printed [%s]", string(output))
+	}
+}
+
+// sixteen threads inserting and looking up the same names through one table get the same
+// items
+func TestSymbolTable(t *testing.T) {
+	defer os.Remove("symbols/symbols")
+
+	if output, err := exec.Command("gcc", "-o", "symbols/symbols", "symbols/symbols.c").CombinedOutput(); err != nil {
+		t.Fatalf("failed to build symbols/symbols.c (%s)\n%s", err.Error(), output)
+	}
+	if output, err := exec.Command("./symbols/symbols", "16", "5000").CombinedOutput(); err != nil {
+		t.Errorf("symbols failed on sixteen threads (%s)\n%s", err.Error(), output)
+	}
+}
+
+// functions selected on four threads give the same assembly as on one
+func TestParallelFunctions(t *testing.T) {
+	defer cleanup()
+
+	for _, test := range tests {
+		if _, err := exec.Command("./comp", test.programName, "void", "-j", "1").Output(); err != nil {
+			t.Fatalf("failed to compile %s (%s)", test.programName, err.Error())
+		}
+		serial, err := os.ReadFile("generated/out.s")
+		if err != nil {
+			t.Fatalf("no assembly for %s (%s)", test.programName, err.Error())
+		}
+		if _, err := exec.Command("./comp", test.programName, "void", "-j", "4").Output(); err != nil {
+			t.Fatalf("failed to compile %s on four threads (%s)", test.programName, err.Error())
+		}
+		parallel, err := os.ReadFile("generated/out.s")
+		if err != nil {
+			t.Fatalf("no assembly for %s on four threads (%s)", test.programName, err.Error())
+		}
+		if !bytes.Equal(serial, parallel) {
+			t.Errorf("%s compiled differently on four threads", test.programName)
+		}
+	}
+}
+
+// semantic1.comp has errors in three functions; they are reported in source order, the
+// same on any number of threads
+func TestParallelChecks(t *testing.T) {
+	expected := []string{
+		"Semantic error: invalid assignment of bool to int at line 6\n",
+		"Semantic error: function second is missing return statement at line 14\n",
+		"Semantic error: invalid conditional statement (expected bool, got int) at line 14\n",
+		"Semantic error: invalid parameter type (expected int, got real) at line 17\n",
+		"Semantic error: invalid number of parameters (expected 1, got 2) at line 17\n",
+	}
+
+	reports := []string{}
+	for _, jobs := range []string{"1", "4"} {
+		var stderr bytes.Buffer
+		cmd := exec.Command("./comp", "semantic1.comp", "void", "-j", jobs)
+		cmd.Stderr = &stderr
+		if err := cmd.Run(); err == nil {
+			t.Fatalf("semantic1.comp compiled on %s threads", jobs)
+		}
+		reports = append(reports, stderr.String())
+	}
+	if reports[0] != reports[1] {
+		t.Errorf("diagnostics differ on four threads:\n%s\n%s", reports[0], reports[1])
+	}
+	if !strings.Contains(reports[0], strings.Join(expected, "")) {
+		t.Errorf("diagnostics out of source order:\n%s", reports[0])
 	}
-}
\ No newline at end of file
+	if !strings.Contains(reports[0], "Compilation failed with 5 Semantic errors.") {
+		t.Errorf("wrong error count:\n%s", reports[0])
+	}
+}
+
+// sources lexed in chunks of sixteen bytes on four threads compile as when the scanner
+// reads them whole; lex1.comp has comments, strings and literals across chunk boundaries,
+// and lex2.comp a syntax error that stops the parse before the end
+func TestParallelLexing(t *testing.T) {
+	defer cleanup()
+
+	programs := []string{"lex1.comp", "lex2.comp", "semantic1.comp"}
+	for _, test := range tests {
+		programs = append(programs, test.programName)
+	}
+	for _, program := range programs {
+		outputs := [][]byte{}
+		for _, options := range [][]string{{"-j", "1"}, {"-j", "4", "--lex-chunk", "16"}} {
+			var stderr bytes.Buffer
+			os.Remove("generated/out.s")
+			cmd := exec.Command("./comp", append([]string{program, "void"}, options...)...)
+			cmd.Stderr = &stderr
+			cmd.Run()
+			asm, _ := os.ReadFile("generated/out.s")
+			status := []byte("exit " + strconv.Itoa(cmd.ProcessState.ExitCode()) + "\n")
+			outputs = append(outputs, append(append(stderr.Bytes(), status...), asm...))
+		}
+		if !bytes.Equal(outputs[0], outputs[1]) {
+			t.Errorf("%s compiled differently when lexed in chunks:\n%s\n%s", program, outputs[0], outputs[1])
+		}
+	}
+}
+
+// the chunk lexer follows the rules of scanner.l by hand: over every source here it gives
+// the tokens, lines and symbol texts the scanner gives
+func TestLexers(t *testing.T) {
+	programs, _ := filepath.Glob("*.comp")
+	for _, program := range programs {
+		outputs := []string{}
+		for _, options := range [][]string{{"-j", "1"}, {"-j", "4", "--lex-chunk", "16"}} {
+			output, err := exec.Command("./comp", append([]string{program, "void", "--tokens"}, options...)...).CombinedOutput()
+			if err != nil {
+				t.Errorf("failed to list the tokens of %s (%s)", program, err.Error())
+			}
+			outputs = append(outputs, string(output))
+		}
+		if !strings.HasSuffix(outputs[0], "\n") || outputs[0] != outputs[1] {
+			t.Errorf("%s lexed differently in chunks:\n%s\n%s", program, outputs[0], outputs[1])
+		}
+	}
+}
+
+// a manifest of every test program and one missing file compiled on four threads
+func TestBatch(t *testing.T) {
+	defer cleanup()
+	defer os.Remove("batch.txt")
+
+	manifest := ""
+	for _, test := range tests {
+		manifest += test.programName + " generated/batch_" + test.programName + ".s\n"
+		defer os.Remove("generated/batch_" + test.programName + ".s")
+	}
+	manifest += "missing.comp\n"
+	if err := os.WriteFile("batch.txt", []byte(manifest), 0644); err != nil {
+		t.Fatalf("cannot write the manifest (%s)", err.Error())
+	}
+
+	var stderr bytes.Buffer
+	cmd := exec.Command("./comp", "--batch", "batch.txt", "-j", "4")
+	cmd.Stderr = &stderr
+	if err := cmd.Run(); err == nil {
+		t.Errorf("batch with a missing file exited successfully")
+	}
+	report := stderr.String()
+	if !strings.Contains(report, "batch: missing.comp could not be read\n") {
+		t.Errorf("missing file not reported:\n%s", report)
+	}
+	if !regexp.MustCompile(`batch: ` + strconv.Itoa(len(tests)+1) + ` files, 1 failed, 4 jobs, [\d.]+ s, [\d.]+ files/s\n`).MatchString(report) {
+		t.Errorf("no throughput report:\n%s", report)
+	}
+
+	for _, test := range tests {
+		if _, err := exec.Command("gcc", "generated/batch_"+test.programName+".s").Output(); err != nil {
+			t.Errorf("failed to generate %s binary from the batch (%s)", test.programName, err.Error())
+			continue
+		}
+		if output, err := run(); err != nil || string(output) != test.expectedOutput {
+			t.Errorf("%s compiled in the batch printed [%s]", test.programName, string(output))
+		}
+	}
+}
+
+// compiles forwarded to a server give the same messages, status and assembly as local
+// ones; without a server the client compiles locally
+func TestServer(t *testing.T) {
+	defer cleanup()
+	defer os.Remove("server.sock")
+
+	server := exec.Command("./comp", "--server", "server.sock", "-j", "2")
+	if err := server.Start(); err != nil {
+		t.Fatalf("failed to start the server (%s)", err.Error())
+	}
+	for i := 0; i < 100; i++ {
+		if _, err := os.Stat("server.sock"); err == nil {
+			break
+		}
+		time.Sleep(10 * time.Millisecond)
+	}
+
+	compileWith := func(args ...string) (int, string, []byte) {
+		var stderr bytes.Buffer
+		os.Remove("generated/out.s")
+		cmd := exec.Command("./comp", args...)
+		cmd.Stderr = &stderr
+		cmd.Run()
+		asm, _ := os.ReadFile("generated/out.s")
+		return cmd.ProcessState.ExitCode(), stderr.String(), asm
+	}
+
+	programs := []string{"semantic1.comp"}
+	for _, test := range tests {
+		programs = append(programs, test.programName)
+	}
+	for _, program := range programs {
+		status, messages, asm := compileWith(program, "void", "-o")
+		served, servedMessages, servedAsm := compileWith("--connect", "server.sock", program, "void", "-o")
+		if status != served || messages != servedMessages || !bytes.Equal(asm, servedAsm) {
+			t.Errorf("%s compiled differently by the server (status %d, %d):\n%s\n%s", program, status, served, messages, servedMessages)
+		}
+	}
+
+	// the options may follow the input directly, as on the command line, and the files
+	// they choose are written as a local compile writes them
+	for _, options := range [][]string{{"-o"}, {"-c"}, {"-c", "-o"}} {
+		results := [][]byte{}
+		for _, prefix := range [][]string{{}, {"--connect", "server.sock"}} {
+			var stderr bytes.Buffer
+			os.Remove("generated/out.s")
+			os.Remove("generated/out.o")
+			cmd := exec.Command("./comp", append(append(prefix, "program8.comp"), options...)...)
+			cmd.Stderr = &stderr
+			cmd.Run()
+			asm, _ := os.ReadFile("generated/out.s")
+			object, _ := os.ReadFile("generated/out.o")
+			status := []byte("exit " + strconv.Itoa(cmd.ProcessState.ExitCode()) + "\n")
+			results = append(results, bytes.Join([][]byte{stderr.Bytes(), status, asm, object}, nil))
+		}
+		if !bytes.Equal(results[0], results[1]) {
+			t.Errorf("program8.comp %v compiled differently by the server:\n%s\n%s", options, results[0], results[1])
+		}
+	}
+	os.Remove("generated/out.o")
+
+	// the server survives a compile that gives up and replies with its status
+	status, messages, _ := compileWith("bounds1.comp", "void", "--interp")
+	served, servedMessages, _ := compileWith("--connect", "server.sock", "bounds1.comp", "void", "--interp")
+	if status != 5 || served != 5 || messages != servedMessages {
+		t.Errorf("bounds1.comp failed differently by the server (status %d, %d):\n%s\n%s", status, served, messages, servedMessages)
+	}
+	if served, _, asm := compileWith("--connect", "server.sock", "program1.comp", "void"); served != 0 || len(asm) == 0 {
+		t.Errorf("no compile by the server after a failed one (status %d)", served)
+	}
+
+	server.Process.Kill()
+	server.Wait()
+	os.Remove("server.sock")
+	if status, _, asm := compileWith("--connect", "server.sock", "program1.comp", "void"); status != 0 || len(asm) == 0 {
+		t.Errorf("no local compile without a server (status %d)", status)
+	}
+}
+
+// a vector read out of bounds stops the interpreter with status 5 instead of ending the
+// process from inside it, after the output made before it
+func TestInternalErrors(t *testing.T) {
+	for _, options := range [][]string{{"--interp"}, {"--tiered", "--tier-threshold", "1"}} {
+		var stderr bytes.Buffer
+		cmd := exec.Command("./comp", append([]string{"bounds1.comp", "void"}, options...)...)
+		cmd.Stderr = &stderr
+		output, _ := cmd.Output()
+		if status := cmd.ProcessState.ExitCode(); status != 5 || string(output) != "7 " {
+			t.Errorf("bounds1.comp %v exited with %d and printed [%s]", options, status, string(output))
+		}
+		if !strings.Contains(stderr.String(), "interp: index 5 out of bounds for vector of 2\n") {
+			t.Errorf("bounds1.comp %v reported:\n%s", options, stderr.String())
+		}
+	}
+}
+
+// a second compile of the same source with the same options comes from the cache with
+// the same messages and files; failed compiles are not kept, and the cache stays within
+// its size by dropping the entries used longest ago
+func TestCache(t *testing.T) {
+	defer cleanup()
+	defer os.RemoveAll("cache")
+	os.RemoveAll("cache")
+
+	compileWith := func(args ...string) (int, string, []byte, []byte) {
+		var stderr bytes.Buffer
+		os.Remove("generated/out.s")
+		os.Remove("out.decomp")
+		cmd := exec.Command("./comp", args...)
+		cmd.Stderr = &stderr
+		cmd.Run()
+		asm, _ := os.ReadFile("generated/out.s")
+		decomp, _ := os.ReadFile("out.decomp")
+		return cmd.ProcessState.ExitCode(), stderr.String(), asm, decomp
+	}
+	report := regexp.MustCompile(`cache: (hit|miss) [0-9a-f]{64}(, \d+ of \d+ functions compiled)?(, stored)?\n$`)
+
+	programs := []string{"semantic1.comp"}
+	for _, test := range tests {
+		programs = append(programs, test.programName)
+	}
+	for _, program := range programs {
+		status, messages, asm, decomp := compileWith(program, "void", "-o")
+		for _, want := range []string{"miss", "hit"} {
+			if status != 0 {
+				want = "miss"
+			}
+			cached, cachedMessages, cachedAsm, cachedDecomp := compileWith(program, "void", "-o", "--cache", "cache")
+			found := report.FindStringSubmatch(cachedMessages)
+			if found == nil || found[1] != want {
+				t.Errorf("%s was no cache %s:\n%s", program, want, cachedMessages)
+				continue
+			}
+			cachedMessages = strings.TrimSuffix(cachedMessages, found[0])
+			if status != cached || messages != cachedMessages || !bytes.Equal(asm, cachedAsm) || !bytes.Equal(decomp, cachedDecomp) {
+				t.Errorf("%s compiled differently on a cache %s (status %d, %d):\n%s\n%s", program, want, status, cached, messages, cachedMessages)
+			}
+		}
+	}
+	if _, messages, _, _ := compileWith("program1.comp", "void", "--cache", "cache"); !strings.Contains(messages, "cache: miss") {
+		t.Errorf("program1.comp without -o came from the cache:\n%s", messages)
+	}
+
+	os.RemoveAll("cache")
+	for _, program := range programs {
+		compileWith(program, "void", "-o", "--cache", "cache", "--cache-size", "40000")
+	}
+	entries, _ := os.ReadDir("cache")
+	size := int64(0)
+	for _, entry := range entries {
+		info, _ := entry.Info()
+		size += info.Size()
+	}
+	if len(entries) == 0 || size > 40000 {
+		t.Errorf("the cache kept %d entries of %d bytes", len(entries), size)
+	}
+	if _, messages, _, _ := compileWith(programs[len(programs)-1], "void", "-o", "--cache", "cache", "--cache-size", "40000"); !strings.Contains(messages, "cache: hit") {
+		t.Errorf("the entry used last was evicted:\n%s", messages)
+	}
+}
+
+// after a change only the functions whose tree, or the signatures they refer to, changed
+// are compiled again, and the program made of old and new code still runs
+func TestIncremental(t *testing.T) {
+	defer cleanup()
+	defer os.RemoveAll("cache")
+	defer os.Remove("incremental.comp")
+	os.RemoveAll("cache")
+
+	program := func(helper string, step string) string {
+		return "int helper(int " + helper + ") {\n    return " + helper + " + 1;\n}\n" +
+			"int twice(int twiceof) {\n    return helper(twiceof) * 2;\n}\n" +
+			"int stepped(int steps) {\n    return steps " + step + ";\n}\n" +
+			"int main() {\n    output twice(3), \" \", stepped(4);\n    return 0;\n}\n"
+	}
+	steps := []struct {
+		source   string
+		compiled string
+		output   string
+	}{
+		{program("value", "+ 10"), "4 of 4", "8 14"},
+		{program("value", "* 10"), "1 of 4", "8 40"},
+		{program("other", "* 10"), "2 of 4", "8 40"},
+		{"\\\\ only a comment is new\n" + program("value", "+ 10"), "0 of 4", "8 14"},
+	}
+
+	for i, step := range steps {
+		if err := os.WriteFile("incremental.comp", []byte(step.source), 0644); err != nil {
+			t.Fatalf("cannot write the program (%s)", err.Error())
+		}
+		var stderr bytes.Buffer
+		cmd := exec.Command("./comp", "incremental.comp", "void", "--cache", "cache")
+		cmd.Stderr = &stderr
+		if err := cmd.Run(); err != nil {
+			t.Fatalf("step %d failed to compile (%s)", i, err.Error())
+		}
+		if !strings.Contains(stderr.String(), ", "+step.compiled+" functions compiled") {
+			t.Errorf("step %d compiled other than %s functions:\n%s", i, step.compiled, stderr.String())
+		}
+		if err := generateBinary(); err != nil {
+			t.Fatalf("failed to generate the binary of step %d (%s)", i, err.Error())
+		}
+		if output, err := run(); err != nil || string(output) != step.output {
+			t.Errorf("step %d printed [%s] instead of [%s]", i, string(output), step.output)
+		}
+	}
+}
+
+// every output command of output1.comp mixes text with arguments, so each becomes a
+// single out_format call on its own descriptor
+func TestOutputFormat(t *testing.T) {
+	defer exec.Command("rm", "-f", "generated/out.s").Output()
+
+	if err := compile("output1.comp"); err != nil {
+		t.Fatalf("failed to compile output1.comp (%s)", err.Error())
+	}
+	asm, err := os.ReadFile("generated/out.s")
+	if err != nil {
+		t.Fatalf("no assembly for output1.comp (%s)", err.Error())
+	}
+
+	program := asm[:bytes.Index(asm, []byte("\nout_flush:"))]
+	if calls := bytes.Count(program, []byte("call out_format")); calls != 2 {
+		t.Errorf("expected 2 calls to out_format, found %d", calls)
+	}
+	if match := regexp.MustCompile(`call out_(int|char|real|string)`).Find(program); match != nil {
+		t.Errorf("output1.comp still prints items one by one (%s)", match)
+	}
+	for _, format := range regexp.MustCompile(`(?m)^_format_\d+:`).FindAll(asm, -1) {
+		if bytes.Count(asm, format) != 1 {
+			t.Errorf("output1.comp defines %s more than once", format)
+		}
+	}
+}
+
+// output1.comp writes many times the runtime buffer, so native runs flush it repeatedly
+func TestBufferedOutput(t *testing.T) {
+	defer cleanup()
+
+	expected, err := exec.Command("./comp", "output1.comp", "void", "--interp").Output()
+	if err != nil {
+		t.Fatalf("failed to interpret output1.comp (%s)", err.Error())
+	}
+	if !bytes.HasPrefix(expected, []byte("0 -2 x\n1 -4 x\n")) || !bytes.HasSuffix(expected, []byte("199999 1 x\n1.500000\n")) {
+		t.Fatalf("unexpected interpreter output for output1.comp")
+	}
+
+	for _, mode := range []string{"--run", "--tiered"} {
+		output, err := exec.Command("./comp", "output1.comp", "void", mode).Output()
+		if err != nil {
+			t.Errorf("failed to run output1.comp with %s (%s)", mode, err.Error())
+		}
+		if !bytes.Equal(output, expected) {
+			t.Errorf("output1.comp with %s differs from the interpreter", mode)
+		}
+	}
+
+	if err := compile("output1.comp"); err != nil {
+		t.Fatalf("failed to compile output1.comp (%s)", err.Error())
+	}
+	if err := generateBinary(); err != nil {
+		t.Fatalf("failed to generate output1.comp binary (%s)", err.Error())
+	}
+	output, err := run()
+	if err != nil {
+		t.Errorf("failed to run output1.comp (%s)", err.Error())
+	}
+	if !bytes.Equal(output, expected) {
+		t.Errorf("output1.comp binary differs from the interpreter")
+	}
+}
+
+// TAC instructions the interpreter executes for one run of the program
+// count integers, count reals and a char, enough to refill the input buffer many times
+func writeInput(path string, count int) error {
+	var input bytes.Buffer
+	input.WriteString(strconv.Itoa(count) + "\n")
+	for i := 0; i < count; i++ {
+		input.WriteString(strconv.Itoa(i*7919%100003-50000) + " ")
+	}
+	for i := 0; i < count; i++ {
+		input.WriteString("\t" + strconv.Itoa(i%7-3) + "." + strconv.Itoa(i%4) + "e-1\n")
+	}
+	input.WriteString("  z\n")
+	return os.WriteFile(path, input.Bytes(), 0644)
+}
+
+func runWithInput(path string, args ...string) ([]byte, error) {
+	input, err := os.Open(path)
+	if err != nil {
+		return nil, err
+	}
+	defer input.Close()
+	command := exec.Command(args[0], args[1:]...)
+	command.Stdin = input
+	return command.Output()
+}
+
+func TestBufferedInput(t *testing.T) {
+	defer cleanup()
+	defer os.Remove("input1.txt")
+
+	if err := writeInput("input1.txt", 100000); err != nil {
+		t.Fatalf("failed to write input1.txt (%s)", err.Error())
+	}
+	expected, err := runWithInput("input1.txt", "./comp", "input1.comp", "void", "--interp")
+	if err != nil {
+		t.Fatalf("failed to interpret input1.comp (%s)", err.Error())
+	}
+	if !bytes.HasSuffix(expected, []byte(" z\n")) {
+		t.Fatalf("unexpected interpreter output for input1.comp: %q", expected)
+	}
+
+	for _, mode := range []string{"--run", "--tiered"} {
+		output, err := runWithInput("input1.txt", "./comp", "input1.comp", "void", mode)
+		if err != nil {
+			t.Errorf("failed to run input1.comp with %s (%s)", mode, err.Error())
+		}
+		if !bytes.Equal(output, expected) {
+			t.Errorf("input1.comp with %s prints %q, the interpreter %q", mode, output, expected)
+		}
+	}
+
+	if err := compile("input1.comp"); err != nil {
+		t.Fatalf("failed to compile input1.comp (%s)", err.Error())
+	}
+	if err := generateBinary(); err != nil {
+		t.Fatalf("failed to generate input1.comp binary (%s)", err.Error())
+	}
+	output, err := runWithInput("input1.txt", "./a.out")
+	if err != nil {
+		t.Errorf("failed to run input1.comp (%s)", err.Error())
+	}
+	if !bytes.Equal(output, expected) {
+		t.Errorf("input1.comp binary prints %q, the interpreter %q", output, expected)
+	}
+}
+
+func interpInstructions(b *testing.B, programName string) float64 {
+	var stderr bytes.Buffer
+	cmd := exec.Command("./comp", programName, "void", "--interp", "-v")
+	cmd.Stderr = &stderr
+	if _, err := cmd.Output(); err != nil {
+		b.Fatalf("failed to interpret %s (%s)", programName, err.Error())
+	}
+
+	match := regexp.MustCompile(`interp: (\d+) instructions in`).FindSubmatch(stderr.Bytes())
+	if match == nil {
+		b.Fatalf("no instruction count for %s", programName)
+	}
+	count, _ := strconv.ParseFloat(string(match[1]), 64)
+	return count
+}
+
+// both modes include the front end; instrs/s counts the same TAC instructions
+func benchmarkKernel(b *testing.B, mode string) {
+	instructions := interpInstructions(b, "kernel1.comp")
+	b.ResetTimer()
+	for i := 0; i < b.N; i++ {
+		if _, err := exec.Command("./comp", "kernel1.comp", "void", mode).Output(); err != nil {
+			b.Fatalf("failed to run kernel1.comp with %s (%s)", mode, err.Error())
+		}
+	}
+	b.ReportMetric(instructions*float64(b.N)/b.Elapsed().Seconds(), "instrs/s")
+}
+
+func BenchmarkInterpKernel(b *testing.B) {
+	benchmarkKernel(b, "--interp")
+}
+
+func BenchmarkTieredKernel(b *testing.B) {
+	benchmarkKernel(b, "--tiered")
+}
+
+func BenchmarkNativeKernel(b *testing.B) {
+	benchmarkKernel(b, "--run")
+}
+
+func BenchmarkNativeOutput(b *testing.B) {
+	for i := 0; i < b.N; i++ {
+		if _, err := exec.Command("./comp", "output1.comp", "void", "--run").Output(); err != nil {
+			b.Fatalf("failed to run output1.comp (%s)", err.Error())
+		}
+	}
+}
+
+// two million integers and as many reals
+func BenchmarkNativeInput(b *testing.B) {
+	defer os.Remove("input2.txt")
+	if err := writeInput("input2.txt", 2000000); err != nil {
+		b.Fatalf("failed to write input2.txt (%s)", err.Error())
+	}
+	b.ResetTimer()
+	for i := 0; i < b.N; i++ {
+		if _, err := runWithInput("input2.txt", "./comp", "input1.comp", "void", "--run"); err != nil {
+			b.Fatalf("failed to run input1.comp (%s)", err.Error())
+		}
+	}
+}
+
+// ops/s of inserts and lookups through the shared table on 1 to 16 threads
+func BenchmarkSymbolTable(b *testing.B) {
+	defer os.Remove("symbols/symbols")
+	if output, err := exec.Command("gcc", "-O2", "-o", "symbols/symbols", "symbols/symbols.c").CombinedOutput(); err != nil {
+		b.Fatalf("failed to build symbols/symbols.c (%s)\n%s", err.Error(), output)
+	}
+	pattern := regexp.MustCompile(`([\d.]+) ops/s`)
+	for _, threads := range []string{"1", "2", "4", "8", "16"} {
+		b.Run(threads, func(b *testing.B) {
+			rate := 0.0
+			for i := 0; i < b.N; i++ {
+				output, err := exec.Command("./symbols/symbols", threads, "20000").Output()
+				if err != nil {
+					b.Fatalf("symbols failed on %s threads (%s)", threads, err.Error())
+				}
+				match := pattern.FindSubmatch(output)
+				if match == nil {
+					b.Fatalf("no rate in [%s]", output)
+				}
+				value, _ := strconv.ParseFloat(string(match[1]), 64)
+				rate += value
+			}
+			b.ReportMetric(rate/float64(b.N), "ops/s")
+		})
+	}
+}
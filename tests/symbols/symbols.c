@@ -0,0 +1,125 @@
+// inserts and looks up the same names on several threads sharing one symbol table and
+// checks every thread got the same items; prints the operations per second
+#define COMPILER_LIBRARY
+#include "../../lex.yy.c"
+
+#define SYMBOLS_MAX_THREADS 64
+
+typedef struct symbols_worker
+{
+    COMPILER_CONTEXT context; // shares the table; the arena is the thread's
+    HASH **found;
+    int first;
+} SYMBOLS_WORKER;
+
+COMPILER_CONTEXT *symbols_shared;
+char **symbols_names;
+int symbols_count;
+
+void *symbols_run(void *argument)
+{
+    SYMBOLS_WORKER *worker = (SYMBOLS_WORKER *)argument;
+    int i;
+
+    compiler = &worker->context;
+    // every thread starts elsewhere in the names, so most inserts race for new ones
+    for (i = 0; i < symbols_count; i++)
+    {
+        int name = (worker->first + i) % symbols_count;
+        worker->found[name] = hash_insert(symbols_names[name], name % 2 ? SYMBOL_LIT_STRING : SYMBOL_IDENTIFIER, 0);
+    }
+    for (i = 0; i < symbols_count; i++)
+    {
+        if (hash_find(symbols_names[i]) != worker->found[i])
+            worker->found[i] = NULL;
+    }
+    return NULL;
+}
+
+double symbols_seconds(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+int main(int argc, char **argv)
+{
+    SYMBOLS_WORKER workers[SYMBOLS_MAX_THREADS];
+    pthread_t threads[SYMBOLS_MAX_THREADS];
+    int threads_count = argc > 1 ? atoi(argv[1]) : 16;
+    char *seen;
+    double start;
+    double elapsed;
+    int i;
+    int j;
+
+    symbols_count = argc > 2 ? atoi(argv[2]) : 20000;
+    if (threads_count < 1 || threads_count > SYMBOLS_MAX_THREADS || symbols_count < 1)
+    {
+        fprintf(stderr, "usage: symbols [threads] [names]\n");
+        return 1;
+    }
+
+    symbols_shared = compiler_create();
+    symbols_names = (char **)malloc(symbols_count * sizeof(char *));
+    for (i = 0; i < symbols_count; i++)
+    {
+        symbols_names[i] = (char *)malloc(32);
+        sprintf(symbols_names[i], "name_%d", i);
+    }
+
+    for (i = 0; i < threads_count; i++)
+    {
+        workers[i].context = *symbols_shared;
+        memset(&workers[i].context.arena, 0, sizeof(ARENA));
+        workers[i].found = (HASH **)calloc(symbols_count, sizeof(HASH *));
+        workers[i].first = (int)((long)symbols_count * i / threads_count);
+    }
+    start = symbols_seconds();
+    for (i = 0; i < threads_count; i++)
+        pthread_create(&threads[i], NULL, symbols_run, &workers[i]);
+    for (i = 0; i < threads_count; i++)
+        pthread_join(threads[i], NULL);
+    elapsed = symbols_seconds() - start;
+
+    // one item per name, the same on every thread, and a distinct id per string; the ids
+    // of items that lost a race are skipped
+    compiler = symbols_shared;
+    seen = (char *)calloc(symbols_shared->symbols->string_id, 1);
+    for (i = 0; i < symbols_count; i++)
+    {
+        HASH *item = workers[0].found[i];
+        if (!item || strcmp(item->text, symbols_names[i]) != 0 || hash_find(symbols_names[i]) != item)
+        {
+            fprintf(stderr, "symbols: %s was not found\n", symbols_names[i]);
+            return 1;
+        }
+        for (j = 1; j < threads_count; j++)
+        {
+            if (workers[j].found[i] != item)
+            {
+                fprintf(stderr, "symbols: thread %d got another %s\n", j, symbols_names[i]);
+                return 1;
+            }
+        }
+        if (item->type == SYMBOL_LIT_STRING)
+        {
+            if (item->string_id < 1 || item->string_id >= symbols_shared->symbols->string_id || seen[item->string_id]++)
+            {
+                fprintf(stderr, "symbols: %s has string id %d\n", symbols_names[i], item->string_id);
+                return 1;
+            }
+        }
+    }
+
+    printf("symbols: %d threads, %d names, %.3f s, %.0f ops/s\n", threads_count, symbols_count, elapsed,
+           2.0 * threads_count * symbols_count / elapsed);
+    for (i = 0; i < threads_count; i++)
+    {
+        arena_adopt(&symbols_shared->arena, &workers[i].context.arena);
+        free(workers[i].found);
+    }
+    compiler_destroy(symbols_shared);
+    return 0;
+}
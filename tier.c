@@ -0,0 +1,157 @@
+#include <sys/mman.h>
+#include "tier.h"
+
+// compiled code and the interpreter cells share one mapping, so every
+// cell is within rel32 reach of the code that names it
+JIT_SPACE tier_space;
+unsigned char *tier_region;
+size_t tier_region_size;
+
+void tier_start(IPROGRAM *program)
+{
+    size_t cells_size = jit_page_align(program->cell_count * sizeof(ICELL));
+    tier_region_size = TIER_CODE_SIZE + cells_size;
+    tier_region = (unsigned char *)mmap(NULL, tier_region_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (tier_region == MAP_FAILED)
+    {
+        compiler_fail("tier: mmap failed\n");
+    }
+
+    memcpy(tier_region + TIER_CODE_SIZE, program->cells, program->cell_count * sizeof(ICELL));
+    free(program->cells);
+    program->cells = (ICELL *)(tier_region + TIER_CODE_SIZE);
+    tier_space.base = tier_region;
+    tier_space.size = TIER_CODE_SIZE;
+    tier_space.used = 0;
+    if (compiler->vectorize_loops)
+        vectorize_analyze(program->first);
+}
+
+void tier_finish(IPROGRAM *program)
+{
+    munmap(tier_region, tier_region_size);
+    program->cells = NULL;
+}
+
+// the function and whatever it calls that is not native yet
+int tier_collect(IPROGRAM *program, int function, int *set, int count)
+{
+    TAC *tac;
+    int i;
+    for (i = 0; i < count; i++)
+    {
+        if (set[i] == function)
+            return count;
+    }
+    set[count++] = function;
+
+    for (tac = program->functions[function].begin; tac; tac = tac->next)
+    {
+        if (tac->type == TAC_CALL)
+        {
+            int callee = interp_function(program, tac->op1);
+            if (!program->functions[callee].native)
+                count = tier_collect(program, callee, set, count);
+        }
+        if (tac == program->functions[function].end)
+            break;
+    }
+    return count;
+}
+
+char *tier_osr_name(MCODE *code, ILOOP *loop)
+{
+    char *name = (char *)arena_alloc(&code->arena, strlen(loop->label->text) + 5);
+    sprintf(name, "osr_%s", loop->label->text);
+    return name;
+}
+
+// data operands name interpreter cells; calls to earlier compiled functions go straight there
+void tier_bind(IPROGRAM *program, XOBJECT *object, MOPERAND *operand)
+{
+    char name[160];
+    XSYMBOL *symbol;
+    if (operand->kind == MOP_MEM && operand->symbol.kind == MSYM_HASH)
+    {
+        HASH *cell = operand->symbol.hash->slot ? operand->symbol.hash : interp_lookup(operand->symbol.hash);
+        if (!cell->slot)
+        {
+            compiler_fail("tier: no cell for %s\n", cell->text);
+        }
+        symbol = x86_symbol(object, minstr_format_symbol(name, &operand->symbol));
+        symbol->address = &program->cells[cell->slot];
+    }
+    else if (operand->kind == MOP_SYM && operand->symbol.kind == MSYM_FUNCTION)
+    {
+        int function = interp_function(program, operand->symbol.hash);
+        if (program->functions[function].native)
+        {
+            symbol = x86_symbol(object, minstr_format_symbol(name, &operand->symbol));
+            symbol->address = (void *)program->functions[function].native;
+        }
+    }
+}
+
+void tier_promote(IPROGRAM *program, int function)
+{
+    MCODE rodata = {.first = NULL, .last = NULL};
+    MCODE code = {.first = NULL, .last = NULL};
+    XOBJECT *object = (XOBJECT *)calloc(1, sizeof(XOBJECT));
+    int *set = (int *)malloc(program->function_count * sizeof(int));
+    int count = tier_collect(program, function, set, 0);
+    unsigned char *text;
+    MINSTR *instr;
+    int i;
+    int j;
+
+    asm_rodata(&rodata);
+    minstr_emit(&code, MI_SECTION, 0, mop_none(), mop_extern(".text"));
+    isel_count_uses(program->first);
+    for (i = 0; i < count; i++)
+    {
+        IFUNCTION *compiled = &program->functions[set[i]];
+        asm_text(&code, compiled->begin, compiled->end);
+
+        // loop entries rebuild the frame the function prologue would have made
+        for (j = 0; j < program->loop_count; j++)
+        {
+            if (program->loops[j].function != set[i])
+                continue;
+            minstr_emit(&code, MI_FUNCTION, 8, mop_none(), mop_extern(tier_osr_name(&code, &program->loops[j])));
+            minstr_emit(&code, MI_PUSH, 8, mop_none(), mop_reg(REG_RBP));
+            minstr_emit(&code, MI_MOV, 8, mop_reg(REG_RSP), mop_reg(REG_RBP));
+            minstr_emit(&code, MI_JMP, 8, mop_none(), mop_label(program->loops[j].label));
+        }
+    }
+    isel_reset();
+    peephole_optimize(&code);
+    asm_pool(&rodata);
+
+    for (instr = code.first; instr; instr = instr->next)
+    {
+        tier_bind(program, object, &instr->src);
+        tier_bind(program, object, &instr->dst);
+    }
+    x86_assemble(object, &rodata);
+    x86_assemble(object, &code);
+    text = jit_load(&tier_space, object);
+
+    for (i = 0; i < count; i++)
+    {
+        IFUNCTION *compiled = &program->functions[set[i]];
+        compiled->native = (int (*)(void))(text + x86_symbol(object, compiled->symbol->text)->offset);
+        for (j = 0; j < program->loop_count; j++)
+        {
+            if (program->loops[j].function == set[i])
+                program->loops[j].native = (int (*)(void))(text + x86_symbol(object, tier_osr_name(&code, &program->loops[j]))->offset);
+        }
+        if (compiler->verbose)
+            fprintf(stderr, "tier: compiled %s (%d calls, %d bytes of code so far)\n", compiled->symbol->text, compiled->calls, (int)tier_space.used);
+    }
+
+    minstr_release(&rodata);
+    minstr_release(&code);
+    x86_release(object);
+    free(object);
+    free(set);
+}
@@ -0,0 +1,10 @@
+#pragma once
+#include "interp.h"
+#include "jit.h"
+
+// room for every function compiled during one run
+#define TIER_CODE_SIZE (16 << 20)
+
+void tier_start(IPROGRAM *program);
+void tier_promote(IPROGRAM *program, int function);
+void tier_finish(IPROGRAM *program);
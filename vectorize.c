@@ -0,0 +1,826 @@
+#include <stdarg.h>
+#include "vectorize.h"
+
+// vector bases are addressed from these while the induction variable sits in rcx;
+// rax and rdx are free again once the trip test is done
+int vector_base_pool[VECTOR_MAX_BASES] = {REG_RSI, REG_RDI, REG_R8, REG_R9, REG_R10, REG_R11, REG_RAX, REG_RDX};
+
+int vectorize_fail(VGEN *gen, const char *format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    vsnprintf(gen->reason, sizeof(gen->reason), format, args);
+    va_end(args);
+    return 0;
+}
+
+MINSTR *vectorize_op(VGEN *gen, int op, int size, MOPERAND src, MOPERAND dst)
+{
+    if (!gen->code)
+        return NULL;
+    return minstr_emit(gen->code, op, size, src, dst);
+}
+
+void vectorize_op_imm8(VGEN *gen, int op, int imm8, MOPERAND src, MOPERAND dst)
+{
+    MINSTR *instr = vectorize_op(gen, op, gen->size, src, dst);
+    if (instr)
+        instr->cc = imm8;
+}
+
+int vectorize_alloc(VGEN *gen)
+{
+    int i;
+    for (i = 0; i < 8; i++)
+    {
+        if (!gen->xmm_used[i])
+        {
+            gen->xmm_used[i] = 1;
+            return REG_XMM0 + i;
+        }
+    }
+    vectorize_fail(gen, "needs more than 8 vector registers");
+    return REG_NONE;
+}
+
+void vectorize_free(VGEN *gen, int reg)
+{
+    gen->xmm_used[reg - REG_XMM0] = 0;
+}
+
+MOPERAND vectorize_scalar(HASH *symbol)
+{
+    return isel_is_literal(symbol) ? mop_imm(isel_literal_value(symbol)) : isel_symbol(symbol);
+}
+
+// int literals and int variables other than the induction variable
+int vectorize_is_bound(VGEN *gen, HASH *symbol)
+{
+    return symbol && symbol != gen->loop->induction && !symbol->is_vector && !symbol->is_function &&
+           !symbol->is_temp && symbol->datatype == DATATYPE_INT;
+}
+
+int vectorize_class(VGEN *gen, HASH *symbol)
+{
+    int i;
+    for (i = 0; i < gen->value_count; i++)
+    {
+        if (gen->value[i] == symbol)
+            return gen->value_cls[i];
+    }
+    return isel_class_of(symbol->datatype);
+}
+
+int vectorize_used_after(VGEN *gen, TAC *tac, HASH *symbol)
+{
+    for (tac = tac->next; tac != gen->loop->step; tac = tac->next)
+    {
+        if (tac->op1 == symbol || tac->op2 == symbol)
+            return 1;
+    }
+    return 0;
+}
+
+int vectorize_reads(VGEN *gen, HASH *symbol)
+{
+    TAC *tac;
+    for (tac = gen->loop->body; tac != gen->loop->step; tac = tac->next)
+    {
+        if (tac->op1 == symbol || tac->op2 == symbol)
+            return 1;
+    }
+    return 0;
+}
+
+// whether value, computed in the body before tac, is made from symbol
+int vectorize_feeds(VGEN *gen, TAC *tac, HASH *value, HASH *symbol)
+{
+    TAC *made = NULL;
+    TAC *scan;
+
+    if (value == symbol)
+        return 1;
+    if (!value || !value->is_temp)
+        return 0;
+    for (scan = gen->loop->body; scan != tac; scan = scan->next)
+    {
+        if (scan->res == value)
+            made = scan;
+    }
+    return made && (vectorize_feeds(gen, made, made->op1, symbol) || vectorize_feeds(gen, made, made->op2, symbol));
+}
+
+// the variables the condition compares the induction variable against
+int vectorize_in_bound(VGEN *gen, HASH *symbol)
+{
+    VLOOP *loop = gen->loop;
+    if (loop->bound_tac)
+        return loop->bound_tac->op1 == symbol || loop->bound_tac->op2 == symbol;
+    return loop->bound == symbol;
+}
+
+int vectorize_record(VGEN *gen, HASH *temp, int reg, int cls)
+{
+    if (gen->value_count == VECTOR_MAX_VALUES)
+        return vectorize_fail(gen, "too many values in the body");
+    gen->value[gen->value_count] = temp;
+    gen->value_reg[gen->value_count] = reg;
+    gen->value_cls[gen->value_count] = cls;
+    gen->value_count++;
+    return 1;
+}
+
+// i itself, or a temp holding i plus a constant
+int vectorize_offset(VGEN *gen, HASH *index, int *offset)
+{
+    int i;
+    if (index == gen->loop->induction)
+    {
+        *offset = 0;
+        return 1;
+    }
+    for (i = 0; i < gen->index_count; i++)
+    {
+        if (gen->index[i] == index)
+        {
+            *offset = gen->index_offset[i];
+            return 1;
+        }
+    }
+    return 0;
+}
+
+int vectorize_base(VGEN *gen, HASH *vector)
+{
+    int i;
+    for (i = 0; i < gen->vector_count; i++)
+    {
+        if (gen->vector[i] == vector)
+            return vector_base_pool[i];
+    }
+    if (gen->vector_count == VECTOR_MAX_BASES)
+    {
+        vectorize_fail(gen, "touches more than 8 vectors");
+        return REG_NONE;
+    }
+    gen->vector[gen->vector_count] = vector;
+    vectorize_op(gen, MI_LEA, 8, mop_hash(vector, 0), mop_reg(vector_base_pool[gen->vector_count]));
+    return vector_base_pool[gen->vector_count++];
+}
+
+// element address for lane 0; the lanes follow at consecutive indices
+MOPERAND vectorize_element(VGEN *gen, HASH *vector, HASH *index, int store, int *ok)
+{
+    int offset;
+    int base;
+    *ok = 0;
+    if (vector->datatype != DATATYPE_INT && vector->datatype != DATATYPE_REAL && vector->datatype != DATATYPE_BOOL)
+    {
+        vectorize_fail(gen, "%s is a char vector", vector->text);
+        return mop_none();
+    }
+    if (!vectorize_offset(gen, index, &offset))
+    {
+        vectorize_fail(gen, "index into %s is not the induction variable plus a constant", vector->text);
+        return mop_none();
+    }
+    if (gen->access_count == VECTOR_MAX_ACCESSES)
+    {
+        vectorize_fail(gen, "too many vector accesses");
+        return mop_none();
+    }
+    base = vectorize_base(gen, vector);
+    if (base == REG_NONE)
+        return mop_none();
+
+    gen->access[gen->access_count].vector = vector;
+    gen->access[gen->access_count].offset = offset;
+    gen->access[gen->access_count].store = store;
+    gen->access_count++;
+    *ok = 1;
+    return mop_mem(base, REG_RCX, 4, 4 * offset);
+}
+
+// packed value of an operand: a temp of the body, or an invariant broadcast to every lane;
+// owned registers may be overwritten because nothing reads them afterwards
+int vectorize_value(VGEN *gen, TAC *tac, HASH *symbol, int cls, int keep, int *owned)
+{
+    int offset;
+    int reg;
+    MOPERAND scalar;
+    int i;
+
+    if (vectorize_offset(gen, symbol, &offset))
+    {
+        vectorize_fail(gen, "induction variable %s is used as a value", gen->loop->induction->text);
+        return REG_NONE;
+    }
+
+    for (i = 0; i < gen->value_count; i++)
+    {
+        if (gen->value[i] != symbol)
+            continue;
+        if (gen->value_cls[i] != cls)
+        {
+            vectorize_fail(gen, "mixes int and real operands");
+            return REG_NONE;
+        }
+        reg = gen->value_reg[i];
+        *owned = !keep && !vectorize_used_after(gen, tac, symbol);
+        if (*owned)
+        {
+            gen->value_count--;
+            gen->value[i] = gen->value[gen->value_count];
+            gen->value_reg[i] = gen->value_reg[gen->value_count];
+            gen->value_cls[i] = gen->value_cls[gen->value_count];
+        }
+        return reg;
+    }
+
+    if (symbol->is_temp || symbol->is_vector || symbol->is_function)
+    {
+        vectorize_fail(gen, "%s is not computed in the loop body", symbol->text);
+        return REG_NONE;
+    }
+    if (symbol->datatype != DATATYPE_INT && symbol->datatype != DATATYPE_REAL && symbol->datatype != DATATYPE_BOOL)
+    {
+        vectorize_fail(gen, "%s is a char", symbol->text);
+        return REG_NONE;
+    }
+    if (isel_class_of(symbol->datatype) != cls)
+    {
+        vectorize_fail(gen, "mixes int and real operands");
+        return REG_NONE;
+    }
+
+    reg = vectorize_alloc(gen);
+    if (reg == REG_NONE)
+        return REG_NONE;
+    // literals are broadcast from the constant pool, which only takes entries once code is emitted
+    scalar = gen->code ? isel_symbol(symbol) : mop_none();
+    if (gen->size == 32)
+    {
+        vectorize_op(gen, MI_VPBROADCASTD, 32, scalar, mop_reg(reg));
+    }
+    else
+    {
+        vectorize_op(gen, MI_MOVD, 4, scalar, mop_reg(reg));
+        vectorize_op_imm8(gen, MI_PSHUFD, 0, mop_reg(reg), mop_reg(reg));
+    }
+    *owned = 1;
+    return reg;
+}
+
+// a register the result can be computed into, copying the operand when it is still needed
+int vectorize_target(VGEN *gen, int reg, int owned)
+{
+    int target;
+    if (owned)
+        return reg;
+    target = vectorize_alloc(gen);
+    if (target != REG_NONE)
+        vectorize_op(gen, MI_MOVUPS, gen->size, mop_reg(reg), mop_reg(target));
+    return target;
+}
+
+// lanes that are zero become 1 and the others 0, as the scalar test and sete do
+int vectorize_zero_test(VGEN *gen, int reg, int owned)
+{
+    int zero = vectorize_alloc(gen);
+    if (zero == REG_NONE)
+        return REG_NONE;
+    vectorize_op(gen, MI_PXOR, gen->size, mop_reg(zero), mop_reg(zero));
+    vectorize_op(gen, MI_PCMPEQD, gen->size, mop_reg(reg), mop_reg(zero));
+    vectorize_op(gen, MI_PSRLD, gen->size, mop_imm(31), mop_reg(zero));
+    if (owned)
+        vectorize_free(gen, reg);
+    return zero;
+}
+
+// int multiply by a power of two is a shift, which SSE2 has where it lacks pmulld
+int vectorize_shift(VGEN *gen, TAC *tac)
+{
+    HASH *scaled = NULL;
+    int shift = -1;
+    int owned;
+    int reg;
+
+    if (isel_is_literal(tac->op2) && (shift = isel_log2(isel_literal_value(tac->op2))) >= 0)
+        scaled = tac->op1;
+    else if (isel_is_literal(tac->op1) && (shift = isel_log2(isel_literal_value(tac->op1))) >= 0)
+        scaled = tac->op2;
+    if (!scaled)
+    {
+        if (gen->size == 32)
+            return -1;
+        return vectorize_fail(gen, "int multiply needs pmulld, available with --avx2");
+    }
+
+    reg = vectorize_value(gen, tac, scaled, ISEL_CLASS_INT, 0, &owned);
+    if (reg == REG_NONE || (reg = vectorize_target(gen, reg, owned)) == REG_NONE)
+        return 0;
+    vectorize_op(gen, MI_PSLLD, gen->size, mop_imm(shift), mop_reg(reg));
+    return vectorize_record(gen, tac->res, reg, ISEL_CLASS_INT);
+}
+
+int vectorize_binary(VGEN *gen, TAC *tac)
+{
+    HASH *left = tac->op1;
+    HASH *right = tac->op2;
+    int cls = vectorize_class(gen, left);
+    int compare = isel_is_compare(tac->type);
+    int logic = tac->type == TAC_AND || tac->type == TAC_OR;
+    int commutative = 0;
+    int swap = 0;
+    int negate = 0;
+    int imm8 = -1;
+    int op = 0;
+    int own_a;
+    int own_b;
+    int a;
+    int b;
+    if (vectorize_class(gen, right) != cls || (!compare && !logic && isel_class_of(tac->res->datatype) != cls))
+        return vectorize_fail(gen, "mixes int and real operands");
+
+    if (cls == ISEL_CLASS_REAL)
+    {
+        switch (tac->type)
+        {
+        case TAC_ADD:
+            op = MI_ADDPS;
+            commutative = 1;
+            break;
+        case TAC_SUB:
+            op = MI_SUBPS;
+            break;
+        case TAC_MUL:
+            op = MI_MULPS;
+            commutative = 1;
+            break;
+        case TAC_DIV:
+            op = MI_DIVPS;
+            break;
+        case TAC_LT:
+        case TAC_GT:
+            op = MI_CMPPS;
+            imm8 = 1;
+            swap = tac->type == TAC_GT;
+            break;
+        case TAC_LE:
+        case TAC_GE:
+            op = MI_CMPPS;
+            imm8 = 2;
+            swap = tac->type == TAC_GE;
+            break;
+        case TAC_EQ:
+        case TAC_DIF:
+            // unordered lanes compare unequal, as ucomiss does
+            op = MI_CMPPS;
+            imm8 = tac->type == TAC_EQ ? 0 : 4;
+            commutative = 1;
+            break;
+        default:
+            return vectorize_fail(gen, "logic on real operands");
+        }
+    }
+    else
+    {
+        switch (tac->type)
+        {
+        case TAC_ADD:
+            op = MI_PADDD;
+            commutative = 1;
+            break;
+        case TAC_SUB:
+            op = MI_PSUBD;
+            break;
+        case TAC_MUL:
+        {
+            int shifted = vectorize_shift(gen, tac);
+            if (shifted >= 0)
+                return shifted;
+            op = MI_PMULLD;
+            commutative = 1;
+            break;
+        }
+        case TAC_DIV:
+            return vectorize_fail(gen, "int division has no packed form");
+        case TAC_AND:
+            op = MI_PAND;
+            commutative = 1;
+            break;
+        case TAC_OR:
+            op = MI_POR;
+            commutative = 1;
+            break;
+        case TAC_GT:
+        case TAC_LE:
+            op = MI_PCMPGTD;
+            negate = tac->type == TAC_LE;
+            break;
+        case TAC_LT:
+        case TAC_GE:
+            op = MI_PCMPGTD;
+            swap = 1;
+            negate = tac->type == TAC_GE;
+            break;
+        default:
+            op = MI_PCMPEQD;
+            commutative = 1;
+            negate = tac->type == TAC_DIF;
+            break;
+        }
+    }
+
+    if (swap)
+    {
+        left = tac->op2;
+        right = tac->op1;
+    }
+
+    a = vectorize_value(gen, tac, left, cls, left == right, &own_a);
+    if (a == REG_NONE)
+        return 0;
+    b = vectorize_value(gen, tac, right, cls, 0, &own_b);
+    if (b == REG_NONE)
+        return 0;
+    if (!own_a && own_b && commutative)
+    {
+        int reg = a;
+        a = b;
+        b = reg;
+        own_a = 1;
+        own_b = 0;
+    }
+
+    a = vectorize_target(gen, a, own_a);
+    if (a == REG_NONE)
+        return 0;
+    if (imm8 >= 0)
+        vectorize_op_imm8(gen, op, imm8, mop_reg(b), mop_reg(a));
+    else
+        vectorize_op(gen, op, gen->size, mop_reg(b), mop_reg(a));
+    if (own_b)
+        vectorize_free(gen, b);
+
+    // a mask of all ones per true lane, turned into the 1 the scalar compare produces
+    if (compare && negate)
+    {
+        a = vectorize_zero_test(gen, a, 1);
+        if (a == REG_NONE)
+            return 0;
+    }
+    else if (compare)
+    {
+        vectorize_op(gen, MI_PSRLD, gen->size, mop_imm(31), mop_reg(a));
+    }
+    if (compare)
+        cls = ISEL_CLASS_INT;
+    return vectorize_record(gen, tac->res, a, cls);
+}
+
+int vectorize_unary(VGEN *gen, TAC *tac)
+{
+    int cls = vectorize_class(gen, tac->op1);
+    int owned;
+    int zero;
+    int reg = vectorize_value(gen, tac, tac->op1, cls, 0, &owned);
+    if (reg == REG_NONE)
+        return 0;
+
+    if (tac->type == TAC_NOT)
+    {
+        reg = vectorize_zero_test(gen, reg, owned);
+        return reg != REG_NONE && vectorize_record(gen, tac->res, reg, ISEL_CLASS_INT);
+    }
+
+    // 0 - x, which for reals keeps the sign of zero the way the scalar code does
+    if (isel_class_of(tac->res->datatype) != cls)
+        return vectorize_fail(gen, "mixes int and real operands");
+    zero = vectorize_alloc(gen);
+    if (zero == REG_NONE)
+        return 0;
+    vectorize_op(gen, MI_PXOR, gen->size, mop_reg(zero), mop_reg(zero));
+    vectorize_op(gen, cls == ISEL_CLASS_REAL ? MI_SUBPS : MI_PSUBD, gen->size, mop_reg(reg), mop_reg(zero));
+    if (owned)
+        vectorize_free(gen, reg);
+    return vectorize_record(gen, tac->res, zero, cls);
+}
+
+int vectorize_statement(VGEN *gen, TAC *tac)
+{
+    HASH *induction = gen->loop->induction;
+    MOPERAND element;
+    int owned;
+    int reg;
+    int ok;
+
+    switch (tac->type)
+    {
+    case TAC_SYMBOL:
+        return 1;
+    case TAC_ADD:
+    case TAC_SUB:
+        if (tac->op1 == induction || tac->op2 == induction)
+        {
+            HASH *other = tac->op1 == induction ? tac->op2 : tac->op1;
+            if (!isel_is_literal(other) || other->datatype != DATATYPE_INT || (tac->type == TAC_SUB && tac->op2 == induction))
+                return vectorize_fail(gen, "induction variable %s is used as a value", induction->text);
+            if (gen->index_count == VECTOR_MAX_VALUES)
+                return vectorize_fail(gen, "too many values in the body");
+            gen->index[gen->index_count] = tac->res;
+            gen->index_offset[gen->index_count] = tac->type == TAC_SUB ? -isel_literal_value(other) : isel_literal_value(other);
+            gen->index_count++;
+            return 1;
+        }
+        return vectorize_binary(gen, tac);
+    case TAC_MUL:
+    case TAC_DIV:
+    case TAC_AND:
+    case TAC_OR:
+    case TAC_LT:
+    case TAC_LE:
+    case TAC_GT:
+    case TAC_GE:
+    case TAC_EQ:
+    case TAC_DIF:
+        return vectorize_binary(gen, tac);
+    case TAC_NEG:
+    case TAC_NOT:
+        return vectorize_unary(gen, tac);
+    case TAC_COPY:
+        if (tac->res->is_vector)
+        {
+            element = vectorize_element(gen, tac->res, tac->op1, 1, &ok);
+            if (!ok)
+                return 0;
+            reg = vectorize_value(gen, tac, tac->op2, isel_class_of(tac->res->datatype), 0, &owned);
+            if (reg == REG_NONE)
+                return 0;
+            vectorize_op(gen, MI_MOVUPS, gen->size, mop_reg(reg), element);
+            if (owned)
+                vectorize_free(gen, reg);
+            return 1;
+        }
+        if (tac->op1 && tac->op1->is_vector && tac->res->is_temp)
+        {
+            element = vectorize_element(gen, tac->op1, tac->op2, 0, &ok);
+            if (!ok || (reg = vectorize_alloc(gen)) == REG_NONE)
+                return 0;
+            vectorize_op(gen, MI_MOVUPS, gen->size, element, mop_reg(reg));
+            return vectorize_record(gen, tac->res, reg, isel_class_of(tac->op1->datatype));
+        }
+        if (vectorize_in_bound(gen, tac->res))
+            return vectorize_fail(gen, "bound %s is written in the body", tac->res->text);
+        if (vectorize_feeds(gen, tac, tac->op1, tac->res))
+            return vectorize_fail(gen, "reduction into %s", tac->res->text);
+        if (vectorize_reads(gen, tac->res))
+            return vectorize_fail(gen, "loop-invariant %s is written in the body", tac->res->text);
+        return vectorize_fail(gen, "assigns the scalar %s", tac->res->text);
+    case TAC_PRINT:
+    case TAC_PRINT_ARG:
+        return vectorize_fail(gen, "output in the body");
+    case TAC_READ:
+        return vectorize_fail(gen, "input in the body");
+    case TAC_ARG:
+    case TAC_CALL:
+        return vectorize_fail(gen, "function call in the body");
+    }
+    return vectorize_fail(gen, "unsupported statement in the body");
+}
+
+// a stored vector must be touched at one offset only, or lanes would read elements
+// that earlier scalar iterations had already overwritten
+int vectorize_check_overlap(VGEN *gen)
+{
+    int i;
+    int j;
+    for (i = 0; i < gen->access_count; i++)
+    {
+        if (!gen->access[i].store)
+            continue;
+        for (j = 0; j < gen->access_count; j++)
+        {
+            if (gen->access[j].vector == gen->access[i].vector && gen->access[j].offset != gen->access[i].offset)
+                return vectorize_fail(gen, "%s is stored and accessed at different offsets", gen->access[i].vector->text);
+        }
+    }
+    return 1;
+}
+
+// registers do not survive the loop label, so every iteration reloads the index, the
+// vector bases and the broadcast invariants
+int vectorize_body(VGEN *gen)
+{
+    VLOOP *loop = gen->loop;
+    int lanes = gen->size / 4;
+    MOPERAND eax = mop_reg(REG_RAX);
+    MOPERAND edx = mop_reg(REG_RDX);
+    MOPERAND bound;
+    TAC *tac;
+
+    vectorize_op(gen, MI_LABEL, 8, mop_none(), mop_extern(loop->start));
+    vectorize_op(gen, MI_MOV, 4, mop_hash(loop->induction, 0), eax);
+    vectorize_op(gen, MI_ADD, 4, mop_imm(loop->inclusive ? lanes - 1 : lanes), eax);
+    if (loop->bound_tac)
+    {
+        vectorize_op(gen, MI_MOV, 4, vectorize_scalar(loop->bound_tac->op1), edx);
+        vectorize_op(gen, loop->bound_tac->type == TAC_ADD ? MI_ADD : MI_SUB, 4, vectorize_scalar(loop->bound_tac->op2), edx);
+        bound = edx;
+    }
+    else
+    {
+        bound = vectorize_scalar(loop->bound);
+    }
+    vectorize_op(gen, MI_CMP, 4, bound, eax);
+    if (gen->code)
+        minstr_emit_cc(gen->code, MI_JCC, CC_G, mop_extern(loop->end));
+    vectorize_op(gen, MI_MOVSLQ, 8, mop_hash(loop->induction, 0), mop_reg(REG_RCX));
+
+    for (tac = loop->body; tac != loop->step; tac = tac->next)
+    {
+        if (!vectorize_statement(gen, tac))
+            return 0;
+    }
+    if (!vectorize_check_overlap(gen))
+        return 0;
+
+    vectorize_op(gen, MI_ADD, 4, mop_imm(lanes), mop_hash(loop->induction, 0));
+    vectorize_op(gen, MI_JMP, 8, mop_none(), mop_extern(loop->start));
+    vectorize_op(gen, MI_LABEL, 8, mop_none(), mop_extern(loop->end));
+    if (gen->size == 32)
+        vectorize_op(gen, MI_VZEROUPPER, 0, mop_none(), mop_none());
+    return 1;
+}
+
+// symbol references are interleaved with the instructions and generate nothing
+TAC *vectorize_next(TAC *tac)
+{
+    for (tac = tac->next; tac && tac->type == TAC_SYMBOL; tac = tac->next)
+        ;
+    return tac;
+}
+
+TAC *vectorize_prev(TAC *tac)
+{
+    for (tac = tac->prev; tac && tac->type == TAC_SYMBOL; tac = tac->prev)
+        ;
+    return tac;
+}
+
+// LABEL start; [bound temp]; i < bound; JFALSE end; LABEL body; body; t = i + 1; i = t; JUMP start
+int vectorize_match(VGEN *gen, TAC *label)
+{
+    VLOOP *loop = gen->loop;
+    TAC *compare = vectorize_next(label);
+    TAC *jfalse;
+    TAC *entry;
+    TAC *jump;
+    TAC *step;
+    TAC *last;
+
+    loop->label = label->res;
+    if (compare && (compare->type == TAC_ADD || compare->type == TAC_SUB) && compare->res->is_temp)
+    {
+        loop->bound_tac = compare;
+        compare = vectorize_next(compare);
+    }
+    if (!compare || (compare->type != TAC_LT && compare->type != TAC_LE && compare->type != TAC_GT && compare->type != TAC_GE))
+        return vectorize_fail(gen, "condition is not a comparison against a bound");
+    jfalse = vectorize_next(compare);
+    if (!jfalse || jfalse->type != TAC_JFALSE || jfalse->op1 != compare->res)
+        return vectorize_fail(gen, "condition is not a comparison against a bound");
+
+    if (compare->type == TAC_LT || compare->type == TAC_LE)
+    {
+        loop->induction = compare->op1;
+        loop->bound = compare->op2;
+        loop->inclusive = compare->type == TAC_LE;
+    }
+    else
+    {
+        loop->induction = compare->op2;
+        loop->bound = compare->op1;
+        loop->inclusive = compare->type == TAC_GE;
+    }
+    if (loop->induction->is_temp || loop->induction->is_vector || loop->induction->datatype != DATATYPE_INT ||
+        isel_is_literal(loop->induction))
+        return vectorize_fail(gen, "condition does not test an int variable");
+    if (loop->bound_tac)
+    {
+        if (loop->bound != loop->bound_tac->res || !vectorize_is_bound(gen, loop->bound_tac->op1) || !vectorize_is_bound(gen, loop->bound_tac->op2))
+            return vectorize_fail(gen, "bound is not invariant");
+    }
+    else if (!vectorize_is_bound(gen, loop->bound))
+    {
+        return vectorize_fail(gen, "bound is not invariant");
+    }
+
+    entry = vectorize_next(jfalse);
+    if (!entry || entry->type != TAC_LABEL)
+        return vectorize_fail(gen, "condition is not a comparison against a bound");
+
+    for (jump = entry->next; jump; jump = jump->next)
+    {
+        if (jump->type == TAC_LABEL || jump->type == TAC_JUMP || jump->type == TAC_JFALSE || jump->type == TAC_RET || jump->type == TAC_ENDFUN)
+            break;
+    }
+    if (!jump || jump->type != TAC_JUMP || jump->res != loop->label)
+        return vectorize_fail(gen, jump && jump->type == TAC_RET ? "return in the body" : "branch or inner loop in the body");
+
+    step = vectorize_prev(jump);
+    if (step->type != TAC_COPY || step->res != loop->induction || step->op2 || step == entry)
+        return vectorize_fail(gen, "%s does not step by 1 at the end of the body", loop->induction->text);
+    last = step;
+    step = vectorize_prev(step);
+    if (step == entry || step->type != TAC_ADD || step->res != last->op1 ||
+        !((step->op1 == loop->induction && isel_is_literal(step->op2) && isel_literal_value(step->op2) == 1) ||
+          (step->op2 == loop->induction && isel_is_literal(step->op1) && isel_literal_value(step->op1) == 1)))
+        return vectorize_fail(gen, "%s does not step by 1 at the end of the body", loop->induction->text);
+    if (step == vectorize_next(entry))
+        return vectorize_fail(gen, "empty body");
+
+    loop->body = vectorize_next(entry);
+    loop->step = step;
+    return 1;
+}
+
+// a profile that shows fewer iterations per entry than a register holds leaves the loop
+// scalar; the start label counts entries and tests, the body label the iterations
+int vectorize_profitable(VGEN *gen, TAC *label)
+{
+    long long tests = profile_count(label);
+    long long iterations;
+    TAC *entry;
+    for (entry = label->next; entry && entry->type != TAC_LABEL; entry = entry->next)
+        ;
+    iterations = profile_count(entry);
+    if (tests < 0 || iterations < 0 || iterations >= (tests - iterations) * (gen->size / 4))
+        return 1;
+    return vectorize_fail(gen, "profile shows %lld iterations in %lld entries", iterations, tests - iterations);
+}
+
+char *vectorize_name(HASH *label, char *suffix)
+{
+    char *name = (char *)malloc(strlen(label->text) + strlen(suffix) + 2);
+    sprintf(name, "_%s%s", label->text, suffix);
+    return name;
+}
+
+// finds the loops worth vectorizing before any code is selected, and says why the others are not
+void vectorize_analyze(TAC *first)
+{
+    TAC *tac;
+    compiler->vector->count = 0;
+
+    for (tac = first; tac; tac = tac->next)
+    {
+        VLOOP loop;
+        VGEN gen;
+        if (tac->type != TAC_LABEL || strncmp(tac->res->text, "loop_start_label", 16) != 0)
+            continue;
+
+        memset(&loop, 0, sizeof(loop));
+        memset(&gen, 0, sizeof(gen));
+        gen.loop = &loop;
+        gen.size = compiler->vectorize_avx2 ? 32 : 16;
+        if (!vectorize_match(&gen, tac) || !vectorize_body(&gen) || !vectorize_profitable(&gen, tac))
+        {
+            if (compiler->verbose)
+                fprintf(compiler->diagnostics, "vectorize: %s not vectorized: %s\n", tac->res->text, gen.reason);
+            continue;
+        }
+
+        loop.start = vectorize_name(loop.label, "_vector");
+        loop.end = vectorize_name(loop.label, "_vector_end");
+        if (compiler->vector->count == compiler->vector->capacity)
+        {
+            compiler->vector->capacity = compiler->vector->capacity ? compiler->vector->capacity * 2 : 16;
+            compiler->vector->loops = (VLOOP *)realloc(compiler->vector->loops, compiler->vector->capacity * sizeof(VLOOP));
+        }
+        compiler->vector->loops[compiler->vector->count++] = loop;
+        if (compiler->verbose)
+            fprintf(compiler->diagnostics, "vectorize: %s vectorized over %s, %d lanes of %s\n", tac->res->text, loop.induction->text, gen.size / 4, compiler->vectorize_avx2 ? "avx2" : "sse2");
+    }
+}
+
+VLOOP *vectorize_find(HASH *label)
+{
+    int i;
+    for (i = 0; i < compiler->vector->count; i++)
+    {
+        if (compiler->vector->loops[i].label == label)
+            return &compiler->vector->loops[i];
+    }
+    return NULL;
+}
+
+void vectorize_emit(MCODE *code, VLOOP *loop)
+{
+    VGEN gen;
+    memset(&gen, 0, sizeof(gen));
+    gen.code = code;
+    gen.loop = loop;
+    gen.size = compiler->vectorize_avx2 ? 32 : 16;
+    vectorize_body(&gen);
+}
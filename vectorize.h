@@ -0,0 +1,64 @@
+#pragma once
+#include "tac.h"
+#include "isel.h"
+#include "profile.h"
+
+#define VECTOR_MAX_VALUES 64
+#define VECTOR_MAX_BASES 8
+#define VECTOR_MAX_ACCESSES 64
+
+// a counted loop the vectorizer accepted; the packed loop runs in front of the scalar
+// one, which stays in place and finishes the iterations that do not fill a register
+typedef struct vloop
+{
+    HASH *label;     // loop_start_label of the scalar loop
+    HASH *induction;
+    HASH *bound;     // literal, variable or the temp computed by bound_tac
+    TAC *bound_tac;  // temp = a + b or a - b in the condition, or NULL
+    int inclusive;   // i <= bound rather than i < bound
+    TAC *body;       // first statement after the body label
+    TAC *step;       // i = i + 1 closing the body
+    char *start;     // labels of the packed loop
+    char *end;
+} VLOOP;
+
+// where each vector of the body is addressed from, and at which offsets
+typedef struct vaccess
+{
+    HASH *vector;
+    int offset;
+    int store;
+} VACCESS;
+
+// state while walking one loop body; code is NULL while the loop is only being checked
+typedef struct vgen
+{
+    MCODE *code;
+    VLOOP *loop;
+    int size;         // 16 for SSE2, 32 for AVX2
+    char reason[160]; // why the loop was rejected
+    HASH *value[VECTOR_MAX_VALUES];
+    int value_reg[VECTOR_MAX_VALUES];
+    int value_cls[VECTOR_MAX_VALUES];
+    int value_count;
+    HASH *index[VECTOR_MAX_VALUES]; // temps holding i + constant
+    int index_offset[VECTOR_MAX_VALUES];
+    int index_count;
+    HASH *vector[VECTOR_MAX_BASES];
+    int vector_count;
+    VACCESS access[VECTOR_MAX_ACCESSES];
+    int access_count;
+    int xmm_used[8];
+} VGEN;
+
+// loops of one compilation that vectorize_analyze accepted
+typedef struct vector_state
+{
+    VLOOP *loops;
+    int count;
+    int capacity;
+} VECTOR_STATE;
+
+void vectorize_analyze(TAC *first);
+VLOOP *vectorize_find(HASH *label);
+void vectorize_emit(MCODE *code, VLOOP *loop);
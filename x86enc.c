@@ -0,0 +1,649 @@
+#include "x86enc.h"
+
+// condition code field of setcc/jcc, indexed by CC_*
+int x86_cc_bits[] = {0x4, 0x5, 0xC, 0xD, 0xE, 0xF, 0x2, 0x3, 0x6, 0x7, 0xA, 0xB};
+
+void xb_byte(XBUFFER *buffer, int value)
+{
+    if (buffer->length == buffer->capacity)
+    {
+        buffer->capacity = buffer->capacity ? buffer->capacity * 2 : 4096;
+        buffer->data = (unsigned char *)realloc(buffer->data, buffer->capacity);
+    }
+    buffer->data[buffer->length++] = (unsigned char)value;
+}
+
+void xb_int32(XBUFFER *buffer, int value)
+{
+    xb_byte(buffer, value);
+    xb_byte(buffer, value >> 8);
+    xb_byte(buffer, value >> 16);
+    xb_byte(buffer, value >> 24);
+}
+
+unsigned int x86_hash_name(char *name)
+{
+    unsigned int h = 2166136261u;
+    for (; *name; name++)
+        h = (h ^ (unsigned char)*name) * 16777619u;
+    return h % XSYM_HASH_SIZE;
+}
+
+XSYMBOL *x86_symbol(XOBJECT *obj, char *name)
+{
+    unsigned int h = x86_hash_name(name);
+    XSYMBOL *symbol;
+    for (symbol = obj->symbols[h]; symbol; symbol = symbol->next)
+    {
+        if (strcmp(symbol->name, name) == 0)
+            return symbol;
+    }
+
+    symbol = (XSYMBOL *)arena_alloc(&obj->arena, sizeof(XSYMBOL));
+    symbol->name = (char *)arena_alloc(&obj->arena, strlen(name) + 1);
+    strcpy(symbol->name, name);
+    symbol->next = obj->symbols[h];
+    obj->symbols[h] = symbol;
+    if (obj->last_symbol)
+        obj->last_symbol->next_list = symbol;
+    else
+        obj->first_symbol = symbol;
+    obj->last_symbol = symbol;
+    return symbol;
+}
+
+// external names are written name@PLT in the assembly
+XSYMBOL *x86_operand_symbol(XOBJECT *obj, MOPERAND *operand, int *plt)
+{
+    char name[160];
+    char *at;
+    minstr_format_symbol(name, &operand->symbol);
+    at = strchr(name, '@');
+    *plt = at != NULL;
+    if (at)
+        *at = '\0';
+    return x86_symbol(obj, name);
+}
+
+void x86_reloc(XOBJECT *obj, int type, XSYMBOL *symbol, int addend)
+{
+    XRELOC *reloc;
+    if (obj->reloc_count == obj->reloc_capacity)
+    {
+        obj->reloc_capacity = obj->reloc_capacity ? obj->reloc_capacity * 2 : 1024;
+        obj->relocs = (XRELOC *)realloc(obj->relocs, obj->reloc_capacity * sizeof(XRELOC));
+    }
+    reloc = &obj->relocs[obj->reloc_count++];
+    reloc->section = obj->current;
+    reloc->offset = obj->section[obj->current].length;
+    reloc->type = type;
+    reloc->addend = addend;
+    reloc->symbol = symbol;
+}
+
+int x86_reg(int reg)
+{
+    return reg >= REG_XMM0 ? reg - REG_XMM0 : reg;
+}
+
+int x86_fits8(int value)
+{
+    return value >= -128 && value <= 127;
+}
+
+// byte_regs flags: spl/bpl/sil/dil need a REX prefix to be addressed
+#define X86_BYTE_RM 1
+#define X86_BYTE_REG 2
+
+// ModRM, SIB and displacement; r is the register or /digit field
+void x86_modrm(XOBJECT *obj, int r, MOPERAND *rm, int imm_size)
+{
+    XBUFFER *out = &obj->section[obj->current];
+    if (rm->kind == MOP_REG)
+    {
+        xb_byte(out, 0xC0 | ((r & 7) << 3) | (x86_reg(rm->reg) & 7));
+    }
+    else if (rm->symbol.kind != MSYM_NONE)
+    {
+        int plt;
+        XSYMBOL *symbol = x86_operand_symbol(obj, rm, &plt);
+        xb_byte(out, ((r & 7) << 3) | 5);
+        x86_reloc(obj, XRELOC_PC32, symbol, rm->disp - 4 - imm_size);
+        xb_int32(out, 0);
+    }
+    else
+    {
+        int base = rm->reg & 7;
+        int mod = rm->disp == 0 && base != 5 ? 0 : x86_fits8(rm->disp) ? 1 : 2;
+        if (rm->index != REG_NONE)
+        {
+            int scale = rm->scale == 8 ? 3 : rm->scale == 4 ? 2 : rm->scale == 2 ? 1 : 0;
+            xb_byte(out, (mod << 6) | ((r & 7) << 3) | 4);
+            xb_byte(out, (scale << 6) | ((rm->index & 7) << 3) | base);
+        }
+        else
+        {
+            xb_byte(out, (mod << 6) | ((r & 7) << 3) | base);
+            if (base == 4)
+                xb_byte(out, 0x24);
+        }
+        if (mod == 1)
+            xb_byte(out, rm->disp);
+        else if (mod == 2)
+            xb_int32(out, rm->disp);
+    }
+}
+
+// prefix, REX, opcode, ModRM, SIB and displacement for a reg, r/m operand pair;
+// imm_size is the number of immediate bytes the caller appends afterwards
+void x86_rm(XOBJECT *obj, int prefix, int w, int opcode, int opcode_bytes, int reg, MOPERAND *rm, int byte_regs, int imm_size)
+{
+    XBUFFER *out = &obj->section[obj->current];
+    int rex = w ? 0x08 : 0;
+    int r = x86_reg(reg);
+    int i;
+
+    if (r & 8)
+        rex |= 0x04;
+    if (rm->kind == MOP_REG)
+    {
+        int b = x86_reg(rm->reg);
+        if (b & 8)
+            rex |= 0x01;
+        if ((byte_regs & X86_BYTE_RM) && b >= 4 && b < 8)
+            rex |= 0x40;
+    }
+    else if (rm->kind == MOP_MEM && rm->symbol.kind == MSYM_NONE)
+    {
+        if (rm->reg >= 0 && (rm->reg & 8))
+            rex |= 0x01;
+        if (rm->index >= 0 && (rm->index & 8))
+            rex |= 0x02;
+    }
+    if ((byte_regs & X86_BYTE_REG) && r >= 4 && r < 8)
+        rex |= 0x40;
+
+    if (prefix)
+        xb_byte(out, prefix);
+    if (rex)
+        xb_byte(out, 0x40 | rex);
+    for (i = opcode_bytes - 1; i >= 0; i--)
+        xb_byte(out, (opcode >> (8 * i)) & 0xFF);
+
+    x86_modrm(obj, r, rm, imm_size);
+}
+
+// VEX form of the 0F (map 1) and 0F38 (map 2) opcodes; pp selects the implied 66/F3/F2 prefix
+// and vvvv names the extra source register, REG_NONE when the instruction has none
+void x86_vex(XOBJECT *obj, int pp, int map, int l, int opcode, int reg, int vvvv, MOPERAND *rm, int imm_size)
+{
+    XBUFFER *out = &obj->section[obj->current];
+    int r = x86_reg(reg);
+    int v = vvvv == REG_NONE ? 0 : x86_reg(vvvv);
+    int x = 0;
+    int b = 0;
+
+    if (rm->kind == MOP_REG)
+        b = x86_reg(rm->reg) >> 3;
+    else if (rm->kind == MOP_MEM && rm->symbol.kind == MSYM_NONE)
+    {
+        b = rm->reg >= 0 ? (rm->reg >> 3) & 1 : 0;
+        x = rm->index >= 0 ? (rm->index >> 3) & 1 : 0;
+    }
+
+    // R, X, B and vvvv are stored inverted; the two byte form implies X = B = 0 and map 1
+    if (!x && !b && map == 1)
+    {
+        xb_byte(out, 0xC5);
+        xb_byte(out, ((~r & 8) << 4) | ((~v & 15) << 3) | (l << 2) | pp);
+    }
+    else
+    {
+        xb_byte(out, 0xC4);
+        xb_byte(out, ((~r & 8) << 4) | (!x << 6) | (!b << 5) | map);
+        xb_byte(out, ((~v & 15) << 3) | (l << 2) | pp);
+    }
+    xb_byte(out, opcode);
+    x86_modrm(obj, r, rm, imm_size);
+}
+
+// add/or/and/sub/xor/cmp share one encoding family, selected by the /digit
+void x86_alu(XOBJECT *obj, MINSTR *instr, int digit)
+{
+    XBUFFER *out = &obj->section[obj->current];
+    int w = instr->size == 8;
+    int byte = instr->size == 1;
+    if (instr->src.kind == MOP_IMM)
+    {
+        if (byte)
+        {
+            x86_rm(obj, 0, 0, 0x80, 1, digit, &instr->dst, X86_BYTE_RM, 1);
+            xb_byte(out, instr->src.disp);
+        }
+        else if (x86_fits8(instr->src.disp))
+        {
+            x86_rm(obj, 0, w, 0x83, 1, digit, &instr->dst, 0, 1);
+            xb_byte(out, instr->src.disp);
+        }
+        else
+        {
+            x86_rm(obj, 0, w, 0x81, 1, digit, &instr->dst, 0, 4);
+            xb_int32(out, instr->src.disp);
+        }
+    }
+    else if (instr->src.kind == MOP_REG)
+    {
+        x86_rm(obj, 0, w, digit * 8 + (byte ? 0 : 1), 1, instr->src.reg, &instr->dst, byte ? X86_BYTE_RM | X86_BYTE_REG : 0, 0);
+    }
+    else
+    {
+        x86_rm(obj, 0, w, digit * 8 + (byte ? 2 : 3), 1, instr->dst.reg, &instr->src, byte ? X86_BYTE_RM | X86_BYTE_REG : 0, 0);
+    }
+}
+
+// packed operations, indexed from MI_MOVUPS: pp prefix (1 = 66), opcode map (1 = 0F, 2 = 0F38),
+// opcode byte and the /digit of the shift-by-immediate forms
+typedef struct x86_packed_form
+{
+    int pp;
+    int map;
+    int opcode;
+    int digit;
+} X86_PACKED_FORM;
+
+X86_PACKED_FORM x86_packed_forms[] = {
+    {0, 1, 0x10, -1}, // movups
+    {1, 1, 0x70, -1}, // pshufd
+    {1, 2, 0x58, -1}, // vpbroadcastd
+    {1, 1, 0xFE, -1}, // paddd
+    {1, 1, 0xFA, -1}, // psubd
+    {1, 2, 0x40, -1}, // pmulld
+    {1, 1, 0x72, 6},  // pslld
+    {1, 1, 0x72, 2},  // psrld
+    {1, 1, 0xDB, -1}, // pand
+    {1, 1, 0xEB, -1}, // por
+    {1, 1, 0x76, -1}, // pcmpeqd
+    {1, 1, 0x66, -1}, // pcmpgtd
+    {0, 1, 0x58, -1}, // addps
+    {0, 1, 0x5C, -1}, // subps
+    {0, 1, 0x59, -1}, // mulps
+    {0, 1, 0x5E, -1}, // divps
+    {0, 1, 0xC2, -1}, // cmpps
+};
+
+// size 32 selects the 256-bit VEX form, anything else the legacy SSE one
+void x86_packed(XOBJECT *obj, MINSTR *instr, X86_PACKED_FORM *form)
+{
+    XBUFFER *out = &obj->section[obj->current];
+    int vex = instr->size == 32;
+    int reads_dst = instr->op != MI_MOVUPS && instr->op != MI_PSHUFD && instr->op != MI_VPBROADCASTD;
+    int imm8 = instr->op == MI_PSHUFD || instr->op == MI_CMPPS;
+    int opcode = form->opcode;
+
+    if (instr->op == MI_MOVUPS && instr->dst.kind == MOP_MEM)
+    {
+        if (vex)
+            x86_vex(obj, form->pp, form->map, 1, opcode + 1, instr->src.reg, REG_NONE, &instr->dst, 0);
+        else
+            x86_rm(obj, 0, 0, 0x0F00 | (opcode + 1), 2, instr->src.reg, &instr->dst, 0, 0);
+        return;
+    }
+
+    if (form->digit >= 0)
+    {
+        // shift by immediate: the register is the r/m operand, VEX names the destination in vvvv
+        if (vex)
+            x86_vex(obj, form->pp, form->map, 1, opcode, form->digit, instr->dst.reg, &instr->dst, 1);
+        else
+            x86_rm(obj, form->pp ? 0x66 : 0, 0, 0x0F00 | opcode, 2, form->digit, &instr->dst, 0, 1);
+        xb_byte(out, instr->src.disp);
+        return;
+    }
+
+    if (vex)
+        x86_vex(obj, form->pp, form->map, 1, opcode, instr->dst.reg, reads_dst ? instr->dst.reg : REG_NONE, &instr->src, imm8);
+    else if (form->map == 2)
+        x86_rm(obj, form->pp ? 0x66 : 0, 0, 0x0F3800 | opcode, 3, instr->dst.reg, &instr->src, 0, imm8);
+    else
+        x86_rm(obj, form->pp ? 0x66 : 0, 0, 0x0F00 | opcode, 2, instr->dst.reg, &instr->src, 0, imm8);
+    if (imm8)
+        xb_byte(out, instr->cc);
+}
+
+void x86_branch(XOBJECT *obj, MOPERAND *target)
+{
+    int plt;
+    XSYMBOL *symbol = x86_operand_symbol(obj, target, &plt);
+    x86_reloc(obj, plt ? XRELOC_PLT32 : XRELOC_PC32, symbol, -4);
+    xb_int32(&obj->section[obj->current], 0);
+}
+
+// decodes the escapes gas accepts in .string literals
+void x86_string(XBUFFER *out, char *text)
+{
+    char *c = text + 1;
+    while (*c && *c != '"')
+    {
+        if (*c != '\\')
+        {
+            xb_byte(out, *c++);
+            continue;
+        }
+        c++;
+        switch (*c)
+        {
+        case 'n':
+            xb_byte(out, '\n');
+            c++;
+            break;
+        case 't':
+            xb_byte(out, '\t');
+            c++;
+            break;
+        case 'r':
+            xb_byte(out, '\r');
+            c++;
+            break;
+        case '0':
+        case '1':
+        case '2':
+        case '3':
+        case '4':
+        case '5':
+        case '6':
+        case '7':
+        {
+            int value = 0;
+            int digits;
+            for (digits = 0; digits < 3 && *c >= '0' && *c <= '7'; digits++)
+                value = value * 8 + (*c++ - '0');
+            xb_byte(out, value);
+            break;
+        }
+        default:
+            if (*c)
+                xb_byte(out, *c++);
+        }
+    }
+    xb_byte(out, 0);
+}
+
+void x86_data(XOBJECT *obj, int bytes, int value)
+{
+    int i;
+    if (obj->current == XSEC_BSS)
+    {
+        obj->bss_size += bytes;
+        return;
+    }
+    for (i = 0; i < bytes; i++)
+        xb_byte(&obj->section[obj->current], i < 4 ? value >> (8 * i) : 0);
+}
+
+int x86_section_size(XOBJECT *obj, int section)
+{
+    return section == XSEC_BSS ? obj->bss_size : obj->section[section].length;
+}
+
+void x86_define(XOBJECT *obj, MOPERAND *operand, int type)
+{
+    int plt;
+    XSYMBOL *symbol = x86_operand_symbol(obj, operand, &plt);
+    symbol->section = obj->current;
+    symbol->offset = x86_section_size(obj, obj->current);
+    if (type != XSYM_NOTYPE)
+        symbol->type = type;
+    if (type == XSYM_FUNC)
+        symbol->global = 1;
+}
+
+void x86_instr(XOBJECT *obj, MINSTR *instr)
+{
+    XBUFFER *out = &obj->section[obj->current];
+    int w = instr->size == 8;
+
+    switch (instr->op)
+    {
+    case MI_SECTION:
+    {
+        char *name = instr->dst.symbol.name;
+        obj->current = strcmp(name, ".text") == 0 ? XSEC_TEXT : strcmp(name, ".rodata") == 0 ? XSEC_RODATA : strcmp(name, ".bss") == 0 ? XSEC_BSS : XSEC_DATA;
+        break;
+    }
+    case MI_LABEL:
+        x86_define(obj, &instr->dst, XSYM_NOTYPE);
+        break;
+    case MI_FUNCTION:
+        x86_define(obj, &instr->dst, XSYM_FUNC);
+        break;
+    case MI_GLOBL:
+    {
+        int plt;
+        x86_operand_symbol(obj, &instr->dst, &plt)->global = 1;
+        break;
+    }
+    case MI_OBJECT:
+    {
+        int plt;
+        XSYMBOL *symbol = x86_operand_symbol(obj, &instr->dst, &plt);
+        symbol->type = XSYM_OBJECT;
+        symbol->size = instr->src.disp;
+        break;
+    }
+    case MI_ALIGN:
+        while (x86_section_size(obj, obj->current) % instr->dst.disp)
+            x86_data(obj, 1, 0);
+        break;
+    case MI_LONG:
+        x86_data(obj, 4, instr->dst.disp);
+        break;
+    case MI_FLOAT:
+    {
+        float value = strtof(instr->dst.symbol.name, NULL);
+        int bits;
+        memcpy(&bits, &value, sizeof(bits));
+        x86_data(obj, 4, bits);
+        break;
+    }
+    case MI_STRING:
+        x86_string(out, instr->dst.symbol.name);
+        break;
+    case MI_ZERO:
+        x86_data(obj, instr->dst.disp, 0);
+        break;
+    case MI_MOV:
+        if (instr->src.kind == MOP_IMM && instr->size == 1)
+        {
+            x86_rm(obj, 0, 0, 0xC6, 1, 0, &instr->dst, X86_BYTE_RM, 1);
+            xb_byte(out, instr->src.disp);
+        }
+        else if (instr->src.kind == MOP_IMM)
+        {
+            x86_rm(obj, 0, w, 0xC7, 1, 0, &instr->dst, 0, 4);
+            xb_int32(out, instr->src.disp);
+        }
+        else if (instr->src.kind == MOP_REG && instr->size == 1)
+        {
+            x86_rm(obj, 0, 0, 0x88, 1, instr->src.reg, &instr->dst, X86_BYTE_RM | X86_BYTE_REG, 0);
+        }
+        else if (instr->src.kind == MOP_REG)
+        {
+            x86_rm(obj, 0, w, 0x89, 1, instr->src.reg, &instr->dst, 0, 0);
+        }
+        else
+        {
+            x86_rm(obj, 0, w, 0x8B, 1, instr->dst.reg, &instr->src, 0, 0);
+        }
+        break;
+    case MI_MOVSLQ:
+        x86_rm(obj, 0, 1, 0x63, 1, instr->dst.reg, &instr->src, 0, 0);
+        break;
+    case MI_MOVZB:
+        x86_rm(obj, 0, 0, 0x0FB6, 2, instr->dst.reg, &instr->src, X86_BYTE_RM, 0);
+        break;
+    case MI_LEA:
+        x86_rm(obj, 0, w, 0x8D, 1, instr->dst.reg, &instr->src, 0, 0);
+        break;
+    case MI_ADD:
+        x86_alu(obj, instr, 0);
+        break;
+    case MI_OR:
+        x86_alu(obj, instr, 1);
+        break;
+    case MI_AND:
+        x86_alu(obj, instr, 4);
+        break;
+    case MI_SUB:
+        x86_alu(obj, instr, 5);
+        break;
+    case MI_XOR:
+        x86_alu(obj, instr, 6);
+        break;
+    case MI_CMP:
+        x86_alu(obj, instr, 7);
+        break;
+    case MI_TEST:
+        if (instr->src.kind == MOP_IMM)
+        {
+            x86_rm(obj, 0, w, 0xF7, 1, 0, &instr->dst, 0, 4);
+            xb_int32(out, instr->src.disp);
+        }
+        else if (instr->src.kind == MOP_REG)
+        {
+            x86_rm(obj, 0, w, 0x85, 1, instr->src.reg, &instr->dst, 0, 0);
+        }
+        else
+        {
+            x86_rm(obj, 0, w, 0x85, 1, instr->dst.reg, &instr->src, 0, 0);
+        }
+        break;
+    case MI_IMUL:
+        if (instr->src.kind == MOP_IMM && x86_fits8(instr->src.disp))
+        {
+            x86_rm(obj, 0, w, 0x6B, 1, instr->dst.reg, &instr->dst, 0, 1);
+            xb_byte(out, instr->src.disp);
+        }
+        else if (instr->src.kind == MOP_IMM)
+        {
+            x86_rm(obj, 0, w, 0x69, 1, instr->dst.reg, &instr->dst, 0, 4);
+            xb_int32(out, instr->src.disp);
+        }
+        else
+        {
+            x86_rm(obj, 0, w, 0x0FAF, 2, instr->dst.reg, &instr->src, 0, 0);
+        }
+        break;
+    case MI_NEG:
+        x86_rm(obj, 0, w, 0xF7, 1, 3, &instr->dst, 0, 0);
+        break;
+    case MI_IDIV:
+        x86_rm(obj, 0, w, 0xF7, 1, 7, &instr->dst, 0, 0);
+        break;
+    case MI_SHL:
+        x86_rm(obj, 0, w, 0xC1, 1, 4, &instr->dst, 0, 1);
+        xb_byte(out, instr->src.disp);
+        break;
+    case MI_CLTD:
+        xb_byte(out, 0x99);
+        break;
+    case MI_SETCC:
+        x86_rm(obj, 0, 0, 0x0F90 | x86_cc_bits[instr->cc], 2, 0, &instr->dst, X86_BYTE_RM, 0);
+        break;
+    case MI_JCC:
+        xb_byte(out, 0x0F);
+        xb_byte(out, 0x80 | x86_cc_bits[instr->cc]);
+        x86_branch(obj, &instr->dst);
+        break;
+    case MI_JMP:
+        xb_byte(out, 0xE9);
+        x86_branch(obj, &instr->dst);
+        break;
+    case MI_CALL:
+        xb_byte(out, 0xE8);
+        x86_branch(obj, &instr->dst);
+        break;
+    case MI_RET:
+        xb_byte(out, 0xC3);
+        break;
+    case MI_PUSH:
+    case MI_POP:
+        if (instr->dst.reg & 8)
+            xb_byte(out, 0x41);
+        xb_byte(out, (instr->op == MI_PUSH ? 0x50 : 0x58) + (instr->dst.reg & 7));
+        break;
+    case MI_MOVSS:
+        if (instr->dst.kind == MOP_MEM)
+            x86_rm(obj, 0xF3, 0, 0x0F11, 2, instr->src.reg, &instr->dst, 0, 0);
+        else
+            x86_rm(obj, 0xF3, 0, 0x0F10, 2, instr->dst.reg, &instr->src, 0, 0);
+        break;
+    case MI_ADDSS:
+        x86_rm(obj, 0xF3, 0, 0x0F58, 2, instr->dst.reg, &instr->src, 0, 0);
+        break;
+    case MI_MULSS:
+        x86_rm(obj, 0xF3, 0, 0x0F59, 2, instr->dst.reg, &instr->src, 0, 0);
+        break;
+    case MI_SUBSS:
+        x86_rm(obj, 0xF3, 0, 0x0F5C, 2, instr->dst.reg, &instr->src, 0, 0);
+        break;
+    case MI_DIVSS:
+        x86_rm(obj, 0xF3, 0, 0x0F5E, 2, instr->dst.reg, &instr->src, 0, 0);
+        break;
+    case MI_COMISS:
+        x86_rm(obj, 0, 0, 0x0F2F, 2, instr->dst.reg, &instr->src, 0, 0);
+        break;
+    case MI_UCOMISS:
+        x86_rm(obj, 0, 0, 0x0F2E, 2, instr->dst.reg, &instr->src, 0, 0);
+        break;
+    case MI_CVTSS2SD:
+        x86_rm(obj, 0xF3, 0, 0x0F5A, 2, instr->dst.reg, &instr->src, 0, 0);
+        break;
+    case MI_CVTSI2SS:
+        x86_rm(obj, 0xF3, instr->size == 8, 0x0F2A, 2, instr->dst.reg, &instr->src, 0, 0);
+        break;
+    case MI_PXOR:
+        if (instr->size == 32)
+            x86_vex(obj, 1, 1, 1, 0xEF, instr->dst.reg, instr->dst.reg, &instr->src, 0);
+        else
+            x86_rm(obj, 0x66, 0, 0x0FEF, 2, instr->dst.reg, &instr->src, 0, 0);
+        break;
+    case MI_MOVD:
+        if (instr->src.kind == MOP_REG && instr->src.reg >= REG_XMM0)
+            x86_rm(obj, 0x66, 0, 0x0F7E, 2, instr->src.reg, &instr->dst, 0, 0);
+        else
+            x86_rm(obj, 0x66, 0, 0x0F6E, 2, instr->dst.reg, &instr->src, 0, 0);
+        break;
+    case MI_VZEROUPPER:
+        xb_byte(out, 0xC5);
+        xb_byte(out, 0xF8);
+        xb_byte(out, 0x77);
+        break;
+    default:
+        if (instr->op >= MI_MOVUPS && instr->op <= MI_CMPPS)
+        {
+            x86_packed(obj, instr, &x86_packed_forms[instr->op - MI_MOVUPS]);
+            break;
+        }
+        compiler_fail("x86: cannot encode opcode %d\n", instr->op);
+    }
+}
+
+void x86_assemble(XOBJECT *obj, MCODE *code)
+{
+    MINSTR *instr;
+    if (obj->current == XSEC_UNDEF)
+        obj->current = XSEC_TEXT;
+    for (instr = code->first; instr; instr = instr->next)
+    {
+        x86_instr(obj, instr);
+    }
+}
+
+void x86_release(XOBJECT *obj)
+{
+    int i;
+    for (i = 0; i < XSEC_COUNT; i++)
+        free(obj->section[i].data);
+    free(obj->relocs);
+    arena_free(&obj->arena);
+}
@@ -0,0 +1,69 @@
+#pragma once
+#include "minstr.h"
+
+// sections, numbered as in the object file
+#define XSEC_UNDEF 0
+#define XSEC_TEXT 1
+#define XSEC_DATA 2
+#define XSEC_RODATA 3
+#define XSEC_BSS 4
+#define XSEC_COUNT 5
+
+// relocation kinds, both 32-bit and relative to the end of the field plus addend
+#define XRELOC_PC32 0
+#define XRELOC_PLT32 1
+
+#define XSYM_NOTYPE 0
+#define XSYM_OBJECT 1
+#define XSYM_FUNC 2
+
+#define XSYM_HASH_SIZE 4096
+
+typedef struct xbuffer
+{
+    unsigned char *data;
+    int length;
+    int capacity;
+} XBUFFER;
+
+typedef struct xsymbol
+{
+    char *name;
+    int section; // XSEC_UNDEF until defined
+    int offset;
+    int global;
+    int type;
+    int size;
+    int index;   // symbol table index, assigned by the object writer
+    void *address; // where an undefined symbol lives when linked in process
+    struct xsymbol *next;      // hash chain
+    struct xsymbol *next_list; // definition order
+} XSYMBOL;
+
+typedef struct xreloc
+{
+    int section;
+    int offset;
+    int type;
+    int addend;
+    XSYMBOL *symbol;
+} XRELOC;
+
+typedef struct xobject
+{
+    XBUFFER section[XSEC_COUNT];
+    int bss_size;
+    int current;
+    XSYMBOL *symbols[XSYM_HASH_SIZE];
+    XSYMBOL *first_symbol;
+    XSYMBOL *last_symbol;
+    XRELOC *relocs;
+    int reloc_count;
+    int reloc_capacity;
+    ARENA arena;
+} XOBJECT;
+
+XSYMBOL *x86_symbol(XOBJECT *obj, char *name);
+void x86_assemble(XOBJECT *obj, MCODE *code);
+int x86_section_size(XOBJECT *obj, int section);
+void x86_release(XOBJECT *obj);
@@ -55,7 +55,7 @@
 #define YYSKELETON_NAME "yacc.c"
 
 /* Pure parsers.  */
-#define YYPURE 0
+#define YYPURE 2
 
 /* Push parsers.  */
 #define YYPUSH 0
@@ -75,10 +75,15 @@
 #include "semantic.h"
 #include "tac.h"
 #include "asmgen.h"
-int SyntaxErrors = 0;
-int optimize = 0;
+#include "interp.h"
 
-#line 82 "y.tab.c"
+// the parser takes its tokens from lexer_next, which reads the tokens of the context
+// being compiled; the parser is pure, so contexts parse at the same time
+union YYSTYPE;
+int lexer_next(union YYSTYPE *value);
+#define yylex(value) lexer_next(value)
+
+#line 87 "y.tab.c"
 
 # ifndef YY_CAST
 #  ifdef __cplusplus
@@ -175,12 +180,12 @@ extern int yydebug;
 #if ! defined YYSTYPE && ! defined YYSTYPE_IS_DECLARED
 union YYSTYPE
 {
-#line 14 "parser.y"
+#line 21 "parser.y"
 
     HASH* symbol; 
     AST *ast;
 
-#line 184 "y.tab.c"
+#line 189 "y.tab.c"
 
 };
 typedef union YYSTYPE YYSTYPE;
@@ -189,7 +194,6 @@ typedef union YYSTYPE YYSTYPE;
 #endif
 
 
-extern YYSTYPE yylval;
 
 
 int yyparse (void);
@@ -653,23 +657,23 @@ static const yytype_int8 yytranslate[] =
 /* YYRLINE[YYN] -- Source line where rule number YYN was defined.  */
 static const yytype_int16 yyrline[] =
 {
-       0,    79,    79,   149,   150,   151,   154,   155,   156,   160,
-     161,   162,   163,   165,   166,   167,   168,   170,   171,   172,
-     173,   175,   176,   177,   178,   180,   181,   182,   183,   185,
-     186,   187,   188,   191,   192,   193,   194,   196,   197,   198,
-     199,   201,   202,   203,   204,   207,   208,   209,   210,   214,
-     215,   216,   217,   220,   221,   222,   223,   226,   227,   228,
-     229,   231,   232,   233,   234,   237,   238,   239,   240,   243,
-     244,   247,   248,   251,   252,   253,   254,   257,   263,   264,
-     265,   267,   269,   272,   273,   276,   277,   278,   282,   284,
-     285,   286,   287,   288,   289,   291,   292,   293,   296,   297,
-     298,   299,   300,   303,   304,   307,   308,   311,   314,   315,
-     316,   317,   320,   321,   322,   325,   330,   331,   332,   333,
-     336,   337,   339,   340,   341,   343,   344,   345,   347,   348,
-     349,   351,   352,   353,   357,   358,   359,   360,   361,   362,
-     363,   364,   365,   366,   367,   368,   369,   370,   371,   372,
-     373,   374,   375,   376,   377,   378,   383,   385,   386,   387,
-     390,   391,   394,   396,   397
+       0,    86,    86,    89,    90,    91,    94,    95,    96,   100,
+     101,   102,   103,   105,   106,   107,   108,   110,   111,   112,
+     113,   115,   116,   117,   118,   120,   121,   122,   123,   125,
+     126,   127,   128,   131,   132,   133,   134,   136,   137,   138,
+     139,   141,   142,   143,   144,   147,   148,   149,   150,   154,
+     155,   156,   157,   160,   161,   162,   163,   166,   167,   168,
+     169,   171,   172,   173,   174,   177,   178,   179,   180,   183,
+     184,   187,   188,   191,   192,   193,   194,   197,   203,   204,
+     205,   207,   209,   212,   213,   216,   217,   218,   222,   224,
+     225,   226,   227,   228,   229,   231,   232,   233,   236,   237,
+     238,   239,   240,   243,   244,   247,   248,   251,   254,   255,
+     256,   257,   260,   261,   262,   265,   270,   271,   272,   273,
+     276,   277,   279,   280,   281,   283,   284,   285,   287,   288,
+     289,   291,   292,   293,   297,   298,   299,   300,   301,   302,
+     303,   304,   305,   306,   307,   308,   309,   310,   311,   312,
+     313,   314,   315,   316,   317,   318,   323,   325,   326,   327,
+     330,   331,   334,   336,   337
 };
 #endif
 
@@ -1198,13 +1202,6 @@ yydestruct (const char *yymsg,
 }
 
 
-/* Lookahead token kind.  */
-int yychar;
-
-/* The semantic value of the lookahead symbol.  */
-YYSTYPE yylval;
-/* Number of syntax errors so far.  */
-int yynerrs;
 
 
 
@@ -1216,6 +1213,19 @@ int yynerrs;
 int
 yyparse (void)
 {
+/* Lookahead token kind.  */
+int yychar;
+
+
+/* The semantic value of the lookahead symbol.  */
+/* Default value used for initialization, for pacifying older GCCs
+   or non-GCC compilers.  */
+YY_INITIAL_VALUE (static YYSTYPE yyval_default;)
+YYSTYPE yylval YY_INITIAL_VALUE (= yyval_default);
+
+    /* Number of syntax errors so far.  */
+    int yynerrs = 0;
+
     yy_state_fast_t yystate = 0;
     /* Number of tokens to shift before error messages enabled.  */
     int yyerrstatus = 0;
@@ -1368,7 +1378,7 @@ yybackup:
   if (yychar == YYEMPTY)
     {
       YYDPRINTF ((stderr, "Reading a token\n"));
-      yychar = yylex ();
+      yychar = yylex (&yylval);
     }
 
   if (yychar <= YYEOF)
@@ -1456,1052 +1466,985 @@ yyreduce:
   switch (yyn)
     {
   case 2: /* program: declaration_list  */
-#line 79 "parser.y"
-                            { 
-                              
-                                    root = astCreate(AST_PROGRAM, NULL, (yyvsp[0].ast), NULL, NULL, NULL, getLineNumber()); (yyvsp[0].ast) = root; (yyval.ast) = (yyvsp[0].ast);
-                                   
-                                    set_param_list_item_function(root);
-                                    set_expr_list_item_function(root);
-                                    check_and_set_declarations((yyvsp[0].ast));
-                                    check_undeclared();
-                                    
-                                    check_operands((yyvsp[0].ast));
-                                    
-                                    check_assignments((yyvsp[0].ast));	
-                                        
-                                    check_return((yyvsp[0].ast));
-                                        
-                                    check_function_call((yyvsp[0].ast));
-                                    
-                                    check_conditional_stmts((yyvsp[0].ast));
-
-
-                                    if (SyntaxErrors == 0 && SemanticErrors == 0) {
-                                       
-                                        if (optimize) {
-                                            fprintf(stderr, "Generating optimized code...\n");
-                                            ast_collect_loop_elements((yyvsp[0].ast));
-                                            ast_collect_loop_conditions((yyvsp[0].ast));
-                                            ast_collect_loop_variables((yyvsp[0].ast));
-                                            // ast_collect_has_dependencies($1);
-                                           
-                                            ast_collect_varies((yyvsp[0].ast));
-                                            
-                                            ast_set_dependencies((yyvsp[0].ast));
-
-                                            ast_set_varies((yyvsp[0].ast));
-                                            ast_set_order_dependencies((yyvsp[0].ast));
-                                     
-                                           // ast_print_cond_list();
-                                        
-                                            ast_optimize((yyvsp[0].ast));
-                                            if (optimized > 0) {
-                                                ast_handle_marked_assignments((yyvsp[0].ast));
-                                                ast_add_assignment_conds((yyvsp[0].ast));
-                                                fprintf(stderr, "Optimization done!\n");
-                                            } else {
-                                                fprintf(stderr, "No optimization done!\n");
-                                            }
-                                            
-                                        } else {
-                                            fprintf(stderr, "Generating unoptimized code...\n");
-                                        }
-                                      
-                                        TAC * code = generate_code((yyvsp[0].ast));
-                                        code = generate_code((yyvsp[0].ast));
-                                        //tac_print_backwards(code);
-                                        generate_asm(code);
-                                        
-                                    }
-                                
-
-                                
-                                //astPrint($1, 0);
-                                /*AST * test = $1;
-                                test = test->son[0]->son[1]->son[0]->son[1]->son[0]->son[0]->son[0];
-                                int typecheck_result = expression_typecheck(test);
-                                fprintf(stderr, "typecheck result: %d\n", typecheck_result);*/
-
-                               
-                            }
-#line 1529 "y.tab.c"
+#line 86 "parser.y"
+                            { compiler->root = astCreate(AST_PROGRAM, NULL, (yyvsp[0].ast), NULL, NULL, NULL, getLineNumber()); (yyval.ast) = compiler->root; }
+#line 1472 "y.tab.c"
     break;
 
   case 3: /* declaration_list: var_declaration ';' declaration_list  */
-#line 149 "parser.y"
+#line 89 "parser.y"
                                                         { (yyval.ast) = astCreate(AST_DECL_LIST, NULL, (yyvsp[-2].ast), (yyvsp[0].ast), NULL, NULL, getLineNumber()); }
-#line 1535 "y.tab.c"
+#line 1478 "y.tab.c"
     break;
 
   case 4: /* declaration_list: vec_declaration ';' declaration_list  */
-#line 150 "parser.y"
+#line 90 "parser.y"
                                             { (yyval.ast) = astCreate(AST_DECL_LIST, NULL, (yyvsp[-2].ast), (yyvsp[0].ast), NULL, NULL, getLineNumber()); }
-#line 1541 "y.tab.c"
+#line 1484 "y.tab.c"
     break;
 
   case 5: /* declaration_list: func_declaration declaration_list  */
-#line 151 "parser.y"
+#line 91 "parser.y"
                                          { (yyval.ast) = astCreate(AST_DECL_LIST, NULL, (yyvsp[-1].ast), (yyvsp[0].ast), NULL, NULL, getLineNumber()); }
-#line 1547 "y.tab.c"
+#line 1490 "y.tab.c"
     break;
 
   case 6: /* declaration_list: var_declaration error declaration_list  */
-#line 154 "parser.y"
-                                                          { (yyval.ast) = astCreate(AST_DECL_LIST, NULL, (yyvsp[-2].ast), (yyvsp[0].ast), NULL, NULL, getLineNumber()); fprintf(stderr, "Expecting ; on end of variable declaration\n"); SyntaxErrors++; }
-#line 1553 "y.tab.c"
+#line 94 "parser.y"
+                                                          { (yyval.ast) = astCreate(AST_DECL_LIST, NULL, (yyvsp[-2].ast), (yyvsp[0].ast), NULL, NULL, getLineNumber()); fprintf(compiler->diagnostics, "Expecting ; on end of variable declaration\n"); compiler->syntax_errors++; }
+#line 1496 "y.tab.c"
     break;
 
   case 7: /* declaration_list: vec_declaration error declaration_list  */
-#line 155 "parser.y"
-                                                          { (yyval.ast) = astCreate(AST_DECL_LIST, NULL, (yyvsp[-2].ast), (yyvsp[0].ast), NULL, NULL, getLineNumber()); fprintf(stderr, "Expecting ; on end of vector declaration\n"); SyntaxErrors++; }
-#line 1559 "y.tab.c"
+#line 95 "parser.y"
+                                                          { (yyval.ast) = astCreate(AST_DECL_LIST, NULL, (yyvsp[-2].ast), (yyvsp[0].ast), NULL, NULL, getLineNumber()); fprintf(compiler->diagnostics, "Expecting ; on end of vector declaration\n"); compiler->syntax_errors++; }
+#line 1502 "y.tab.c"
     break;
 
   case 8: /* declaration_list: %empty  */
-#line 156 "parser.y"
+#line 96 "parser.y"
                  { (yyval.ast) = 0; }
-#line 1565 "y.tab.c"
+#line 1508 "y.tab.c"
     break;
 
   case 9: /* var_declaration: KW_INT TK_IDENTIFIER '=' LIT_INT  */
-#line 160 "parser.y"
+#line 100 "parser.y"
                                                     { (yyval.ast) = astCreate(AST_VAR_DECL_INT, (yyvsp[-2].symbol), astCreate(AST_LIT_INT, (yyvsp[0].symbol), NULL, NULL, NULL, NULL, getLineNumber()), NULL, NULL, NULL, getLineNumber()); }
-#line 1571 "y.tab.c"
+#line 1514 "y.tab.c"
     break;
 
   case 10: /* var_declaration: KW_CHAR TK_IDENTIFIER '=' LIT_INT  */
-#line 161 "parser.y"
+#line 101 "parser.y"
                                                     { (yyval.ast) = astCreate(AST_VAR_DECL_CHAR, (yyvsp[-2].symbol), astCreate(AST_LIT_INT, (yyvsp[0].symbol), NULL, NULL, NULL, NULL, getLineNumber()), NULL, NULL, NULL, getLineNumber()); }
-#line 1577 "y.tab.c"
+#line 1520 "y.tab.c"
     break;
 
   case 11: /* var_declaration: KW_REAL TK_IDENTIFIER '=' LIT_INT  */
-#line 162 "parser.y"
+#line 102 "parser.y"
                                                       { (yyval.ast) = astCreate(AST_VAR_DECL_REAL, (yyvsp[-2].symbol), astCreate(AST_LIT_INT, (yyvsp[0].symbol), NULL, NULL, NULL, NULL, getLineNumber()), NULL, NULL, NULL, getLineNumber()); }
-#line 1583 "y.tab.c"
+#line 1526 "y.tab.c"
     break;
 
   case 12: /* var_declaration: KW_BOOL TK_IDENTIFIER '=' LIT_INT  */
-#line 163 "parser.y"
+#line 103 "parser.y"
                                                     { (yyval.ast) = astCreate(AST_VAR_DECL_BOOL, (yyvsp[-2].symbol), astCreate(AST_LIT_INT, (yyvsp[0].symbol), NULL, NULL, NULL, NULL, getLineNumber()), NULL, NULL, NULL, getLineNumber()); }
-#line 1589 "y.tab.c"
+#line 1532 "y.tab.c"
     break;
 
   case 13: /* var_declaration: KW_INT TK_IDENTIFIER '=' LIT_CHAR  */
-#line 165 "parser.y"
+#line 105 "parser.y"
                                                     { (yyval.ast) = astCreate(AST_VAR_DECL_INT, (yyvsp[-2].symbol), astCreate(AST_LIT_CHAR, (yyvsp[0].symbol), NULL, NULL, NULL, NULL, getLineNumber()), NULL, NULL, NULL, getLineNumber()); }
-#line 1595 "y.tab.c"
+#line 1538 "y.tab.c"
     break;
 
   case 14: /* var_declaration: KW_CHAR TK_IDENTIFIER '=' LIT_CHAR  */
-#line 166 "parser.y"
+#line 106 "parser.y"
                                                     { (yyval.ast) = astCreate(AST_VAR_DECL_CHAR, (yyvsp[-2].symbol),astCreate(AST_LIT_CHAR, (yyvsp[0].symbol), NULL, NULL, NULL, NULL, getLineNumber()), NULL, NULL, NULL, getLineNumber()); }
-#line 1601 "y.tab.c"
+#line 1544 "y.tab.c"
     break;
 
   case 15: /* var_declaration: KW_REAL TK_IDENTIFIER '=' LIT_CHAR  */
-#line 167 "parser.y"
+#line 107 "parser.y"
                                                      { (yyval.ast) = astCreate(AST_VAR_DECL_REAL, (yyvsp[-2].symbol), astCreate(AST_LIT_CHAR, (yyvsp[0].symbol), NULL, NULL, NULL, NULL, getLineNumber()), NULL, NULL, NULL, getLineNumber()); }
-#line 1607 "y.tab.c"
+#line 1550 "y.tab.c"
     break;
 
   case 16: /* var_declaration: KW_BOOL TK_IDENTIFIER '=' LIT_CHAR  */
-#line 168 "parser.y"
+#line 108 "parser.y"
                                                      { (yyval.ast) = astCreate(AST_VAR_DECL_BOOL, (yyvsp[-2].symbol), astCreate(AST_LIT_CHAR, (yyvsp[0].symbol), NULL, NULL, NULL, NULL, getLineNumber()), NULL, NULL, NULL, getLineNumber()); }
-#line 1613 "y.tab.c"
+#line 1556 "y.tab.c"
     break;
 
   case 17: /* var_declaration: KW_INT TK_IDENTIFIER '=' LIT_REAL  */
-#line 170 "parser.y"
+#line 110 "parser.y"
                                                    { (yyval.ast) = astCreate(AST_VAR_DECL_INT, (yyvsp[-2].symbol), astCreate(AST_LIT_REAL, (yyvsp[0].symbol), NULL, NULL, NULL, NULL, getLineNumber()), NULL, NULL, NULL, getLineNumber()); }
-#line 1619 "y.tab.c"
+#line 1562 "y.tab.c"
     break;
 
   case 18: /* var_declaration: KW_CHAR TK_IDENTIFIER '=' LIT_REAL  */
-#line 171 "parser.y"
+#line 111 "parser.y"
                                                     { (yyval.ast) = astCreate(AST_VAR_DECL_CHAR, (yyvsp[-2].symbol), astCreate(AST_LIT_REAL, (yyvsp[0].symbol), NULL, NULL, NULL, NULL, getLineNumber()), NULL, NULL, NULL, getLineNumber()); }
-#line 1625 "y.tab.c"
+#line 1568 "y.tab.c"
     break;
 
   case 19: /* var_declaration: KW_REAL TK_IDENTIFIER '=' LIT_REAL  */
-#line 172 "parser.y"
+#line 112 "parser.y"
                                                          { (yyval.ast) = astCreate(AST_VAR_DECL_REAL, (yyvsp[-2].symbol), astCreate(AST_LIT_REAL, (yyvsp[0].symbol), NULL, NULL, NULL, NULL, getLineNumber()), NULL, NULL, NULL, getLineNumber()); }
-#line 1631 "y.tab.c"
+#line 1574 "y.tab.c"
     break;
 
   case 20: /* var_declaration: KW_BOOL TK_IDENTIFIER '=' LIT_REAL  */
-#line 173 "parser.y"
+#line 113 "parser.y"
                                                         { (yyval.ast) = astCreate(AST_VAR_DECL_BOOL, (yyvsp[-2].symbol), astCreate(AST_LIT_REAL, (yyvsp[0].symbol), NULL, NULL, NULL, NULL, getLineNumber()), NULL, NULL, NULL, getLineNumber()); }
-#line 1637 "y.tab.c"
+#line 1580 "y.tab.c"
     break;
 
   case 21: /* var_declaration: KW_INT error '=' LIT_INT  */
-#line 175 "parser.y"
-                                           { (yyval.ast) = astCreate(AST_VAR_DECL_INT, make_missing(DATATYPE_INT), astCreate(AST_LIT_INT, (yyvsp[0].symbol), NULL, NULL, NULL, NULL, getLineNumber()), NULL, NULL, NULL, getLineNumber()); fprintf(stderr, "Expected identifier on variable declaration\n"); SyntaxErrors++; }
-#line 1643 "y.tab.c"
+#line 115 "parser.y"
+                                           { (yyval.ast) = astCreate(AST_VAR_DECL_INT, make_missing(DATATYPE_INT), astCreate(AST_LIT_INT, (yyvsp[0].symbol), NULL, NULL, NULL, NULL, getLineNumber()), NULL, NULL, NULL, getLineNumber()); fprintf(compiler->diagnostics, "Expected identifier on variable declaration\n"); compiler->syntax_errors++; }
+#line 1586 "y.tab.c"
     break;
 
   case 22: /* var_declaration: KW_CHAR error '=' LIT_INT  */
-#line 176 "parser.y"
-                                           { (yyval.ast) = astCreate(AST_VAR_DECL_CHAR, make_missing(DATATYPE_CHAR), astCreate(AST_LIT_INT, (yyvsp[0].symbol), NULL, NULL, NULL, NULL, getLineNumber()), NULL, NULL, NULL, getLineNumber());  fprintf(stderr, "Expected identifier on variable declaration\n"); SyntaxErrors++; }
-#line 1649 "y.tab.c"
+#line 116 "parser.y"
+                                           { (yyval.ast) = astCreate(AST_VAR_DECL_CHAR, make_missing(DATATYPE_CHAR), astCreate(AST_LIT_INT, (yyvsp[0].symbol), NULL, NULL, NULL, NULL, getLineNumber()), NULL, NULL, NULL, getLineNumber());  fprintf(compiler->diagnostics, "Expected identifier on variable declaration\n"); compiler->syntax_errors++; }
+#line 1592 "y.tab.c"
     break;
 
   case 23: /* var_declaration: KW_REAL error '=' LIT_INT  */
-#line 177 "parser.y"
-                                           { (yyval.ast) = astCreate(AST_VAR_DECL_REAL, make_missing(DATATYPE_REAL), astCreate(AST_LIT_INT, (yyvsp[0].symbol), NULL, NULL, NULL, NULL, getLineNumber()), NULL, NULL, NULL, getLineNumber());  fprintf(stderr, "Expected identifier on variable declaration\n"); SyntaxErrors++; }
-#line 1655 "y.tab.c"
+#line 117 "parser.y"
+                                           { (yyval.ast) = astCreate(AST_VAR_DECL_REAL, make_missing(DATATYPE_REAL), astCreate(AST_LIT_INT, (yyvsp[0].symbol), NULL, NULL, NULL, NULL, getLineNumber()), NULL, NULL, NULL, getLineNumber());  fprintf(compiler->diagnostics, "Expected identifier on variable declaration\n"); compiler->syntax_errors++; }
+#line 1598 "y.tab.c"
     break;
 
   case 24: /* var_declaration: KW_BOOL error '=' LIT_INT  */
-#line 178 "parser.y"
-                                           { (yyval.ast) = astCreate(AST_VAR_DECL_BOOL, make_missing(DATATYPE_BOOL), astCreate(AST_LIT_INT, (yyvsp[0].symbol), NULL, NULL, NULL, NULL, getLineNumber()), NULL, NULL, NULL, getLineNumber());  fprintf(stderr, "Expected identifier on variable declaration\n"); SyntaxErrors++; }
-#line 1661 "y.tab.c"
+#line 118 "parser.y"
+                                           { (yyval.ast) = astCreate(AST_VAR_DECL_BOOL, make_missing(DATATYPE_BOOL), astCreate(AST_LIT_INT, (yyvsp[0].symbol), NULL, NULL, NULL, NULL, getLineNumber()), NULL, NULL, NULL, getLineNumber());  fprintf(compiler->diagnostics, "Expected identifier on variable declaration\n"); compiler->syntax_errors++; }
+#line 1604 "y.tab.c"
     break;
 
   case 25: /* var_declaration: KW_INT error '=' LIT_CHAR  */
-#line 180 "parser.y"
-                                            { (yyval.ast) = astCreate(AST_VAR_DECL_INT, make_missing(DATATYPE_INT), astCreate(AST_LIT_CHAR, (yyvsp[0].symbol), NULL, NULL, NULL, NULL, getLineNumber()), NULL, NULL, NULL, getLineNumber()); fprintf(stderr, "Expected identifier on variable declaration\n"); SyntaxErrors++; }
-#line 1667 "y.tab.c"
+#line 120 "parser.y"
+                                            { (yyval.ast) = astCreate(AST_VAR_DECL_INT, make_missing(DATATYPE_INT), astCreate(AST_LIT_CHAR, (yyvsp[0].symbol), NULL, NULL, NULL, NULL, getLineNumber()), NULL, NULL, NULL, getLineNumber()); fprintf(compiler->diagnostics, "Expected identifier on variable declaration\n"); compiler->syntax_errors++; }
+#line 1610 "y.tab.c"
     break;
 
   case 26: /* var_declaration: KW_CHAR error '=' LIT_CHAR  */
-#line 181 "parser.y"
-                                            { (yyval.ast) = astCreate(AST_VAR_DECL_CHAR, make_missing(DATATYPE_CHAR), astCreate(AST_LIT_CHAR, (yyvsp[0].symbol), NULL, NULL, NULL, NULL, getLineNumber()), NULL, NULL, NULL, getLineNumber());  fprintf(stderr, "Expected identifier on variable declaration\n"); SyntaxErrors++; }
-#line 1673 "y.tab.c"
+#line 121 "parser.y"
+                                            { (yyval.ast) = astCreate(AST_VAR_DECL_CHAR, make_missing(DATATYPE_CHAR), astCreate(AST_LIT_CHAR, (yyvsp[0].symbol), NULL, NULL, NULL, NULL, getLineNumber()), NULL, NULL, NULL, getLineNumber());  fprintf(compiler->diagnostics, "Expected identifier on variable declaration\n"); compiler->syntax_errors++; }
+#line 1616 "y.tab.c"
     break;
 
   case 27: /* var_declaration: KW_REAL error '=' LIT_CHAR  */
-#line 182 "parser.y"
-                                            { (yyval.ast) = astCreate(AST_VAR_DECL_REAL, make_missing(DATATYPE_REAL), astCreate(AST_LIT_CHAR, (yyvsp[0].symbol), NULL, NULL, NULL, NULL, getLineNumber()), NULL, NULL, NULL, getLineNumber());  fprintf(stderr, "Expected identifier on variable declaration\n"); SyntaxErrors++; }
-#line 1679 "y.tab.c"
+#line 122 "parser.y"
+                                            { (yyval.ast) = astCreate(AST_VAR_DECL_REAL, make_missing(DATATYPE_REAL), astCreate(AST_LIT_CHAR, (yyvsp[0].symbol), NULL, NULL, NULL, NULL, getLineNumber()), NULL, NULL, NULL, getLineNumber());  fprintf(compiler->diagnostics, "Expected identifier on variable declaration\n"); compiler->syntax_errors++; }
+#line 1622 "y.tab.c"
     break;
 
   case 28: /* var_declaration: KW_BOOL error '=' LIT_CHAR  */
-#line 183 "parser.y"
-                                            { (yyval.ast) = astCreate(AST_VAR_DECL_BOOL, make_missing(DATATYPE_BOOL), astCreate(AST_LIT_CHAR, (yyvsp[0].symbol), NULL, NULL, NULL, NULL, getLineNumber()), NULL, NULL, NULL, getLineNumber());  fprintf(stderr, "Expected identifier on variable declaration\n"); SyntaxErrors++; }
-#line 1685 "y.tab.c"
+#line 123 "parser.y"
+                                            { (yyval.ast) = astCreate(AST_VAR_DECL_BOOL, make_missing(DATATYPE_BOOL), astCreate(AST_LIT_CHAR, (yyvsp[0].symbol), NULL, NULL, NULL, NULL, getLineNumber()), NULL, NULL, NULL, getLineNumber());  fprintf(compiler->diagnostics, "Expected identifier on variable declaration\n"); compiler->syntax_errors++; }
+#line 1628 "y.tab.c"
     break;
 
   case 29: /* var_declaration: KW_INT error '=' LIT_REAL  */
-#line 185 "parser.y"
-                                            { (yyval.ast) = astCreate(AST_VAR_DECL_INT, make_missing(DATATYPE_INT), astCreate(AST_LIT_REAL, (yyvsp[0].symbol), NULL, NULL, NULL, NULL, getLineNumber()), NULL, NULL, NULL, getLineNumber()); fprintf(stderr, "Expected identifier on variable declaration\n"); SyntaxErrors++; }
-#line 1691 "y.tab.c"
+#line 125 "parser.y"
+                                            { (yyval.ast) = astCreate(AST_VAR_DECL_INT, make_missing(DATATYPE_INT), astCreate(AST_LIT_REAL, (yyvsp[0].symbol), NULL, NULL, NULL, NULL, getLineNumber()), NULL, NULL, NULL, getLineNumber()); fprintf(compiler->diagnostics, "Expected identifier on variable declaration\n"); compiler->syntax_errors++; }
+#line 1634 "y.tab.c"
     break;
 
   case 30: /* var_declaration: KW_CHAR error '=' LIT_REAL  */
-#line 186 "parser.y"
-                                            { (yyval.ast) = astCreate(AST_VAR_DECL_CHAR, make_missing(DATATYPE_CHAR), astCreate(AST_LIT_REAL, (yyvsp[0].symbol), NULL, NULL, NULL, NULL, getLineNumber()), NULL, NULL, NULL, getLineNumber());  fprintf(stderr, "Expected identifier on variable declaration\n"); SyntaxErrors++; }
-#line 1697 "y.tab.c"
+#line 126 "parser.y"
+                                            { (yyval.ast) = astCreate(AST_VAR_DECL_CHAR, make_missing(DATATYPE_CHAR), astCreate(AST_LIT_REAL, (yyvsp[0].symbol), NULL, NULL, NULL, NULL, getLineNumber()), NULL, NULL, NULL, getLineNumber());  fprintf(compiler->diagnostics, "Expected identifier on variable declaration\n"); compiler->syntax_errors++; }
+#line 1640 "y.tab.c"
     break;
 
   case 31: /* var_declaration: KW_REAL error '=' LIT_REAL  */
-#line 187 "parser.y"
-                                            { (yyval.ast) = astCreate(AST_VAR_DECL_REAL, make_missing(DATATYPE_REAL), astCreate(AST_LIT_REAL, (yyvsp[0].symbol), NULL, NULL, NULL, NULL, getLineNumber()), NULL, NULL, NULL, getLineNumber());  fprintf(stderr, "Expected identifier on variable declaration\n"); SyntaxErrors++; }
-#line 1703 "y.tab.c"
+#line 127 "parser.y"
+                                            { (yyval.ast) = astCreate(AST_VAR_DECL_REAL, make_missing(DATATYPE_REAL), astCreate(AST_LIT_REAL, (yyvsp[0].symbol), NULL, NULL, NULL, NULL, getLineNumber()), NULL, NULL, NULL, getLineNumber());  fprintf(compiler->diagnostics, "Expected identifier on variable declaration\n"); compiler->syntax_errors++; }
+#line 1646 "y.tab.c"
     break;
 
   case 32: /* var_declaration: KW_BOOL error '=' LIT_REAL  */
-#line 188 "parser.y"
-                                            { (yyval.ast) = astCreate(AST_VAR_DECL_BOOL, make_missing(DATATYPE_BOOL), astCreate(AST_LIT_REAL, (yyvsp[0].symbol), NULL, NULL, NULL, NULL, getLineNumber()), NULL, NULL, NULL, getLineNumber());  fprintf(stderr, "Expected identifier on variable declaration\n"); SyntaxErrors++; }
-#line 1709 "y.tab.c"
+#line 128 "parser.y"
+                                            { (yyval.ast) = astCreate(AST_VAR_DECL_BOOL, make_missing(DATATYPE_BOOL), astCreate(AST_LIT_REAL, (yyvsp[0].symbol), NULL, NULL, NULL, NULL, getLineNumber()), NULL, NULL, NULL, getLineNumber());  fprintf(compiler->diagnostics, "Expected identifier on variable declaration\n"); compiler->syntax_errors++; }
+#line 1652 "y.tab.c"
     break;
 
   case 33: /* var_declaration: KW_INT TK_IDENTIFIER error LIT_INT  */
-#line 191 "parser.y"
-                                                    { (yyval.ast) = astCreate(AST_VAR_DECL_INT, (yyvsp[-2].symbol), astCreate(AST_LIT_INT, (yyvsp[0].symbol), NULL, NULL, NULL, NULL, getLineNumber()), NULL, NULL, NULL, getLineNumber()); fprintf(stderr, "Expected = on variable declaration\n"); SyntaxErrors++; }
-#line 1715 "y.tab.c"
+#line 131 "parser.y"
+                                                    { (yyval.ast) = astCreate(AST_VAR_DECL_INT, (yyvsp[-2].symbol), astCreate(AST_LIT_INT, (yyvsp[0].symbol), NULL, NULL, NULL, NULL, getLineNumber()), NULL, NULL, NULL, getLineNumber()); fprintf(compiler->diagnostics, "Expected = on variable declaration\n"); compiler->syntax_errors++; }
+#line 1658 "y.tab.c"
     break;
 
   case 34: /* var_declaration: KW_CHAR TK_IDENTIFIER error LIT_INT  */
-#line 192 "parser.y"
-                                         { (yyval.ast) = astCreate(AST_VAR_DECL_CHAR, (yyvsp[-2].symbol), astCreate(AST_LIT_INT, (yyvsp[0].symbol), NULL, NULL, NULL, NULL, getLineNumber()), NULL, NULL, NULL, getLineNumber());  fprintf(stderr, "Expected = on variable declaration\n"); SyntaxErrors++; }
-#line 1721 "y.tab.c"
+#line 132 "parser.y"
+                                         { (yyval.ast) = astCreate(AST_VAR_DECL_CHAR, (yyvsp[-2].symbol), astCreate(AST_LIT_INT, (yyvsp[0].symbol), NULL, NULL, NULL, NULL, getLineNumber()), NULL, NULL, NULL, getLineNumber());  fprintf(compiler->diagnostics, "Expected = on variable declaration\n"); compiler->syntax_errors++; }
+#line 1664 "y.tab.c"
     break;
 
   case 35: /* var_declaration: KW_REAL TK_IDENTIFIER error LIT_INT  */
-#line 193 "parser.y"
-                                         { (yyval.ast) = astCreate(AST_VAR_DECL_REAL, (yyvsp[-2].symbol), astCreate(AST_LIT_INT, (yyvsp[0].symbol), NULL, NULL, NULL, NULL, getLineNumber()), NULL, NULL, NULL, getLineNumber());  fprintf(stderr, "Expected = on variable declaration\n"); SyntaxErrors++; }
-#line 1727 "y.tab.c"
+#line 133 "parser.y"
+                                         { (yyval.ast) = astCreate(AST_VAR_DECL_REAL, (yyvsp[-2].symbol), astCreate(AST_LIT_INT, (yyvsp[0].symbol), NULL, NULL, NULL, NULL, getLineNumber()), NULL, NULL, NULL, getLineNumber());  fprintf(compiler->diagnostics, "Expected = on variable declaration\n"); compiler->syntax_errors++; }
+#line 1670 "y.tab.c"
     break;
 
   case 36: /* var_declaration: KW_BOOL TK_IDENTIFIER error LIT_INT  */
-#line 194 "parser.y"
-                                         { (yyval.ast) = astCreate(AST_VAR_DECL_BOOL, (yyvsp[-2].symbol), astCreate(AST_LIT_INT, (yyvsp[0].symbol), NULL, NULL, NULL, NULL, getLineNumber()), NULL, NULL, NULL, getLineNumber());  fprintf(stderr, "Expected = on variable declaration\n"); SyntaxErrors++; }
-#line 1733 "y.tab.c"
+#line 134 "parser.y"
+                                         { (yyval.ast) = astCreate(AST_VAR_DECL_BOOL, (yyvsp[-2].symbol), astCreate(AST_LIT_INT, (yyvsp[0].symbol), NULL, NULL, NULL, NULL, getLineNumber()), NULL, NULL, NULL, getLineNumber());  fprintf(compiler->diagnostics, "Expected = on variable declaration\n"); compiler->syntax_errors++; }
+#line 1676 "y.tab.c"
     break;
 
   case 37: /* var_declaration: KW_INT TK_IDENTIFIER error LIT_CHAR  */
-#line 196 "parser.y"
-                                          { (yyval.ast) = astCreate(AST_VAR_DECL_INT, (yyvsp[-2].symbol), astCreate(AST_LIT_CHAR, (yyvsp[0].symbol), NULL, NULL, NULL, NULL, getLineNumber()), NULL, NULL, NULL, getLineNumber()); fprintf(stderr, "Expected = on variable declaration\n"); SyntaxErrors++; }
-#line 1739 "y.tab.c"
+#line 136 "parser.y"
+                                          { (yyval.ast) = astCreate(AST_VAR_DECL_INT, (yyvsp[-2].symbol), astCreate(AST_LIT_CHAR, (yyvsp[0].symbol), NULL, NULL, NULL, NULL, getLineNumber()), NULL, NULL, NULL, getLineNumber()); fprintf(compiler->diagnostics, "Expected = on variable declaration\n"); compiler->syntax_errors++; }
+#line 1682 "y.tab.c"
     break;
 
   case 38: /* var_declaration: KW_CHAR TK_IDENTIFIER error LIT_CHAR  */
-#line 197 "parser.y"
-                                          { (yyval.ast) = astCreate(AST_VAR_DECL_CHAR, (yyvsp[-2].symbol), astCreate(AST_LIT_CHAR, (yyvsp[0].symbol), NULL, NULL, NULL, NULL, getLineNumber()), NULL, NULL, NULL, getLineNumber());  fprintf(stderr, "Expected = on variable declaration\n"); SyntaxErrors++; }
-#line 1745 "y.tab.c"
+#line 137 "parser.y"
+                                          { (yyval.ast) = astCreate(AST_VAR_DECL_CHAR, (yyvsp[-2].symbol), astCreate(AST_LIT_CHAR, (yyvsp[0].symbol), NULL, NULL, NULL, NULL, getLineNumber()), NULL, NULL, NULL, getLineNumber());  fprintf(compiler->diagnostics, "Expected = on variable declaration\n"); compiler->syntax_errors++; }
+#line 1688 "y.tab.c"
     break;
 
   case 39: /* var_declaration: KW_REAL TK_IDENTIFIER error LIT_CHAR  */
-#line 198 "parser.y"
-                                          { (yyval.ast) = astCreate(AST_VAR_DECL_REAL, (yyvsp[-2].symbol), astCreate(AST_LIT_CHAR, (yyvsp[0].symbol), NULL, NULL, NULL, NULL, getLineNumber()), NULL, NULL, NULL, getLineNumber());  fprintf(stderr, "Expected = on variable declaration\n"); SyntaxErrors++; }
-#line 1751 "y.tab.c"
+#line 138 "parser.y"
+                                          { (yyval.ast) = astCreate(AST_VAR_DECL_REAL, (yyvsp[-2].symbol), astCreate(AST_LIT_CHAR, (yyvsp[0].symbol), NULL, NULL, NULL, NULL, getLineNumber()), NULL, NULL, NULL, getLineNumber());  fprintf(compiler->diagnostics, "Expected = on variable declaration\n"); compiler->syntax_errors++; }
+#line 1694 "y.tab.c"
     break;
 
   case 40: /* var_declaration: KW_BOOL TK_IDENTIFIER error LIT_CHAR  */
-#line 199 "parser.y"
-                                          { (yyval.ast) = astCreate(AST_VAR_DECL_BOOL, (yyvsp[-2].symbol), astCreate(AST_LIT_CHAR, (yyvsp[0].symbol), NULL, NULL, NULL, NULL, getLineNumber()), NULL, NULL, NULL, getLineNumber());  fprintf(stderr, "Expected = on variable declaration\n"); SyntaxErrors++; }
-#line 1757 "y.tab.c"
+#line 139 "parser.y"
+                                          { (yyval.ast) = astCreate(AST_VAR_DECL_BOOL, (yyvsp[-2].symbol), astCreate(AST_LIT_CHAR, (yyvsp[0].symbol), NULL, NULL, NULL, NULL, getLineNumber()), NULL, NULL, NULL, getLineNumber());  fprintf(compiler->diagnostics, "Expected = on variable declaration\n"); compiler->syntax_errors++; }
+#line 1700 "y.tab.c"
     break;
 
   case 41: /* var_declaration: KW_INT TK_IDENTIFIER error LIT_REAL  */
-#line 201 "parser.y"
-                                          { (yyval.ast) = astCreate(AST_VAR_DECL_INT, (yyvsp[-2].symbol), astCreate(AST_LIT_REAL, (yyvsp[0].symbol), NULL, NULL, NULL, NULL, getLineNumber()), NULL, NULL, NULL, getLineNumber()); fprintf(stderr, "Expected = on variable declaration\n"); SyntaxErrors++; }
-#line 1763 "y.tab.c"
+#line 141 "parser.y"
+                                          { (yyval.ast) = astCreate(AST_VAR_DECL_INT, (yyvsp[-2].symbol), astCreate(AST_LIT_REAL, (yyvsp[0].symbol), NULL, NULL, NULL, NULL, getLineNumber()), NULL, NULL, NULL, getLineNumber()); fprintf(compiler->diagnostics, "Expected = on variable declaration\n"); compiler->syntax_errors++; }
+#line 1706 "y.tab.c"
     break;
 
   case 42: /* var_declaration: KW_CHAR TK_IDENTIFIER error LIT_REAL  */
-#line 202 "parser.y"
-                                          { (yyval.ast) = astCreate(AST_VAR_DECL_CHAR, (yyvsp[-2].symbol), astCreate(AST_LIT_REAL, (yyvsp[0].symbol), NULL, NULL, NULL, NULL, getLineNumber()), NULL, NULL, NULL, getLineNumber());  fprintf(stderr, "Expected = on variable declaration\n"); SyntaxErrors++; }
-#line 1769 "y.tab.c"
+#line 142 "parser.y"
+                                          { (yyval.ast) = astCreate(AST_VAR_DECL_CHAR, (yyvsp[-2].symbol), astCreate(AST_LIT_REAL, (yyvsp[0].symbol), NULL, NULL, NULL, NULL, getLineNumber()), NULL, NULL, NULL, getLineNumber());  fprintf(compiler->diagnostics, "Expected = on variable declaration\n"); compiler->syntax_errors++; }
+#line 1712 "y.tab.c"
     break;
 
   case 43: /* var_declaration: KW_REAL TK_IDENTIFIER error LIT_REAL  */
-#line 203 "parser.y"
-                                          { (yyval.ast) = astCreate(AST_VAR_DECL_REAL, (yyvsp[-2].symbol), astCreate(AST_LIT_REAL, (yyvsp[0].symbol), NULL, NULL, NULL, NULL, getLineNumber()), NULL, NULL, NULL, getLineNumber());  fprintf(stderr, "Expected = on variable declaration\n"); SyntaxErrors++; }
-#line 1775 "y.tab.c"
+#line 143 "parser.y"
+                                          { (yyval.ast) = astCreate(AST_VAR_DECL_REAL, (yyvsp[-2].symbol), astCreate(AST_LIT_REAL, (yyvsp[0].symbol), NULL, NULL, NULL, NULL, getLineNumber()), NULL, NULL, NULL, getLineNumber());  fprintf(compiler->diagnostics, "Expected = on variable declaration\n"); compiler->syntax_errors++; }
+#line 1718 "y.tab.c"
     break;
 
   case 44: /* var_declaration: KW_BOOL TK_IDENTIFIER error LIT_REAL  */
-#line 204 "parser.y"
-                                          { (yyval.ast) = astCreate(AST_VAR_DECL_BOOL, (yyvsp[-2].symbol), astCreate(AST_LIT_REAL, (yyvsp[0].symbol), NULL, NULL, NULL, NULL, getLineNumber()), NULL, NULL, NULL, getLineNumber());  fprintf(stderr, "Expected = on variable declaration\n"); SyntaxErrors++; }
-#line 1781 "y.tab.c"
+#line 144 "parser.y"
+                                          { (yyval.ast) = astCreate(AST_VAR_DECL_BOOL, (yyvsp[-2].symbol), astCreate(AST_LIT_REAL, (yyvsp[0].symbol), NULL, NULL, NULL, NULL, getLineNumber()), NULL, NULL, NULL, getLineNumber());  fprintf(compiler->diagnostics, "Expected = on variable declaration\n"); compiler->syntax_errors++; }
+#line 1724 "y.tab.c"
     break;
 
   case 45: /* var_declaration: KW_INT TK_IDENTIFIER '=' error  */
-#line 207 "parser.y"
-                                     { (yyval.ast) = astCreate(AST_VAR_DECL_INT, (yyvsp[-2].symbol), astCreate(AST_LIT_REAL, make_value(SYMBOL_LIT_INTEGER), NULL, NULL, NULL, NULL, getLineNumber()), NULL, NULL, NULL, getLineNumber()); fprintf(stderr, "Expected literal as value on variable declaration\n"); SyntaxErrors++; }
-#line 1787 "y.tab.c"
+#line 147 "parser.y"
+                                     { (yyval.ast) = astCreate(AST_VAR_DECL_INT, (yyvsp[-2].symbol), astCreate(AST_LIT_REAL, make_value(SYMBOL_LIT_INTEGER), NULL, NULL, NULL, NULL, getLineNumber()), NULL, NULL, NULL, getLineNumber()); fprintf(compiler->diagnostics, "Expected literal as value on variable declaration\n"); compiler->syntax_errors++; }
+#line 1730 "y.tab.c"
     break;
 
   case 46: /* var_declaration: KW_CHAR TK_IDENTIFIER '=' error  */
-#line 208 "parser.y"
-                                     { (yyval.ast) = astCreate(AST_VAR_DECL_CHAR, (yyvsp[-2].symbol), astCreate(AST_LIT_REAL, make_value(SYMBOL_LIT_CHAR), NULL, NULL, NULL, NULL, getLineNumber()), NULL, NULL, NULL, getLineNumber());  fprintf(stderr, "Expected literal as value on variable declaration\n"); SyntaxErrors++; }
-#line 1793 "y.tab.c"
+#line 148 "parser.y"
+                                     { (yyval.ast) = astCreate(AST_VAR_DECL_CHAR, (yyvsp[-2].symbol), astCreate(AST_LIT_REAL, make_value(SYMBOL_LIT_CHAR), NULL, NULL, NULL, NULL, getLineNumber()), NULL, NULL, NULL, getLineNumber());  fprintf(compiler->diagnostics, "Expected literal as value on variable declaration\n"); compiler->syntax_errors++; }
+#line 1736 "y.tab.c"
     break;
 
   case 47: /* var_declaration: KW_REAL TK_IDENTIFIER '=' error  */
-#line 209 "parser.y"
-                                     { (yyval.ast) = astCreate(AST_VAR_DECL_REAL, (yyvsp[-2].symbol), astCreate(AST_LIT_REAL, make_value(SYMBOL_LIT_REAL), NULL, NULL, NULL, NULL, getLineNumber()), NULL, NULL, NULL, getLineNumber());  fprintf(stderr, "Expected literal as value on variable declaration\n"); SyntaxErrors++; }
-#line 1799 "y.tab.c"
+#line 149 "parser.y"
+                                     { (yyval.ast) = astCreate(AST_VAR_DECL_REAL, (yyvsp[-2].symbol), astCreate(AST_LIT_REAL, make_value(SYMBOL_LIT_REAL), NULL, NULL, NULL, NULL, getLineNumber()), NULL, NULL, NULL, getLineNumber());  fprintf(compiler->diagnostics, "Expected literal as value on variable declaration\n"); compiler->syntax_errors++; }
+#line 1742 "y.tab.c"
     break;
 
   case 48: /* var_declaration: KW_BOOL TK_IDENTIFIER '=' error  */
-#line 210 "parser.y"
-                                     { (yyval.ast) = astCreate(AST_VAR_DECL_BOOL, (yyvsp[-2].symbol), astCreate(AST_LIT_REAL, make_value(SYMBOL_LIT_INTEGER), NULL, NULL, NULL, NULL, getLineNumber()), NULL, NULL, NULL, getLineNumber());  fprintf(stderr, "Expected literal as value on variable declaration\n"); SyntaxErrors++; }
-#line 1805 "y.tab.c"
+#line 150 "parser.y"
+                                     { (yyval.ast) = astCreate(AST_VAR_DECL_BOOL, (yyvsp[-2].symbol), astCreate(AST_LIT_REAL, make_value(SYMBOL_LIT_INTEGER), NULL, NULL, NULL, NULL, getLineNumber()), NULL, NULL, NULL, getLineNumber());  fprintf(compiler->diagnostics, "Expected literal as value on variable declaration\n"); compiler->syntax_errors++; }
+#line 1748 "y.tab.c"
     break;
 
   case 49: /* vec_init_opt: LIT_INT vec_init_opt  */
-#line 214 "parser.y"
+#line 154 "parser.y"
                                    { (yyval.ast) = astCreate(AST_VEC_INIT_OPT_INT, NULL, astCreate(AST_LIT_INT, (yyvsp[-1].symbol), NULL, NULL, NULL, NULL, getLineNumber()), (yyvsp[0].ast), NULL, NULL, getLineNumber());}
-#line 1811 "y.tab.c"
+#line 1754 "y.tab.c"
     break;
 
   case 50: /* vec_init_opt: LIT_REAL vec_init_opt  */
-#line 215 "parser.y"
+#line 155 "parser.y"
                                    { (yyval.ast) = astCreate(AST_VEC_INIT_OPT_REAL, NULL, astCreate(AST_LIT_REAL, (yyvsp[-1].symbol), NULL, NULL, NULL, NULL, getLineNumber()), (yyvsp[0].ast), NULL, NULL, getLineNumber()); }
-#line 1817 "y.tab.c"
+#line 1760 "y.tab.c"
     break;
 
   case 51: /* vec_init_opt: LIT_CHAR vec_init_opt  */
-#line 216 "parser.y"
+#line 156 "parser.y"
                                     { (yyval.ast) = astCreate(AST_VEC_INIT_OPT_CHAR, NULL, astCreate(AST_LIT_CHAR, (yyvsp[-1].symbol), NULL, NULL, NULL, NULL, getLineNumber()), (yyvsp[0].ast), NULL, NULL, getLineNumber()); }
-#line 1823 "y.tab.c"
+#line 1766 "y.tab.c"
     break;
 
   case 52: /* vec_init_opt: %empty  */
-#line 217 "parser.y"
+#line 157 "parser.y"
           { (yyval.ast) = 0; }
-#line 1829 "y.tab.c"
+#line 1772 "y.tab.c"
     break;
 
   case 53: /* vec_declaration: KW_INT TK_IDENTIFIER '[' LIT_INT ']' vec_init_opt  */
-#line 220 "parser.y"
+#line 160 "parser.y"
                                                                      { (yyval.ast) = astCreate(AST_VEC_DECL_INT, (yyvsp[-4].symbol),  astCreate(AST_LIT_INT, (yyvsp[-2].symbol), NULL, NULL, NULL, NULL, getLineNumber()), (yyvsp[0].ast), NULL, NULL, getLineNumber()); }
-#line 1835 "y.tab.c"
+#line 1778 "y.tab.c"
     break;
 
   case 54: /* vec_declaration: KW_CHAR TK_IDENTIFIER '[' LIT_INT ']' vec_init_opt  */
-#line 221 "parser.y"
+#line 161 "parser.y"
                                                                     { (yyval.ast) = astCreate(AST_VEC_DECL_CHAR, (yyvsp[-4].symbol), astCreate(AST_LIT_INT, (yyvsp[-2].symbol), NULL, NULL, NULL, NULL, getLineNumber()), (yyvsp[0].ast), NULL, NULL, getLineNumber()); }
-#line 1841 "y.tab.c"
+#line 1784 "y.tab.c"
     break;
 
   case 55: /* vec_declaration: KW_REAL TK_IDENTIFIER '[' LIT_INT ']' vec_init_opt  */
-#line 222 "parser.y"
+#line 162 "parser.y"
                                                                     { (yyval.ast) = astCreate(AST_VEC_DECL_REAL, (yyvsp[-4].symbol), astCreate(AST_LIT_INT, (yyvsp[-2].symbol), NULL, NULL, NULL, NULL, getLineNumber()), (yyvsp[0].ast), NULL, NULL, getLineNumber()); }
-#line 1847 "y.tab.c"
+#line 1790 "y.tab.c"
     break;
 
   case 56: /* vec_declaration: KW_BOOL TK_IDENTIFIER '[' LIT_INT ']' vec_init_opt  */
-#line 223 "parser.y"
+#line 163 "parser.y"
                                                                     { (yyval.ast) = astCreate(AST_VEC_DECL_BOOL, (yyvsp[-4].symbol), astCreate(AST_LIT_INT, (yyvsp[-2].symbol), NULL, NULL, NULL, NULL, getLineNumber()), (yyvsp[0].ast), NULL, NULL, getLineNumber()); }
-#line 1853 "y.tab.c"
+#line 1796 "y.tab.c"
     break;
 
   case 57: /* vec_declaration: KW_INT TK_IDENTIFIER '[' error ']' vec_init_opt  */
-#line 226 "parser.y"
-                                                                  { (yyval.ast) = 0; fprintf(stderr, "Expected size on vector declaration\n"); SyntaxErrors++; }
-#line 1859 "y.tab.c"
+#line 166 "parser.y"
+                                                                  { (yyval.ast) = 0; fprintf(compiler->diagnostics, "Expected size on vector declaration\n"); compiler->syntax_errors++; }
+#line 1802 "y.tab.c"
     break;
 
   case 58: /* vec_declaration: KW_CHAR TK_IDENTIFIER '[' error ']' vec_init_opt  */
-#line 227 "parser.y"
-                                                                  { (yyval.ast) = 0;  fprintf(stderr, "Expected size on vector declaration\n"); SyntaxErrors++; }
-#line 1865 "y.tab.c"
+#line 167 "parser.y"
+                                                                  { (yyval.ast) = 0;  fprintf(compiler->diagnostics, "Expected size on vector declaration\n"); compiler->syntax_errors++; }
+#line 1808 "y.tab.c"
     break;
 
   case 59: /* vec_declaration: KW_REAL TK_IDENTIFIER '[' error ']' vec_init_opt  */
-#line 228 "parser.y"
-                                                                   { (yyval.ast) = 0;  fprintf(stderr, "Expected size on vector declaration\n"); SyntaxErrors++; }
-#line 1871 "y.tab.c"
+#line 168 "parser.y"
+                                                                   { (yyval.ast) = 0;  fprintf(compiler->diagnostics, "Expected size on vector declaration\n"); compiler->syntax_errors++; }
+#line 1814 "y.tab.c"
     break;
 
   case 60: /* vec_declaration: KW_BOOL TK_IDENTIFIER '[' error ']' vec_init_opt  */
-#line 229 "parser.y"
-                                                                   { (yyval.ast) = 0;  fprintf(stderr, "Expected size on vector declaration\n"); SyntaxErrors++; }
-#line 1877 "y.tab.c"
+#line 169 "parser.y"
+                                                                   { (yyval.ast) = 0;  fprintf(compiler->diagnostics, "Expected size on vector declaration\n"); compiler->syntax_errors++; }
+#line 1820 "y.tab.c"
     break;
 
   case 61: /* vec_declaration: KW_INT TK_IDENTIFIER '[' LIT_INT ']' error  */
-#line 231 "parser.y"
-                                                             { (yyval.ast) = 0; fprintf(stderr, "Expected literal list on vector declaration opt\n"); SyntaxErrors++; }
-#line 1883 "y.tab.c"
+#line 171 "parser.y"
+                                                             { (yyval.ast) = 0; fprintf(compiler->diagnostics, "Expected literal list on vector declaration opt\n"); compiler->syntax_errors++; }
+#line 1826 "y.tab.c"
     break;
 
   case 62: /* vec_declaration: KW_CHAR TK_IDENTIFIER '[' LIT_INT ']' error  */
-#line 232 "parser.y"
-                                                             { (yyval.ast) = 0;  fprintf(stderr, "Expected literal list on vector declaration opt\n"); SyntaxErrors++; }
-#line 1889 "y.tab.c"
+#line 172 "parser.y"
+                                                             { (yyval.ast) = 0;  fprintf(compiler->diagnostics, "Expected literal list on vector declaration opt\n"); compiler->syntax_errors++; }
+#line 1832 "y.tab.c"
     break;
 
   case 63: /* vec_declaration: KW_REAL TK_IDENTIFIER '[' LIT_INT ']' error  */
-#line 233 "parser.y"
-                                                              { (yyval.ast) = 0;  fprintf(stderr, "Expected literal list on vector declaration opt\n"); SyntaxErrors++; }
-#line 1895 "y.tab.c"
+#line 173 "parser.y"
+                                                              { (yyval.ast) = 0;  fprintf(compiler->diagnostics, "Expected literal list on vector declaration opt\n"); compiler->syntax_errors++; }
+#line 1838 "y.tab.c"
     break;
 
   case 64: /* vec_declaration: KW_BOOL TK_IDENTIFIER '[' LIT_INT ']' error  */
-#line 234 "parser.y"
-                                                              { (yyval.ast) = 0;  fprintf(stderr, "Expected literal list on vector declaration opt\n"); SyntaxErrors++; }
-#line 1901 "y.tab.c"
+#line 174 "parser.y"
+                                                              { (yyval.ast) = 0;  fprintf(compiler->diagnostics, "Expected literal list on vector declaration opt\n"); compiler->syntax_errors++; }
+#line 1844 "y.tab.c"
     break;
 
   case 65: /* parameter: KW_INT TK_IDENTIFIER  */
-#line 237 "parser.y"
+#line 177 "parser.y"
                                     { (yyval.ast) = astCreate(AST_PARAM_INT, (yyvsp[0].symbol), NULL, NULL, NULL, NULL, getLineNumber()); }
-#line 1907 "y.tab.c"
+#line 1850 "y.tab.c"
     break;
 
   case 66: /* parameter: KW_CHAR TK_IDENTIFIER  */
-#line 238 "parser.y"
+#line 178 "parser.y"
                                     { (yyval.ast) = astCreate(AST_PARAM_CHAR, (yyvsp[0].symbol), NULL, NULL, NULL, NULL, getLineNumber()); }
-#line 1913 "y.tab.c"
+#line 1856 "y.tab.c"
     break;
 
   case 67: /* parameter: KW_REAL TK_IDENTIFIER  */
-#line 239 "parser.y"
+#line 179 "parser.y"
                                     { (yyval.ast) = astCreate(AST_PARAM_REAL, (yyvsp[0].symbol), NULL, NULL, NULL, NULL, getLineNumber()); }
-#line 1919 "y.tab.c"
+#line 1862 "y.tab.c"
     break;
 
   case 68: /* parameter: KW_BOOL TK_IDENTIFIER  */
-#line 240 "parser.y"
+#line 180 "parser.y"
                                     { (yyval.ast) = astCreate(AST_PARAM_BOOL, (yyvsp[0].symbol), NULL, NULL, NULL, NULL, getLineNumber()); }
-#line 1925 "y.tab.c"
+#line 1868 "y.tab.c"
     break;
 
   case 69: /* parameter_list: parameter parameter_list_aux  */
-#line 243 "parser.y"
+#line 183 "parser.y"
                                              { (yyval.ast) = astCreate(AST_PARAM_LIST, NULL, (yyvsp[-1].ast), (yyvsp[0].ast), NULL, NULL, getLineNumber()); }
-#line 1931 "y.tab.c"
+#line 1874 "y.tab.c"
     break;
 
   case 70: /* parameter_list: %empty  */
-#line 244 "parser.y"
+#line 184 "parser.y"
       { (yyval.ast) = astCreate(AST_EMPTY_PARAM_LIST, NULL, NULL, NULL, NULL, NULL, getLineNumber());}
-#line 1937 "y.tab.c"
+#line 1880 "y.tab.c"
     break;
 
   case 71: /* parameter_list_aux: ',' parameter parameter_list_aux  */
-#line 247 "parser.y"
+#line 187 "parser.y"
                                                      { (yyval.ast) = astCreate(AST_PARAM_LIST, NULL, (yyvsp[-1].ast), (yyvsp[0].ast), NULL, NULL, getLineNumber()); }
-#line 1943 "y.tab.c"
+#line 1886 "y.tab.c"
     break;
 
   case 72: /* parameter_list_aux: %empty  */
-#line 248 "parser.y"
+#line 188 "parser.y"
       { (yyval.ast) = 0; }
-#line 1949 "y.tab.c"
+#line 1892 "y.tab.c"
     break;
 
   case 73: /* func_declaration: KW_INT TK_IDENTIFIER '(' parameter_list ')' body  */
-#line 251 "parser.y"
+#line 191 "parser.y"
                                                                         { (yyval.ast) = astCreate(AST_FUNC_DECL_INT, (yyvsp[-4].symbol), (yyvsp[-2].ast), (yyvsp[0].ast), NULL, NULL, getLineNumber()); }
-#line 1955 "y.tab.c"
+#line 1898 "y.tab.c"
     break;
 
   case 74: /* func_declaration: KW_CHAR TK_IDENTIFIER '(' parameter_list ')' body  */
-#line 252 "parser.y"
+#line 192 "parser.y"
                                                                         { (yyval.ast) = astCreate(AST_FUNC_DECL_CHAR, (yyvsp[-4].symbol), (yyvsp[-2].ast), (yyvsp[0].ast), NULL, NULL, getLineNumber()); }
-#line 1961 "y.tab.c"
+#line 1904 "y.tab.c"
     break;
 
   case 75: /* func_declaration: KW_REAL TK_IDENTIFIER '(' parameter_list ')' body  */
-#line 253 "parser.y"
+#line 193 "parser.y"
                                                                         { (yyval.ast) = astCreate(AST_FUNC_DECL_REAL, (yyvsp[-4].symbol), (yyvsp[-2].ast), (yyvsp[0].ast), NULL, NULL, getLineNumber()); }
-#line 1967 "y.tab.c"
+#line 1910 "y.tab.c"
     break;
 
   case 76: /* func_declaration: KW_BOOL TK_IDENTIFIER '(' parameter_list ')' body  */
-#line 254 "parser.y"
+#line 194 "parser.y"
                                                                         { (yyval.ast) = astCreate(AST_FUNC_DECL_BOOL, (yyvsp[-4].symbol), (yyvsp[-2].ast), (yyvsp[0].ast), NULL, NULL, getLineNumber()); }
-#line 1973 "y.tab.c"
+#line 1916 "y.tab.c"
     break;
 
   case 77: /* body: '{' cmd_list '}'  */
-#line 257 "parser.y"
+#line 197 "parser.y"
                        { (yyval.ast) = astCreate(AST_BODY, NULL, (yyvsp[-1].ast), NULL, NULL, NULL, getLineNumber()); }
-#line 1979 "y.tab.c"
+#line 1922 "y.tab.c"
     break;
 
   case 78: /* cmd_list: cmd ';' cmd_list  */
-#line 263 "parser.y"
+#line 203 "parser.y"
                            { (yyval.ast) = astCreate(AST_CMD_LIST, 0, (yyvsp[-2].ast), (yyvsp[0].ast), NULL, NULL, getLineNumber()); }
-#line 1985 "y.tab.c"
+#line 1928 "y.tab.c"
     break;
 
   case 79: /* cmd_list: body cmd_list  */
-#line 264 "parser.y"
+#line 204 "parser.y"
                            { (yyval.ast) = astCreate(AST_CMD_LIST, 0, (yyvsp[-1].ast), (yyvsp[0].ast), NULL, NULL, getLineNumber()); }
-#line 1991 "y.tab.c"
+#line 1934 "y.tab.c"
     break;
 
   case 80: /* cmd_list: if_statement cmd_list  */
-#line 265 "parser.y"
+#line 205 "parser.y"
                                     { (yyval.ast) = astCreate(AST_CMD_LIST, 0, (yyvsp[-1].ast), (yyvsp[0].ast), NULL, NULL, getLineNumber()); }
-#line 1997 "y.tab.c"
+#line 1940 "y.tab.c"
     break;
 
   case 81: /* cmd_list: cmd error cmd_list  */
-#line 267 "parser.y"
-                           { (yyval.ast) = astCreate(AST_CMD_LIST, 0, (yyvsp[-2].ast), (yyvsp[0].ast), NULL, NULL, getLineNumber()); fprintf(stderr, "Expecting ; on end of command\n"); SyntaxErrors++; }
-#line 2003 "y.tab.c"
+#line 207 "parser.y"
+                           { (yyval.ast) = astCreate(AST_CMD_LIST, 0, (yyvsp[-2].ast), (yyvsp[0].ast), NULL, NULL, getLineNumber()); fprintf(compiler->diagnostics, "Expecting ; on end of command\n"); compiler->syntax_errors++; }
+#line 1946 "y.tab.c"
     break;
 
   case 82: /* cmd_list: %empty  */
-#line 269 "parser.y"
+#line 209 "parser.y"
           { (yyval.ast) = 0; }
-#line 2009 "y.tab.c"
+#line 1952 "y.tab.c"
     break;
 
   case 83: /* if_body: body  */
-#line 272 "parser.y"
+#line 212 "parser.y"
               { (yyval.ast) = (yyvsp[0].ast); }
-#line 2015 "y.tab.c"
+#line 1958 "y.tab.c"
     break;
 
   case 84: /* if_body: cmd ';'  */
-#line 273 "parser.y"
+#line 213 "parser.y"
                  { (yyval.ast) = (yyvsp[-1].ast); }
-#line 2021 "y.tab.c"
+#line 1964 "y.tab.c"
     break;
 
   case 85: /* if_statement: KW_IF '(' expr ')' if_body  */
-#line 276 "parser.y"
+#line 216 "parser.y"
                                                    { (yyval.ast) = astCreate(AST_IF, 0, (yyvsp[-2].ast), (yyvsp[0].ast), NULL, NULL, getLineNumber()); }
-#line 2027 "y.tab.c"
+#line 1970 "y.tab.c"
     break;
 
   case 86: /* if_statement: KW_IF '(' expr ')' if_body KW_ELSE if_body  */
-#line 277 "parser.y"
+#line 217 "parser.y"
                                                    { (yyval.ast) = astCreate(AST_IF_ELSE, 0, (yyvsp[-4].ast), (yyvsp[-2].ast), (yyvsp[0].ast), NULL, getLineNumber()); }
-#line 2033 "y.tab.c"
+#line 1976 "y.tab.c"
     break;
 
   case 87: /* if_statement: KW_IF '(' expr ')' KW_LOOP if_body  */
-#line 278 "parser.y"
+#line 218 "parser.y"
                                                    { (yyval.ast) = astCreate(AST_LOOP, 0, (yyvsp[-3].ast), (yyvsp[0].ast), NULL, NULL, getLineNumber()); }
-#line 2039 "y.tab.c"
+#line 1982 "y.tab.c"
     break;
 
   case 88: /* if_statement: KW_IF '(' expr ')' KW_LOOP error  */
-#line 282 "parser.y"
-                                                 { (yyval.ast) = astCreate(AST_LOOP, 0, (yyvsp[-3].ast), NULL, NULL, NULL, getLineNumber()); fprintf(stderr, "Expecting loop body\n"); SyntaxErrors++; }
-#line 2045 "y.tab.c"
+#line 222 "parser.y"
+                                                 { (yyval.ast) = astCreate(AST_LOOP, 0, (yyvsp[-3].ast), NULL, NULL, NULL, getLineNumber()); fprintf(compiler->diagnostics, "Expecting loop body\n"); compiler->syntax_errors++; }
+#line 1988 "y.tab.c"
     break;
 
   case 89: /* if_statement: KW_IF error expr ')' if_body  */
-#line 284 "parser.y"
-                                             { (yyval.ast) = astCreate(AST_IF, 0, (yyvsp[-2].ast), (yyvsp[0].ast), NULL, NULL, getLineNumber()); fprintf(stderr, "Expecting ( at the start of if condition\n"); SyntaxErrors++; }
-#line 2051 "y.tab.c"
+#line 224 "parser.y"
+                                             { (yyval.ast) = astCreate(AST_IF, 0, (yyvsp[-2].ast), (yyvsp[0].ast), NULL, NULL, getLineNumber()); fprintf(compiler->diagnostics, "Expecting ( at the start of if condition\n"); compiler->syntax_errors++; }
+#line 1994 "y.tab.c"
     break;
 
   case 90: /* if_statement: KW_IF '(' expr error if_body  */
-#line 285 "parser.y"
-                                             { (yyval.ast) = astCreate(AST_IF, 0, (yyvsp[-2].ast), (yyvsp[0].ast), NULL, NULL, getLineNumber()); fprintf(stderr, "Expecting ) at the end of if condition\n"); SyntaxErrors++; }
-#line 2057 "y.tab.c"
+#line 225 "parser.y"
+                                             { (yyval.ast) = astCreate(AST_IF, 0, (yyvsp[-2].ast), (yyvsp[0].ast), NULL, NULL, getLineNumber()); fprintf(compiler->diagnostics, "Expecting ) at the end of if condition\n"); compiler->syntax_errors++; }
+#line 2000 "y.tab.c"
     break;
 
   case 91: /* if_statement: KW_IF error expr ')' if_body KW_ELSE if_body  */
-#line 286 "parser.y"
-                                                     { (yyval.ast) = astCreate(AST_IF_ELSE, 0, (yyvsp[-4].ast), (yyvsp[-2].ast), (yyvsp[0].ast), NULL, getLineNumber()); fprintf(stderr, "Expecting ( at the start of if condition\n"); SyntaxErrors++; }
-#line 2063 "y.tab.c"
+#line 226 "parser.y"
+                                                     { (yyval.ast) = astCreate(AST_IF_ELSE, 0, (yyvsp[-4].ast), (yyvsp[-2].ast), (yyvsp[0].ast), NULL, getLineNumber()); fprintf(compiler->diagnostics, "Expecting ( at the start of if condition\n"); compiler->syntax_errors++; }
+#line 2006 "y.tab.c"
     break;
 
   case 92: /* if_statement: KW_IF '(' expr error if_body KW_ELSE if_body  */
-#line 287 "parser.y"
-                                                     { (yyval.ast) = astCreate(AST_IF_ELSE, 0, (yyvsp[-4].ast), (yyvsp[-2].ast), (yyvsp[0].ast), NULL, getLineNumber()); fprintf(stderr, "Expecting ) at the end of if condition\n"); SyntaxErrors++; }
-#line 2069 "y.tab.c"
+#line 227 "parser.y"
+                                                     { (yyval.ast) = astCreate(AST_IF_ELSE, 0, (yyvsp[-4].ast), (yyvsp[-2].ast), (yyvsp[0].ast), NULL, getLineNumber()); fprintf(compiler->diagnostics, "Expecting ) at the end of if condition\n"); compiler->syntax_errors++; }
+#line 2012 "y.tab.c"
     break;
 
   case 93: /* if_statement: KW_IF error expr ')' KW_LOOP if_body  */
-#line 288 "parser.y"
-                                                     { (yyval.ast) = astCreate(AST_LOOP, 0, (yyvsp[-3].ast), (yyvsp[0].ast), NULL, NULL, getLineNumber()); fprintf(stderr, "Expecting ( at the start of loop condition\n"); SyntaxErrors++;}
-#line 2075 "y.tab.c"
+#line 228 "parser.y"
+                                                     { (yyval.ast) = astCreate(AST_LOOP, 0, (yyvsp[-3].ast), (yyvsp[0].ast), NULL, NULL, getLineNumber()); fprintf(compiler->diagnostics, "Expecting ( at the start of loop condition\n"); compiler->syntax_errors++;}
+#line 2018 "y.tab.c"
     break;
 
   case 94: /* if_statement: KW_IF '(' expr error KW_LOOP if_body  */
-#line 289 "parser.y"
-                                                     { (yyval.ast) = astCreate(AST_LOOP, 0, (yyvsp[-3].ast), (yyvsp[0].ast), NULL, NULL, getLineNumber()); fprintf(stderr, "Expecting ) at the end of loop condition\n"); SyntaxErrors++;}
-#line 2081 "y.tab.c"
+#line 229 "parser.y"
+                                                     { (yyval.ast) = astCreate(AST_LOOP, 0, (yyvsp[-3].ast), (yyvsp[0].ast), NULL, NULL, getLineNumber()); fprintf(compiler->diagnostics, "Expecting ) at the end of loop condition\n"); compiler->syntax_errors++;}
+#line 2024 "y.tab.c"
     break;
 
   case 95: /* if_statement: KW_IF error expr error if_body  */
-#line 291 "parser.y"
-                                               { (yyval.ast) = astCreate(AST_IF, 0, (yyvsp[-2].ast), (yyvsp[0].ast), NULL, NULL, getLineNumber()); fprintf(stderr, "Expecting if condition to be inside (...)\n"); SyntaxErrors++; }
-#line 2087 "y.tab.c"
+#line 231 "parser.y"
+                                               { (yyval.ast) = astCreate(AST_IF, 0, (yyvsp[-2].ast), (yyvsp[0].ast), NULL, NULL, getLineNumber()); fprintf(compiler->diagnostics, "Expecting if condition to be inside (...)\n"); compiler->syntax_errors++; }
+#line 2030 "y.tab.c"
     break;
 
   case 96: /* if_statement: KW_IF error expr error if_body KW_ELSE if_body  */
-#line 292 "parser.y"
-                                                       { (yyval.ast) = astCreate(AST_IF_ELSE, 0, (yyvsp[-4].ast), (yyvsp[-2].ast), (yyvsp[0].ast), NULL, getLineNumber()); fprintf(stderr, "Expecting if condition to be inside (...)\n"); SyntaxErrors++; }
-#line 2093 "y.tab.c"
+#line 232 "parser.y"
+                                                       { (yyval.ast) = astCreate(AST_IF_ELSE, 0, (yyvsp[-4].ast), (yyvsp[-2].ast), (yyvsp[0].ast), NULL, getLineNumber()); fprintf(compiler->diagnostics, "Expecting if condition to be inside (...)\n"); compiler->syntax_errors++; }
+#line 2036 "y.tab.c"
     break;
 
   case 97: /* if_statement: KW_IF error expr error KW_LOOP if_body  */
-#line 293 "parser.y"
-                                                       { (yyval.ast) = astCreate(AST_LOOP, 0, (yyvsp[-3].ast), (yyvsp[0].ast), NULL, NULL, getLineNumber()); fprintf(stderr, "Expecting loop condition to be inside (...)\n"); SyntaxErrors++;}
-#line 2099 "y.tab.c"
+#line 233 "parser.y"
+                                                       { (yyval.ast) = astCreate(AST_LOOP, 0, (yyvsp[-3].ast), (yyvsp[0].ast), NULL, NULL, getLineNumber()); fprintf(compiler->diagnostics, "Expecting loop condition to be inside (...)\n"); compiler->syntax_errors++;}
+#line 2042 "y.tab.c"
     break;
 
   case 98: /* cmd: var_attrib  */
-#line 296 "parser.y"
+#line 236 "parser.y"
                  {  (yyval.ast) = (yyvsp[0].ast); }
-#line 2105 "y.tab.c"
+#line 2048 "y.tab.c"
     break;
 
   case 99: /* cmd: vec_attrib  */
-#line 297 "parser.y"
+#line 237 "parser.y"
                  { (yyval.ast) = (yyvsp[0].ast); }
-#line 2111 "y.tab.c"
+#line 2054 "y.tab.c"
     break;
 
   case 100: /* cmd: output_cmd  */
-#line 298 "parser.y"
+#line 238 "parser.y"
                  { (yyval.ast) = (yyvsp[0].ast); }
-#line 2117 "y.tab.c"
+#line 2060 "y.tab.c"
     break;
 
   case 101: /* cmd: return_cmd  */
-#line 299 "parser.y"
+#line 239 "parser.y"
                  { (yyval.ast) = (yyvsp[0].ast); }
-#line 2123 "y.tab.c"
+#line 2066 "y.tab.c"
     break;
 
   case 102: /* cmd: %empty  */
-#line 300 "parser.y"
+#line 240 "parser.y"
       { (yyval.ast) = 0; }
-#line 2129 "y.tab.c"
+#line 2072 "y.tab.c"
     break;
 
   case 103: /* var_attrib: TK_IDENTIFIER '=' expr  */
-#line 303 "parser.y"
+#line 243 "parser.y"
                                    { (yyval.ast) = astCreate(AST_VAR_ATTRIB, (yyvsp[-2].symbol), (yyvsp[0].ast), NULL, NULL, NULL, getLineNumber());  }
-#line 2135 "y.tab.c"
+#line 2078 "y.tab.c"
     break;
 
   case 104: /* var_attrib: TK_IDENTIFIER error expr  */
-#line 304 "parser.y"
-                               { (yyval.ast) = astCreate(AST_VAR_ATTRIB, (yyvsp[-2].symbol), (yyvsp[0].ast), NULL, NULL, NULL, getLineNumber()); fprintf(stderr, "Expecting = on variable assignment\n"); SyntaxErrors++;  }
-#line 2141 "y.tab.c"
+#line 244 "parser.y"
+                               { (yyval.ast) = astCreate(AST_VAR_ATTRIB, (yyvsp[-2].symbol), (yyvsp[0].ast), NULL, NULL, NULL, getLineNumber()); fprintf(compiler->diagnostics, "Expecting = on variable assignment\n"); compiler->syntax_errors++;  }
+#line 2084 "y.tab.c"
     break;
 
   case 105: /* vec_attrib: TK_IDENTIFIER '[' expr ']' '=' expr  */
-#line 307 "parser.y"
+#line 247 "parser.y"
                                                 { (yyval.ast) = astCreate(AST_VEC_ATTRIB, (yyvsp[-5].symbol), (yyvsp[-3].ast), (yyvsp[0].ast), NULL, NULL, getLineNumber()); }
-#line 2147 "y.tab.c"
+#line 2090 "y.tab.c"
     break;
 
   case 106: /* vec_attrib: TK_IDENTIFIER '[' expr ']' error expr  */
-#line 308 "parser.y"
-                                            { (yyval.ast) = astCreate(AST_VEC_ATTRIB, (yyvsp[-5].symbol), (yyvsp[-3].ast), (yyvsp[0].ast), NULL, NULL, getLineNumber());  fprintf(stderr, "Expecting = on vector assignment\n"); SyntaxErrors++; }
-#line 2153 "y.tab.c"
+#line 248 "parser.y"
+                                            { (yyval.ast) = astCreate(AST_VEC_ATTRIB, (yyvsp[-5].symbol), (yyvsp[-3].ast), (yyvsp[0].ast), NULL, NULL, getLineNumber());  fprintf(compiler->diagnostics, "Expecting = on vector assignment\n"); compiler->syntax_errors++; }
+#line 2096 "y.tab.c"
     break;
 
   case 107: /* output_cmd: KW_OUTPUT output_param_list  */
-#line 311 "parser.y"
+#line 251 "parser.y"
                                         { (yyval.ast) = astCreate(AST_OUTPUT_CMD, 0, (yyvsp[0].ast), NULL, NULL, NULL, getLineNumber()); }
-#line 2159 "y.tab.c"
+#line 2102 "y.tab.c"
     break;
 
   case 108: /* output_param_list: LIT_STRING ',' output_param_list  */
-#line 314 "parser.y"
+#line 254 "parser.y"
                                                         { (yyval.ast) = astCreate(AST_OUTPUT_PARAM_LIST, NULL, astCreate(AST_LIT_STRING, (yyvsp[-2].symbol), NULL, NULL, NULL, NULL, getLineNumber()), (yyvsp[0].ast), NULL, NULL, getLineNumber()); }
-#line 2165 "y.tab.c"
+#line 2108 "y.tab.c"
     break;
 
   case 109: /* output_param_list: expr ',' output_param_list  */
-#line 315 "parser.y"
+#line 255 "parser.y"
                                                         { (yyval.ast) = astCreate(AST_OUTPUT_PARAM_LIST, 0, (yyvsp[-2].ast), (yyvsp[0].ast), NULL, NULL, getLineNumber()); }
-#line 2171 "y.tab.c"
+#line 2114 "y.tab.c"
     break;
 
   case 110: /* output_param_list: LIT_STRING  */
-#line 316 "parser.y"
+#line 256 "parser.y"
                                                         { (yyval.ast) = astCreate(AST_OUTPUT_PARAM_LIST, NULL, astCreate(AST_LIT_STRING, (yyvsp[0].symbol), NULL, NULL, NULL, NULL, getLineNumber()), NULL, NULL, NULL, getLineNumber()); }
-#line 2177 "y.tab.c"
+#line 2120 "y.tab.c"
     break;
 
   case 111: /* output_param_list: expr  */
-#line 317 "parser.y"
+#line 257 "parser.y"
                                                         { (yyval.ast) = astCreate(AST_OUTPUT_PARAM_LIST, NULL, (yyvsp[0].ast),  NULL, NULL, NULL, getLineNumber()); }
-#line 2183 "y.tab.c"
+#line 2126 "y.tab.c"
     break;
 
   case 112: /* output_param_list: LIT_STRING error output_param_list  */
-#line 320 "parser.y"
-                                            { (yyval.ast) = astCreate(AST_OUTPUT_PARAM_LIST, NULL, astCreate(AST_LIT_STRING, (yyvsp[-2].symbol), NULL, NULL, NULL, NULL, getLineNumber()), (yyvsp[0].ast), NULL, NULL, getLineNumber()); fprintf(stderr, "Expecting , on output command\n"); SyntaxErrors++; }
-#line 2189 "y.tab.c"
+#line 260 "parser.y"
+                                            { (yyval.ast) = astCreate(AST_OUTPUT_PARAM_LIST, NULL, astCreate(AST_LIT_STRING, (yyvsp[-2].symbol), NULL, NULL, NULL, NULL, getLineNumber()), (yyvsp[0].ast), NULL, NULL, getLineNumber()); fprintf(compiler->diagnostics, "Expecting , on output command\n"); compiler->syntax_errors++; }
+#line 2132 "y.tab.c"
     break;
 
   case 113: /* output_param_list: expr error output_param_list  */
-#line 321 "parser.y"
-                                            { (yyval.ast) = astCreate(AST_OUTPUT_PARAM_LIST, 0, (yyvsp[-2].ast), (yyvsp[0].ast), NULL, NULL, getLineNumber()); fprintf(stderr, "Expecting , on output command\n"); SyntaxErrors++; }
-#line 2195 "y.tab.c"
+#line 261 "parser.y"
+                                            { (yyval.ast) = astCreate(AST_OUTPUT_PARAM_LIST, 0, (yyvsp[-2].ast), (yyvsp[0].ast), NULL, NULL, getLineNumber()); fprintf(compiler->diagnostics, "Expecting , on output command\n"); compiler->syntax_errors++; }
+#line 2138 "y.tab.c"
     break;
 
   case 114: /* output_param_list: %empty  */
-#line 322 "parser.y"
+#line 262 "parser.y"
                    { (yyval.ast) = 0; }
-#line 2201 "y.tab.c"
+#line 2144 "y.tab.c"
     break;
 
   case 115: /* return_cmd: KW_RETURN expr  */
-#line 325 "parser.y"
+#line 265 "parser.y"
                            { (yyval.ast) = astCreate(AST_RETURN_CMD, 0, (yyvsp[0].ast), NULL, NULL, NULL, getLineNumber()); }
-#line 2207 "y.tab.c"
+#line 2150 "y.tab.c"
     break;
 
   case 116: /* input_expr: KW_INPUT '(' KW_INT ')'  */
-#line 330 "parser.y"
+#line 270 "parser.y"
                                      { (yyval.ast) = astCreate(AST_INPUT_EXPR_INT, 0, NULL, NULL, NULL, NULL, getLineNumber()); }
-#line 2213 "y.tab.c"
+#line 2156 "y.tab.c"
     break;
 
   case 117: /* input_expr: KW_INPUT '(' KW_CHAR ')'  */
-#line 331 "parser.y"
+#line 271 "parser.y"
                                      { (yyval.ast) = astCreate(AST_INPUT_EXPR_CHAR, 0, NULL, NULL, NULL, NULL, getLineNumber()); }
-#line 2219 "y.tab.c"
+#line 2162 "y.tab.c"
     break;
 
   case 118: /* input_expr: KW_INPUT '(' KW_REAL ')'  */
-#line 332 "parser.y"
+#line 272 "parser.y"
                                      { (yyval.ast) = astCreate(AST_INPUT_EXPR_REAL, 0, NULL, NULL, NULL, NULL, getLineNumber()); }
-#line 2225 "y.tab.c"
+#line 2168 "y.tab.c"
     break;
 
   case 119: /* input_expr: KW_INPUT '(' KW_BOOL ')'  */
-#line 333 "parser.y"
+#line 273 "parser.y"
                                      { (yyval.ast) = astCreate(AST_INPUT_EXPR_BOOL, 0, NULL, NULL, NULL, NULL, getLineNumber()); }
-#line 2231 "y.tab.c"
+#line 2174 "y.tab.c"
     break;
 
   case 120: /* input_expr: KW_INPUT '(' error ')'  */
-#line 336 "parser.y"
-                                   { (yyval.ast) = astCreate(AST_INPUT_EXPR_INT, 0, NULL, NULL, NULL, NULL, getLineNumber()); fprintf(stderr, "Expecting type on input command\n"); SyntaxErrors++; }
-#line 2237 "y.tab.c"
+#line 276 "parser.y"
+                                   { (yyval.ast) = astCreate(AST_INPUT_EXPR_INT, 0, NULL, NULL, NULL, NULL, getLineNumber()); fprintf(compiler->diagnostics, "Expecting type on input command\n"); compiler->syntax_errors++; }
+#line 2180 "y.tab.c"
     break;
 
   case 121: /* input_expr: KW_INPUT error  */
-#line 337 "parser.y"
-                           {  (yyval.ast) =  astCreate(AST_INPUT_EXPR_INT, 0, NULL, NULL, NULL, NULL, getLineNumber()); fprintf(stderr, "Expecting (type) on input command\n"); SyntaxErrors++; }
-#line 2243 "y.tab.c"
+#line 277 "parser.y"
+                           {  (yyval.ast) =  astCreate(AST_INPUT_EXPR_INT, 0, NULL, NULL, NULL, NULL, getLineNumber()); fprintf(compiler->diagnostics, "Expecting (type) on input command\n"); compiler->syntax_errors++; }
+#line 2186 "y.tab.c"
     break;
 
   case 122: /* input_expr: KW_INPUT error KW_INT ')'  */
-#line 339 "parser.y"
-                                      { (yyval.ast) =  astCreate(AST_INPUT_EXPR_INT, 0, NULL, NULL, NULL, NULL, getLineNumber()); fprintf(stderr, "Expecting ( after input command type, it should be input(int) instead\n"); SyntaxErrors++; }
-#line 2249 "y.tab.c"
+#line 279 "parser.y"
+                                      { (yyval.ast) =  astCreate(AST_INPUT_EXPR_INT, 0, NULL, NULL, NULL, NULL, getLineNumber()); fprintf(compiler->diagnostics, "Expecting ( after input command type, it should be input(int) instead\n"); compiler->syntax_errors++; }
+#line 2192 "y.tab.c"
     break;
 
   case 123: /* input_expr: KW_INPUT '(' KW_INT error  */
-#line 340 "parser.y"
-                                      {  (yyval.ast) =  astCreate(AST_INPUT_EXPR_INT, 0, NULL, NULL, NULL, NULL, getLineNumber()); fprintf(stderr, "Expecting ) after input command type, it should be input(int) instead\n"); SyntaxErrors++; }
-#line 2255 "y.tab.c"
+#line 280 "parser.y"
+                                      {  (yyval.ast) =  astCreate(AST_INPUT_EXPR_INT, 0, NULL, NULL, NULL, NULL, getLineNumber()); fprintf(compiler->diagnostics, "Expecting ) after input command type, it should be input(int) instead\n"); compiler->syntax_errors++; }
+#line 2198 "y.tab.c"
     break;
 
   case 124: /* input_expr: KW_INPUT error KW_INT error  */
-#line 341 "parser.y"
-                                        {  (yyval.ast) =  astCreate(AST_INPUT_EXPR_INT, 0, NULL, NULL, NULL, NULL, getLineNumber()); fprintf(stderr, "Expecting input command type to be this way input(int)\n"); SyntaxErrors++; }
-#line 2261 "y.tab.c"
+#line 281 "parser.y"
+                                        {  (yyval.ast) =  astCreate(AST_INPUT_EXPR_INT, 0, NULL, NULL, NULL, NULL, getLineNumber()); fprintf(compiler->diagnostics, "Expecting input command type to be this way input(int)\n"); compiler->syntax_errors++; }
+#line 2204 "y.tab.c"
     break;
 
   case 125: /* input_expr: KW_INPUT error KW_CHAR ')'  */
-#line 343 "parser.y"
-                                       {  (yyval.ast) = astCreate(AST_INPUT_EXPR_CHAR, 0, NULL, NULL, NULL, NULL, getLineNumber()); fprintf(stderr, "Expecting ( after input command type, it should be input(char) instead\n"); SyntaxErrors++; }
-#line 2267 "y.tab.c"
+#line 283 "parser.y"
+                                       {  (yyval.ast) = astCreate(AST_INPUT_EXPR_CHAR, 0, NULL, NULL, NULL, NULL, getLineNumber()); fprintf(compiler->diagnostics, "Expecting ( after input command type, it should be input(char) instead\n"); compiler->syntax_errors++; }
+#line 2210 "y.tab.c"
     break;
 
   case 126: /* input_expr: KW_INPUT '(' KW_CHAR error  */
-#line 344 "parser.y"
-                                       {  (yyval.ast) =  astCreate(AST_INPUT_EXPR_CHAR, 0, NULL, NULL, NULL, NULL, getLineNumber()); fprintf(stderr, "Expecting ) after input command type, it should be input(char) instead\n"); SyntaxErrors++; }
-#line 2273 "y.tab.c"
+#line 284 "parser.y"
+                                       {  (yyval.ast) =  astCreate(AST_INPUT_EXPR_CHAR, 0, NULL, NULL, NULL, NULL, getLineNumber()); fprintf(compiler->diagnostics, "Expecting ) after input command type, it should be input(char) instead\n"); compiler->syntax_errors++; }
+#line 2216 "y.tab.c"
     break;
 
   case 127: /* input_expr: KW_INPUT error KW_CHAR error  */
-#line 345 "parser.y"
-                                         {  (yyval.ast) =  astCreate(AST_INPUT_EXPR_CHAR, 0, NULL, NULL, NULL, NULL, getLineNumber()); fprintf(stderr, "Expecting input command type to be this way input(char)\n"); SyntaxErrors++; }
-#line 2279 "y.tab.c"
+#line 285 "parser.y"
+                                         {  (yyval.ast) =  astCreate(AST_INPUT_EXPR_CHAR, 0, NULL, NULL, NULL, NULL, getLineNumber()); fprintf(compiler->diagnostics, "Expecting input command type to be this way input(char)\n"); compiler->syntax_errors++; }
+#line 2222 "y.tab.c"
     break;
 
   case 128: /* input_expr: KW_INPUT error KW_REAL ')'  */
-#line 347 "parser.y"
-                                       {  (yyval.ast) = astCreate(AST_INPUT_EXPR_REAL, 0, NULL, NULL, NULL, NULL, getLineNumber()); fprintf(stderr, "Expecting ( after input command type, it should be input(real) instead\n"); SyntaxErrors++; }
-#line 2285 "y.tab.c"
+#line 287 "parser.y"
+                                       {  (yyval.ast) = astCreate(AST_INPUT_EXPR_REAL, 0, NULL, NULL, NULL, NULL, getLineNumber()); fprintf(compiler->diagnostics, "Expecting ( after input command type, it should be input(real) instead\n"); compiler->syntax_errors++; }
+#line 2228 "y.tab.c"
     break;
 
   case 129: /* input_expr: KW_INPUT '(' KW_REAL error  */
-#line 348 "parser.y"
-                                       {  (yyval.ast) =  astCreate(AST_INPUT_EXPR_REAL, 0, NULL, NULL, NULL, NULL, getLineNumber()); fprintf(stderr, "Expecting ) after input command type, it should be input(real) instead\n"); SyntaxErrors++; }
-#line 2291 "y.tab.c"
+#line 288 "parser.y"
+                                       {  (yyval.ast) =  astCreate(AST_INPUT_EXPR_REAL, 0, NULL, NULL, NULL, NULL, getLineNumber()); fprintf(compiler->diagnostics, "Expecting ) after input command type, it should be input(real) instead\n"); compiler->syntax_errors++; }
+#line 2234 "y.tab.c"
     break;
 
   case 130: /* input_expr: KW_INPUT error KW_REAL error  */
-#line 349 "parser.y"
-                                         {  (yyval.ast) =  astCreate(AST_INPUT_EXPR_REAL, 0, NULL, NULL, NULL, NULL, getLineNumber()); fprintf(stderr, "Expecting input command type to be this way input(real)\n"); SyntaxErrors++; }
-#line 2297 "y.tab.c"
+#line 289 "parser.y"
+                                         {  (yyval.ast) =  astCreate(AST_INPUT_EXPR_REAL, 0, NULL, NULL, NULL, NULL, getLineNumber()); fprintf(compiler->diagnostics, "Expecting input command type to be this way input(real)\n"); compiler->syntax_errors++; }
+#line 2240 "y.tab.c"
     break;
 
   case 131: /* input_expr: KW_INPUT error KW_BOOL ')'  */
-#line 351 "parser.y"
-                                       {  (yyval.ast) = astCreate(AST_INPUT_EXPR_BOOL, 0, NULL, NULL, NULL, NULL, getLineNumber()); fprintf(stderr, "Expecting ( before input command type, it should be input(bool) instead\n"); SyntaxErrors++; }
-#line 2303 "y.tab.c"
+#line 291 "parser.y"
+                                       {  (yyval.ast) = astCreate(AST_INPUT_EXPR_BOOL, 0, NULL, NULL, NULL, NULL, getLineNumber()); fprintf(compiler->diagnostics, "Expecting ( before input command type, it should be input(bool) instead\n"); compiler->syntax_errors++; }
+#line 2246 "y.tab.c"
     break;
 
   case 132: /* input_expr: KW_INPUT '(' KW_BOOL error  */
-#line 352 "parser.y"
-                                       {  (yyval.ast) =  astCreate(AST_INPUT_EXPR_BOOL, 0, NULL, NULL, NULL, NULL, getLineNumber()); fprintf(stderr, "Expecting ) after input command type, it should be input(bool) instead\n"); SyntaxErrors++; }
-#line 2309 "y.tab.c"
+#line 292 "parser.y"
+                                       {  (yyval.ast) =  astCreate(AST_INPUT_EXPR_BOOL, 0, NULL, NULL, NULL, NULL, getLineNumber()); fprintf(compiler->diagnostics, "Expecting ) after input command type, it should be input(bool) instead\n"); compiler->syntax_errors++; }
+#line 2252 "y.tab.c"
     break;
 
   case 133: /* input_expr: KW_INPUT error KW_BOOL error  */
-#line 353 "parser.y"
-                                         {   (yyval.ast) = astCreate(AST_INPUT_EXPR_BOOL, 0, NULL, NULL, NULL, NULL, getLineNumber()); fprintf(stderr, "Expecting input command type to be this way input(bool)\n"); SyntaxErrors++; }
-#line 2315 "y.tab.c"
+#line 293 "parser.y"
+                                         {   (yyval.ast) = astCreate(AST_INPUT_EXPR_BOOL, 0, NULL, NULL, NULL, NULL, getLineNumber()); fprintf(compiler->diagnostics, "Expecting input command type to be this way input(bool)\n"); compiler->syntax_errors++; }
+#line 2258 "y.tab.c"
     break;
 
   case 134: /* expr: LIT_INT  */
-#line 357 "parser.y"
+#line 297 "parser.y"
                                             { (yyval.ast) = astCreate(AST_LIT_INT, (yyvsp[0].symbol), NULL, NULL, NULL, NULL, getLineNumber()); }
-#line 2321 "y.tab.c"
+#line 2264 "y.tab.c"
     break;
 
   case 135: /* expr: TK_IDENTIFIER  */
-#line 358 "parser.y"
+#line 298 "parser.y"
                                             { (yyval.ast) = astCreate(AST_IDENTIFIER, (yyvsp[0].symbol), NULL, NULL, NULL, NULL, getLineNumber());    }
-#line 2327 "y.tab.c"
+#line 2270 "y.tab.c"
     break;
 
   case 136: /* expr: LIT_CHAR  */
-#line 359 "parser.y"
+#line 299 "parser.y"
                                             { (yyval.ast) = astCreate(AST_LIT_CHAR, (yyvsp[0].symbol), NULL, NULL, NULL, NULL, getLineNumber()); }
-#line 2333 "y.tab.c"
+#line 2276 "y.tab.c"
     break;
 
   case 137: /* expr: LIT_REAL  */
-#line 360 "parser.y"
+#line 300 "parser.y"
                                             { (yyval.ast) = astCreate(AST_LIT_REAL, (yyvsp[0].symbol), NULL, NULL, NULL, NULL, getLineNumber()); }
-#line 2339 "y.tab.c"
+#line 2282 "y.tab.c"
     break;
 
   case 138: /* expr: TK_IDENTIFIER '[' expr ']'  */
-#line 361 "parser.y"
+#line 301 "parser.y"
                                             { (yyval.ast) = astCreate(AST_VEC_ACCESS, (yyvsp[-3].symbol), (yyvsp[-1].ast), NULL, NULL, NULL, getLineNumber());   }
-#line 2345 "y.tab.c"
+#line 2288 "y.tab.c"
     break;
 
   case 139: /* expr: input_expr  */
-#line 362 "parser.y"
+#line 302 "parser.y"
                                             { (yyval.ast) = (yyvsp[0].ast);                                                 }
-#line 2351 "y.tab.c"
+#line 2294 "y.tab.c"
     break;
 
   case 140: /* expr: func_call  */
-#line 363 "parser.y"
+#line 303 "parser.y"
                                             { (yyval.ast) = (yyvsp[0].ast);                                                }
-#line 2357 "y.tab.c"
+#line 2300 "y.tab.c"
     break;
 
   case 141: /* expr: expr '*' expr  */
-#line 364 "parser.y"
+#line 304 "parser.y"
                                             { (yyval.ast) = astCreate(AST_MUL, 0, (yyvsp[-2].ast), (yyvsp[0].ast), NULL, NULL, getLineNumber());         }
-#line 2363 "y.tab.c"
+#line 2306 "y.tab.c"
     break;
 
   case 142: /* expr: expr '/' expr  */
-#line 365 "parser.y"
+#line 305 "parser.y"
                                             { (yyval.ast) = astCreate(AST_DIV, 0, (yyvsp[-2].ast), (yyvsp[0].ast), NULL, NULL, getLineNumber());         }
-#line 2369 "y.tab.c"
+#line 2312 "y.tab.c"
     break;
 
   case 143: /* expr: expr '+' expr  */
-#line 366 "parser.y"
+#line 306 "parser.y"
                                             { (yyval.ast) = astCreate(AST_ADD, 0, (yyvsp[-2].ast), (yyvsp[0].ast), NULL, NULL, getLineNumber());         }
-#line 2375 "y.tab.c"
+#line 2318 "y.tab.c"
     break;
 
   case 144: /* expr: expr '-' expr  */
-#line 367 "parser.y"
+#line 307 "parser.y"
                                             { (yyval.ast) = astCreate(AST_SUB, 0, (yyvsp[-2].ast), (yyvsp[0].ast), NULL, NULL, getLineNumber());         }
-#line 2381 "y.tab.c"
+#line 2324 "y.tab.c"
     break;
 
   case 145: /* expr: '-' expr  */
-#line 368 "parser.y"
+#line 308 "parser.y"
                                             { (yyval.ast) = astCreate(AST_NEG, 0, (yyvsp[0].ast), NULL, NULL, NULL, getLineNumber());       }
-#line 2387 "y.tab.c"
+#line 2330 "y.tab.c"
     break;
 
   case 146: /* expr: '~' expr  */
-#line 369 "parser.y"
+#line 309 "parser.y"
                                             { (yyval.ast) = astCreate(AST_NOT, 0, (yyvsp[0].ast), NULL, NULL, NULL, getLineNumber());       }
-#line 2393 "y.tab.c"
+#line 2336 "y.tab.c"
     break;
 
   case 147: /* expr: expr '&' expr  */
-#line 370 "parser.y"
+#line 310 "parser.y"
                                             { (yyval.ast) = astCreate(AST_AND, 0, (yyvsp[-2].ast), (yyvsp[0].ast), NULL, NULL, getLineNumber());         }
-#line 2399 "y.tab.c"
+#line 2342 "y.tab.c"
     break;
 
   case 148: /* expr: expr '|' expr  */
-#line 371 "parser.y"
+#line 311 "parser.y"
                                             { (yyval.ast) = astCreate(AST_OR, 0, (yyvsp[-2].ast), (yyvsp[0].ast), NULL, NULL, getLineNumber());          }
-#line 2405 "y.tab.c"
+#line 2348 "y.tab.c"
     break;
 
   case 149: /* expr: expr OPERATOR_LE expr  */
-#line 372 "parser.y"
+#line 312 "parser.y"
                                             { (yyval.ast) = astCreate(AST_LE, 0, (yyvsp[-2].ast), (yyvsp[0].ast), NULL, NULL, getLineNumber());          }
-#line 2411 "y.tab.c"
+#line 2354 "y.tab.c"
     break;
 
   case 150: /* expr: expr OPERATOR_GE expr  */
-#line 373 "parser.y"
+#line 313 "parser.y"
                                             { (yyval.ast) = astCreate(AST_GE, 0, (yyvsp[-2].ast), (yyvsp[0].ast), NULL, NULL, getLineNumber());          }
-#line 2417 "y.tab.c"
+#line 2360 "y.tab.c"
     break;
 
   case 151: /* expr: expr OPERATOR_EQ expr  */
-#line 374 "parser.y"
+#line 314 "parser.y"
                                             { (yyval.ast) = astCreate(AST_EQ, 0, (yyvsp[-2].ast), (yyvsp[0].ast), NULL, NULL, getLineNumber());          }
-#line 2423 "y.tab.c"
+#line 2366 "y.tab.c"
     break;
 
   case 152: /* expr: expr OPERATOR_DIF expr  */
-#line 375 "parser.y"
+#line 315 "parser.y"
                                             { (yyval.ast) = astCreate(AST_DIF, 0, (yyvsp[-2].ast), (yyvsp[0].ast), NULL, NULL, getLineNumber());         }
-#line 2429 "y.tab.c"
+#line 2372 "y.tab.c"
     break;
 
   case 153: /* expr: expr '>' expr  */
-#line 376 "parser.y"
+#line 316 "parser.y"
                                             { (yyval.ast) = astCreate(AST_GT, 0, (yyvsp[-2].ast), (yyvsp[0].ast), NULL, NULL, getLineNumber());          }
-#line 2435 "y.tab.c"
+#line 2378 "y.tab.c"
     break;
 
   case 154: /* expr: expr '<' expr  */
-#line 377 "parser.y"
+#line 317 "parser.y"
                                             { (yyval.ast) = astCreate(AST_LT, 0, (yyvsp[-2].ast), (yyvsp[0].ast), NULL, NULL, getLineNumber());          }
-#line 2441 "y.tab.c"
+#line 2384 "y.tab.c"
     break;
 
   case 155: /* expr: '(' expr ')'  */
-#line 378 "parser.y"
+#line 318 "parser.y"
                                             { (yyval.ast) = astCreate(AST_NESTED_EXPR, 0, (yyvsp[-1].ast), NULL, NULL, NULL, getLineNumber()); }
-#line 2447 "y.tab.c"
+#line 2390 "y.tab.c"
     break;
 
   case 156: /* func_call: TK_IDENTIFIER '(' expr_list ')'  */
-#line 383 "parser.y"
+#line 323 "parser.y"
                                            { (yyval.ast) = astCreate(AST_FUNC_CALL, (yyvsp[-3].symbol), (yyvsp[-1].ast), NULL, NULL, NULL, getLineNumber());  }
-#line 2453 "y.tab.c"
+#line 2396 "y.tab.c"
     break;
 
   case 157: /* func_call: TK_IDENTIFIER '(' expr_list error  */
-#line 385 "parser.y"
-                                        { (yyval.ast) = astCreate(AST_FUNC_CALL, (yyvsp[-3].symbol), (yyvsp[-1].ast), NULL, NULL, NULL, getLineNumber()); fprintf(stderr, "Expecting ) on end of function call\n"); SyntaxErrors++; }
-#line 2459 "y.tab.c"
+#line 325 "parser.y"
+                                        { (yyval.ast) = astCreate(AST_FUNC_CALL, (yyvsp[-3].symbol), (yyvsp[-1].ast), NULL, NULL, NULL, getLineNumber()); fprintf(compiler->diagnostics, "Expecting ) on end of function call\n"); compiler->syntax_errors++; }
+#line 2402 "y.tab.c"
     break;
 
   case 158: /* func_call: TK_IDENTIFIER error expr_list ')'  */
-#line 386 "parser.y"
-                                        { (yyval.ast) = astCreate(AST_FUNC_CALL, (yyvsp[-3].symbol), (yyvsp[-1].ast), NULL, NULL, NULL, getLineNumber()); fprintf(stderr, "Expecting ( on start of function call\n"); SyntaxErrors++; }
-#line 2465 "y.tab.c"
+#line 326 "parser.y"
+                                        { (yyval.ast) = astCreate(AST_FUNC_CALL, (yyvsp[-3].symbol), (yyvsp[-1].ast), NULL, NULL, NULL, getLineNumber()); fprintf(compiler->diagnostics, "Expecting ( on start of function call\n"); compiler->syntax_errors++; }
+#line 2408 "y.tab.c"
     break;
 
   case 159: /* func_call: TK_IDENTIFIER error expr_list error  */
-#line 387 "parser.y"
-                                          { (yyval.ast) = astCreate(AST_FUNC_CALL, (yyvsp[-3].symbol), (yyvsp[-1].ast), NULL, NULL, NULL, getLineNumber()); fprintf(stderr, "Expecting function parameters to be inside (...)\n"); SyntaxErrors++; }
-#line 2471 "y.tab.c"
+#line 327 "parser.y"
+                                          { (yyval.ast) = astCreate(AST_FUNC_CALL, (yyvsp[-3].symbol), (yyvsp[-1].ast), NULL, NULL, NULL, getLineNumber()); fprintf(compiler->diagnostics, "Expecting function parameters to be inside (...)\n"); compiler->syntax_errors++; }
+#line 2414 "y.tab.c"
     break;
 
   case 160: /* expr_list: expr expr_list_aux  */
-#line 390 "parser.y"
+#line 330 "parser.y"
                                       { (yyval.ast) = astCreate(AST_EXPR_LIST, NULL, (yyvsp[-1].ast), (yyvsp[0].ast), NULL, NULL, getLineNumber());}
-#line 2477 "y.tab.c"
+#line 2420 "y.tab.c"
     break;
 
   case 161: /* expr_list: %empty  */
-#line 391 "parser.y"
+#line 331 "parser.y"
                                       { (yyval.ast) = 0; }
-#line 2483 "y.tab.c"
+#line 2426 "y.tab.c"
     break;
 
   case 162: /* expr_list_aux: ',' expr expr_list_aux  */
-#line 394 "parser.y"
+#line 334 "parser.y"
                                       { (yyval.ast) = astCreate(AST_EXPR_LIST, NULL, (yyvsp[-1].ast), (yyvsp[0].ast), NULL, NULL, getLineNumber());}
-#line 2489 "y.tab.c"
+#line 2432 "y.tab.c"
     break;
 
   case 163: /* expr_list_aux: error expr expr_list_aux  */
-#line 396 "parser.y"
-                               { (yyval.ast) = astCreate(AST_EXPR_LIST, NULL, (yyvsp[-1].ast), (yyvsp[0].ast), NULL, NULL, getLineNumber()); fprintf(stderr, "Expecting function parameters to be separated by a ,\n"); SyntaxErrors++; }
-#line 2495 "y.tab.c"
+#line 336 "parser.y"
+                               { (yyval.ast) = astCreate(AST_EXPR_LIST, NULL, (yyvsp[-1].ast), (yyvsp[0].ast), NULL, NULL, getLineNumber()); fprintf(compiler->diagnostics, "Expecting function parameters to be separated by a ,\n"); compiler->syntax_errors++; }
+#line 2438 "y.tab.c"
     break;
 
   case 164: /* expr_list_aux: %empty  */
-#line 397 "parser.y"
+#line 337 "parser.y"
                                       { (yyval.ast) = 0; }
-#line 2501 "y.tab.c"
+#line 2444 "y.tab.c"
     break;
 
 
-#line 2505 "y.tab.c"
+#line 2448 "y.tab.c"
 
       default: break;
     }
@@ -2694,7 +2637,7 @@ yyreturnlab:
   return yyresult;
 }
 
-#line 401 "parser.y"
+#line 341 "parser.y"
 
 
 #include "definitions.h" // yyparse() is defined here